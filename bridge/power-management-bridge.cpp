@@ -0,0 +1,776 @@
+/*       Power Management Serial Bridge
+
+Owns the serial port of a BMS and shares it among many TCP clients, each with
+its own bounded send buffer, so that the GUIs can connect over a network.
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include "power-management-bridge.h"
+#include <QCoreApplication>
+#include <csignal>
+#include <cstdio>
+
+static volatile sig_atomic_t stopSignal = 0;
+
+//-----------------------------------------------------------------------------
+/** Serial Bridge Constructor
+*/
+
+SerialBridge::SerialBridge(QObject* parent) : QObject(parent)
+{
+    serial = NULL;
+    serialDevice = DEFAULT_SERIAL_PORT;
+    serialBaudrate = DEFAULT_BAUDRATE;
+    clientLimit = BRIDGE_MAX_CLIENTS;
+    clientBuffer = BRIDGE_CLIENT_BUFFER;
+    linesRead = 0;
+    bytesRead = 0;
+    linesDiscarded = 0;
+    commandsWritten = 0;
+    nextSequence = 0;
+    bytesSent = 0;
+    bytesTaken = 0;
+    takenTime = 0;
+    takeRate = qMax(1, serialBaudrate*BRIDGE_SEND_SHARE/1000);
+    clock.start();
+    sendTimer.setSingleShot(true);
+    connect(&sendTimer, SIGNAL(timeout()), this, SLOT(schedule()));
+    expiryTimer.setInterval(BRIDGE_SIGNAL_INTERVAL);
+    connect(&expiryTimer, SIGNAL(timeout()), this, SLOT(onExpiryCheck()));
+    reopenTimer.setSingleShot(true);
+    reopenTimer.setInterval(BRIDGE_REOPEN_TIME);
+    connect(&reopenTimer, SIGNAL(timeout()), this, SLOT(onReopen()));
+    connect(&statisticsTimer, SIGNAL(timeout()), this, SLOT(onStatistics()));
+    signalCheck.setInterval(BRIDGE_SIGNAL_INTERVAL);
+    connect(&signalCheck, SIGNAL(timeout()), this, SLOT(onSignalCheck()));
+    connect(&server, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+}
+
+SerialBridge::~SerialBridge()
+{
+    closeSerial();
+    while (! clients.isEmpty())
+    {
+        BridgeClient* client = clients.takeFirst();
+        client->socket->disconnect(this);
+        delete client->socket;
+        delete client;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the serial port of the BMS
+
+Ten bits are sent for each byte, and the BMS is assumed to take commands at
+BRIDGE_SEND_SHARE of them.
+
+@param[in] device Serial device name.
+@param[in] baudrate Baud rate.
+*/
+
+void SerialBridge::setSerial(QString device, qint32 baudrate)
+{
+    serialDevice = device;
+    serialBaudrate = baudrate;
+    takeRate = qMax(1, serialBaudrate*BRIDGE_SEND_SHARE/1000);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the number of clients and the bytes held for each
+
+@param[in] maxClients Clients served at once. Others are refused.
+@param[in] bufferSize Bytes held for a client before lines are dropped.
+*/
+
+void SerialBridge::setClientLimits(int maxClients, qint64 bufferSize)
+{
+    if (maxClients > 0) clientLimit = maxClients;
+    if (bufferSize >= BRIDGE_MAX_RESPONSE) clientBuffer = bufferSize;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the time between reports of the counters
+
+@param[in] seconds Interval, zero for no reports.
+*/
+
+void SerialBridge::setStatisticsInterval(int seconds)
+{
+    if (seconds > 0) statisticsTimer.setInterval(seconds*1000);
+    else statisticsTimer.setInterval(0);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Listen for clients on a TCP port
+
+@param[in] port TCP port.
+@returns true if listening.
+*/
+
+bool SerialBridge::listenTcp(quint16 port)
+{
+    if (server.listen(QHostAddress::Any, port)) return true;
+    fprintf(stderr, "Unable to listen on port %u: %s\n", port,
+            qPrintable(server.errorString()));
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Open the serial port and start serving
+
+If the port cannot be opened it is tried again every BRIDGE_REOPEN_TIME.
+*/
+
+void SerialBridge::start()
+{
+    if (! openSerial()) reopenTimer.start();
+    if (statisticsTimer.interval() > 0) statisticsTimer.start();
+    signalCheck.start();
+    expiryTimer.start();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Stop serving and report the counters
+
+Commands still waiting to be paced out are sent at once, so that the last
+commands of the clients are not lost.
+*/
+
+void SerialBridge::stop()
+{
+    signalCheck.stop();
+    statisticsTimer.stop();
+    reopenTimer.stop();
+    expiryTimer.stop();
+    sendTimer.stop();
+    server.close();
+    if (serial != NULL)
+        for (int i=0; i<outbound.size(); i++) sendSerial(outbound[i].data);
+    outbound.clear();
+    onStatistics();
+    for (int i=0; i<clients.size(); i++) clients[i]->socket->flush();
+    closeSerial();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Signal handler for stopping the bridge
+
+Only sets a flag, which is acted on by the signal check timer.
+*/
+
+void SerialBridge::signalHandler(int signal)
+{
+    Q_UNUSED(signal);
+    stopSignal = 1;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Stop and quit if a signal has been received
+*/
+
+void SerialBridge::onSignalCheck()
+{
+    if (! stopSignal) return;
+    stop();
+    QCoreApplication::quit();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Open the serial port
+
+The BMS is told to forget the sequence numbers it has seen, as the bridge
+numbers the commands of its clients afresh.
+
+@returns true if the port was opened.
+*/
+
+bool SerialBridge::openSerial()
+{
+    closeSerial();
+    serial = new QSerialPort(serialDevice, this);
+    if (! serial->open(QIODevice::ReadWrite))
+    {
+        fprintf(stderr, "Unable to open %s: %s\n", qPrintable(serialDevice),
+                qPrintable(serial->errorString()));
+        delete serial;
+        serial = NULL;
+        return false;
+    }
+    serial->setBaudRate(serialBaudrate);
+    serial->setDataBits(QSerialPort::Data8);
+    serial->setParity(QSerialPort::NoParity);
+    serial->setStopBits(QSerialPort::OneStop);
+    serial->setFlowControl(QSerialPort::NoFlowControl);
+    connect(serial, SIGNAL(readyRead()), this, SLOT(onSerialData()));
+    connect(serial, SIGNAL(errorOccurred(QSerialPort::SerialPortError)),
+            this, SLOT(onSerialError(QSerialPort::SerialPortError)));
+    fprintf(stderr, "Opened %s at %d baud\n", qPrintable(serialDevice),
+            serialBaudrate);
+    nextSequence = 0;
+    queueSerial("aK\n\r");
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Close the serial port, giving commands not yet sent a short time
+
+Commands waiting to be paced out or for acknowledgement are forgotten. The
+clients send again those they still want.
+*/
+
+void SerialBridge::closeSerial()
+{
+    if (serial == NULL) return;
+    sendTimer.stop();
+    outbound.clear();
+    waiting.clear();
+    outstanding.clear();
+    bytesSent = 0;
+    bytesTaken = 0;
+    serial->disconnect(this);
+    if (serial->bytesToWrite() > 0) serial->waitForBytesWritten(100);
+    serial->close();
+    serial->deleteLater();
+    serial = NULL;
+    buffer.clear();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Close the serial port when the device has gone away
+
+A resource error means that the device has gone away, as when a USB adapter
+is unplugged. Opening is tried again later. The clients stay connected.
+*/
+
+void SerialBridge::onSerialError(QSerialPort::SerialPortError error)
+{
+    if (error != QSerialPort::ResourceError) return;
+    fprintf(stderr, "Lost %s\n", qPrintable(serialDevice));
+    closeSerial();
+    reopenTimer.start();
+}
+
+void SerialBridge::onReopen()
+{
+    if (! openSerial()) reopenTimer.start();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Pass the complete lines received from the BMS to every client
+
+All bytes available are read at once and each line is passed on as received,
+with its line ending. A partial line is held until the rest arrives. A line
+longer than BRIDGE_MAX_RESPONSE is taken as garbage and discarded.
+
+Acknowledgements of sequenced commands are not passed to every client but only
+to the client whose command it was.
+*/
+
+void SerialBridge::onSerialData()
+{
+    QByteArray data = serial->readAll();
+    bytesRead += data.size();
+    buffer.append(data);
+    int start = 0;
+    int end;
+    while ((end = buffer.indexOf('\n', start)) >= 0)
+    {
+        QByteArray line = buffer.mid(start, end+1-start);
+        start = end+1;
+        linesRead++;
+        if (line.startsWith("aK,"))
+        {
+            bool ok;
+            int sequence = line.mid(3).trimmed().toInt(&ok);
+            if (ok)
+            {
+                acknowledge(sequence);
+                continue;
+            }
+        }
+        for (int i=0; i<clients.size(); i++) queueLine(clients[i], line);
+    }
+    buffer.remove(0, start);
+    if (buffer.size() > BRIDGE_MAX_RESPONSE)
+    {
+        buffer.clear();
+        linesDiscarded++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Hold a line for a client and send what the client can take
+
+The oldest lines are dropped while the client holds more than its buffer.
+
+@param[in] client Client.
+@param[in] line Line with its line ending.
+*/
+
+void SerialBridge::queueLine(BridgeClient* client, const QByteArray& line)
+{
+    client->pending.append(line);
+    client->pendingBytes += line.size();
+    while (client->pendingBytes > clientBuffer)
+    {
+        client->pendingBytes -= client->pending.takeFirst().size();
+        client->linesDropped++;
+    }
+    flush(client);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Give a client the lines held for it while its socket has room
+
+Lines are given only while the socket holds less than BRIDGE_CLIENT_CHUNK
+not yet sent, so that lines wait in the bounded buffer rather than in the
+socket. This is called again as the socket sends.
+*/
+
+void SerialBridge::flush(BridgeClient* client)
+{
+    while (! client->pending.isEmpty() &&
+           (client->socket->bytesToWrite() < BRIDGE_CLIENT_CHUNK))
+    {
+        QByteArray line = client->pending.takeFirst();
+        client->pendingBytes -= line.size();
+        client->socket->write(line);
+        client->linesSent++;
+        client->bytesSent += line.size();
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Accept new clients up to the limit
+*/
+
+void SerialBridge::onNewConnection()
+{
+    while (server.hasPendingConnections())
+    {
+        QTcpSocket* socket = server.nextPendingConnection();
+        QString name = QString("%1:%2").arg(socket->peerAddress().toString())
+                                       .arg(socket->peerPort());
+        if (clients.size() >= clientLimit)
+        {
+            fprintf(stderr, "Refused %s, %d clients connected\n",
+                    qPrintable(name), clients.size());
+            socket->abort();
+            socket->deleteLater();
+            continue;
+        }
+        BridgeClient* client = new BridgeClient;
+        client->socket = socket;
+        client->name = name;
+        client->pendingBytes = 0;
+        client->discarding = false;
+        client->linesSent = 0;
+        client->bytesSent = 0;
+        client->linesDropped = 0;
+        client->bytesReceived = 0;
+        client->commandsForwarded = 0;
+        client->commandsDiscarded = 0;
+        client->commandsAnswered = 0;
+        clients.append(client);
+        connect(socket, SIGNAL(readyRead()), this, SLOT(onClientData()));
+        connect(socket, SIGNAL(bytesWritten(qint64)),
+                this, SLOT(onClientBytesWritten()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(onClientDisconnected()));
+        fprintf(stderr, "Connected %s\n", qPrintable(name));
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Find the client of a socket
+*/
+
+BridgeClient* SerialBridge::findClient(QObject* socket) const
+{
+    for (int i=0; i<clients.size(); i++)
+        if (clients[i]->socket == socket) return clients[i];
+    return NULL;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Frame the command lines from a client
+
+Either a carriage return or a newline ends a command, as in the firmware, and
+empty lines are ignored. A line too long for the firmware is discarded up to
+its end.
+*/
+
+void SerialBridge::onClientData()
+{
+    BridgeClient* client = findClient(sender());
+    if (client == NULL) return;
+    QByteArray data = client->socket->readAll();
+    client->bytesReceived += data.size();
+    for (int i=0; i<data.size(); i++)
+    {
+        char character = data.at(i);
+        if ((character == '\r') || (character == '\n'))
+        {
+            if (! client->discarding && ! client->input.isEmpty())
+                forwardCommand(client, client->input);
+            client->input.clear();
+            client->discarding = false;
+        }
+        else if (! client->discarding)
+        {
+            client->input.append(character);
+            if (client->input.size() > BRIDGE_MAX_LINE)
+            {
+                client->input.clear();
+                client->discarding = true;
+                client->commandsDiscarded++;
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send a complete command to the BMS
+
+Commands are discarded while the serial port is closed. A sequenced command is
+renumbered. Commands that would upset the other clients are answered here:
+aK only starts the numbering of this client afresh, and pc- is sent only when
+no other client is left to want the telemetry.
+
+@param[in] client Client that sent the command.
+@param[in] command Command without its line ending.
+*/
+
+void SerialBridge::forwardCommand(BridgeClient* client, const QByteArray& command)
+{
+    if (serial == NULL)
+    {
+        client->commandsDiscarded++;
+        return;
+    }
+    QByteArray body = command;
+    int clientSequence = -1;
+    if (command.startsWith('#'))
+    {
+        int comma = command.indexOf(',');
+        bool ok = false;
+        if (comma > 1) clientSequence = command.mid(1, comma-1).toInt(&ok);
+        if (! ok || (clientSequence < 0) || (clientSequence > 255))
+        {
+            client->commandsDiscarded++;
+            return;
+        }
+        body = command.mid(comma+1);
+    }
+    if ((body == "aK") || ((body == "pc-") && (clients.size() > 1)))
+    {
+        if (body == "aK") resetClient(client);
+        if (clientSequence >= 0) answer(client, clientSequence);
+        client->commandsAnswered++;
+        return;
+    }
+    if (clientSequence >= 0) forwardSequenced(client, clientSequence, body);
+    else
+    {
+        queueSerial(command + "\n\r");
+        client->commandsForwarded++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send a sequenced command to the BMS under a number of the bridge
+
+A command already acknowledged is answered here without being sent, as the BMS
+would. One still outstanding is sent again under the number it was given, so
+that the BMS recognises it. A new one waits for a number, which is given when
+the window has room.
+
+@param[in] client Client that sent the command.
+@param[in] clientSequence Number given by the client.
+@param[in] command Command without its number and line ending.
+*/
+
+void SerialBridge::forwardSequenced(BridgeClient* client, int clientSequence,
+                                    const QByteArray& command)
+{
+    if (client->acknowledged.contains(clientSequence))
+    {
+        answer(client, clientSequence);
+        client->commandsAnswered++;
+        return;
+    }
+    for (int i=0; i<outstanding.size(); i++)
+    {
+        if ((outstanding[i].client != client) ||
+            (outstanding[i].clientSequence != clientSequence)) continue;
+        int sequence = outstanding[i].sequence;
+        for (int j=0; j<outbound.size(); j++)
+            if (outbound[j].sequence == sequence) return;
+        queueSerial(QByteArray("#") + QByteArray::number(sequence) + ","
+                    + outstanding[i].command + "\n\r", sequence);
+        client->commandsForwarded++;
+        return;
+    }
+    for (int i=0; i<waiting.size(); i++)
+        if ((waiting[i].client == client) &&
+            (waiting[i].clientSequence == clientSequence)) return;
+    BridgeCommand entry;
+    entry.client = client;
+    entry.clientSequence = clientSequence;
+    entry.sequence = -1;
+    entry.command = command;
+    entry.sent = -1;
+    entry.mark = 0;
+    entry.sendings = 0;
+    waiting.append(entry);
+    client->commandsForwarded++;
+    fillWindow();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Number and send waiting commands while the window has room
+
+The window slides only as the oldest outstanding command is acknowledged or
+forgotten, so that the numbers outstanding never span more than BRIDGE_WINDOW.
+*/
+
+void SerialBridge::fillWindow()
+{
+    while (! waiting.isEmpty())
+    {
+        if (! outstanding.isEmpty() &&
+            ((nextSequence - outstanding.first().sequence + 256) % 256
+                >= BRIDGE_WINDOW)) break;
+        BridgeCommand entry = waiting.takeFirst();
+        entry.sequence = nextSequence;
+        nextSequence = (nextSequence+1) % 256;
+        outstanding.append(entry);
+        queueSerial(QByteArray("#") + QByteArray::number(entry.sequence) + ","
+                    + entry.command + "\n\r", entry.sequence);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Pass an acknowledgement to the client whose command it was
+
+Acknowledgements of commands already dealt with are dropped. The
+acknowledgement of a first sending shows that the BMS has taken all bytes sent
+up to the command, which lets the scheduler send more.
+
+@param[in] sequence Number given by the bridge.
+*/
+
+void SerialBridge::acknowledge(int sequence)
+{
+    for (int i=0; i<outstanding.size(); i++)
+    {
+        if (outstanding[i].sequence != sequence) continue;
+        BridgeCommand entry = outstanding.takeAt(i);
+        if ((entry.sendings == 1) && (entry.mark > bytesTaken))
+            bytesTaken = entry.mark;
+        if (entry.client != NULL) answer(entry.client, entry.clientSequence);
+        fillWindow();
+        schedule();
+        return;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Acknowledge a command to a client under the client's number
+
+The number is remembered so that the command is answered here if sent again.
+
+@param[in] client Client.
+@param[in] clientSequence Number given by the client.
+*/
+
+void SerialBridge::answer(BridgeClient* client, int clientSequence)
+{
+    if (! client->acknowledged.contains(clientSequence))
+    {
+        client->acknowledged.append(clientSequence);
+        if (client->acknowledged.size() > BRIDGE_SEQUENCE_HISTORY)
+            client->acknowledged.removeFirst();
+    }
+    queueLine(client, QByteArray("aK,") + QByteArray::number(clientSequence)
+                      + "\r\n");
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Forget the numbering of a client
+
+Called when the client starts its numbering afresh or leaves. Its commands
+waiting for a number are dropped. Those outstanding keep their place in the
+window until acknowledged or forgotten, but the acknowledgement goes nowhere.
+*/
+
+void SerialBridge::resetClient(BridgeClient* client)
+{
+    client->acknowledged.clear();
+    for (int i=0; i<waiting.size(); i++)
+        if (waiting[i].client == client) waiting.removeAt(i--);
+    for (int i=0; i<outstanding.size(); i++)
+        if (outstanding[i].client == client) outstanding[i].client = NULL;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Forget sequenced commands never acknowledged
+
+A command not acknowledged within BRIDGE_COMMAND_EXPIRY of its last sending has
+been given up by its client, and its place in the window is freed.
+*/
+
+void SerialBridge::onExpiryCheck()
+{
+    qint64 now = clock.elapsed();
+    bool expired = false;
+    for (int i=0; i<outstanding.size(); i++)
+    {
+        if ((outstanding[i].sent < 0) ||
+            (now - outstanding[i].sent < BRIDGE_COMMAND_EXPIRY)) continue;
+        outstanding.removeAt(i--);
+        expired = true;
+    }
+    if (expired) fillWindow();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Hold a line for the scheduler
+
+@param[in] data Line with its line ending.
+@param[in] sequence Number given by the bridge to a sequenced command, -1 for
+           others.
+*/
+
+void SerialBridge::queueSerial(const QByteArray& data, int sequence)
+{
+    BridgeLine line;
+    line.data = data;
+    line.sequence = sequence;
+    outbound.append(line);
+    schedule();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send the lines waiting while the BMS has room for them
+
+The bytes taken by the BMS since the last call are estimated from its rate.
+Lines are sent in order while the bytes still in the BMS queue would stay
+within BRIDGE_REMOTE_BUFFER. A line longer than that is sent only once the BMS
+queue is estimated to be empty. Otherwise the timer is set for when there will
+be room. The lines of all clients are paced together, as each client paces
+only its own.
+*/
+
+void SerialBridge::schedule()
+{
+    if (serial == NULL) return;
+    qint64 now = clock.elapsed();
+    bytesTaken = qMin((double)bytesSent,
+                      bytesTaken + (double)(now - takenTime)*takeRate/1000);
+    takenTime = now;
+    while (! outbound.isEmpty())
+    {
+        int size = outbound.first().data.size();
+        double held = bytesSent - bytesTaken;
+        if ((held > 0) && (held + size > BRIDGE_REMOTE_BUFFER))
+        {
+            sendTimer.start((int)((held + size - BRIDGE_REMOTE_BUFFER)*1000
+                                  /takeRate) + 1);
+            return;
+        }
+        BridgeLine line = outbound.takeFirst();
+        sendSerial(line.data);
+        bytesSent += size;
+        if (line.sequence < 0) continue;
+        for (int i=0; i<outstanding.size(); i++)
+        {
+            if (outstanding[i].sequence != line.sequence) continue;
+            outstanding[i].sent = now;
+            outstanding[i].mark = bytesSent;
+            outstanding[i].sendings++;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Write a line to the serial port and count it
+*/
+
+void SerialBridge::sendSerial(const QByteArray& data)
+{
+    serial->write(data);
+    commandsWritten++;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send more to a client as its socket empties
+*/
+
+void SerialBridge::onClientBytesWritten()
+{
+    BridgeClient* client = findClient(sender());
+    if (client != NULL) flush(client);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Remove a client that has gone and report its counters
+*/
+
+void SerialBridge::onClientDisconnected()
+{
+    BridgeClient* client = findClient(sender());
+    if (client == NULL) return;
+    clients.removeOne(client);
+    resetClient(client);
+    fprintf(stderr, "Disconnected ");
+    reportClient(client);
+    client->socket->deleteLater();
+    delete client;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Report the counters of the bridge and of each client on stderr
+*/
+
+void SerialBridge::onStatistics()
+{
+    fprintf(stderr, "Serial: %lld lines (%lld bytes) read, %lld discarded, "
+                    "%lld commands written, %d clients\n",
+            linesRead, bytesRead, linesDiscarded, commandsWritten, clients.size());
+    for (int i=0; i<clients.size(); i++) reportClient(clients[i]);
+}
+
+void SerialBridge::reportClient(const BridgeClient* client) const
+{
+    fprintf(stderr, "%s: %lld lines (%lld bytes) sent, %lld dropped, "
+                    "%lld held, %lld bytes received, %lld commands forwarded, "
+                    "%lld answered, %lld discarded\n",
+            qPrintable(client->name), client->linesSent, client->bytesSent,
+            client->linesDropped, (qint64)client->pending.size(),
+            client->bytesReceived, client->commandsForwarded,
+            client->commandsAnswered, client->commandsDiscarded);
+}
+
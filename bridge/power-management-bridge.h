@@ -0,0 +1,227 @@
+/*          Power Management Serial Bridge Header
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#ifndef POWER_MANAGEMENT_BRIDGE_H
+#define POWER_MANAGEMENT_BRIDGE_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QSerialPort>
+
+#define DEFAULT_SERIAL_PORT "/dev/ttyUSB0"
+#define DEFAULT_BAUDRATE    38400
+#define DEFAULT_TCP_PORT    6666
+
+// Clients served at once
+#define BRIDGE_MAX_CLIENTS  8
+// Bytes of telemetry held for each client before the oldest lines are dropped
+#define BRIDGE_CLIENT_BUFFER 65536
+// Bytes given to a client socket at a time, so that its own buffer stays small
+#define BRIDGE_CLIENT_CHUNK 4096
+// Longest command line passed from a client, as the firmware COMMS_LINE_SIZE
+#define BRIDGE_MAX_LINE     255
+// Bytes in each chunk of a bulk file read, as the firmware FILE_BULK_SIZE
+#define BRIDGE_BULK_SIZE    256
+// Longest line passed from the BMS. The base64 fb line of a bulk chunk is the
+// longest the firmware sends, at about four thirds of BRIDGE_BULK_SIZE.
+#define BRIDGE_MAX_RESPONSE (2*BRIDGE_BULK_SIZE)
+// Time in ms between attempts to open the serial port again after it is lost
+#define BRIDGE_REOPEN_TIME  5000
+// Time in ms between checks for a stop signal
+#define BRIDGE_SIGNAL_INTERVAL 1000
+// Bytes allowed in the BMS receive queue at once, half the firmware
+// COMMS_QUEUE_SIZE, as for the link of each GUI
+#define BRIDGE_REMOTE_BUFFER 256
+// Percentage of the line rate the BMS is assumed to take commands at, leaving
+// the rest of its time for the responses
+#define BRIDGE_SEND_SHARE   50
+// Span of the numbers given to the sequenced commands of all clients, from the
+// oldest outstanding to the next. Must be fewer than the firmware
+// COMMS_SEQUENCE_HISTORY so that a command sent again is recognised.
+#define BRIDGE_WINDOW       8
+// Sequence numbers of each client remembered as acknowledged, as the firmware
+// COMMS_SEQUENCE_HISTORY
+#define BRIDGE_SEQUENCE_HISTORY 16
+// Time in ms after which a sequenced command never acknowledged is forgotten,
+// longer than a client spends sending it again
+#define BRIDGE_COMMAND_EXPIRY 5000
+
+//-----------------------------------------------------------------------------
+/** @brief A TCP client of the bridge with its own send buffer and counters.
+*/
+
+struct BridgeClient
+{
+    QTcpSocket* socket;
+    QString name;
+    QList<QByteArray> pending;
+    qint64 pendingBytes;
+    QByteArray input;
+    bool discarding;
+    qint64 linesSent;
+    qint64 bytesSent;
+    qint64 linesDropped;
+    qint64 bytesReceived;
+    qint64 commandsForwarded;
+    qint64 commandsDiscarded;
+    qint64 commandsAnswered;
+    QList<int> acknowledged;
+};
+
+//-----------------------------------------------------------------------------
+/** @brief A sequenced command of a client, renumbered by the bridge.
+*/
+
+struct BridgeCommand
+{
+    BridgeClient* client;
+    int clientSequence;
+    int sequence;
+    QByteArray command;
+    qint64 sent;
+    qint64 mark;
+    int sendings;
+};
+
+//-----------------------------------------------------------------------------
+/** @brief A line waiting to be sent to the BMS.
+*/
+
+struct BridgeLine
+{
+    QByteArray data;
+    int sequence;
+};
+
+//-----------------------------------------------------------------------------
+/** @brief Bridge from the BMS serial port to many TCP clients.
+
+Owns the serial port and serves the GUIs and capture daemons that connect in
+place of a serial link. Each line received from the BMS is passed to every
+client. A client is given only a little at a time, and what it has not yet
+taken is held in its own bounded buffer, from which the oldest lines are
+dropped when it is full. A slow or stalled client therefore loses lines but
+never holds up the serial port or the other clients.
+
+Command lines from the clients are sent to the BMS whole, in the order they
+are completed, so that commands from different clients are never mixed.
+
+Each client numbers its sequenced commands (#n,command) from 0 and expects the
+acknowledgements (aK,n) of its own numbers. The bridge gives each such command
+a number of its own and sends each acknowledgement only to the client whose
+command it is, under the client's number. A command that a client sends again
+keeps its number while outstanding, and one already acknowledged is answered
+here, so the BMS recognises repeats as it would from a single client. The
+numbers outstanding span fewer than the BMS remembers, and commands wait here
+when they would not. The BMS is told to forget old numbers (aK) when the serial
+port is opened, and the same from a client only resets that client. Telemetry
+is turned off (pc-) only by the last client to leave.
+
+The commands of all clients are paced together against the BMS receive queue,
+as the link of a single GUI paces its own.
+
+
+Everything runs in the one event loop and nothing waits on a port.
+*/
+
+class SerialBridge : public QObject
+{
+    Q_OBJECT
+public:
+    SerialBridge(QObject* parent = 0);
+    ~SerialBridge();
+    void setSerial(QString device, qint32 baudrate);
+    void setClientLimits(int maxClients, qint64 bufferSize);
+    void setStatisticsInterval(int seconds);
+    bool listenTcp(quint16 port);
+    void start();
+    void stop();
+    static void signalHandler(int signal);
+private slots:
+    void onSerialData();
+    void onSerialError(QSerialPort::SerialPortError error);
+    void onReopen();
+    void onNewConnection();
+    void onClientData();
+    void onClientBytesWritten();
+    void onClientDisconnected();
+    void onStatistics();
+    void onSignalCheck();
+    void schedule();
+    void onExpiryCheck();
+private:
+    bool openSerial();
+    void closeSerial();
+    void queueLine(BridgeClient* client, const QByteArray& line);
+    void flush(BridgeClient* client);
+    void forwardCommand(BridgeClient* client, const QByteArray& command);
+    void forwardSequenced(BridgeClient* client, int clientSequence,
+                          const QByteArray& command);
+    void fillWindow();
+    void acknowledge(int sequence);
+    void answer(BridgeClient* client, int clientSequence);
+    void resetClient(BridgeClient* client);
+    void queueSerial(const QByteArray& data, int sequence = -1);
+    void sendSerial(const QByteArray& data);
+    BridgeClient* findClient(QObject* socket) const;
+    void reportClient(const BridgeClient* client) const;
+    QSerialPort* serial;
+    QString serialDevice;
+    qint32 serialBaudrate;
+    QByteArray buffer;
+    QTcpServer server;
+    QList<BridgeClient*> clients;
+    int clientLimit;
+    qint64 clientBuffer;
+    QTimer reopenTimer;
+    QTimer statisticsTimer;
+    QTimer signalCheck;
+    QTimer sendTimer;
+    QTimer expiryTimer;
+    QElapsedTimer clock;
+    QList<BridgeLine> outbound;
+    QList<BridgeCommand> waiting;
+    QList<BridgeCommand> outstanding;
+    int nextSequence;
+    qint64 bytesSent;
+    double bytesTaken;
+    qint64 takenTime;
+    int takeRate;
+    qint64 linesRead;
+    qint64 bytesRead;
+    qint64 linesDiscarded;
+    qint64 commandsWritten;
+};
+
+#endif
@@ -0,0 +1,136 @@
+/*       Power Management Serial Bridge Main Program
+
+Shares the serial port of a BMS among the GUIs and capture daemons that connect
+over TCP.
+
+Call with power-management-bridge [options]
+
+-P   serial port (/dev/ttyUSB0 default)
+-b   baudrate (38400 default)
+-p   TCP port (6666 default)
+-c   clients served at once (8 default)
+-B   bytes held for each client before the oldest lines are dropped (65536
+     default)
+-s   seconds between reports of the counters on stderr (none default)
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include <unistd.h>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include "power-management-bridge.h"
+#include <QCoreApplication>
+
+//-----------------------------------------------------------------------------
+/** @brief Power Management Serial Bridge Main Program
+
+*/
+
+int main(int argc,char ** argv)
+{
+/* Interpret any command line options */
+    int c;
+    opterr = 0;
+    QString serialDevice = DEFAULT_SERIAL_PORT;
+    qint32 baudrate = DEFAULT_BAUDRATE;
+    uint tcpPort = DEFAULT_TCP_PORT;
+    int maxClients = BRIDGE_MAX_CLIENTS;
+    qint64 bufferSize = BRIDGE_CLIENT_BUFFER;
+    int statisticsInterval = 0;
+    while ((c = getopt (argc, argv, "P:b:p:c:B:s:")) != -1)
+    {
+        switch (c)
+        {
+// Serial Port Device
+        case 'P':
+            serialDevice = optarg;
+            break;
+// Serial baudrate
+        case 'b':
+            baudrate = atoi(optarg);
+            switch (baudrate)
+            {
+            case 1200: case 2400: case 4800: case 9600:
+            case 19200: case 38400: case 57600: case 115200:
+                break;
+            default:
+                fprintf (stderr, "Invalid Baudrate %i.\n", baudrate);
+                return 1;
+            }
+            break;
+// TCP port number
+        case 'p':
+            tcpPort = atoi(optarg);
+            break;
+// Clients served at once
+        case 'c':
+            maxClients = atoi(optarg);
+            if (maxClients < 1)
+            {
+                fprintf (stderr, "Invalid number of clients %i.\n", maxClients);
+                return 1;
+            }
+            break;
+// Bytes held for each client
+        case 'B':
+            bufferSize = atoll(optarg);
+            if (bufferSize < BRIDGE_MAX_RESPONSE)
+            {
+                fprintf (stderr, "Client buffer must be at least %i bytes.\n",
+                         BRIDGE_MAX_RESPONSE);
+                return 1;
+            }
+            break;
+// Counters report interval
+        case 's':
+            statisticsInterval = atoi(optarg);
+            break;
+// Unknown
+        case '?':
+            if ((optopt == 'P') || (optopt == 'b') || (optopt == 'p')
+                 || (optopt == 'c') || (optopt == 'B') || (optopt == 's'))
+                fprintf (stderr, "Option -%c requires an argument.\n", optopt);
+            else if (isprint (optopt))
+                fprintf (stderr, "Unknown option `-%c'.\n", optopt);
+            else
+                fprintf (stderr,"Unknown option character `\\x%x'.\n",optopt);
+            default: return 1;
+        }
+    }
+
+    QCoreApplication application(argc,argv);
+    SerialBridge bridge;
+    bridge.setSerial(serialDevice,baudrate);
+    bridge.setClientLimits(maxClients,bufferSize);
+    bridge.setStatisticsInterval(statisticsInterval);
+    if (! bridge.listenTcp(tcpPort)) return 1;
+    signal(SIGINT, SerialBridge::signalHandler);
+    signal(SIGTERM, SerialBridge::signalHandler);
+    bridge.start();
+    return application.exec();
+}
@@ -0,0 +1,18 @@
+PROJECT =       Power Management Serial Bridge
+TEMPLATE =      app
+TARGET          = power-management-bridge
+DEPENDPATH      += .
+QT              -= gui
+QT              += serialport
+QT              += network
+
+OBJECTS_DIR     = obj
+MOC_DIR         = moc
+LANGUAGE        = C++
+CONFIG          += qt warn_on release console
+CONFIG          -= app_bundle
+
+# Input
+HEADERS         += power-management-bridge.h
+SOURCES         += power-management.cpp
+SOURCES         += power-management-bridge.cpp
@@ -0,0 +1,128 @@
+/*       Power Management Capture Daemon
+
+Connects to one or more BMS units by serial or TCP and saves all lines received
+to a capture file for each unit and day, in the same form as the GUI save file.
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include "power-management-daemon.h"
+#include <QCoreApplication>
+#include <csignal>
+
+static volatile sig_atomic_t stopSignal = 0;
+
+//-----------------------------------------------------------------------------
+/** Capture Daemon Constructor
+*/
+
+CaptureDaemon::CaptureDaemon(QObject* parent) : QObject(parent)
+{
+    signalCheck.setInterval(DAEMON_SIGNAL_INTERVAL);
+    connect(&signalCheck, SIGNAL(timeout()), this, SLOT(onSignalCheck()));
+}
+
+CaptureDaemon::~CaptureDaemon()
+{
+    stop();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Add a unit to be captured
+
+The daemon takes ownership of the unit.
+*/
+
+void CaptureDaemon::addUnit(UnitConnection* unit)
+{
+    unit->setParent(this);
+    units.append(unit);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the capture file options for all units
+*/
+
+void CaptureDaemon::setCaptureOptions(int syncInterval, bool timestamps)
+{
+    for (int i=0; i<units.size(); i++)
+        units[i]->setCaptureOptions(syncInterval, timestamps);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the time between link statistics reports for all units
+*/
+
+void CaptureDaemon::setStatisticsInterval(int seconds)
+{
+    for (int i=0; i<units.size(); i++)
+        units[i]->setStatisticsInterval(seconds);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Start capturing from all units
+*/
+
+void CaptureDaemon::start()
+{
+    for (int i=0; i<units.size(); i++) units[i]->start();
+    signalCheck.start();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Stop all units
+
+Each BMS is told to stop sending, and the capture files are written out and
+closed.
+*/
+
+void CaptureDaemon::stop()
+{
+    signalCheck.stop();
+    for (int i=0; i<units.size(); i++) units[i]->stop();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Request a stop from a signal handler
+
+Only a flag is set here. It is acted on by the signal check timer.
+*/
+
+void CaptureDaemon::signalHandler(int)
+{
+    stopSignal = 1;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Stop and quit if a signal has been received
+*/
+
+void CaptureDaemon::onSignalCheck()
+{
+    if (! stopSignal) return;
+    stop();
+    QCoreApplication::quit();
+}
+
@@ -0,0 +1,73 @@
+/*          Power Management Capture Daemon Header
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#ifndef POWER_MANAGEMENT_DAEMON_H
+#define POWER_MANAGEMENT_DAEMON_H
+
+#include "power-management-unit.h"
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QTimer>
+
+#define DEFAULT_SERIAL_PORT "/dev/ttyUSB0"
+#define DEFAULT_BAUDRATE    38400
+#define DEFAULT_TCP_PORT    6666
+#define DEFAULT_DIRECTORY   "."
+#define DEFAULT_UNIT_NAME   "bms"
+
+// Time in ms between checks for a stop signal
+#define DAEMON_SIGNAL_INTERVAL 1000
+
+//-----------------------------------------------------------------------------
+/** @brief Capture of BMS data to daily files without a GUI.
+
+Runs one unit connection for each BMS unit, which does all the work. The
+daemon only starts the units and stops them cleanly on a signal.
+*/
+
+class CaptureDaemon : public QObject
+{
+    Q_OBJECT
+public:
+    CaptureDaemon(QObject* parent = 0);
+    ~CaptureDaemon();
+    void addUnit(UnitConnection* unit);
+    void setCaptureOptions(int syncInterval, bool timestamps);
+    void setStatisticsInterval(int seconds);
+    void start();
+    void stop();
+    static void signalHandler(int signal);
+private slots:
+    void onSignalCheck();
+private:
+    QList<UnitConnection*> units;
+    QTimer signalCheck;
+};
+
+#endif
@@ -0,0 +1,160 @@
+/*       Power Management Capture Daemon Main Program
+
+Runs without a display to save all data received from the BMS to daily files.
+
+Call with power-management-daemon [options]
+
+-P   serial port (/dev/ttyUSB0 default)
+-b   baudrate (38400 default)
+-a   TCP address. If given, TCP is used in place of the serial port.
+-p   TCP port (6666 default)
+-u   units file listing several units to be captured, in place of the above
+-d   directory for the capture files (current directory default)
+-f   ms between forcing the capture file to storage (5000 default)
+-s   seconds between reports of the link statistics on stderr (none default)
+-T   put the host time in front of each line
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include <unistd.h>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include "power-management-daemon.h"
+#include <QCoreApplication>
+
+//-----------------------------------------------------------------------------
+/** @brief Power Management Capture Daemon Main Program
+
+*/
+
+int main(int argc,char ** argv)
+{
+/* Interpret any command line options */
+    int c;
+    opterr = 0;
+    QString serialDevice = DEFAULT_SERIAL_PORT;
+    qint32 baudrate = DEFAULT_BAUDRATE;
+    QString tcpAddress;
+    uint tcpPort = DEFAULT_TCP_PORT;
+    QString directory = DEFAULT_DIRECTORY;
+    QString unitsFile;
+    int syncInterval = CAPTURE_SYNC_INTERVAL;
+    bool timestamps = false;
+    int statisticsInterval = 0;
+    while ((c = getopt (argc, argv, "P:b:a:p:u:d:f:s:T")) != -1)
+    {
+        switch (c)
+        {
+// Serial Port Device
+        case 'P':
+            serialDevice = optarg;
+            break;
+// Serial baudrate
+        case 'b':
+            baudrate = atoi(optarg);
+            switch (baudrate)
+            {
+            case 1200: case 2400: case 4800: case 9600:
+            case 19200: case 38400: case 57600: case 115200:
+                break;
+            default:
+                fprintf (stderr, "Invalid Baudrate %i.\n", baudrate);
+                return 1;
+            }
+            break;
+// TCP address
+        case 'a':
+            tcpAddress = optarg;
+            break;
+// TCP port number
+        case 'p':
+            tcpPort = atoi(optarg);
+            break;
+// Units file
+        case 'u':
+            unitsFile = optarg;
+            break;
+// Capture file directory
+        case 'd':
+            directory = optarg;
+            break;
+// Capture file sync interval
+        case 'f':
+            syncInterval = atoi(optarg);
+            break;
+// Link statistics report interval
+        case 's':
+            statisticsInterval = atoi(optarg);
+            break;
+// Capture file host timestamps
+        case 'T':
+            timestamps = true;
+            break;
+// Unknown
+        case '?':
+            if ((optopt == 'P') || (optopt == 'b') || (optopt == 'a')
+                 || (optopt == 'p') || (optopt == 'u') || (optopt == 'd')
+                 || (optopt == 'f') || (optopt == 's'))
+                fprintf (stderr, "Option -%c requires an argument.\n", optopt);
+            else if (isprint (optopt))
+                fprintf (stderr, "Unknown option `-%c'.\n", optopt);
+            else
+                fprintf (stderr,"Unknown option character `\\x%x'.\n",optopt);
+            default: return 1;
+        }
+    }
+
+    QCoreApplication application(argc,argv);
+    CaptureDaemon daemon;
+    if (unitsFile.isEmpty())
+    {
+        UnitConnection* unit = new UnitConnection(DEFAULT_UNIT_NAME,directory);
+        if (tcpAddress.isEmpty()) unit->setSerial(serialDevice,baudrate);
+        else unit->setTcp(tcpAddress,tcpPort);
+        daemon.addUnit(unit);
+    }
+    else
+    {
+        QString error;
+        QList<UnitConnection*> units =
+            loadUnits(unitsFile,directory,&daemon,&error);
+        if (units.isEmpty())
+        {
+            if (error.isEmpty()) error = "No units listed in " + unitsFile;
+            fprintf (stderr, "%s\n", qPrintable(error));
+            return 1;
+        }
+        for (int i=0; i<units.size(); i++) daemon.addUnit(units[i]);
+    }
+    daemon.setCaptureOptions(syncInterval,timestamps);
+    daemon.setStatisticsInterval(statisticsInterval);
+    signal(SIGINT, CaptureDaemon::signalHandler);
+    signal(SIGTERM, CaptureDaemon::signalHandler);
+    daemon.start();
+    return application.exec();
+}
@@ -0,0 +1,29 @@
+PROJECT =       Power Management Capture Daemon
+TEMPLATE =      app
+TARGET          = power-management-daemon
+DEPENDPATH      += .
+INCLUDEPATH     += ../gui
+QT              -= gui
+QT              += serialport
+QT              += network
+
+OBJECTS_DIR     = obj
+MOC_DIR         = moc
+LANGUAGE        = C++
+CONFIG          += qt warn_on release console
+CONFIG          -= app_bundle
+
+# Input
+HEADERS         += power-management-daemon.h
+HEADERS         += ../gui/power-management-message.h
+HEADERS         += ../gui/power-management-link.h
+HEADERS         += ../gui/power-management-capture.h
+HEADERS         += ../gui/power-management-unit.h
+HEADERS         += ../gui/power-management-statistics.h
+SOURCES         += power-management.cpp
+SOURCES         += power-management-daemon.cpp
+SOURCES         += ../gui/power-management-message.cpp
+SOURCES         += ../gui/power-management-link.cpp
+SOURCES         += ../gui/power-management-capture.cpp
+SOURCES         += ../gui/power-management-unit.cpp
+SOURCES         += ../gui/power-management-statistics.cpp
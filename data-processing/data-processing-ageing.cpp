@@ -0,0 +1,490 @@
+/**
+@mainpage Power Management Data Processing Battery Ageing
+@version 1.0
+@author Ken Sarkies (www.jiggerjuice.net)
+@date 16 October 2026
+
+Estimation of battery resistance and capacity from raw data files.
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@trinity.asn.au                                                *
+ *                                                                          *
+ *   This file is part of Power Management                                  *
+ *                                                                          *
+ *   Power Management is free software; you can redistribute it and/or      *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management is distributed in the hope that it will be useful,    *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management if not, write to the                       *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+#include "data-processing-ageing.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QStringList>
+#include <cstdlib>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+/** @brief Start a new charge segment.
+*/
+
+static void initSegment(ChargeSegment* segment)
+{
+    segment->fullTime = QDateTime();
+    segment->charge = 0;
+    segment->depth = 0;
+    segment->depthSoC = -1;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Order results by the first time record in the file.
+*/
+
+static bool earlierFile(const FileAgeing& first, const FileAgeing& second)
+{
+    return first.firstTime < second.firstTime;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Unit that a raw file was logged from.
+
+@param[in] fileName: raw file name.
+@returns name of the directory holding the file.
+*/
+
+QString ageingUnit(const QString& fileName)
+{
+    return QFileInfo(fileName).absoluteDir().dirName();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Stream a raw file for battery resistance and charge drawn.
+
+Runs in a worker thread, one file to each thread.
+
+Resistance follows the firmware estimate: when the current of a battery changes
+by more than AGEING_CURRENT_STEP between successive dB records, the magnitudes
+of the voltage and current steps are added to the sums for the day. The ratio
+of the daily sums is less noisy than the firmware's running average.
+
+Charge is counted from the dB current and the time between time records. The
+dO charge phase marks a full charge when it enters float from bulk or
+absorption. The current is not corrected for zero offset as no calibration
+is available across a batch of files.
+
+@param[in] job: raw file name and statistics.
+@returns resistance sums and charge segments for the file, marked as failed if
+         the file could not be opened.
+*/
+
+FileAgeing ageingFile(const AgeingJob& job)
+{
+    FileAgeing result;
+    QFileInfo fileInfo(job.fileName);
+    result.fileName = fileInfo.absoluteFilePath();
+    result.unit = ageingUnit(result.fileName);
+    result.failed = false;
+    result.size = fileInfo.size();
+    result.modified = fileInfo.lastModified();
+    StageCounters counters;
+    qint64 start = job.statistics->now();
+    QFile file(job.fileName);
+    if (! file.open(QIODevice::ReadOnly))
+    {
+        result.failed = true;
+        return result;
+    }
+    StageClock stageClock(&counters);
+    QDateTime time;
+    long long elapsedSeconds = 0;
+    ChargeSegment segment[3];
+    int lastCurrent[3];
+    int lastVoltage[3];
+    bool currentSeen[3];
+    int soc[3];
+    int lastPhase[3];
+    for (int i=0; i<3; i++)
+    {
+        initSegment(&segment[i]);
+        currentSeen[i] = false;
+        soc[i] = -1;
+        lastPhase[i] = -1;
+    }
+    while (! file.atEnd())
+    {
+        QByteArray bytes = file.readLine();
+        counters.bytes += bytes.size();
+        counters.lines++;
+        QString lineIn = QString::fromLatin1(bytes).trimmed();
+        stageClock.lap(stageRead);
+        QStringList breakdown = lineIn.split(",");
+        int size = breakdown.size();
+        stageClock.lap(stageSplit);
+        if (size <= 1)
+        {
+            counters.malformed++;
+            continue;
+        }
+        QString firstText = breakdown[0].simplified();
+        counters.records[firstText]++;
+        if (firstText == "pH")
+        {
+            QDateTime previousTime = time;
+            time = QDateTime::fromString(breakdown[1].simplified(),Qt::ISODate);
+            stageClock.lap(stageTime);
+            elapsedSeconds = 0;
+            if (previousTime.isValid() && time.isValid())
+                elapsedSeconds = previousTime.secsTo(time);
+            if (time.isValid() && ! result.firstTime.isValid())
+                result.firstTime = time;
+            continue;
+        }
+        if ((firstText.size() != 3) || (firstText.at(0) != 'd')) continue;
+        int battery = firstText.at(2).digitValue()-1;
+        if ((battery < 0) || (battery > 2) || ! time.isValid()) continue;
+        int secondField = breakdown[1].simplified().toInt();
+        if ((firstText.at(1) == 'B') && (size > 2))
+        {
+            int voltage = breakdown[2].simplified().toInt();
+            if (currentSeen[battery])
+            {
+                int currentStep = abs(secondField-lastCurrent[battery]);
+                int voltageStep = abs(voltage-lastVoltage[battery]);
+                if (currentStep > AGEING_CURRENT_STEP)
+                {
+                    QDate date = time.date();
+                    if (! result.resistance.contains(date))
+                    {
+                        DayResistance empty;
+                        for (int i=0; i<3; i++)
+                        {
+                            empty.voltageStep[i] = 0;
+                            empty.currentStep[i] = 0;
+                            empty.steps[i] = 0;
+                        }
+                        result.resistance.insert(date,empty);
+                    }
+                    DayResistance& day = result.resistance[date];
+                    day.voltageStep[battery] += voltageStep;
+                    day.currentStep[battery] += currentStep;
+                    day.steps[battery]++;
+                }
+            }
+            currentSeen[battery] = true;
+            lastCurrent[battery] = secondField;
+            lastVoltage[battery] = voltage;
+// Positive current is drawn from the battery.
+            ChargeSegment& charge = segment[battery];
+            charge.charge += (long long)secondField*elapsedSeconds;
+            if (charge.charge > charge.depth)
+            {
+                charge.depth = charge.charge;
+                charge.depthSoC = soc[battery];
+            }
+        }
+        else if (firstText.at(1) == 'C')
+        {
+            soc[battery] = secondField;
+        }
+        else if (firstText.at(1) == 'O')
+        {
+            int phase = (secondField >> 4) & 0x03;
+            if ((phase == 2) && ((lastPhase[battery] == 0)
+                                 || (lastPhase[battery] == 1)))
+            {
+                segment[battery].fullTime = time;
+                result.segments[battery] << segment[battery];
+                initSegment(&segment[battery]);
+            }
+            lastPhase[battery] = phase;
+        }
+        stageClock.lap(stageFormat);
+    }
+    file.close();
+    for (int i=0; i<3; i++) result.segments[i] << segment[i];
+    job.statistics->merge(counters,"ageing file",start);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Read the results of raw files already analysed.
+
+Each file starts with an F line giving its name, size, modification time and
+first time record, followed by R lines of daily resistance sums and S lines of
+charge segments in order. The modification time is held in milliseconds since
+the epoch, so that it compares equal to the time of an unchanged file on a
+filesystem with sub-second times.
+
+@param[in] cacheName: name of the cache file.
+@returns results keyed on absolute file name, empty if there is no cache.
+*/
+
+QHash<QString,FileAgeing> readAgeingCache(QString cacheName)
+{
+    QHash<QString,FileAgeing> cache;
+    QFile file(cacheName);
+    if (! file.open(QIODevice::ReadOnly | QIODevice::Text)) return cache;
+    QTextStream inStream(&file);
+    FileAgeing* result = NULL;
+    while (! inStream.atEnd())
+    {
+        QStringList breakdown = inStream.readLine().split(",");
+        QString type = breakdown[0];
+        if ((type == "F") && (breakdown.size() == 5))
+        {
+            FileAgeing entry;
+            entry.fileName = breakdown[1];
+            entry.unit = ageingUnit(entry.fileName);
+            entry.failed = false;
+            entry.size = breakdown[2].toLongLong();
+            entry.modified =
+                QDateTime::fromMSecsSinceEpoch(breakdown[3].toLongLong());
+            entry.firstTime = QDateTime::fromString(breakdown[4],Qt::ISODate);
+            cache.insert(entry.fileName,entry);
+            result = &cache[entry.fileName];
+        }
+        else if (result == NULL) continue;
+        else if ((type == "R") && (breakdown.size() == 3*3+2))
+        {
+            QDate date = QDate::fromString(breakdown[1],Qt::ISODate);
+            DayResistance day;
+            for (int i=0; i<3; i++)
+            {
+                day.voltageStep[i] = breakdown[2+3*i].toLongLong();
+                day.currentStep[i] = breakdown[3+3*i].toLongLong();
+                day.steps[i] = breakdown[4+3*i].toInt();
+            }
+            result->resistance.insert(date,day);
+        }
+        else if ((type == "S") && (breakdown.size() == 6))
+        {
+            int battery = breakdown[1].toInt();
+            if ((battery < 0) || (battery > 2)) continue;
+            ChargeSegment segment;
+            segment.fullTime = QDateTime::fromString(breakdown[2],Qt::ISODate);
+            segment.charge = breakdown[3].toLongLong();
+            segment.depth = breakdown[4].toLongLong();
+            segment.depthSoC = breakdown[5].toInt();
+            result->segments[battery] << segment;
+        }
+    }
+    file.close();
+    return cache;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Write the results of all files analysed to the cache.
+
+Files that could not be read are left out so that they are tried again.
+
+@param[in] cacheName: name of the cache file.
+@param[in] results: results for each raw file.
+@returns true if the cache could be written.
+*/
+
+bool writeAgeingCache(QString cacheName, const QList<FileAgeing>& results)
+{
+    QFile file(cacheName);
+    if (! file.open(QIODevice::WriteOnly | QIODevice::Truncate
+                                         | QIODevice::Text)) return false;
+    QTextStream outStream(&file);
+    for (int n=0; n<results.size(); n++)
+    {
+        const FileAgeing& result = results[n];
+        if (result.failed) continue;
+        outStream << "F," << result.fileName << "," << result.size << ","
+                  << result.modified.toMSecsSinceEpoch() << ","
+                  << result.firstTime.toString(Qt::ISODate) << "\n";
+        ResistanceMap::const_iterator day;
+        for (day = result.resistance.constBegin();
+             day != result.resistance.constEnd(); ++day)
+        {
+            outStream << "R," << day.key().toString(Qt::ISODate);
+            for (int i=0; i<3; i++)
+                outStream << "," << day.value().voltageStep[i]
+                          << "," << day.value().currentStep[i]
+                          << "," << day.value().steps[i];
+            outStream << "\n";
+        }
+        for (int i=0; i<3; i++)
+            for (int s=0; s<result.segments[i].size(); s++)
+            {
+                const ChargeSegment& segment = result.segments[i][s];
+                outStream << "S," << i << ","
+                          << segment.fullTime.toString(Qt::ISODate) << ","
+                          << segment.charge << "," << segment.depth << ","
+                          << segment.depthSoC << "\n";
+            }
+    }
+    file.close();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Join the charge segments of the files of a unit into cycles for a
+battery.
+
+Only the files of the unit are taken, in time order. Charge drawn before the first full charge is
+discarded as the starting state is unknown. Any gaps between files are not
+counted, so a cycle that spans missing data will understate the depth.
+
+@param[in] results: results for each raw file.
+@param[in] unit: unit name.
+@param[in] battery: battery number 0-2.
+@returns cycles between successive full charge events.
+*/
+
+QList<ChargeCycle> stitchCycles(const QList<FileAgeing>& results,
+                                const QString& unit, int battery)
+{
+    QList<FileAgeing> ordered;
+    for (int n=0; n<results.size(); n++)
+        if (! results[n].failed && (results[n].unit == unit))
+            ordered << results[n];
+    std::sort(ordered.begin(), ordered.end(), earlierFile);
+    QList<ChargeCycle> cycles;
+    ChargeCycle cycle;
+    long long charge = 0;
+    bool open = false;
+    for (int n=0; n<ordered.size(); n++)
+    {
+        const QList<ChargeSegment>& segments = ordered[n].segments[battery];
+        for (int s=0; s<segments.size(); s++)
+        {
+            const ChargeSegment& segment = segments[s];
+            if (open)
+            {
+                if (charge+segment.depth > cycle.depth)
+                {
+                    cycle.depth = charge+segment.depth;
+                    cycle.depthSoC = segment.depthSoC;
+                }
+                charge += segment.charge;
+            }
+            if (! segment.fullTime.isValid()) continue;
+            if (open)
+            {
+                cycle.end = segment.fullTime;
+                cycles << cycle;
+            }
+            open = true;
+            cycle.start = segment.fullTime;
+            cycle.depth = 0;
+            cycle.depthSoC = -1;
+            charge = 0;
+        }
+    }
+    return cycles;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Write the ageing report for all files.
+
+The units are reported in turn, each from its own files only. A line is
+written for each battery on each day that has resistance samples or the end of
+a charge cycle. The capacity is estimated from the deepest charge drawn in the
+cycle and the SoC at that point, provided the SoC dropped by at least
+AGEING_MIN_SOC_DROP percent.
+
+@param[in] outStream: report output.
+@param[in] results: results for each raw file.
+*/
+
+void writeAgeingReport(QTextStream& outStream,
+                       const QList<FileAgeing>& results)
+{
+// Resistance sums for a day of a unit can come from more than one file.
+    QMap<QString,ResistanceMap> units;
+    for (int n=0; n<results.size(); n++)
+    {
+        if (results[n].failed) continue;
+        ResistanceMap& resistance = units[results[n].unit];
+        ResistanceMap::const_iterator day;
+        for (day = results[n].resistance.constBegin();
+             day != results[n].resistance.constEnd(); ++day)
+        {
+            if (! resistance.contains(day.key()))
+            {
+                resistance.insert(day.key(),day.value());
+                continue;
+            }
+            DayResistance& total = resistance[day.key()];
+            for (int i=0; i<3; i++)
+            {
+                total.voltageStep[i] += day.value().voltageStep[i];
+                total.currentStep[i] += day.value().currentStep[i];
+                total.steps[i] += day.value().steps[i];
+            }
+        }
+    }
+    outStream << "Unit," << "Date," << "Battery," << "Resistance (mOhm),"
+              << "Steps,";
+    outStream << "Cycle Start," << "Drawn (Ah)," << "SoC at Depth (%),";
+    outStream << "Capacity (Ah)";
+    outStream << "\n\r";
+    QMap<QString,ResistanceMap>::const_iterator unit;
+    for (unit = units.constBegin(); unit != units.constEnd(); ++unit)
+    {
+        const ResistanceMap& resistance = unit.value();
+        for (int i=0; i<3; i++)
+        {
+// The deepest cycle ending on each day is reported.
+            QList<ChargeCycle> cycles = stitchCycles(results,unit.key(),i);
+            QMap<QDate,ChargeCycle> cycleDays;
+            for (int n=0; n<cycles.size(); n++)
+            {
+                QDate date = cycles[n].end.date();
+                if (! cycleDays.contains(date)
+                    || (cycleDays[date].depth < cycles[n].depth))
+                    cycleDays.insert(date,cycles[n]);
+            }
+            QList<QDate> dates = cycleDays.keys();
+            ResistanceMap::const_iterator day;
+            for (day = resistance.constBegin(); day != resistance.constEnd(); ++day)
+                if ((day.value().steps[i] > 0) && ! cycleDays.contains(day.key()))
+                    dates << day.key();
+            std::sort(dates.begin(), dates.end());
+            for (int n=0; n<dates.size(); n++)
+            {
+                QDate date = dates[n];
+                outStream << unit.key() << "," << date.toString(Qt::ISODate)
+                          << "," << i+1 << ",";
+                const DayResistance& sums = resistance.value(date);
+                if (resistance.contains(date) && (sums.currentStep[i] > 0))
+                    outStream << QString::number((double)sums.voltageStep[i]*1000
+                                                 /sums.currentStep[i],'f',1)
+                              << "," << sums.steps[i];
+                else outStream << ",";
+                outStream << ",";
+                if (cycleDays.contains(date))
+                {
+                    const ChargeCycle& cycle = cycleDays[date];
+                    double drawn = (double)cycle.depth/(256*3600);
+                    outStream << cycle.start.toString(Qt::ISODate) << ","
+                              << QString::number(drawn,'f',2) << ",";
+                    if (cycle.depthSoC >= 0)
+                        outStream << QString::number((double)cycle.depthSoC/256,'f',1);
+                    outStream << ",";
+                    double drop = 100-(double)cycle.depthSoC/256;
+                    if ((cycle.depthSoC >= 0) && (drop >= AGEING_MIN_SOC_DROP))
+                        outStream << QString::number(drawn*100/drop,'f',1);
+                }
+                else outStream << ",,,";
+                outStream << "\n\r";
+            }
+        }
+    }
+}
@@ -0,0 +1,131 @@
+/**
+@mainpage Power Management Data Processing Battery Ageing
+@version 1.0
+@author Ken Sarkies (www.jiggerjuice.net)
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@trinity.asn.au                                                *
+ *                                                                          *
+ *   This file is part of Power Management                                  *
+ *                                                                          *
+ *   Power Management is free software; you can redistribute it and/or      *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management is distributed in the hope that it will be useful,    *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management if not, write to the                       *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+#ifndef DATA_PROCESSING_AGEING_H
+#define DATA_PROCESSING_AGEING_H
+
+#include "data-processing-stats.h"
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QMap>
+#include <QDate>
+#include <QDateTime>
+#include <QTextStream>
+
+// Current step (x256) above which a resistance sample is taken, as firmware
+#define AGEING_CURRENT_STEP 100
+// Drop in SoC (percent) needed before a capacity estimate is made
+#define AGEING_MIN_SOC_DROP 20
+// Name of the file holding results of raw files already analysed
+#define AGEING_CACHE_FILE "ageing-cache.txt"
+
+//-----------------------------------------------------------------------------
+/** @brief Sums of voltage and current steps for each battery over one day.
+
+Voltage and current are x256 so the ratio of the sums is in ohms.
+*/
+
+struct DayResistance
+{
+    long long voltageStep[3];
+    long long currentStep[3];
+    int steps[3];
+};
+
+typedef QMap<QDate, DayResistance> ResistanceMap;
+
+//-----------------------------------------------------------------------------
+/** @brief Charge drawn from a battery over part of a raw file.
+
+A segment ends at a full charge event (entry to float from bulk or absorption)
+or at the end of the file. Charge is the current (x256) times seconds. Depth is
+the largest charge drawn from the start of the segment and the SoC (x256) seen
+at that point, -1 if no SoC was seen.
+*/
+
+struct ChargeSegment
+{
+    QDateTime fullTime;
+    long long charge;
+    long long depth;
+    int depthSoC;
+};
+
+//-----------------------------------------------------------------------------
+/** @brief Ageing results for one raw file.
+
+The file size and modification time identify the results in the cache so that
+a file is only read again when it changes.
+
+The unit is the name of the directory holding the file, so the logs of each
+unit in a fleet are kept in a directory of their own. A file that could not
+be read is marked as failed and is not cached.
+*/
+
+struct FileAgeing
+{
+    QString fileName;
+    QString unit;
+    bool failed;
+    qint64 size;
+    QDateTime modified;
+    QDateTime firstTime;
+    ResistanceMap resistance;
+    QList<ChargeSegment> segments[3];
+};
+
+//-----------------------------------------------------------------------------
+/** @brief Charge drawn from a battery between two full charge events.
+*/
+
+struct ChargeCycle
+{
+    QDateTime start;
+    QDateTime end;
+    long long depth;
+    int depthSoC;
+};
+
+struct AgeingJob
+{
+    QString fileName;
+    PassStatistics* statistics;
+};
+
+FileAgeing ageingFile(const AgeingJob& job);
+QHash<QString,FileAgeing> readAgeingCache(QString cacheName);
+bool writeAgeingCache(QString cacheName, const QList<FileAgeing>& results);
+QString ageingUnit(const QString& fileName);
+QList<ChargeCycle> stitchCycles(const QList<FileAgeing>& results,
+                                const QString& unit, int battery);
+void writeAgeingReport(QTextStream& outStream,
+                       const QList<FileAgeing>& results);
+
+#endif
@@ -0,0 +1,594 @@
+/**
+@mainpage Power Management Data Processing Raw File Chunks
+@version 1.0
+@author Ken Sarkies (www.jiggerjuice.net)
+@date 16 October 2026
+
+Splitting of large raw data files into chunks that can be parsed in parallel.
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@trinity.asn.au                                                *
+ *                                                                          *
+ *   This file is part of Power Management                                  *
+ *                                                                          *
+ *   Power Management is free software; you can redistribute it and/or      *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management is distributed in the hope that it will be useful,    *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management if not, write to the                       *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+#include "data-processing-chunk.h"
+#include <QFile>
+#include <QThread>
+#include <QByteArray>
+
+//-----------------------------------------------------------------------------
+/** @brief Read a line from a chunk of the file.
+
+@param[in] file: open file positioned within the chunk.
+@param[in] end: offset of the end of the chunk.
+@param[out] line: line read without the line ending.
+@param[out] counters: bytes and lines read are added.
+@returns false if the chunk is exhausted.
+*/
+
+static bool readChunkLine(QFile* file, qint64 end, QString* line,
+                          StageCounters* counters)
+{
+    if (file->atEnd() || (file->pos() >= end)) return false;
+    QByteArray bytes = file->readLine();
+    counters->bytes += bytes.size();
+    counters->lines++;
+    *line = QString::fromLatin1(bytes).trimmed();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Clear the partial results of a chunk.
+*/
+
+static void initChunk(RawChunk* chunk)
+{
+    chunk->start = 0;
+    chunk->end = 0;
+    chunk->lastRecord.clear();
+    chunk->controlsDelta = QString(CONTROLS_LENGTH,QChar(0));
+    for (int i=0; i<3; i++)
+    {
+        chunk->calibrationSum[i] = 0;
+        chunk->calibrationCount[i] = 0;
+        chunk->pendingCount[i] = 0;
+        chunk->currentSeen[i] = false;
+        chunk->lastCurrent[i] = 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Split a raw file into chunks aligned on time records.
+
+The file is divided into roughly equal byte ranges, enough to keep all cores
+busy. Each boundary is moved forward to the next pH record. Small files give
+a single chunk.
+
+@param[in] fileName: name of the raw data file.
+@returns list of chunks in file order, empty if the file cannot be opened.
+*/
+
+QList<RawChunk> splitRawFile(QString fileName)
+{
+    QList<RawChunk> chunks;
+    QFile file(fileName);
+    if (! file.open(QIODevice::ReadOnly)) return chunks;
+    qint64 size = file.size();
+    int threads = QThread::idealThreadCount();
+    if (threads < 1) threads = 1;
+    qint64 chunkSize = size/(threads*CHUNKS_PER_THREAD);
+    if (chunkSize < CHUNK_MIN_SIZE) chunkSize = CHUNK_MIN_SIZE;
+    if (chunkSize > CHUNK_MAX_SIZE) chunkSize = CHUNK_MAX_SIZE;
+    QList<qint64> boundaries;
+    boundaries << 0;
+    for (qint64 offset = chunkSize; offset < size; offset += chunkSize)
+    {
+        if (offset <= boundaries.last()) continue;
+        file.seek(offset);
+// Discard the partial line then look for the next time record
+        file.readLine();
+        qint64 boundary = size;
+        while (! file.atEnd())
+        {
+            qint64 position = file.pos();
+            QByteArray line = file.readLine();
+            if (line.startsWith("pH"))
+            {
+                boundary = position;
+                break;
+            }
+        }
+        if (boundary >= size) break;
+        if (boundary > boundaries.last()) boundaries << boundary;
+    }
+    boundaries << size;
+    file.close();
+    for (int n=0; n<boundaries.size()-1; n++)
+    {
+        RawChunk chunk;
+        initChunk(&chunk);
+        chunk.start = boundaries[n];
+        chunk.end = boundaries[n+1];
+        chunks << chunk;
+    }
+    return chunks;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Scan a chunk for times, calibration and carried state.
+
+Runs in a worker thread. The partial calibration sums use the raw battery
+current at the time that a battery is found to be isolated.
+
+@param[in] job: file name and chunk to scan.
+@returns the chunk with partial results filled in.
+*/
+
+RawChunk scanChunk(const ScanJob& job)
+{
+    RawChunk chunk = job.chunk;
+    StageCounters counters;
+    qint64 start = job.statistics->now();
+    QFile file(job.fileName);
+    if (! file.open(QIODevice::ReadOnly)) return chunk;
+    file.seek(chunk.start);
+    StageClock stageClock(&counters);
+    QString lineIn;
+    while (readChunkLine(&file,chunk.end,&lineIn,&counters))
+    {
+        stageClock.lap(stageRead);
+        QStringList breakdown = lineIn.split(",");
+        int length = breakdown.size();
+        stageClock.lap(stageSplit);
+        if (length <= 1)
+        {
+            counters.malformed++;
+            continue;
+        }
+        QString firstText = breakdown[0].simplified();
+        QString secondText = breakdown[1].simplified();
+        counters.records[firstText]++;
+        if (firstText == "pH")
+        {
+            QDateTime time = QDateTime::fromString(secondText,Qt::ISODate);
+            stageClock.lap(stageTime);
+            if (time.isValid())
+            {
+                if (! chunk.firstTime.isValid()) chunk.firstTime = time;
+                chunk.lastTime = time;
+                if (! chunk.maxTime.isValid() || (time > chunk.maxTime))
+                    chunk.maxTime = time;
+            }
+            continue;
+        }
+        int secondField = secondText.toInt();
+        if (firstText == "dD")
+        {
+            CombineState::updateControls(&chunk.controlsDelta,secondField);
+            continue;
+        }
+        chunk.lastRecord.insert(firstText,lineIn);
+        if ((firstText.size() == 3) && (firstText.at(0) == 'd'))
+        {
+            int battery = firstText.at(2).digitValue()-1;
+            if ((battery < 0) || (battery > 2)) continue;
+            if (firstText.at(1) == 'B')
+            {
+                chunk.currentSeen[battery] = true;
+                chunk.lastCurrent[battery] = secondField;
+            }
+            else if ((firstText.at(1) == 'O') && ((secondField & 0x03) == 2))
+            {
+                chunk.calibrationCount[battery]++;
+                if (chunk.currentSeen[battery])
+                    chunk.calibrationSum[battery] += chunk.lastCurrent[battery];
+                else chunk.pendingCount[battery]++;
+            }
+        }
+    }
+    file.close();
+    job.statistics->merge(counters,"scan chunk",start);
+    return chunk;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Sum energy for each day within a chunk.
+
+Runs in a worker thread. Each measurement is multiplied by the time since the
+previous time record, which for the first record of the chunk comes from the
+previous chunk. Negative load and panel currents are phantoms due to the
+electronics and are ignored.
+
+@param[in] job: file name, chunk, time range and current zeros.
+@returns map of daily energy sums for days in the time range.
+*/
+
+EnergyMap energyChunk(const EnergyJob& job)
+{
+    EnergyMap energyMap;
+    StageCounters counters;
+    qint64 start = job.statistics->now();
+    QFile file(job.fileName);
+    if (! file.open(QIODevice::ReadOnly)) return energyMap;
+    file.seek(job.chunk.start);
+    StageClock stageClock(&counters);
+    QDateTime time = job.previousTime;
+    long long elapsedSeconds = 0;
+    DayEnergy* day = NULL;
+    QString lineIn;
+    while (readChunkLine(&file,job.chunk.end,&lineIn,&counters))
+    {
+        stageClock.lap(stageRead);
+        QStringList breakdown = lineIn.split(",");
+        stageClock.lap(stageSplit);
+        if (breakdown.size() <= 1)
+        {
+            counters.malformed++;
+            continue;
+        }
+        QString firstText = breakdown[0].simplified();
+        counters.records[firstText]++;
+        if (firstText == "pH")
+        {
+            QDateTime previousTime = time;
+            time = QDateTime::fromString(breakdown[1].simplified(),Qt::ISODate);
+            stageClock.lap(stageTime);
+            elapsedSeconds = 0;
+            if (previousTime.isValid() && time.isValid())
+                elapsedSeconds = previousTime.secsTo(time);
+            day = NULL;
+            if (time.isValid() && (time >= job.startTime)
+                && (time <= job.finalTime))
+            {
+                QDate date = time.date();
+                if (! energyMap.contains(date))
+                {
+                    DayEnergy empty;
+                    for (int n=0; n<numberEnergySources; n++) empty.energy[n] = 0;
+                    energyMap.insert(date,empty);
+                }
+                day = &energyMap[date];
+            }
+            continue;
+        }
+        if (day == NULL) continue;
+        long long current = breakdown[1].simplified().toInt();
+        if (firstText == "dB1")
+            day->energy[energyBattery1] +=
+                (current-job.currentZero[0])*elapsedSeconds;
+        else if (firstText == "dB2")
+            day->energy[energyBattery2] +=
+                (current-job.currentZero[1])*elapsedSeconds;
+        else if (firstText == "dB3")
+            day->energy[energyBattery3] +=
+                (current-job.currentZero[2])*elapsedSeconds;
+        else if (current < 0) continue;
+        else if (firstText == "dL1")
+            day->energy[energyLoad1] += current*elapsedSeconds;
+        else if (firstText == "dL2")
+            day->energy[energyLoad2] += current*elapsedSeconds;
+        else if (firstText == "dM1")
+            day->energy[energyPanel] += current*elapsedSeconds;
+    }
+    file.close();
+    job.statistics->merge(counters,"energy chunk",start);
+    return energyMap;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Build combined records for a chunk.
+
+Runs in a worker thread. A record is written for each time block when the next
+time record is found, so the last block in the chunk is written using the first
+time of the following chunk. Processing stops at a time beyond the end time.
+
+@param[in] job: file name, chunk, initial state and time range.
+@returns combined records as text.
+*/
+
+QString combineChunk(const CombineJob& job)
+{
+    QString output;
+    QTextStream outStream(&output);
+    StageCounters counters;
+    qint64 start = job.statistics->now();
+    QFile file(job.fileName);
+    if (! file.open(QIODevice::ReadOnly)) return output;
+    file.seek(job.chunk.start);
+    StageClock stageClock(&counters);
+    CombineState state = job.initial;
+    QDateTime time = job.startTime;
+    QString timeRecord;
+    bool blockStart = false;
+    bool stopped = false;
+    QString lineIn;
+    while (readChunkLine(&file,job.chunk.end,&lineIn,&counters))
+    {
+        stageClock.lap(stageRead);
+        if (time > job.endTime)
+        {
+            stopped = true;
+            break;
+        }
+        QStringList breakdown = lineIn.split(",");
+        stageClock.lap(stageSplit);
+        if (breakdown.size() <= 1)
+        {
+            counters.malformed++;
+            continue;
+        }
+        QString firstText = breakdown[0].simplified();
+        counters.records[firstText]++;
+// Find and extract the time record
+        if (firstText == "pH")
+        {
+            time = QDateTime::fromString(breakdown[1].simplified(),Qt::ISODate);
+            stageClock.lap(stageTime);
+            if (blockStart && (time > job.startTime))
+            {
+                state.writeRow(outStream,timeRecord);
+                stageClock.lap(stageFormat);
+            }
+            timeRecord = breakdown[1].simplified();
+            blockStart = true;
+        }
+        else state.update(breakdown,job.currentZero);
+    }
+    file.close();
+    if (time > job.endTime) stopped = true;
+// The final block is closed by the first time record of the next chunk
+    if (! stopped && blockStart && job.nextTime.isValid()
+        && (job.nextTime > job.startTime))
+        state.writeRow(outStream,timeRecord);
+    outStream.flush();
+    stageClock.lap(stageFormat);
+    job.statistics->merge(counters,"combine chunk",start);
+    return output;
+}
+
+//-----------------------------------------------------------------------------
+/** Combined Record State Constructor
+*/
+
+CombineState::CombineState()
+{
+    for (int i=0; i<3; i++)
+    {
+        batteryVoltage[i] = -1;
+        batteryCurrent[i] = 0;
+        batterySoC[i] = -1;
+        debugA[i] = -1;
+        debugB[i] = -1;
+    }
+    load1Voltage = -1;
+    load1Current = 0;
+    load2Voltage = -1;
+    load2Current = 0;
+    panel1Voltage = -1;
+    panel1Current = 0;
+    temperature = -1;
+    controls = "     ";
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Update the state from a record.
+
+@param[in] breakdown: fields of the record.
+@param[in] currentZero: zero calibration of the battery currents.
+*/
+
+void CombineState::update(const QStringList& breakdown,
+                          const long long currentZero[3])
+{
+    int size = breakdown.size();
+    if (size <= 1) return;
+    QString firstText = breakdown[0].simplified();
+    QString secondText = breakdown[1].simplified();
+    int secondField = secondText.toInt();
+    int thirdField = -1;
+    if (size > 2) thirdField = breakdown[2].simplified().toInt();
+    int battery = -1;
+    if (firstText.size() == 3) battery = firstText.at(2).digitValue()-1;
+    if ((battery >= 0) && (battery < 3) && (firstText.at(0) == 'd'))
+    {
+        if (firstText.at(1) == 'B')
+        {
+            batteryCurrent[battery] = secondField-currentZero[battery];
+            batteryVoltage[battery] = thirdField;
+        }
+        if (firstText.at(1) == 'C')
+        {
+            batterySoC[battery] = secondField;
+        }
+        if (firstText.at(1) == 'O')
+        {
+            uint batteryState = (secondField & 0x03);
+            if (batteryState == 0) batteryStateText[battery] = "Loaded";
+            else if (batteryState == 1) batteryStateText[battery] = "Charge";
+            else if (batteryState == 2) batteryStateText[battery] = "Isolate";
+            else batteryStateText[battery] = "Missing";
+            uint batteryFill = (secondField >> 2) & 0x03;
+            if (batteryFill == 0) batteryFillText[battery] = "Normal";
+            else if (batteryFill == 1) batteryFillText[battery] = "Low";
+            else if (batteryFill == 2) batteryFillText[battery] = "Critical";
+            else batteryFillText[battery] = "Faulty";
+            uint batteryCharge = (secondField >> 4) & 0x03;
+            if (batteryCharge == 0) batteryChargeText[battery] = "Bulk";
+            else if (batteryCharge == 1) batteryChargeText[battery] = "Absorp";
+            else if (batteryCharge == 2) batteryChargeText[battery] = "Float";
+            else batteryChargeText[battery] = "Rest";
+        }
+    }
+    if (firstText == "dL1")
+    {
+        load1Voltage = secondField;
+        load1Current = thirdField;
+    }
+    if (firstText == "dL2")
+    {
+        load2Voltage = secondField;
+        load2Current = thirdField;
+    }
+    if (firstText == "dM1")
+    {
+        panel1Voltage = secondField;
+        panel1Current = thirdField;
+    }
+    if (firstText == "dT")
+    {
+        temperature = secondField;
+    }
+    if (firstText == "dD")
+    {
+        updateControls(&controls,secondField);
+    }
+// Switch control bits - three 2-bit fields: battery number for each of
+// load1, load2 and panel.
+    if (firstText == "ds")
+    {
+        switches.clear();
+        for (int i=0; i<3; i++)
+        {
+            uint switchBattery = (secondField >> 2*i) & 0x03;
+            switches.append(" ").append(QString::number(switchBattery));
+        }
+    }
+    if (firstText == "dd")
+    {
+        bool ok;
+        decision = QString("%1").arg(secondText.toInt(&ok),0,16);
+    }
+    if (firstText == "dI")
+    {
+        bool ok;
+        indicatorString = "";
+        int indicators = secondText.toInt(&ok);
+        for (int i=0; i<12; i+=2)
+        {
+            if ((indicators & (1 << i)) > 0) indicatorString.append("_");
+            else indicatorString.append("O");
+            if ((indicators & (1 << (i+1))) > 0) indicatorString.append("_");
+            else indicatorString.append("U");
+        }
+    }
+    if ((firstText.size() == 2) && (firstText.at(0) == 'D'))
+    {
+        int debug = firstText.at(1).digitValue()-1;
+        if ((debug >= 0) && (debug < 3))
+        {
+            debugA[debug] = secondField;
+            if (size > 2) debugB[debug] = thirdField;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Bring the state up to the end of a scanned chunk.
+
+@param[in] chunk: scanned chunk holding the last line of each record type.
+@param[in] currentZero: zero calibration of the battery currents.
+*/
+
+void CombineState::apply(const RawChunk& chunk, const long long currentZero[3])
+{
+    QHash<QString,QString>::const_iterator record;
+    for (record = chunk.lastRecord.constBegin();
+         record != chunk.lastRecord.constEnd(); ++record)
+        update(record.value().split(","),currentZero);
+    for (int i=0; i<chunk.controlsDelta.size(); i++)
+        if (! chunk.controlsDelta.at(i).isNull()) controls[i] = chunk.controlsDelta.at(i);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set control characters from a dD record.
+
+A = autotrack, R = recording, M = send measurements, D = debug, Charger
+algorithm, X = load avoidance, I = maintain isolation. Characters are only ever
+set so that a chunk can record just those it changed.
+*/
+
+void CombineState::updateControls(QString* controls, int secondField)
+{
+    if ((secondField & (1 << 0)) > 0) (*controls)[0] = 'A';
+    if ((secondField & (1 << 1)) > 0) (*controls)[1] = 'R';
+    if ((secondField & (1 << 3)) > 0) (*controls)[2] = 'M';
+    if ((secondField & (1 << 4)) > 0) (*controls)[3] = 'D';
+    if (((secondField >> 5) & 3) == 0) (*controls)[4] = '1';
+    if (((secondField >> 5) & 3) == 1) (*controls)[4] = '2';
+    if (((secondField >> 5) & 3) == 2) (*controls)[4] = '3';
+    if ((secondField & (1 << 7)) > 0) (*controls)[5] = 'X';
+    if ((secondField & (1 << 8)) > 0) (*controls)[6] = 'I';
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Write the header of the combined file.
+*/
+
+void CombineState::writeHeader(QTextStream& outStream)
+{
+    outStream << "Time,";
+    outStream << "B1 I," << "B1 V," << "B1 Cap," << "B1 Op," << "B1 State," << "B1 Charge,";
+    outStream << "B2 I," << "B2 V," << "B2 Cap," << "B2 Op," << "B2 State," << "B2 Charge,";
+    outStream << "B3 I," << "B3 V," << "B3 Cap," << "B3 Op," << "B3 State," << "B3 Charge,";
+    outStream << "L1 I," << "L1 V," << "L2 I," << "L2 V," << "M1 I," << "M1 V,";
+    outStream << "Temp," << "Controls," << "Switches," << "Decisions," << "Indicators,";
+    outStream << "Debug 1a," << "Debug 1b," << "Debug 2a," << "Debug 2b," << "Debug 3a," << "Debug 3b";
+    outStream << "\n\r";
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Write a combined record for a time block.
+
+@param[in] outStream: stream to write to.
+@param[in] timeRecord: time of the block as given in the pH record.
+*/
+
+void CombineState::writeRow(QTextStream& outStream, QString timeRecord) const
+{
+    outStream << timeRecord << ",";
+    for (int i=0; i<3; i++)
+    {
+        outStream << (float)batteryCurrent[i]/256 << ",";
+        outStream << (float)batteryVoltage[i]/256 << ",";
+        outStream << (float)batterySoC[i]/256 << ",";
+        outStream << batteryStateText[i] << ",";
+        outStream << batteryFillText[i] << ",";
+        outStream << batteryChargeText[i] << ",";
+    }
+    outStream << (float)load1Voltage/256 << ",";
+    outStream << (float)load1Current/256 << ",";
+    outStream << (float)load2Voltage/256 << ",";
+    outStream << (float)load2Current/256 << ",";
+    outStream << (float)panel1Voltage/256 << ",";
+    outStream << (float)panel1Current/256 << ",";
+    outStream << (float)temperature/256 << ",";
+    outStream << controls << ",";
+    outStream << switches << ",";
+    outStream << decision << ",";
+    outStream << indicatorString << ",";
+    outStream << debugA[0] << ",";
+    outStream << debugB[0] << ",";
+    outStream << debugA[1] << ",";
+    outStream << debugB[1] << ",";
+    outStream << debugA[2] << ",";
+    outStream << debugB[2];
+    outStream << "\n\r";
+}
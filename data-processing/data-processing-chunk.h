@@ -0,0 +1,167 @@
+/**
+@mainpage Power Management Data Processing Raw File Chunks
+@version 1.0
+@author Ken Sarkies (www.jiggerjuice.net)
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@trinity.asn.au                                                *
+ *                                                                          *
+ *   This file is part of Power Management                                  *
+ *                                                                          *
+ *   Power Management is free software; you can redistribute it and/or      *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management is distributed in the hope that it will be useful,    *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management if not, write to the                       *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+#ifndef DATA_PROCESSING_CHUNK_H
+#define DATA_PROCESSING_CHUNK_H
+
+#include "data-processing-energy-model.h"
+#include "data-processing-stats.h"
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QMap>
+#include <QDate>
+#include <QDateTime>
+#include <QTextStream>
+
+// Limits on the size of a chunk of raw file parsed by one thread
+#define CHUNK_MIN_SIZE 1048576
+#define CHUNK_MAX_SIZE 67108864
+// Number of chunks for each available core, to balance the load
+#define CHUNKS_PER_THREAD 4
+// Length of the controls field in the combined record
+#define CONTROLS_LENGTH 7
+
+//-----------------------------------------------------------------------------
+/** @brief Section of a raw data file parsed independently.
+
+Chunks start on a pH time record (except the first) so that no time block is
+split. The scan of a chunk keeps partial results which are stitched together in
+file order, along with the last line of each record type so that the state at
+the start of any chunk can be rebuilt without reading the earlier chunks again.
+*/
+
+struct RawChunk
+{
+    qint64 start;
+    qint64 end;
+// Time records found in the chunk
+    QDateTime firstTime;
+    QDateTime lastTime;
+    QDateTime maxTime;
+// Last line of each record type, and control characters set by dD records
+    QHash<QString,QString> lastRecord;
+    QString controlsDelta;
+// Current zero calibration partial sums. Calibration points found before the
+// battery current is first seen in the chunk use the current carried over from
+// the previous chunk.
+    long long calibrationSum[3];
+    uint calibrationCount[3];
+    uint pendingCount[3];
+    bool currentSeen[3];
+    int lastCurrent[3];
+};
+
+//-----------------------------------------------------------------------------
+/** @brief Daily energy sums for each source.
+*/
+
+struct DayEnergy
+{
+    long long energy[numberEnergySources];
+};
+
+typedef QMap<QDate, DayEnergy> EnergyMap;
+
+//-----------------------------------------------------------------------------
+/** @brief Latest values of all records for building a combined record.
+*/
+
+class CombineState
+{
+public:
+    CombineState();
+    void update(const QStringList& breakdown, const long long currentZero[3]);
+    void apply(const RawChunk& chunk, const long long currentZero[3]);
+    void writeRow(QTextStream& outStream, QString timeRecord) const;
+    static void writeHeader(QTextStream& outStream);
+    static void updateControls(QString* controls, int secondField);
+private:
+    int batteryVoltage[3];
+    int batteryCurrent[3];
+    int batterySoC[3];
+    QString batteryStateText[3];
+    QString batteryFillText[3];
+    QString batteryChargeText[3];
+    int load1Voltage;
+    int load1Current;
+    int load2Voltage;
+    int load2Current;
+    int panel1Voltage;
+    int panel1Current;
+    int temperature;
+    QString controls;
+    QString switches;
+    QString decision;
+    QString indicatorString;
+    int debugA[3];
+    int debugB[3];
+};
+
+//-----------------------------------------------------------------------------
+/** @brief Work items passed to the threads.
+*/
+
+struct ScanJob
+{
+    QString fileName;
+    PassStatistics* statistics;
+    RawChunk chunk;
+};
+
+struct EnergyJob
+{
+    QString fileName;
+    PassStatistics* statistics;
+    RawChunk chunk;
+    QDateTime previousTime;
+    QDateTime startTime;
+    QDateTime finalTime;
+    long long currentZero[3];
+};
+
+struct CombineJob
+{
+    QString fileName;
+    PassStatistics* statistics;
+    RawChunk chunk;
+    CombineState initial;
+    QDateTime nextTime;
+    QDateTime startTime;
+    QDateTime endTime;
+    long long currentZero[3];
+};
+
+QList<RawChunk> splitRawFile(QString fileName);
+RawChunk scanChunk(const ScanJob& job);
+EnergyMap energyChunk(const EnergyJob& job);
+QString combineChunk(const CombineJob& job);
+
+#endif
@@ -0,0 +1,171 @@
+/**
+@mainpage Power Management Data Processing Energy Table Model
+@version 1.0
+@author Ken Sarkies (www.jiggerjuice.net)
+@date 16 October 2026
+
+Model for the daily energy balance table.
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@trinity.asn.au                                                *
+ *                                                                          *
+ *   This file is part of Power Management                                  *
+ *                                                                          *
+ *   Power Management is free software; you can redistribute it and/or      *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management is distributed in the hope that it will be useful,    *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management if not, write to the                       *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+#include "data-processing-energy-model.h"
+#include <QApplication>
+#include <QFont>
+#include <QStringList>
+
+//-----------------------------------------------------------------------------
+/** Energy Table Model Constructor
+
+@param[in] parent Parent object.
+*/
+
+EnergyTableModel::EnergyTableModel(QObject* parent)
+                    : QAbstractTableModel(parent)
+{
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Number of days in the table.
+*/
+
+int EnergyTableModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) return 0;
+    return dates.size();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Date, each source and the total.
+*/
+
+int EnergyTableModel::columnCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) return 0;
+    return numberEnergySources+2;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Format a cell on request from the view.
+
+The total is shown in bold.
+*/
+
+QVariant EnergyTableModel::data(const QModelIndex& index, int role) const
+{
+    if (! index.isValid() || (index.row() >= dates.size())) return QVariant();
+    if (role == Qt::DisplayRole) return text(index.row(),index.column());
+    if ((role == Qt::FontRole) && (index.column() == numberEnergySources+1))
+    {
+        QFont tableFont = QApplication::font();
+        tableFont.setBold(true);
+        return tableFont;
+    }
+    return QVariant();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Column titles.
+*/
+
+QVariant EnergyTableModel::headerData(int section, Qt::Orientation orientation,
+                                      int role) const
+{
+    if ((role != Qt::DisplayRole) || (orientation != Qt::Horizontal))
+        return QVariant();
+    QStringList header;
+    header << "Date" << "Battery 1" << "Battery 2" << "Battery 3";
+    header << "Load 1" << "Load 2" << "Panel" << "Total";
+    if ((section < 0) || (section >= header.size())) return QVariant();
+    return header[section];
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Remove all days from the table.
+*/
+
+void EnergyTableModel::clear()
+{
+    beginResetModel();
+    dates.clear();
+    for (int n = 0; n < numberEnergySources; n++) energies[n].clear();
+    endResetModel();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Add a day to the end of the table.
+
+@param[in] date: the day covered.
+@param[in] energy: raw energy sums for each source, indexed by EnergySource.
+*/
+
+void EnergyTableModel::appendDay(QDate date,
+                                 const long long energy[numberEnergySources])
+{
+    int row = dates.size();
+    beginInsertRows(QModelIndex(),row,row);
+    dates.append(date);
+    for (int n = 0; n < numberEnergySources; n++) energies[n].append(energy[n]);
+    endInsertRows();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Text of a cell.
+
+Energies are given in AH to three significant figures.
+*/
+
+QString EnergyTableModel::text(int row, int column) const
+{
+    if ((row < 0) || (row >= dates.size())) return QString();
+    if (column == 0) return dates[row].toString("dd/MM/yy");
+    long long energy = 0;
+    if ((column > 0) && (column <= numberEnergySources))
+        energy = energies[column-1][row];
+// Total energy used (negative if charging) is the sum over the batteries
+    else if (column == numberEnergySources+1)
+        energy = energies[energyBattery1][row] + energies[energyBattery2][row]
+               + energies[energyBattery3][row];
+    else return QString();
+    return QString("%1").arg((float)energy/ENERGY_SCALE,0,'g',3);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Write the table as CSV.
+
+Rows are written directly from the stored sums.
+*/
+
+void EnergyTableModel::save(QTextStream& outStream) const
+{
+    int numberColumns = columnCount();
+    for (int row = 0; row < dates.size(); row++)
+    {
+        for (int column = 0; column < numberColumns; column++)
+        {
+            if (column > 0) outStream << ",";
+            outStream << text(row,column);
+        }
+        outStream << "\n\r";
+    }
+}
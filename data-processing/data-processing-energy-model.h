@@ -0,0 +1,73 @@
+/**
+@mainpage Power Management Data Processing Energy Table Model
+@version 1.0
+@author Ken Sarkies (www.jiggerjuice.net)
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@trinity.asn.au                                                *
+ *                                                                          *
+ *   This file is part of Power Management                                  *
+ *                                                                          *
+ *   Power Management is free software; you can redistribute it and/or      *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management is distributed in the hope that it will be useful,    *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management if not, write to the                       *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+#ifndef DATA_PROCESSING_ENERGY_MODEL_H
+#define DATA_PROCESSING_ENERGY_MODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include <QDate>
+#include <QTextStream>
+
+// Energy accumulated as current times 256 by seconds, converted to AH.
+#define ENERGY_SCALE 921600
+
+typedef enum {energyBattery1, energyBattery2, energyBattery3,
+              energyLoad1, energyLoad2, energyPanel, numberEnergySources}
+              EnergySource;
+
+//-----------------------------------------------------------------------------
+/** @brief Daily energy balance table model.
+
+Energies are held as raw integer sums in one array per source, with one entry
+per day. Text is only formatted when the view asks for a visible cell or the
+table is saved. Column 0 is the date, columns 1-6 are the sources in the order
+of EnergySource and column 7 is the battery total.
+*/
+
+class EnergyTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    EnergyTableModel(QObject* parent = 0);
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const;
+    void clear();
+    void appendDay(QDate date, const long long energy[numberEnergySources]);
+    QString text(int row, int column) const;
+    void save(QTextStream& outStream) const;
+private:
+    QVector<QDate> dates;
+    QVector<long long> energies[numberEnergySources];
+};
+
+#endif
@@ -41,8 +41,11 @@ Utility program to aid in analysis if BMS data files.
 #include <QFileDialog>
 #include <QDateTime>
 #include <QDir>
+#include <QDirIterator>
 #include <QFile>
 #include <QDebug>
+#include <QThread>
+#include <QtConcurrentMap>
 #include <qwt_plot.h>
 #include <qwt_plot_curve.h>
 #include <qwt_plot_grid.h>
@@ -93,13 +96,16 @@ DataProcessingGui::DataProcessingGui()
     DataProcessingMainUi.intervalType->addItem("Maximum");
     DataProcessingMainUi.intervalType->addItem("Sample");
 // Build the energy table
-    QStringList energyViewHeader;
-    energyViewHeader << "Battery 1" << "Battery 2" << "Battery 3";
-    energyViewHeader << "Load 1" << "Load 1" << "Panel" << "Total";
-    DataProcessingMainUi.energyView->setHorizontalHeaderLabels(energyViewHeader);
+    energyModel = new EnergyTableModel(this);
+    DataProcessingMainUi.energyView->setModel(energyModel);
 
     energyOutFile = NULL;
     outFile = NULL;
+    overlayPlot = NULL;
+    overlayCount = 0;
+    overlayReference = 0;
+    overlayAligned = false;
+    overlayTimeOfDay = false;
 }
 
 DataProcessingGui::~DataProcessingGui()
@@ -116,6 +122,16 @@ bool DataProcessingGui::success()
     return true;
 }
 
+//-----------------------------------------------------------------------------
+/** @brief Set a file to receive a Chrome trace of all passes.
+
+@param[in] fileName: name of the JSON trace file.
+*/
+void DataProcessingGui::setTraceFile(QString fileName)
+{
+    statistics.setTraceFile(fileName);
+}
+
 //-----------------------------------------------------------------------------
 /** @brief Open a raw data file for Reading.
 
@@ -294,6 +310,9 @@ energy includes loads and sources and therefore itself provides sufficient
 information. The loads and sources alone do not account for onboard electronics
 power usage. The total balance is displayed.
 
+The file chunks found by the scan are summed in parallel and the daily sums are
+added together afterwards.
+
 The load and source currents show large negative swings when the undervoltage
 or overcurrent indicators are triggered. Any negative swing on those currents
 is set to zero. The indicator settings are captured but not used at this stage.
@@ -303,178 +322,63 @@ void DataProcessingGui::on_energyButton_clicked()
 {
     if (inFile == NULL) return;
     if (! inFile->isOpen()) return;
-    inFile->seek(0);      // rewind file
-    tableRow = 0;
-//    int interval = DataProcessingMainUi.intervalSpinBox->value();
-//    int intervaltype = DataProcessingMainUi.intervalType->currentIndex();
-    QTextStream inStream(inFile);
     QDateTime startTime = DataProcessingMainUi.startTime->dateTime();
     QDateTime finalTime = DataProcessingMainUi.endTime->dateTime();
-    QDateTime time = startTime;
-    QDateTime previousTime = startTime;
-// Cumulative energy measures
-    long long battery1Energy = 0;
-    long long battery2Energy = 0;
-    long long battery3Energy = 0;
-    long long load1Energy = 0;
-    long long load2Energy = 0;
-    long long panelEnergy = 0;
-    long battery1Seconds = 0;
-    long battery2Seconds = 0;
-    long battery3Seconds = 0;
-    long load1Seconds = 0;
-    long load2Seconds = 0;
-    long panelSeconds = 0;
-    long elapsedSeconds = 0;
-//    int indicators = 0;
-    DataProcessingMainUi.energyView->clear();
-// Set the end time to the record before midnight
-    QDateTime endTime(startTime.date(),QTime(23,59,59));
-    while (true)
+    energyModel->clear();
+    statistics.begin("energy");
+// Each chunk is summed in a separate thread, and needs the time of the last
+// time record in the previous chunk to find the first elapsed time.
+    QList<EnergyJob> jobs;
+    QDateTime previousTime;
+    for (int n=0; n<rawChunks.size(); n++)
+    {
+        EnergyJob job;
+        job.fileName = inFile->fileName();
+        job.statistics = &statistics;
+        job.chunk = rawChunks[n];
+        job.previousTime = previousTime;
+        job.startTime = startTime;
+        job.finalTime = finalTime;
+        job.currentZero[0] = battery1CurrentZero;
+        job.currentZero[1] = battery2CurrentZero;
+        job.currentZero[2] = battery3CurrentZero;
+        if (rawChunks[n].lastTime.isValid()) previousTime = rawChunks[n].lastTime;
+        if (rawChunks[n].maxTime.isValid() && (rawChunks[n].maxTime < startTime))
+            continue;
+        jobs << job;
+        if (rawChunks[n].firstTime.isValid() && (rawChunks[n].firstTime > finalTime))
+            break;
+    }
+    QList<EnergyMap> partials =
+        QtConcurrent::blockingMapped<QList<EnergyMap> >(jobs,energyChunk);
+// Stitch the daily sums together. A day can span several chunks.
+    EnergyMap energyMap;
+    for (int n=0; n<partials.size(); n++)
     {
-        if (! inStream.atEnd())
+        EnergyMap::const_iterator day;
+        for (day = partials[n].constBegin(); day != partials[n].constEnd(); ++day)
         {
-          	QString lineIn = inStream.readLine();
-            QStringList breakdown = lineIn.split(",");
-            int size = breakdown.size();
-            if (size <= 0) break;
-            QString firstText = breakdown[0].simplified();
-            int secondField = 0;
-//            int thirdField = 0;
-            if (size > 1)
-            {
-// Extract the time record for time range comparison.
-// records are nominally 0.5 seconds apart but QT doesn't have fractions of
-// a second. Therefore some intervals will be zero. This method however accounts
-// for gaps in the records.
-                if (firstText == "pH")
-                {
-                    previousTime = time;
-                    time = QDateTime::fromString(breakdown[1].simplified(),Qt::ISODate);
-                    elapsedSeconds = previousTime.secsTo(time);
-                }
-                else
-                {
-                    secondField = breakdown[1].simplified().toInt();
-                }
-            }
-//            if (size > 2) thirdField = breakdown[2].simplified().toInt();
-// Extract records of measured currents and add up. The second field is the
-// current times 256 and the third is the voltage times 256 (not needed).
-            if (time >= startTime)
+            if (! energyMap.contains(day.key()))
             {
-                if (firstText == "dB1")
-                {
-                    int battery1Current = secondField-battery1CurrentZero;
-                    battery1Energy += battery1Current*elapsedSeconds;
-                    battery1Seconds += elapsedSeconds;
-                }
-                if (firstText == "dB2")
-                {
-                    int battery2Current = secondField-battery2CurrentZero;
-                    battery2Energy += battery2Current*elapsedSeconds;
-                    battery2Seconds += elapsedSeconds;
-                }
-                if (firstText == "dB3")
-                {
-                    int battery3Current = secondField-battery3CurrentZero;
-                    battery3Energy += battery3Current*elapsedSeconds;
-                    battery3Seconds += elapsedSeconds;
-                }
-// Sum only positive currents. Negatives are phantoms due to electronics.
-                if (firstText == "dL1")
-                {
-                    int load1Current = secondField;
-                    if (load1Current < 0) load1Current = 0;
-                    load1Energy += load1Current*elapsedSeconds;
-                    load1Seconds += elapsedSeconds;
-                }
-                if (firstText == "dL2")
-                {
-                    int load2Current = secondField;
-                    if (load2Current < 0) load2Current = 0;
-                    load2Energy += load2Current*elapsedSeconds;
-                    load2Seconds += elapsedSeconds;
-                }
-                if (firstText == "dM1")
-                {
-                    int panelCurrent = secondField;
-                    if (panelCurrent < 0) panelCurrent = 0;
-                    panelEnergy += panelCurrent*elapsedSeconds;
-                    panelSeconds += elapsedSeconds;
-                }
-// Get record of indicators (not needed)
-//                if (firstText == "dI") indicators = secondField;
+                energyMap.insert(day.key(),day.value());
+                continue;
             }
-        }
-// Completion of a day or file. Print out and get ready for next.
-        if  ((time > endTime) || inStream.atEnd())
-        {
-// Add a row if necessary
-            if (tableRow >= DataProcessingMainUi.energyView->rowCount())
-                DataProcessingMainUi.energyView->setRowCount(tableRow+1);
-
-            QDate date = startTime.date();
-            QTableWidgetItem *day = new QTableWidgetItem(date.toString("dd/MM/yy"));
-            DataProcessingMainUi.energyView->setItem(tableRow, 0, day);
-            QTableWidgetItem *battery1Item = new QTableWidgetItem(tr("%1")
-                 .arg((float)battery1Energy/921600,0,'g',3));
-            DataProcessingMainUi.energyView->setItem(tableRow, 1, battery1Item);
-            QTableWidgetItem *battery2Item = new QTableWidgetItem(tr("%1")
-                 .arg((float)battery2Energy/921600,0,'g',3));
-            DataProcessingMainUi.energyView->setItem(tableRow, 2, battery2Item);
-            QTableWidgetItem *battery3Item = new QTableWidgetItem(tr("%1")
-                 .arg((float)battery3Energy/921600,0,'g',3));
-            DataProcessingMainUi.energyView->setItem(tableRow, 3, battery3Item);
-            QTableWidgetItem *load1Item = new QTableWidgetItem(tr("%1")
-                 .arg((float)load1Energy/921600,0,'g',3));
-            DataProcessingMainUi.energyView->setItem(tableRow, 4, load1Item);
-            QTableWidgetItem *load2Item = new QTableWidgetItem(tr("%1")
-                 .arg((float)load2Energy/921600,0,'g',3));
-            DataProcessingMainUi.energyView->setItem(tableRow, 5, load2Item);
-            QTableWidgetItem *panelItem = new QTableWidgetItem(tr("%1")
-                 .arg((float)panelEnergy/921600,0,'g',3));
-            DataProcessingMainUi.energyView->setItem(tableRow, 6, panelItem);
-// Display total energy used (negative if charging) in last column
-            long long totalEnergy = battery1Energy+battery2Energy+battery3Energy;
-            QTableWidgetItem *energyTotal = new QTableWidgetItem(tr("%1")
-                 .arg((float)totalEnergy/921600,0,'g',3));
-            QFont tableFont = QApplication::font();
-            tableFont.setBold(true);
-            energyTotal->setFont(tableFont);
-            DataProcessingMainUi.energyView->setItem(tableRow, 7, energyTotal);
-
-            if (inStream.atEnd()) break;
-
-// Reset energy measures
-            battery1Energy = 0;
-            battery2Energy = 0;
-            battery3Energy = 0;
-            load1Energy = 0;
-            load2Energy = 0;
-            panelEnergy = 0;
-            battery1Seconds = 0;
-            battery2Seconds = 0;
-            battery3Seconds = 0;
-            load1Seconds = 0;
-            load2Seconds = 0;
-            panelSeconds = 0;
-            elapsedSeconds = 0;
-
-            tableRow++;
-// New start and end times
-            startTime = QDateTime(startTime.date().addDays(1),QTime(0,0,0));
-            if (startTime > DataProcessingMainUi.endTime->dateTime()) return;
-            endTime = QDateTime(startTime.date(),QTime(23,59,59));
-            if (endTime > DataProcessingMainUi.endTime->dateTime())
-                endTime = DataProcessingMainUi.endTime->dateTime();
+            DayEnergy& total = energyMap[day.key()];
+            for (int i=0; i<numberEnergySources; i++)
+                total.energy[i] += day.value().energy[i];
         }
     }
+// Add a row to the table for each day. Text is formatted by the model when shown.
+    EnergyMap::const_iterator day;
+    for (day = energyMap.constBegin(); day != energyMap.constEnd(); ++day)
+        energyModel->appendDay(day.key(),day.value().energy);
+    statusBar()->showMessage(statistics.end());
 }
 
 //-----------------------------------------------------------------------------
 /** @brief Save Energy Computations.
 
+The table is written directly from the energy model.
 */
 
 void DataProcessingGui::on_energySaveButton_clicked()
@@ -495,17 +399,7 @@ void DataProcessingGui::on_energySaveButton_clicked()
         return;
     }
     QTextStream outStream(energyOutFile);
-    int numberColumns = DataProcessingMainUi.energyView->columnCount();
-    for (int row = 0; row<tableRow; row++)
-    {
-        for (int column = 0; column<numberColumns; column++)
-        {
-            if (column > 0) outStream << ",";
-            QString item = DataProcessingMainUi.energyView->item(row,column)->text();
-            outStream << item;
-        }
-        outStream << "\n\r";
-    }
+    energyModel->save(outStream);
     energyOutFile->close();
     delete energyOutFile;
 }
@@ -550,19 +444,29 @@ void DataProcessingGui::on_extractButton_clicked()
     bool firstTime = true;
 // The first record only is preceded by the constructed header.
     bool firstRecord = true;
+    statistics.begin("extract");
+    StageCounters counters;
+    StageClock stageClock(&counters);
+    qint64 start = statistics.now();
     while (! inStream.atEnd())
     {
       	QString lineIn = inStream.readLine();
+        counters.lines++;
+        stageClock.lap(stageRead);
         QStringList breakdown = lineIn.split(",");
         int size = breakdown.size();
+        stageClock.lap(stageSplit);
         if (size <= 0) break;
         QString firstText = breakdown[0].simplified();
+        if (size > 1) counters.records[firstText]++;
+        else counters.malformed++;
 // Extract the time record for time range comparison.
         if (size > 1)
         {
             if (firstText == "pH")
             {
                 time = QDateTime::fromString(breakdown[1].simplified(),Qt::ISODate);
+                stageClock.lap(stageTime);
                 if ((time >= startTime) && (time <= endTime))
                 {
                     if (!firstTime)
@@ -576,6 +480,7 @@ void DataProcessingGui::on_extractButton_clicked()
 // Output the combined record and null it for next pass.
                         outStream << comboRecord << "\n\r";
                         comboRecord = QString();
+                        stageClock.lap(stageWrite);
                     }
                     firstTime = false;
                 }
@@ -607,9 +512,13 @@ void DataProcessingGui::on_extractButton_clicked()
                 if (! comboRecord.isEmpty()) comboRecord += ",";
                 comboRecord += breakdown[1].simplified();
                 if (size > 2) comboRecord += "," + breakdown[2].simplified();
+                stageClock.lap(stageFormat);
             }
         }
     }
+    counters.bytes = inFile->pos();
+    statistics.merge(counters,"extract",start);
+    statusBar()->showMessage(statistics.end());
     if (saveFile.isEmpty())
         displayErrorMessage("File already closed");
     else
@@ -883,14 +792,23 @@ void DataProcessingGui::on_plotFileSelectButton_clicked()
     double index = 0;
     QDateTime startTime;
     QDateTime previousTime;
+    statistics.begin("plot");
+    StageCounters counters;
+    StageClock stageClock(&counters);
+    qint64 start = statistics.now();
     while (! inStream.atEnd())
     {
       	lineIn = inStream.readLine();
+        counters.lines++;
+        stageClock.lap(stageRead);
         QStringList breakdown = lineIn.split(",");
         int size = breakdown.size();
+        stageClock.lap(stageSplit);
+        if (size != LINE_WIDTH) counters.malformed++;
         if (size == LINE_WIDTH)
         {
             QDateTime time = QDateTime::fromString(breakdown[0].simplified(),Qt::ISODate);
+            stageClock.lap(stageTime);
             if (time.isValid())
             {
 // On the first run get the start time
@@ -943,9 +861,13 @@ void DataProcessingGui::on_plotFileSelectButton_clicked()
                         points4 << QPointF(index,currentModule);
                     }
                 }
+                stageClock.lap(stageFormat);
             }
         }
     }
+    counters.bytes = inFile->pos();
+    statistics.merge(counters,"plot",start);
+    statusBar()->showMessage(statistics.end());
 // Build plot
     QwtPlot *plot = new QwtPlot(0);
     if (showStates) plot->setTitle("Battery States");
@@ -994,6 +916,167 @@ void DataProcessingGui::on_plotFileSelectButton_clicked()
     plot->show();
 }
 
+//-----------------------------------------------------------------------------
+/** @brief Select a File to be added to the overlay plot
+
+Series are selected with the same checkboxes as the single file plot, and are
+drawn from the plot cache so files already overlaid are not read again. With
+the time of day option each day in the file is overlaid separately, aligned to
+the midnight of the first day plotted since the overlay was cleared or the
+option was changed. States plots cannot be overlaid as they are scaled for a
+single battery.
+*/
+
+void DataProcessingGui::on_overlayFileSelectButton_clicked()
+{
+    if (DataProcessingMainUi.statesPlotCheckbox->isChecked())
+    {
+        displayErrorMessage("States plots cannot be overlaid");
+        return;
+    }
+    bool showCurrent = ! DataProcessingMainUi.voltagePlotCheckBox->isChecked();
+    bool timeOfDay = DataProcessingMainUi.overlayTimeOfDayCheckbox->isChecked();
+    if (timeOfDay != overlayTimeOfDay)
+    {
+        overlayAligned = false;
+        overlayTimeOfDay = timeOfDay;
+    }
+    QList<int> columns;
+    QStringList titles;
+    if (DataProcessingMainUi.temperaturePlotCheckbox->isChecked())
+    {
+        columns << 25;
+        titles << "Temperature";
+    }
+    else
+    {
+        if (DataProcessingMainUi.battery1Checkbox->isChecked())
+        {
+            columns << (showCurrent ? 1 : 2);
+            titles << "Battery 1";
+        }
+        if (DataProcessingMainUi.battery2Checkbox->isChecked())
+        {
+            columns << (showCurrent ? 7 : 8);
+            titles << "Battery 2";
+        }
+        if (DataProcessingMainUi.battery3Checkbox->isChecked())
+        {
+            columns << (showCurrent ? 13 : 14);
+            titles << "Battery 3";
+        }
+        if (showCurrent && DataProcessingMainUi.moduleCheckbox->isChecked())
+        {
+            columns << 23;
+            titles << "Module";
+        }
+    }
+    if (columns.isEmpty()) return;
+
+// Get data file
+    QString fileName = QFileDialog::getOpenFileName(0,
+                                "Data File","./","CSV Files (*.csv)");
+    if (fileName.isEmpty()) return;
+    if (! plotCache.load(fileName,columns,&statistics))
+    {
+        displayErrorMessage("Could not open overlay file");
+        return;
+    }
+    QFileInfo fileInfo;
+    fileInfo.setFile(fileName);
+
+// Create the overlay plot on first use
+    if (overlayPlot == NULL)
+    {
+        overlayPlot = new QwtPlot(0);
+        overlayPlot->setTitle("Overlay");
+        overlayPlot->setCanvasBackground(Qt::white);
+        QwtDateScaleDraw *qwtDateScaleDraw = new QwtDateScaleDraw(Qt::LocalTime);
+        QwtDateScaleEngine *qwtDateScaleEngine = new QwtDateScaleEngine(Qt::LocalTime);
+        qwtDateScaleDraw->setDateFormat(QwtDate::Hour, "hh:mm");
+        overlayPlot->setAxisScaleDraw(QwtPlot::xBottom, qwtDateScaleDraw);
+        overlayPlot->setAxisScaleEngine(QwtPlot::xBottom, qwtDateScaleEngine);
+        overlayPlot->insertLegend(new QwtLegend());
+        QwtPlotGrid *grid = new QwtPlotGrid();
+        grid->attach(overlayPlot);
+        overlayPlot->resize(1000,600);
+    }
+
+// Build a list of time ranges, either the whole file or each day separately
+    double fileStart = plotCache.startTime(fileName);
+    double fileEnd = plotCache.endTime(fileName) + 1;
+    QList<double> rangeStart;
+    QList<double> rangeEnd;
+    QList<double> rangeOffset;
+    QStringList rangeTitle;
+    if (timeOfDay)
+    {
+        QDateTime day = QDateTime::fromMSecsSinceEpoch((qint64)fileStart);
+        day.setTime(QTime(0,0));
+        if (! overlayAligned)
+        {
+            overlayReference = day.toMSecsSinceEpoch();
+            overlayAligned = true;
+        }
+        while (day.toMSecsSinceEpoch() < fileEnd)
+        {
+            QDateTime nextDay = day.addDays(1);
+            rangeStart << day.toMSecsSinceEpoch();
+            rangeEnd << nextDay.toMSecsSinceEpoch();
+            rangeOffset << overlayReference - day.toMSecsSinceEpoch();
+            rangeTitle << day.date().toString("yyyy-MM-dd");
+            day = nextDay;
+        }
+    }
+    else
+    {
+        rangeStart << fileStart;
+        rangeEnd << fileEnd;
+        rangeOffset << 0;
+        rangeTitle << fileInfo.baseName();
+    }
+
+// Attach a curve for each series and range
+    QList<Qt::GlobalColor> colours;
+    colours << Qt::blue << Qt::red << Qt::darkGreen << Qt::magenta
+            << Qt::darkCyan << Qt::darkYellow << Qt::black << Qt::gray;
+    for (int r = 0; r < rangeStart.size(); r++)
+    {
+        for (int n = 0; n < columns.size(); n++)
+        {
+            QPolygonF points = plotCache.points(fileName,columns[n],rangeStart[r],
+                                    rangeEnd[r],rangeOffset[r],OVERLAY_POINTS);
+            if (points.isEmpty()) continue;
+            QwtPlotCurve *curve = new QwtPlotCurve();
+            curve->setTitle(rangeTitle[r] + " " + titles[n]);
+            curve->setPen(colours[overlayCount % colours.size()], 2);
+            curve->setRenderHint(QwtPlotItem::RenderAntialiased, true);
+            curve->setSamples(points);
+            curve->attach(overlayPlot);
+            overlayCount++;
+        }
+    }
+    overlayPlot->replot();
+    overlayPlot->show();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Clear the overlay plot
+
+Curves are removed from the plot but the cached files are kept so that they can
+be overlaid again without rereading.
+*/
+
+void DataProcessingGui::on_overlayClearButton_clicked()
+{
+    if (overlayPlot == NULL) return;
+    overlayPlot->detachItems(QwtPlotItem::Rtti_PlotCurve, true);
+    overlayCount = 0;
+    overlayReference = 0;
+    overlayAligned = false;
+    overlayPlot->replot();
+}
+
 //-----------------------------------------------------------------------------
 /** @brief Analysis of CSV files for various performance indicators.
 
@@ -1067,6 +1150,10 @@ void DataProcessingGui::on_analysisFileSelectButton_clicked()
         }
 // Read in data from input file
 // Skip first line as it may be a header
+        statistics.begin("fault analysis");
+        StageCounters counters;
+        StageClock stageClock(&counters);
+        qint64 start = statistics.now();
         inFile->seek(0);      // rewind input file
       	QString lineIn;
         lineIn = inStream.readLine();
@@ -1078,12 +1165,18 @@ void DataProcessingGui::on_analysisFileSelectButton_clicked()
         QDateTime previousTime;
         while (! inStream.atEnd())
         {
+            stageClock.lap(stageFormat);
           	lineIn = inStream.readLine();
+            counters.lines++;
+            stageClock.lap(stageRead);
             QStringList breakdown = lineIn.split(",");
             int size = breakdown.size();
+            stageClock.lap(stageSplit);
+            if (size != LINE_WIDTH) counters.malformed++;
             if (size == LINE_WIDTH)
             {
                 QDateTime time = QDateTime::fromString(breakdown[0].simplified(),Qt::ISODate);
+                stageClock.lap(stageTime);
                 if (time.isValid())
                 {
 // On the first run get the start time
@@ -1144,6 +1237,9 @@ void DataProcessingGui::on_analysisFileSelectButton_clicked()
                 }
             }
         }
+        counters.bytes = inFile->pos();
+        statistics.merge(counters,"fault analysis",start);
+        statusBar()->showMessage(statistics.end());
         outFile->close();
         delete outFile;
     }
@@ -1179,17 +1275,27 @@ void DataProcessingGui::on_analysisFileSelectButton_clicked()
             }
 // Read in data from input file
 // Skip first line as it may be a header
+            statistics.begin(QString("charging B%1 analysis").arg(i+1));
+            StageCounters counters;
+            StageClock stageClock(&counters);
+            qint64 start = statistics.now();
             inFile->seek(0);                // rewind input file
           	QString lineIn;
             lineIn = inStream.readLine();
             while (! inStream.atEnd())
             {
+                stageClock.lap(stageFormat);
               	lineIn = inStream.readLine();
+                counters.lines++;
+                stageClock.lap(stageRead);
                 QStringList breakdown = lineIn.split(",");
                 int size = breakdown.size();
+                stageClock.lap(stageSplit);
+                if (size != LINE_WIDTH) counters.malformed++;
                 if (size == LINE_WIDTH)
                 {
                     QDateTime time = QDateTime::fromString(breakdown[0].simplified(),Qt::ISODate);
+                    stageClock.lap(stageTime);
                     if (time.isValid())
                     {
 
@@ -1211,6 +1317,9 @@ void DataProcessingGui::on_analysisFileSelectButton_clicked()
                     }
                 }
             }
+            counters.bytes = inFile->pos();
+            statistics.merge(counters,QString("charging B%1 analysis").arg(i+1),start);
+            statusBar()->showMessage(statistics.end());
             outFile->close();
             delete outFile;
         }
@@ -1244,17 +1353,27 @@ void DataProcessingGui::on_analysisFileSelectButton_clicked()
         }
 // Read in data from input file
 // Skip first line as it may be a header
+        statistics.begin("solar analysis");
+        StageCounters counters;
+        StageClock stageClock(&counters);
+        qint64 start = statistics.now();
         inFile->seek(0);                // rewind input file
       	QString lineIn;
         lineIn = inStream.readLine();
         while (! inStream.atEnd())
         {
+            stageClock.lap(stageFormat);
           	lineIn = inStream.readLine();
+            counters.lines++;
+            stageClock.lap(stageRead);
             QStringList breakdown = lineIn.split(",");
             int size = breakdown.size();
+            stageClock.lap(stageSplit);
+            if (size != LINE_WIDTH) counters.malformed++;
             if (size == LINE_WIDTH)
             {
                 QDateTime time = QDateTime::fromString(breakdown[0].simplified(),Qt::ISODate);
+                stageClock.lap(stageTime);
                 if (time.isValid())
                 {
 
@@ -1300,17 +1419,112 @@ void DataProcessingGui::on_analysisFileSelectButton_clicked()
                 }
             }
         }
+        counters.bytes = inFile->pos();
+        statistics.merge(counters,"solar analysis",start);
+        statusBar()->showMessage(statistics.end());
         outFile->close();
         delete outFile;
     }
 }
 
+//-----------------------------------------------------------------------------
+/** @brief Battery Ageing from Raw Files.
+
+A fleet directory is selected and every raw data file in it and in the
+directories below it is read. The internal resistance of each battery is
+estimated for each day, along with the capacity from the charge drawn between
+full charge events. Files are analysed in parallel.
+
+Results for each file are kept in a cache in the fleet directory, so that as
+new files are logged only those files need to be read. A file is read again if
+its size or modification time has changed, or if it could not be read before.
+
+Each unit of a fleet is reported separately, the unit being the directory that
+holds its files, so each unit keeps its files in its own directory below the
+fleet directory.
+*/
+
+void DataProcessingGui::on_ageingFileSelectButton_clicked()
+{
+    QString fleetName = QFileDialog::getExistingDirectory(this,
+                                "Fleet Directory","./");
+    if (fleetName.isEmpty()) return;
+    QDir ageingDirectory(fleetName);
+    QStringList fileNames;
+    QDirIterator rawFiles(fleetName, QStringList() << "*.txt" << "*.TXT",
+                          QDir::Files, QDirIterator::Subdirectories);
+    while (rawFiles.hasNext())
+    {
+        QString fileName = rawFiles.next();
+        if (rawFiles.fileName() != AGEING_CACHE_FILE) fileNames << fileName;
+    }
+    if (fileNames.isEmpty())
+    {
+        displayErrorMessage("No raw files found");
+        return;
+    }
+    fileNames.sort();
+    QString cacheName = ageingDirectory.filePath(AGEING_CACHE_FILE);
+    QHash<QString,FileAgeing> cache = readAgeingCache(cacheName);
+    statistics.begin("ageing");
+    QList<FileAgeing> results;
+    QList<AgeingJob> jobs;
+    for (int n=0; n<fileNames.size(); n++)
+    {
+        QFileInfo rawFileInfo(fileNames[n]);
+        QString fileName = rawFileInfo.absoluteFilePath();
+        if (cache.contains(fileName)
+            && (cache[fileName].size == rawFileInfo.size())
+            && (cache[fileName].modified == rawFileInfo.lastModified()))
+        {
+            results << cache.take(fileName);
+            continue;
+        }
+        AgeingJob job;
+        job.fileName = fileName;
+        job.statistics = &statistics;
+        jobs << job;
+    }
+    results << QtConcurrent::blockingMapped<QList<FileAgeing> >(jobs,ageingFile);
+    QStringList failedFiles;
+    for (int n=0; n<results.size(); n++)
+        if (results[n].failed) failedFiles << results[n].fileName;
+// Files in the cache that were not selected this time are kept.
+    QList<FileAgeing> cached = results;
+    cached << cache.values();
+    if (! writeAgeingCache(cacheName,cached))
+        displayErrorMessage("Could not write the ageing cache");
+    QDateTime local(QDateTime::currentDateTime());
+    QString localTimeDate = local.toTimeSpec(Qt::LocalTime)
+                                 .toString("yyyyMMddhhmmss");
+    QString reportFilename = ageingDirectory
+                    .filePath(QString("ageing-%1.csv").arg(localTimeDate));
+    QFile reportFile(reportFilename);
+    if (! reportFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        displayErrorMessage("Could not open the output file");
+        statistics.end();
+        return;
+    }
+    QTextStream outStream(&reportFile);
+    writeAgeingReport(outStream,results);
+    reportFile.close();
+    statusBar()->showMessage(QString("%1 (%2 of %3 files read)")
+                    .arg(statistics.end()).arg(jobs.size()).arg(fileNames.size()));
+    if (! failedFiles.isEmpty())
+        displayErrorMessage(QString("Could not read %1")
+                            .arg(failedFiles.join(", ")));
+}
+
 //-----------------------------------------------------------------------------
 /** @brief Extract and Combine Raw Records to CSV.
 
 Raw records are combined into single records for each time interval, and written
 to a csv file. Format suitable for spreadsheet analysis.
 
+Only the file chunks covering the time range are processed, in parallel. The
+state carried into each chunk is rebuilt from the scan results.
+
 @param[in] QDateTime start time.
 @param[in] QDateTime end time.
 @param[in] QFile* input file.
@@ -1320,307 +1534,61 @@ to a csv file. Format suitable for spreadsheet analysis.
 bool DataProcessingGui::combineRecords(QDateTime startTime, QDateTime endTime,
                                        QFile* inFile, QFile* outFile,bool header)
 {
-    int battery1Voltage = -1;
-    int battery1Current = 0;
-    int battery1SoC = -1;
-    QString battery1StateText;
-    QString battery1FillText;
-    QString battery1ChargeText;
-    int battery2Voltage = -1;
-    int battery2Current = 0;
-    int battery2SoC = -1;
-    QString battery2StateText;
-    QString battery2FillText;
-    QString battery2ChargeText;
-    int battery3Voltage = -1;
-    int battery3Current = 0;
-    int battery3SoC = -1;
-    QString battery3StateText;
-    QString battery3FillText;
-    QString battery3ChargeText;
-    int load1Voltage = -1;
-    int load1Current = 0;
-    int load2Voltage = -1;
-    int load2Current = 0;
-    int panel1Voltage = -1;
-    int panel1Current = 0;
-    int temperature = -1;
-    QString controls = "     ";
-    QString switches;
-    QString decision;
-    QString indicatorString;
-    int debug1a = -1;
-    int debug2a = -1;
-    int debug3a = -1;
-    int debug1b = -1;
-    int debug2b = -1;
-    int debug3b = -1;
-    bool blockStart = false;
-    QTextStream inStream(inFile);
     QTextStream outStream(outFile);
-    if (header)
-    {
-        outStream << "Time,";
-        outStream << "B1 I," << "B1 V," << "B1 Cap," << "B1 Op," << "B1 State," << "B1 Charge,";
-        outStream << "B2 I," << "B2 V," << "B2 Cap," << "B2 Op," << "B2 State," << "B2 Charge,";
-        outStream << "B3 I," << "B3 V," << "B3 Cap," << "B3 Op," << "B3 State," << "B3 Charge,";
-        outStream << "L1 I," << "L1 V," << "L2 I," << "L2 V," << "M1 I," << "M1 V,";
-        outStream << "Temp," << "Controls," << "Switches," << "Decisions," << "Indicators,";
-        outStream << "Debug 1a," << "Debug 1b," << "Debug 2a," << "Debug 2b," << "Debug 3a," << "Debug 3b";
-        outStream << "\n\r";
-    }
-    QDateTime time = startTime;
-    while (! inStream.atEnd())
+    statistics.begin("combine");
+    if (header) CombineState::writeHeader(outStream);
+    long long currentZero[3] = {battery1CurrentZero, battery2CurrentZero,
+                                battery3CurrentZero};
+// Select the chunks covering the time range and build the state at the start of
+// each from the records carried over from all previous chunks.
+    QList<CombineJob> jobs;
+    CombineState state;
+    bool eof = true;
+    for (int n=0; n<rawChunks.size(); n++)
     {
-        if  (time > endTime) break;
-      	QString lineIn = inStream.readLine();
-        QStringList breakdown = lineIn.split(",");
-        int size = breakdown.size();
-        if (size <= 0) break;
-        QString firstText = breakdown[0].simplified();
-        QString secondText;
-        QString thirdText;
-        int secondField = -1;
-        if (size > 1)
+        const RawChunk& chunk = rawChunks[n];
+        QDateTime nextTime;
+        if (n < rawChunks.size()-1) nextTime = rawChunks[n+1].firstTime;
+        bool before = (! chunk.maxTime.isValid() || (chunk.maxTime <= startTime))
+                   && (! nextTime.isValid() || (nextTime <= startTime));
+        if (! before)
         {
-            secondText = breakdown[1].simplified();
-            secondField = secondText.toInt();
+            CombineJob job;
+            job.fileName = inFile->fileName();
+            job.statistics = &statistics;
+            job.chunk = chunk;
+            job.initial = state;
+            job.nextTime = nextTime;
+            job.startTime = startTime;
+            job.endTime = endTime;
+            for (int i=0; i<3; i++) job.currentZero[i] = currentZero[i];
+            jobs << job;
         }
-        int thirdField = -1;
-        if (size > 2)
+        if (chunk.maxTime.isValid() && (chunk.maxTime > endTime))
         {
-            thirdText = breakdown[2].simplified();
-            thirdField = thirdText.toInt();
-        }
-        if (size > 1)
-        {
-// Find and extract the time record
-            if (firstText == "pH")
-            {
-                time = QDateTime::fromString(breakdown[1].simplified(),Qt::ISODate);
-                if ((blockStart) && (time > startTime))
-                {
-                    outStream << timeRecord << ",";
-                    outStream << (float)battery1Current/256 << ",";
-                    outStream << (float)battery1Voltage/256 << ",";
-                    outStream << (float)battery1SoC/256 << ",";
-                    outStream << battery1StateText << ",";
-                    outStream << battery1FillText << ",";
-                    outStream << battery1ChargeText << ",";
-                    outStream << (float)battery2Current/256 << ",";
-                    outStream << (float)battery2Voltage/256 << ",";
-                    outStream << (float)battery2SoC/256 << ",";
-                    outStream << battery2StateText << ",";
-                    outStream << battery2FillText << ",";
-                    outStream << battery2ChargeText << ",";
-                    outStream << (float)battery3Current/256 << ",";
-                    outStream << (float)battery3Voltage/256 << ",";
-                    outStream << (float)battery3SoC/256 << ",";
-                    outStream << battery3StateText << ",";
-                    outStream << battery3FillText << ",";
-                    outStream << battery3ChargeText << ",";
-                    outStream << (float)load1Voltage/256 << ",";
-                    outStream << (float)load1Current/256 << ",";
-                    outStream << (float)load2Voltage/256 << ",";
-                    outStream << (float)load2Current/256 << ",";
-                    outStream << (float)panel1Voltage/256 << ",";
-                    outStream << (float)panel1Current/256 << ",";
-                    outStream << (float)temperature/256 << ",";
-                    outStream << controls << ",";
-                    outStream << switches << ",";
-                    outStream << decision << ",";
-                    outStream << indicatorString << ",";
-                    outStream << debug1a << ",";
-                    outStream << debug1b << ",";
-                    outStream << debug2a << ",";
-                    outStream << debug2b << ",";
-                    outStream << debug3a << ",";
-                    outStream << debug3b;
-                    outStream << "\n\r";
-                }
-                timeRecord = breakdown[1].simplified();
-                blockStart = true;
-            }
-            if (firstText == "dB1")
-            {
-                battery1Current = secondField-battery1CurrentZero;
-                battery1Voltage = thirdField;
-            }
-            if (firstText == "dB2")
-            {
-                battery2Current = secondField-battery2CurrentZero;
-                battery2Voltage = thirdField;
-            }
-            if (firstText == "dB3")
-            {
-                battery3Current = secondField-battery3CurrentZero;
-                battery3Voltage = thirdField;
-            }
-            if (firstText == "dC1")
-            {
-                battery1SoC = secondField;
-            }
-            if (firstText == "dC2")
-            {
-                battery2SoC = secondField;
-            }
-            if (firstText == "dC3")
-            {
-                battery3SoC = secondField;
-            }
-            if (firstText == "dO1")
-            {
-                uint battery1State = (secondField & 0x03);
-                if (battery1State == 0) battery1StateText = "Loaded";
-                else if (battery1State == 1) battery1StateText = "Charge";
-                else if (battery1State == 2) battery1StateText = "Isolate";
-                else if (battery1State == 3) battery1StateText = "Missing";
-                else battery1StateText = "?";
-                uint battery1Fill = (secondField >> 2) & 0x03;
-                if (battery1Fill == 0) battery1FillText = "Normal";
-                else if (battery1Fill == 1) battery1FillText = "Low";
-                else if (battery1Fill == 2) battery1FillText = "Critical";
-                else if (battery1Fill == 3) battery1FillText = "Faulty";
-                else battery1FillText = "?";
-                uint battery1Charge = (secondField >> 4) & 0x03;
-                if (battery1Charge == 0) battery1ChargeText = "Bulk";
-                else if (battery1Charge == 1) battery1ChargeText = "Absorp";
-                else if (battery1Charge == 2) battery1ChargeText = "Float";
-                else if (battery1Charge == 3) battery1ChargeText = "Rest";
-                else battery1ChargeText = "?";
-            }
-            if (firstText == "dO2")
-            {
-                uint battery2State = (secondField & 0x03);
-                if (battery2State == 0) battery2StateText = "Loaded";
-                else if (battery2State == 1) battery2StateText = "Charge";
-                else if (battery2State == 2) battery2StateText = "Isolate";
-                else if (battery2State == 3) battery2StateText = "Missing";
-                else battery2StateText = "?";
-                uint battery2Fill = (secondField >> 2) & 0x03;
-                if (battery2Fill == 0) battery2FillText = "Normal";
-                else if (battery2Fill == 1) battery2FillText = "Low";
-                else if (battery2Fill == 2) battery2FillText = "Critical";
-                else if (battery2Fill == 3) battery2FillText = "Faulty";
-                else battery2FillText = "?";
-                uint battery2Charge = (secondField >> 4) & 0x03;
-                if (battery2Charge == 0) battery2ChargeText = "Bulk";
-                else if (battery2Charge == 1) battery2ChargeText = "Absorp";
-                else if (battery2Charge == 2) battery2ChargeText = "Float";
-                else if (battery2Charge == 3) battery2ChargeText = "Rest";
-                else battery2ChargeText = "?";
-            }
-            if (firstText == "dO3")
-            {
-                uint battery3State = (secondField & 0x03);
-                if (battery3State == 0) battery3StateText = "Loaded";
-                else if (battery3State == 1) battery3StateText = "Charge";
-                else if (battery3State == 2) battery3StateText = "Isolate";
-                else if (battery3State == 3) battery3StateText = "Missing";
-                else battery3StateText = "?";
-                uint battery3Fill = (secondField >> 2) & 0x03;
-                if (battery3Fill == 0) battery3FillText = "Normal";
-                else if (battery3Fill == 1) battery3FillText = "Low";
-                else if (battery3Fill == 2) battery3FillText = "Critical";
-                else if (battery3Fill == 3) battery3FillText = "Faulty";
-                else battery3FillText = "?";
-                uint battery3Charge = (secondField >> 4) & 0x03;
-                if (battery3Charge == 0) battery3ChargeText = "Bulk";
-                else if (battery3Charge == 1) battery3ChargeText = "Absorp";
-                else if (battery3Charge == 2) battery3ChargeText = "Float";
-                else if (battery3Charge == 3) battery3ChargeText = "Rest";
-                else battery3ChargeText = "?";
-            }
-            if (firstText == "dL1")
-            {
-                load1Voltage = secondField;
-                load1Current = thirdField;
-            }
-            if (firstText == "dL2")
-            {
-                load2Voltage = secondField;
-                load2Current = thirdField;
-            }
-            if (firstText == "dM1")
-            {
-                panel1Voltage = secondField;
-                panel1Current = thirdField;
-            }
-            if (firstText == "dT")
-            {
-                temperature = secondField;
-            }
-// A = autotrack, R = recording, M = send measurements,
-// D = debug, Charger algorithm, X = load avoidance, I = maintain isolation
-            if (firstText == "dD")
-            {
-                if ((secondField & (1 << 0)) > 0) controls[0] = 'A';
-                if ((secondField & (1 << 1)) > 0) controls[1] = 'R';
-                if ((secondField & (1 << 3)) > 0) controls[2] = 'M';
-                if ((secondField & (1 << 4)) > 0) controls[3] = 'D';
-                if (((secondField >> 5) & 3) == 0) controls[4] = '1';
-                if (((secondField >> 5) & 3) == 1) controls[4] = '2';
-                if (((secondField >> 5) & 3) == 2) controls[4] = '3';
-                if ((secondField & (1 << 7)) > 0) controls[5] = 'X';
-                if ((secondField & (1 << 8)) > 0) controls[6] = 'I';
-            }
-// Switch control bits - three 2-bit fields: battery number for each of
-// load1, load2 and panel.
-            if (firstText == "ds")
-            {
-                switches.clear();
-                uint load1Battery = (secondField >> 0) & 0x03;
-                QString load1BatteryText;
-                load1BatteryText.setNum(load1Battery);
-                if (load1Battery > 0) switches.append(" ").append(load1BatteryText);
-                else switches.append(" 0");
-                uint load2Battery = (secondField >> 2) & 0x03;
-                QString load2BatteryText;
-                load2BatteryText.setNum(load2Battery);
-                if (load2Battery > 0) switches.append(" ").append(load2BatteryText);
-                else switches.append(" 0");
-                uint panelBattery = (secondField >> 4) & 0x03;
-                QString panelBatteryText;
-                panelBatteryText.setNum(panelBattery);
-                if (panelBattery > 0) switches.append(" ").append(panelBatteryText);
-                else switches.append(" 0");
-            }
-            if (firstText == "dd")
-            {
-                bool ok;
-                decision = QString("%1").arg(secondText.toInt(&ok),0,16);
-            }
-            if (firstText == "dI")
-            {
-                bool ok;
-                indicatorString = "";
-                int indicators = secondText.toInt(&ok);
-                for (int i=0; i<12; i+=2)
-                {
-                    if ((indicators & (1 << i)) > 0) indicatorString.append("_");
-                    else indicatorString.append("O");
-                    if ((indicators & (1 << (i+1))) > 0) indicatorString.append("_");
-                    else indicatorString.append("U");
-                }
-            }
-            if (firstText == "D1")
-            {
-                debug1a = secondField;
-                if (size > 2) debug1b = thirdField;
-            }
-            if (firstText == "D2")
-            {
-                debug2a = secondField;
-                if (size > 2) debug2b = thirdField;
-            }
-            if (firstText == "D3")
-            {
-                debug3a = secondField;
-                if (size > 2) debug3b = thirdField;
-            }
+            eof = false;
+            break;
         }
+        state.apply(chunk,currentZero);
+    }
+// Chunks are combined in waves to limit the text held in memory, and written in
+// file order.
+    int wave = QThread::idealThreadCount();
+    if (wave < 1) wave = 1;
+    StageCounters writeCounters;
+    qint64 writeStart = statistics.now();
+    for (int n=0; n<jobs.size(); n+=wave)
+    {
+        QList<QString> records = QtConcurrent::blockingMapped<QList<QString> >
+                                    (jobs.mid(n,wave),combineChunk);
+        StageClock stageClock(&writeCounters);
+        for (int i=0; i<records.size(); i++) outStream << records[i];
+        outStream.flush();
+        stageClock.lap(stageWrite);
     }
-    return inStream.atEnd();
+    statistics.merge(writeCounters,"combine write",writeStart);
+    statusBar()->showMessage(statistics.end());
+    return eof;
 }
 
 //-----------------------------------------------------------------------------
@@ -1694,92 +1662,62 @@ bool DataProcessingGui::openSaveFile()
 Look for start and end times and record types. Obtain the current zeros from
 records that have isolated operational status.
 
+The file is split into chunks on time record boundaries which are scanned in
+parallel. The chunks are kept for the energy and combine passes.
+
 */
 
 void DataProcessingGui::scanFile(QFile* inFile)
 {
     if (! inFile->isOpen()) return;
-    QTextStream inStream(inFile);
+    statistics.begin("scan");
+    QList<ScanJob> jobs;
+    QList<RawChunk> chunks = splitRawFile(inFile->fileName());
+    for (int n=0; n<chunks.size(); n++)
+    {
+        ScanJob job;
+        job.fileName = inFile->fileName();
+        job.statistics = &statistics;
+        job.chunk = chunks[n];
+        jobs << job;
+    }
+    rawChunks = QtConcurrent::blockingMapped<QList<RawChunk> >(jobs,scanChunk);
+// Stitch the partial results together in file order. Calibration points found
+// before a battery current in a chunk use the current from earlier chunks.
     QDateTime startTime, endTime;
-    uint calibration1Count = 0;
-    uint calibration2Count = 0;
-    uint calibration3Count = 0;
-    int battery1Current = 0;
-    int battery2Current = 0;
-    int battery3Current = 0;
-    battery1CurrentZero = 0;
-    battery2CurrentZero = 0;
-    battery3CurrentZero = 0;
-    while (! inStream.atEnd())
+    long long calibrationSum[3] = {0, 0, 0};
+    uint calibrationCount[3] = {0, 0, 0};
+    int batteryCurrent[3] = {0, 0, 0};
+    for (int n=0; n<rawChunks.size(); n++)
     {
-      	QString lineIn = inStream.readLine();
-        QStringList breakdown = lineIn.split(",");
-        int length = breakdown.size();
-        if (length <= 0) break;
-        QString firstText = breakdown[0].simplified();
-        QString secondText = breakdown[1].simplified();
-        if ((firstText == "pH") && (length > 1))
-        {
-            QDateTime time = QDateTime::fromString(secondText,Qt::ISODate);
-            if (startTime.isNull()) startTime = time;
-            endTime = time;
-        }
-        int secondField = secondText.toInt();
-        if ((firstText == "dB1") && (length > 1))
-        {
-            battery1Current = secondField;
-        }
-        if ((firstText == "dB2") && (length > 1))
-        {
-            battery2Current = secondField;
-        }
-        if ((firstText == "dB3") && (length > 1))
-        {
-            battery3Current = secondField;
-        }
-        if ((firstText == "dO1") && (length > 1))
-        {
-            int operationalStatus = secondField&0x03;
-            if (operationalStatus == 2)
-            {
-                calibration1Count++;
-                battery1CurrentZero += battery1Current;
-            }
-        }
-        if ((firstText == "dO2") && (length > 1))
-        {
-            int operationalStatus = secondField&0x03;
-            if (operationalStatus == 2)
-            {
-                calibration2Count++;
-                battery2CurrentZero += battery2Current;
-            }
-        }
-        if ((firstText == "dO3") && (length > 1))
+        const RawChunk& chunk = rawChunks[n];
+        if (startTime.isNull() && chunk.firstTime.isValid())
+            startTime = chunk.firstTime;
+        if (chunk.lastTime.isValid()) endTime = chunk.lastTime;
+        for (int i=0; i<3; i++)
         {
-            int operationalStatus = secondField&0x03;
-            if (operationalStatus == 2)
-            {
-                calibration3Count++;
-                battery3CurrentZero += battery3Current;
-            }
+            calibrationSum[i] += chunk.calibrationSum[i]
+                                + chunk.pendingCount[i]*batteryCurrent[i];
+            calibrationCount[i] += chunk.calibrationCount[i];
+            if (chunk.currentSeen[i]) batteryCurrent[i] = chunk.lastCurrent[i];
         }
     }
 // Remove the zero point of current if required
+    battery1CurrentZero = 0;
+    battery2CurrentZero = 0;
+    battery3CurrentZero = 0;
     if (DataProcessingMainUi.zeroCurrentCheckBox->isChecked())  
     {
-        battery1CurrentZero /= calibration1Count;
-        battery2CurrentZero /= calibration2Count;
-        battery3CurrentZero /= calibration3Count;
-    }
-    else
-    {
-        battery1CurrentZero = 0;
-        battery2CurrentZero = 0;
-        battery3CurrentZero = 0;
+        if (calibrationCount[0] > 0)
+            battery1CurrentZero = calibrationSum[0]/calibrationCount[0];
+        if (calibrationCount[1] > 0)
+            battery2CurrentZero = calibrationSum[1]/calibrationCount[1];
+        if (calibrationCount[2] > 0)
+            battery3CurrentZero = calibrationSum[2]/calibrationCount[2];
     }
     if (! startTime.isNull()) DataProcessingMainUi.startTime->setDateTime(startTime);
     if (! endTime.isNull()) DataProcessingMainUi.endTime->setDateTime(endTime);
+    statusBar()->showMessage(statistics.end());
 }
 
 //-----------------------------------------------------------------------------
@@ -43,13 +43,22 @@
 #define Vscale (1+R4/R5)/(1+R9/R7)
 
 #define LINE_WIDTH 36
+// Number of buckets drawn for each overlay series
+#define OVERLAY_POINTS 2000
 
 #include "ui_data-processing-main.h"
+#include "data-processing-plot-cache.h"
+#include "data-processing-energy-model.h"
+#include "data-processing-chunk.h"
+#include "data-processing-stats.h"
+#include "data-processing-ageing.h"
 #include <QDialog>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 
+class QwtPlot;
+
 typedef enum {battery1UnderVoltage, battery2UnderVoltage, battery3UnderVoltage, 
               battery1OverCurrent, battery2OverCurrent, battery3OverCurrent,
               load1UnderVoltage, load2UnderVoltage, panelUnderVoltage, 
@@ -70,6 +79,7 @@ public:
     DataProcessingGui();
     ~DataProcessingGui();
     bool success();
+    void setTraceFile(QString fileName);
 private slots:
     void on_openReadFileButton_clicked();
     void on_dumpAllButton_clicked();
@@ -79,12 +89,15 @@ private slots:
     void on_extractButton_clicked();
     void on_voltagePlotCheckBox_clicked();
     void on_plotFileSelectButton_clicked();
+    void on_overlayFileSelectButton_clicked();
+    void on_overlayClearButton_clicked();
     void on_temperaturePlotCheckbox_clicked();
     void on_battery1Checkbox_clicked();
     void on_battery2Checkbox_clicked();
     void on_battery3Checkbox_clicked();
     void on_statesPlotCheckbox_clicked();
     void on_analysisFileSelectButton_clicked();
+    void on_ageingFileSelectButton_clicked();
 private:
 // User Interface object instance
     Ui::DataProcessingMainWindow DataProcessingMainUi;
@@ -107,9 +120,18 @@ private:
     long long battery1CurrentZero;
     long long battery2CurrentZero;
     long long battery3CurrentZero;
-// Record information
-    QString timeRecord;
-    int tableRow;
+// Chunks of the raw file found by the scan
+    QList<RawChunk> rawChunks;
+// Timing and counters for each pass
+    PassStatistics statistics;
+    EnergyTableModel* energyModel;
+// Overlay plots
+    PlotCache plotCache;
+    QwtPlot* overlayPlot;
+    int overlayCount;
+    double overlayReference;    // Midnight that days are aligned to
+    bool overlayAligned;        // Reference set for the curves now drawn
+    bool overlayTimeOfDay;      // Alignment of the curves now drawn
 };
 
 #endif
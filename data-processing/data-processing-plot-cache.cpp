@@ -0,0 +1,284 @@
+/**
+@mainpage Power Management Data Processing Plot Cache
+@version 1.0
+@author Ken Sarkies (www.jiggerjuice.net)
+@date 16 October 2026
+
+Holds decimated series from combined CSV files for overlay plots.
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@trinity.asn.au                                                *
+ *                                                                          *
+ *   This file is part of Power Management                                  *
+ *                                                                          *
+ *   Power Management is free software; you can redistribute it and/or      *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management is distributed in the hope that it will be useful,    *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management if not, write to the                       *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+#include "data-processing-plot-cache.h"
+#include "data-processing-main.h"
+#include "data-processing-stats.h"
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+#include <QDateTime>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+/** Plot Cache Constructor
+*/
+
+PlotCache::PlotCache()
+{
+}
+
+PlotCache::~PlotCache()
+{
+    clear();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Load columns of a combined file into the cache.
+
+Only the columns not already cached for the file are read. If all are present
+the file is not touched. The time index is built on the first read and follows
+the plot convention of adding 500ms when a timestamp repeats.
+
+@param[in] fileName: name of the combined CSV file.
+@param[in] columns: list of column indices into the combined record.
+@param[in] statistics: timing and counters for the read.
+@returns true if the file could be read.
+*/
+
+bool PlotCache::load(QString fileName, const QList<int>& columns,
+                     PassStatistics* statistics)
+{
+    CachedFile* file = files.value(fileName, NULL);
+    QList<int> missing;
+    for (int n = 0; n < columns.size(); n++)
+    {
+        int column = columns[n];
+        if ((column < 1) || (column >= LINE_WIDTH)) continue;
+        if ((file == NULL) || ! file->pyramids.contains(column))
+            if (! missing.contains(column)) missing << column;
+    }
+    if (missing.isEmpty()) return (file != NULL);
+
+    QFile inFile(fileName);
+    if (! inFile.open(QIODevice::ReadOnly)) return false;
+    QTextStream inStream(&inFile);
+    bool newFile = (file == NULL);
+    if (newFile) file = new CachedFile;
+    QVector<QVector<float> > data(missing.size());
+    double index = 0;
+    QDateTime previousTime;
+    statistics->begin("overlay load");
+    StageCounters counters;
+    StageClock stageClock(&counters);
+    qint64 start = statistics->now();
+// Skip first line as it may be a header
+    QString lineIn = inStream.readLine();
+    while (! inStream.atEnd())
+    {
+        stageClock.lap(stageFormat);
+        lineIn = inStream.readLine();
+        counters.lines++;
+        stageClock.lap(stageRead);
+        QStringList breakdown = lineIn.split(",");
+        stageClock.lap(stageSplit);
+        if (breakdown.size() != LINE_WIDTH)
+        {
+            counters.malformed++;
+            continue;
+        }
+        QDateTime time = QDateTime::fromString(breakdown[0].simplified(),Qt::ISODate);
+        stageClock.lap(stageTime);
+        if (! time.isValid())
+        {
+            counters.malformed++;
+            continue;
+        }
+        if (newFile)
+        {
+            if (previousTime.isValid() && (previousTime == time)) index += 500;
+            else index = time.toMSecsSinceEpoch();
+            previousTime = time;
+            file->time.append(index);
+        }
+        for (int n = 0; n < missing.size(); n++)
+            data[n].append(columnValue(breakdown[missing[n]]));
+    }
+    counters.bytes = inFile.pos();
+    inFile.close();
+    for (int n = 0; n < missing.size(); n++)
+        buildPyramid(file, missing[n], data[n]);
+    statistics->merge(counters,"overlay load",start);
+    statistics->end();
+    if (newFile) files.insert(fileName, file);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Check if a file has been cached.
+*/
+
+bool PlotCache::contains(QString fileName) const
+{
+    return files.contains(fileName);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief First time index of a cached file in ms since epoch.
+*/
+
+double PlotCache::startTime(QString fileName) const
+{
+    CachedFile* file = files.value(fileName, NULL);
+    if ((file == NULL) || file->time.isEmpty()) return 0;
+    return file->time.first();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Last time index of a cached file in ms since epoch.
+*/
+
+double PlotCache::endTime(QString fileName) const
+{
+    CachedFile* file = files.value(fileName, NULL);
+    if ((file == NULL) || file->time.isEmpty()) return 0;
+    return file->time.last();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Extract plot points for a time range of a cached column.
+
+The finest pyramid level having no more than maxPoints buckets in the range is
+used. Decimated levels give the minimum and maximum of each bucket so that short
+peaks remain visible in the plot.
+
+@param[in] fileName: name of a cached file.
+@param[in] column: cached column index.
+@param[in] start: start of range in ms since epoch.
+@param[in] end: end of range (exclusive) in ms since epoch.
+@param[in] offset: value added to each time to align the series.
+@param[in] maxPoints: number of buckets that can be shown.
+@returns points ready for a plot curve, empty if the column is not cached.
+*/
+
+QPolygonF PlotCache::points(QString fileName, int column, double start,
+                            double end, double offset, int maxPoints) const
+{
+    QPolygonF result;
+    CachedFile* file = files.value(fileName, NULL);
+    if ((file == NULL) || ! file->pyramids.contains(column)) return result;
+    const QVector<PyramidLevel>& levels = file->pyramids[column];
+    for (int level = 0; level < levels.size(); level++)
+    {
+        const PyramidLevel& data = levels[level];
+        int first = std::lower_bound(data.time.begin(), data.time.end(), start)
+                    - data.time.begin();
+        int last = std::lower_bound(data.time.begin(), data.time.end(), end)
+                    - data.time.begin();
+        if (((last - first) > maxPoints) && (level < levels.size()-1)) continue;
+        if (level == 0)
+        {
+            for (int i = first; i < last; i++)
+                result << QPointF(data.time[i]+offset,data.minimum[i]);
+        }
+        else
+        {
+            for (int i = first; i < last; i++)
+            {
+                result << QPointF(data.time[i]+offset,data.minimum[i]);
+                result << QPointF(data.time[i]+offset,data.maximum[i]);
+            }
+        }
+        break;
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Remove all files from the cache.
+*/
+
+void PlotCache::clear()
+{
+    qDeleteAll(files);
+    files.clear();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Convert a field of the combined record to a plottable value.
+
+Charging mode text is converted to the same scale as the states plot.
+*/
+
+float PlotCache::columnValue(QString field) const
+{
+    QString text = field.simplified();
+    bool ok;
+    float value = text.toFloat(&ok);
+    if (ok) return value;
+    if (text == "Isolate") return 5;
+    if (text == "Charge") return 10;
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Build the decimation pyramid for a column.
+
+Level 0 is the raw data. Each higher level holds the minimum and maximum over
+PYRAMID_FACTOR buckets of the level below, timed at the first bucket.
+*/
+
+void PlotCache::buildPyramid(CachedFile* file, int column,
+                             const QVector<float>& data)
+{
+    QVector<PyramidLevel> levels;
+    PyramidLevel raw;
+    raw.time = file->time;
+    raw.minimum = data;
+// Implicitly shared so no extra storage is used for the raw level.
+    raw.maximum = data;
+    levels.append(raw);
+    while (levels.last().time.size() >= PYRAMID_MIN_POINTS)
+    {
+        const PyramidLevel& below = levels.last();
+        PyramidLevel above;
+        int size = below.time.size();
+        int buckets = (size + PYRAMID_FACTOR - 1)/PYRAMID_FACTOR;
+        above.time.reserve(buckets);
+        above.minimum.reserve(buckets);
+        above.maximum.reserve(buckets);
+        for (int i = 0; i < size; i += PYRAMID_FACTOR)
+        {
+            float minimum = below.minimum[i];
+            float maximum = below.maximum[i];
+            for (int j = i+1; (j < i+PYRAMID_FACTOR) && (j < size); j++)
+            {
+                if (below.minimum[j] < minimum) minimum = below.minimum[j];
+                if (below.maximum[j] > maximum) maximum = below.maximum[j];
+            }
+            above.time.append(below.time[i]);
+            above.minimum.append(minimum);
+            above.maximum.append(maximum);
+        }
+        levels.append(above);
+    }
+    file->pyramids.insert(column, levels);
+}
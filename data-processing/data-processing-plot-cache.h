@@ -0,0 +1,86 @@
+/**
+@mainpage Power Management Data Processing Plot Cache
+@version 1.0
+@author Ken Sarkies (www.jiggerjuice.net)
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@trinity.asn.au                                                *
+ *                                                                          *
+ *   This file is part of Power Management                                  *
+ *                                                                          *
+ *   Power Management is free software; you can redistribute it and/or      *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management is distributed in the hope that it will be useful,    *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management if not, write to the                       *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+#ifndef DATA_PROCESSING_PLOT_CACHE_H
+#define DATA_PROCESSING_PLOT_CACHE_H
+
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QPolygonF>
+
+class PassStatistics;
+
+// Number of samples merged into one bucket at each level of the pyramid
+#define PYRAMID_FACTOR 4
+// Stop building levels when a level has fewer points than this
+#define PYRAMID_MIN_POINTS 256
+
+//-----------------------------------------------------------------------------
+/** @brief Cache of decimated data series from combined CSV files.
+
+Each combined file is read once. Each requested column is held as a pyramid of
+min/max levels, each level PYRAMID_FACTOR times coarser than the one below. A
+series is drawn from the finest level that fits the requested number of points,
+so plotting any number of overlays does not reread or re-decimate a file that is
+already in the cache.
+*/
+
+class PlotCache
+{
+public:
+    PlotCache();
+    ~PlotCache();
+    bool load(QString fileName, const QList<int>& columns,
+              PassStatistics* statistics);
+    bool contains(QString fileName) const;
+    double startTime(QString fileName) const;
+    double endTime(QString fileName) const;
+    QPolygonF points(QString fileName, int column, double start, double end,
+                     double offset, int maxPoints) const;
+    void clear();
+private:
+    struct PyramidLevel
+    {
+        QVector<double> time;
+        QVector<float> minimum;
+        QVector<float> maximum;
+    };
+    struct CachedFile
+    {
+        QVector<double> time;
+        QHash<int, QVector<PyramidLevel> > pyramids;
+    };
+    QHash<QString, CachedFile*> files;
+    float columnValue(QString field) const;
+    void buildPyramid(CachedFile* file, int column, const QVector<float>& data);
+};
+
+#endif
@@ -0,0 +1,229 @@
+/**
+@mainpage Power Management Data Processing Pass Statistics
+@version 1.0
+@author Ken Sarkies (www.jiggerjuice.net)
+@date 16 October 2026
+
+Instrumentation of the data processing passes.
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@trinity.asn.au                                                *
+ *                                                                          *
+ *   This file is part of Power Management                                  *
+ *                                                                          *
+ *   Power Management is free software; you can redistribute it and/or      *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management is distributed in the hope that it will be useful,    *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management if not, write to the                       *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+#include "data-processing-stats.h"
+#include <QFile>
+#include <QTextStream>
+#include <QThread>
+#include <QMutexLocker>
+#include <cstdio>
+
+//-----------------------------------------------------------------------------
+/** Stage Counters Constructor
+*/
+
+StageCounters::StageCounters()
+{
+    bytes = 0;
+    lines = 0;
+    malformed = 0;
+    for (int n=0; n<numberStages; n++) stageTime[n] = 0;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Add counters from another thread or chunk.
+*/
+
+void StageCounters::add(const StageCounters& other)
+{
+    bytes += other.bytes;
+    lines += other.lines;
+    malformed += other.malformed;
+    QHash<QString,qint64>::const_iterator record;
+    for (record = other.records.constBegin();
+         record != other.records.constEnd(); ++record)
+        records[record.key()] += record.value();
+    for (int n=0; n<numberStages; n++) stageTime[n] += other.stageTime[n];
+}
+
+//-----------------------------------------------------------------------------
+/** Stage Clock Constructor
+
+@param[in] stageCounters: counters to which stage times are added.
+*/
+
+StageClock::StageClock(StageCounters* stageCounters)
+{
+    counters = stageCounters;
+    timer.start();
+    last = 0;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Add the time since the last lap to a stage.
+*/
+
+void StageClock::lap(PassStage stage)
+{
+    qint64 time = timer.nsecsElapsed();
+    counters->stageTime[stage] += time - last;
+    last = time;
+}
+
+//-----------------------------------------------------------------------------
+/** Pass Statistics Constructor
+*/
+
+PassStatistics::PassStatistics()
+{
+    clock.start();
+    passStart = 0;
+    chunks = 0;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the file to receive a Chrome trace.
+
+@param[in] fileName: JSON trace file name, empty to disable tracing.
+*/
+
+void PassStatistics::setTraceFile(QString fileName)
+{
+    traceFile = fileName;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Start a pass.
+
+@param[in] name: name of the pass used in the summary and trace.
+*/
+
+void PassStatistics::begin(QString name)
+{
+    QMutexLocker locker(&mutex);
+    passName = name;
+    passStart = now();
+    chunks = 0;
+    total = StageCounters();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Merge counters from a worker. Thread safe.
+
+@param[in] counters: counters collected by the worker.
+@param[in] eventName: name for the trace event.
+@param[in] start: start time of the work in microseconds from now().
+*/
+
+void PassStatistics::merge(const StageCounters& counters, QString eventName,
+                           qint64 start)
+{
+    qint64 duration = now() - start;
+    QMutexLocker locker(&mutex);
+    total.add(counters);
+    chunks++;
+    addTraceEvent(eventName,start,duration,counters);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief End a pass.
+
+The summary is printed to stdout and the trace file is rewritten.
+
+@returns a one line summary suitable for the status bar.
+*/
+
+QString PassStatistics::end()
+{
+    QMutexLocker locker(&mutex);
+    qint64 duration = now() - passStart;
+    addTraceEvent(passName,passStart,duration,total);
+    double seconds = (double)duration/1000000;
+    double rate = 0;
+    if (seconds > 0) rate = (double)total.bytes/1048576/seconds;
+    QString summary = QString("%1: %2 ms, %3 bytes (%4 MB/s), %5 lines, %6 malformed")
+                        .arg(passName).arg((double)duration/1000,0,'f',1)
+                        .arg(total.bytes).arg(rate,0,'f',1)
+                        .arg(total.lines).arg(total.malformed);
+    QString report = summary;
+    const char* stageNames[numberStages] = {"read", "split", "time", "format",
+                                            "write"};
+    report.append(QString("\n  thread time (%1 chunks):").arg(chunks));
+    for (int n=0; n<numberStages; n++)
+        report.append(QString(" %1 %2 ms").arg(stageNames[n])
+                        .arg((double)total.stageTime[n]/1000000,0,'f',1));
+    if (! total.records.isEmpty())
+    {
+        report.append("\n  records:");
+        QStringList types = total.records.keys();
+        types.sort();
+        for (int n=0; n<types.size(); n++)
+            report.append(QString(" %1 %2").arg(types[n])
+                            .arg(total.records.value(types[n])));
+    }
+    fprintf(stdout,"%s\n",report.toLatin1().constData());
+    fflush(stdout);
+    writeTrace();
+    return summary;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Microseconds since the statistics were created.
+*/
+
+qint64 PassStatistics::now() const
+{
+    return clock.nsecsElapsed()/1000;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Add a complete event to the trace. Mutex must be held.
+*/
+
+void PassStatistics::addTraceEvent(QString eventName, qint64 start,
+                                   qint64 duration,
+                                   const StageCounters& counters)
+{
+    if (traceFile.isEmpty()) return;
+    qulonglong thread = (qulonglong)(quintptr)QThread::currentThreadId();
+    traceEvents << QString("{\"name\":\"%1\",\"cat\":\"%2\",\"ph\":\"X\","
+                           "\"ts\":%3,\"dur\":%4,\"pid\":1,\"tid\":%5,"
+                           "\"args\":{\"bytes\":%6,\"lines\":%7,\"malformed\":%8}}")
+                    .arg(eventName).arg(passName).arg(start).arg(duration)
+                    .arg(thread).arg(counters.bytes).arg(counters.lines)
+                    .arg(counters.malformed);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Write all trace events so far. Mutex must be held.
+*/
+
+void PassStatistics::writeTrace()
+{
+    if (traceFile.isEmpty()) return;
+    QFile file(traceFile);
+    if (! file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return;
+    QTextStream outStream(&file);
+    outStream << "{\"traceEvents\":[\n";
+    outStream << traceEvents.join(",\n");
+    outStream << "\n]}\n";
+    file.close();
+}
@@ -0,0 +1,107 @@
+/**
+@mainpage Power Management Data Processing Pass Statistics
+@version 1.0
+@author Ken Sarkies (www.jiggerjuice.net)
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@trinity.asn.au                                                *
+ *                                                                          *
+ *   This file is part of Power Management                                  *
+ *                                                                          *
+ *   Power Management is free software; you can redistribute it and/or      *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management is distributed in the hope that it will be useful,    *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management if not, write to the                       *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+#ifndef DATA_PROCESSING_STATS_H
+#define DATA_PROCESSING_STATS_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QMutex>
+#include <QElapsedTimer>
+
+typedef enum {stageRead, stageSplit, stageTime, stageFormat, stageWrite,
+              numberStages} PassStage;
+
+//-----------------------------------------------------------------------------
+/** @brief Counters collected by one thread during a pass.
+
+Stage times are in nanoseconds.
+*/
+
+struct StageCounters
+{
+    StageCounters();
+    void add(const StageCounters& other);
+    qint64 bytes;
+    qint64 lines;
+    qint64 malformed;
+    QHash<QString,qint64> records;
+    qint64 stageTime[numberStages];
+};
+
+//-----------------------------------------------------------------------------
+/** @brief Attribute elapsed time to stages of line processing.
+
+Each lap adds the time since the previous lap to the given stage.
+*/
+
+class StageClock
+{
+public:
+    StageClock(StageCounters* stageCounters);
+    void lap(PassStage stage);
+private:
+    StageCounters* counters;
+    QElapsedTimer timer;
+    qint64 last;
+};
+
+//-----------------------------------------------------------------------------
+/** @brief Timing and counters for a processing pass.
+
+Worker threads merge their counters at the end of each chunk. At the end of
+the pass a summary is printed and, if a trace file has been set, all events so
+far are written as a Chrome trace (chrome://tracing).
+*/
+
+class PassStatistics
+{
+public:
+    PassStatistics();
+    void setTraceFile(QString fileName);
+    void begin(QString name);
+    void merge(const StageCounters& counters, QString eventName, qint64 start);
+    QString end();
+    qint64 now() const;
+private:
+    void addTraceEvent(QString eventName, qint64 start, qint64 duration,
+                       const StageCounters& counters);
+    void writeTrace();
+    QMutex mutex;
+    QElapsedTimer clock;
+    QString passName;
+    qint64 passStart;
+    int chunks;
+    StageCounters total;
+    QString traceFile;
+    QStringList traceEvents;
+};
+
+#endif
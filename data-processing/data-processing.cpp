@@ -34,18 +34,47 @@ Uses: Qt version 4.8.1
  *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
  ***************************************************************************/
 
+#include <unistd.h>
+#include <cstdio>
+#include <cctype>
 #include "data-processing-main.h"
 #include <QApplication>
 
 //-----------------------------------------------------------------------------
 /** @brief Power Management Data Processing Main Program
 
+A summary of timing and counters is printed to stdout at the end of each pass.
+The option -t file writes all passes as a Chrome trace in JSON format.
 */
 
 int main(int argc,char ** argv)
 {
     QApplication application(argc,argv);
+/* Interpret any command line options */
+    int c;
+    opterr = 0;
+    QString traceFile;
+    while ((c = getopt (argc, argv, "t:")) != -1)
+    {
+        switch (c)
+        {
+// Chrome trace file
+        case 't':
+            traceFile = optarg;
+            break;
+// Unknown
+        case '?':
+            if (optopt == 't')
+                fprintf (stderr, "Option -%c requires an argument.\n", optopt);
+            else if (isprint (optopt))
+                fprintf (stderr, "Unknown option `-%c'.\n", optopt);
+            else
+                fprintf (stderr,"Unknown option character `\\x%x'.\n",optopt);
+            default: return false;
+        }
+    }
     DataProcessingGui dataProcessingGui;
+    if (! traceFile.isEmpty()) dataProcessingGui.setTraceFile(traceFile);
     if (dataProcessingGui.success())
     {
         dataProcessingGui.show();
@@ -15,10 +15,21 @@ UI_HEADERS_DIR  = ui
 UI_SOURCES_DIR  = ui
 LANGUAGE        = C++
 CONFIG          += qt warn_on release
+greaterThan(QT_MAJOR_VERSION, 4): QT += concurrent
 
 # Input
 FORMS           += data-processing-main.ui
 HEADERS         += data-processing-main.h
+HEADERS         += data-processing-plot-cache.h
+HEADERS         += data-processing-energy-model.h
+HEADERS         += data-processing-chunk.h
+HEADERS         += data-processing-stats.h
+HEADERS         += data-processing-ageing.h
 SOURCES         += data-processing.cpp
 SOURCES         += data-processing-main.cpp
+SOURCES         += data-processing-plot-cache.cpp
+SOURCES         += data-processing-energy-model.cpp
+SOURCES         += data-processing-chunk.cpp
+SOURCES         += data-processing-stats.cpp
+SOURCES         += data-processing-ageing.cpp
 
@@ -0,0 +1,1182 @@
+/*       Power Management Device Emulator
+
+Answers the GUI on a TCP port or a pseudo terminal with the same lines as the
+BMS firmware, sending telemetry replayed from a raw log or generated from a
+simple model, at up to a thousand times real time.
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include "power-management-emulator.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QRegExp>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t stopSignal = 0;
+
+//-----------------------------------------------------------------------------
+/** @brief Convert leading decimal digits to an integer, as the firmware.
+*/
+
+static int asciiToInt(const QByteArray& text, int start)
+{
+    int number = 0;
+    for (int i=start; i<text.size(); i++)
+    {
+        if ((text[i] < '0') || (text[i] > '9')) break;
+        number = number*10 + (text[i] - '0');
+    }
+    return number;
+}
+
+//-----------------------------------------------------------------------------
+/** Device Emulator Constructor
+*/
+
+DeviceEmulator::DeviceEmulator(QObject* parent) : QObject(parent)
+{
+    server = NULL;
+    client = NULL;
+    ptyMaster = -1;
+    ptySlave = -1;
+    ptyRead = NULL;
+    ptyWrite = NULL;
+    ptyWritten = 0;
+    discarding = false;
+    transactionOpen = false;
+    replayIndex = 0;
+    replayStart = 0;
+    loop = false;
+    speed = 1;
+    alwaysSend = false;
+    lastReceived = 0;
+    nextBlock = 0;
+    linesSent = 0;
+    bytesSent = 0;
+    blocksSent = 0;
+    blocksDropped = 0;
+    commandsReceived = 0;
+    setDefaults();
+    tick.setInterval(EMULATOR_TICK);
+    connect(&tick, SIGNAL(timeout()), this, SLOT(onTick()));
+}
+
+DeviceEmulator::~DeviceEmulator()
+{
+    delete ptyRead;
+    delete ptyWrite;
+    if (ptySlave >= 0) ::close(ptySlave);
+    if (ptyMaster >= 0) ::close(ptyMaster);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the device state at reset
+
+The configuration follows the firmware defaults. Batteries 1 and 2 share the
+loads and the panel, and battery 3 is isolated.
+*/
+
+void DeviceEmulator::setDefaults()
+{
+    const int type[3] = {0, 1, 0};
+    for (int i=0; i<3; i++)
+    {
+        config.batteryType[i] = type[i];
+        config.batteryCapacity[i] = 100;
+        config.absorptionVoltage[i] = (type[i] == 1) ? 3584 : 3686;
+        config.floatVoltage[i] = (type[i] == 1) ? 3532 : 3379;
+        config.floatStageCurrentScale[i] = 50;
+        config.bulkCurrentLimitScale[i] = 5;
+        charge[i] = 70 + 10*i;
+    }
+    config.monitorStrategy = 0xFF;
+    config.lowVoltage = 3072;
+    config.criticalVoltage = 2995;
+    config.lowSoC = 60*256;
+    config.criticalSoC = 45*256;
+    config.floatBulkSoC = 95*256;
+    config.chargerStrategy = 0;
+    config.restTime = 30;
+    config.absorptionTime = 90;
+    config.minDutyCycle = 256;
+    config.floatTime = 7200;
+    config.autoTrack = false;
+    config.recording = false;
+    config.measurementSend = true;
+    config.debugMessageSend = false;
+    config.enableSend = false;
+// Load 1 and load 2 on battery 1, panel on battery 2
+    switches = 1 | (1 << 2) | (2 << 4);
+    decision = 0;
+    indicators = 4095;
+    timeOffset = 0;
+    writeFileHandle = EMULATOR_NO_HANDLE;
+    readFileHandle = EMULATOR_NO_HANDLE;
+    readPosition = 0;
+    directoryIndex = 0;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Listen for a GUI on a TCP port
+
+@returns true if the port could be opened.
+*/
+
+bool DeviceEmulator::listenTcp(quint16 port)
+{
+    server = new QTcpServer(this);
+    connect(server, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+    return server->listen(QHostAddress::Any, port);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Create a pseudo terminal for a GUI to open as a serial port
+
+The slave side is held open by the emulator so that the master does not see a
+hangup while no GUI has the port open. The line is set raw as the GUI sets its
+own line parameters when it opens the port.
+
+@returns name of the slave device, empty if it could not be created.
+*/
+
+QString DeviceEmulator::openPty()
+{
+    ptyMaster = posix_openpt(O_RDWR | O_NOCTTY);
+    if (ptyMaster < 0) return QString();
+    if ((grantpt(ptyMaster) < 0) || (unlockpt(ptyMaster) < 0))
+    {
+        ::close(ptyMaster);
+        ptyMaster = -1;
+        return QString();
+    }
+    QString name = QString(ptsname(ptyMaster));
+    struct termios settings;
+    if (tcgetattr(ptyMaster, &settings) == 0)
+    {
+        cfmakeraw(&settings);
+        tcsetattr(ptyMaster, TCSANOW, &settings);
+    }
+    fcntl(ptyMaster, F_SETFL, fcntl(ptyMaster, F_GETFL) | O_NONBLOCK);
+    ptySlave = ::open(name.toLocal8Bit().constData(), O_RDWR | O_NOCTTY);
+    ptyRead = new QSocketNotifier(ptyMaster, QSocketNotifier::Read, this);
+    connect(ptyRead, SIGNAL(activated(int)), this, SLOT(onPtyReadable()));
+    ptyWrite = new QSocketNotifier(ptyMaster, QSocketNotifier::Write, this);
+    ptyWrite->setEnabled(false);
+    connect(ptyWrite, SIGNAL(activated(int)), this, SLOT(onPtyWritable()));
+    return name;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Load a raw log to be replayed
+
+The log is a file saved by the GUI or the capture daemon, or a file recorded by
+the BMS itself. A host time in front of each line is removed. Each line is
+timed by the last pH time record before it, and gaps between time records
+longer than EMULATOR_MAX_GAP, or going backwards, are taken as one block so
+that the replay does not stall over breaks in the recording.
+
+@param[in] fileName: raw log file.
+@param[out] error: description of any failure.
+@returns true if the log has at least one time record.
+*/
+
+bool DeviceEmulator::loadReplay(QString fileName, QString* error)
+{
+    QFile file(fileName);
+    if (! file.open(QIODevice::ReadOnly))
+    {
+        *error = "Could not open " + fileName;
+        return false;
+    }
+    QRegExp hostTime("^\\d{4}-\\d\\d-\\d\\dT\\d\\d:\\d\\d:\\d\\d\\.\\d{3},");
+    QDateTime previousTime;
+    qint64 position = 0;
+    replayLines.clear();
+    replayTimes.clear();
+    while (! file.atEnd())
+    {
+        QByteArray line = file.readLine().trimmed();
+        if (hostTime.indexIn(QString::fromLatin1(line)) == 0)
+            line = line.mid(hostTime.matchedLength());
+        if (line.isEmpty() || (line.size() > EMULATOR_MAX_LINE)) continue;
+        if (line.startsWith("pH,"))
+        {
+            QDateTime time = QDateTime::fromString(QString::fromLatin1(line.mid(3)),
+                                                   Qt::ISODate);
+            if (! time.isValid()) continue;
+            if (previousTime.isValid())
+            {
+                qint64 gap = previousTime.msecsTo(time);
+                if ((gap <= 0) || (gap > EMULATOR_MAX_GAP))
+                    gap = EMULATOR_BLOCK_TIME;
+                position += gap;
+            }
+            previousTime = time;
+        }
+        replayLines.append(line);
+        replayTimes.append(position);
+    }
+    file.close();
+    if (! previousTime.isValid())
+    {
+        *error = "No time records in " + fileName;
+        replayLines.clear();
+        replayTimes.clear();
+        return false;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the device time rate as a multiple of real time
+*/
+
+void DeviceEmulator::setSpeed(int rate)
+{
+    if (rate < 1) rate = 1;
+    if (rate > MAX_SPEED) rate = MAX_SPEED;
+    speed = rate;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Start the replayed log again when it ends
+*/
+
+void DeviceEmulator::setLoop(bool repeat)
+{
+    loop = repeat;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send without waiting for the keep-alive from the GUI
+*/
+
+void DeviceEmulator::setAlwaysSend(bool always)
+{
+    alwaysSend = always;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Start the device clock
+
+Synthetic telemetry starts at the host time, on the next whole second.
+*/
+
+void DeviceEmulator::start()
+{
+    timeOffset = QDateTime::currentMSecsSinceEpoch();
+    nextBlock = EMULATOR_BLOCK_TIME - (timeOffset % EMULATOR_BLOCK_TIME);
+    replayIndex = 0;
+    replayStart = 0;
+    clock.start();
+    lastReceived = 0;
+    tick.start();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Stop and report what was sent
+*/
+
+void DeviceEmulator::stop()
+{
+    tick.stop();
+    fprintf(stderr, "%lld lines (%lld bytes) sent in %lld blocks, "
+                    "%lld blocks dropped, %lld commands received\n",
+            linesSent, bytesSent, blocksSent, blocksDropped, commandsReceived);
+    if (client != NULL) client->flush();
+    QCoreApplication::quit();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Signal handler for stopping the emulator
+
+Only sets a flag, which is acted on by the tick.
+*/
+
+void DeviceEmulator::signalHandler(int signal)
+{
+    Q_UNUSED(signal);
+    stopSignal = 1;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Device time in ms elapsed since the start
+*/
+
+qint64 DeviceEmulator::deviceElapsed() const
+{
+    return clock.elapsed()*speed;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send the telemetry blocks that are due
+
+All blocks due since the last tick are sent, so the rate holds at high speeds.
+A block is dropped if the GUI has not taken the lines already sent, as the
+firmware drops low priority messages when its send queue is full. Sending lapses
+when nothing has been received for EMULATOR_LAPSE_TIME of real time.
+*/
+
+void DeviceEmulator::onTick()
+{
+    if (stopSignal)
+    {
+        stop();
+        return;
+    }
+    if (! alwaysSend && config.enableSend &&
+        (clock.elapsed() - lastReceived > EMULATOR_LAPSE_TIME))
+        config.enableSend = false;
+    qint64 elapsed = deviceElapsed();
+    if (replayLines.isEmpty())
+    {
+        while (nextBlock <= elapsed)
+        {
+            if (pendingBytes() > EMULATOR_MAX_PENDING) blocksDropped++;
+            else sendSyntheticBlock(timeOffset + nextBlock);
+            nextBlock += EMULATOR_BLOCK_TIME;
+        }
+        return;
+    }
+    while (replayIndex < replayLines.size())
+    {
+        if (replayTimes[replayIndex] > elapsed - replayStart) break;
+        sendReplayBlock();
+        if ((replayIndex >= replayLines.size()) && loop)
+        {
+            replayStart += replayTimes.last() + EMULATOR_BLOCK_TIME;
+            replayIndex = 0;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send the next block of the replayed log
+
+A block runs from a time record to the line before the next one. Debug lines
+are sent only when debug messages are on, and the time record is sent even
+when measurements are off, as the firmware.
+
+@returns false if the block was dropped.
+*/
+
+bool DeviceEmulator::sendReplayBlock()
+{
+    bool drop = (pendingBytes() > EMULATOR_MAX_PENDING);
+    int start = replayIndex;
+    do
+    {
+        const QByteArray& line = replayLines[replayIndex];
+        replayIndex++;
+        record(line);
+        if (drop) continue;
+        if (line.startsWith("D") && ! config.debugMessageSend) continue;
+        if (! line.startsWith("pH,") && ! config.measurementSend) continue;
+        printLine(line);
+    }
+    while ((replayIndex < replayLines.size()) &&
+           ! replayLines[replayIndex].startsWith("pH,"));
+    if (drop) blocksDropped++;
+    else if (replayLines[start].startsWith("pH,")) blocksSent++;
+    return ! drop;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send a synthetic telemetry block
+
+The messages and their order are those of the firmware monitor task. The panel
+follows the sun from 6am to 6pm device time, the loads vary slowly, and the
+state of charge of each battery is integrated from its current.
+
+@param[in] time: device time in ms since the epoch.
+*/
+
+void DeviceEmulator::sendSyntheticBlock(qint64 time)
+{
+    QDateTime deviceTime = QDateTime::fromMSecsSinceEpoch(time);
+    double hour = deviceTime.time().msecsSinceStartOfDay()/3600000.0;
+    double daylight = 0;
+    if ((hour > 6) && (hour < 18)) daylight = sin(M_PI*(hour-6)/12);
+    double ripple = sin(2*M_PI*(time % 600000)/600000.0);
+    double panelCurrent = 15*daylight + 0.2*daylight*ripple;
+    double panelVoltage = (daylight > 0) ? 17 + 1.5*daylight : 0.3;
+    double loadCurrent[2] = {2.5 + 0.5*ripple, 0.8};
+    double batteryCurrent[3] = {0, 0, 0};
+    double batteryVoltage[3];
+    int opState[3] = {2, 2, 2};
+    for (int load=0; load<2; load++)
+    {
+        int battery = ((switches >> 2*load) & 0x03) - 1;
+        if (battery < 0) continue;
+        batteryCurrent[battery] -= loadCurrent[load];
+        opState[battery] = 0;
+    }
+    int panelBattery = ((switches >> 4) & 0x03) - 1;
+    if (panelBattery >= 0)
+    {
+        batteryCurrent[panelBattery] += panelCurrent;
+        opState[panelBattery] = 1;
+    }
+
+    QByteArray timeString = deviceTime.toString("yyyy-MM-ddThh:mm:ss").toLatin1();
+    printLine("pH," + timeString);
+    record("pH," + timeString);
+    char id[4] = "d00";
+    for (int i=0; i<3; i++)
+    {
+        charge[i] += 100.0*batteryCurrent[i]*EMULATOR_BLOCK_TIME/3600000.0
+                     /config.batteryCapacity[i];
+        if (charge[i] > 100) charge[i] = 100;
+        if (charge[i] < 0) charge[i] = 0;
+        batteryVoltage[i] = 11.8 + 0.012*charge[i] + 0.02*batteryCurrent[i];
+        int current = (int)(batteryCurrent[i]*256);
+        int voltage = (int)(batteryVoltage[i]*256);
+        int soc = (int)(charge[i]*256);
+        int fillState = 0;
+        if (soc < config.criticalSoC) fillState = 2;
+        else if (soc < config.lowSoC) fillState = 1;
+        int phase = (soc < config.floatBulkSoC) ? 0 : 2;
+        int states = (opState[i] & 0x03) | ((fillState & 0x03) << 2) |
+                     ((phase & 0x03) << 4);
+        id[2] = '1'+i;
+        id[1] = 'B';
+        dataMessageSend(id, current, voltage);
+        recordDual(id, current, voltage);
+        id[1] = 'C';
+        sendResponse(id, soc);
+        recordSingle(id, soc);
+        id[1] = 'O';
+        sendResponse(id, states);
+        recordSingle(id, states);
+    }
+    id[1] = 'L';
+    for (int load=0; load<2; load++)
+    {
+        int battery = ((switches >> 2*load) & 0x03) - 1;
+        double voltage = (battery < 0) ? 0 : batteryVoltage[battery] - 0.05;
+        id[2] = '1'+load;
+        dataMessageSend(id, (int)(loadCurrent[load]*256), (int)(voltage*256));
+        recordDual(id, (int)(loadCurrent[load]*256), (int)(voltage*256));
+    }
+    dataMessageSend("dM1", (int)(panelCurrent*256), (int)(panelVoltage*256));
+    recordDual("dM1", (int)(panelCurrent*256), (int)(panelVoltage*256));
+    int temperature = (int)((20 + 8*daylight)*256);
+    sendResponse("dT", temperature);
+    recordSingle("dT", temperature);
+    sendResponse("dD", controls());
+    recordSingle("dD", controls());
+    sendResponse("ds", switches);
+    recordSingle("ds", switches);
+    if (config.autoTrack)
+    {
+        sendResponse("dd", decision);
+        recordSingle("dd", decision);
+    }
+    sendResponse("dI", indicators);
+    recordSingle("dI", indicators);
+    blocksSent++;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Control bits as sent in dD, as the firmware getControls
+*/
+
+int DeviceEmulator::controls() const
+{
+    int bits = 0;
+    if (config.autoTrack) bits |= 1 << 0;
+    if (config.recording) bits |= 1 << 1;
+    if (config.measurementSend) bits |= 1 << 3;
+    if (config.debugMessageSend) bits |= 1 << 4;
+    return bits;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send a line if communications are enabled
+
+Lines are dropped while sending is off, as the firmware commsPrintChar.
+*/
+
+void DeviceEmulator::printLine(const QByteArray& line)
+{
+    if (! (config.enableSend || alwaysSend)) return;
+    transmit(line + "\r\n");
+    linesSent++;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send a message with two parameters, as the firmware dataMessageSend
+*/
+
+void DeviceEmulator::dataMessageSend(const char* ident, int param1, int param2)
+{
+    if (! config.measurementSend) return;
+    printLine(QByteArray(ident) + "," + QByteArray::number(param1) + ","
+              + QByteArray::number(param2));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send a message with one parameter, as the firmware sendResponse
+*/
+
+void DeviceEmulator::sendResponse(const char* ident, int parameter)
+{
+    if (! config.measurementSend) return;
+    printLine(QByteArray(ident) + "," + QByteArray::number(parameter));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send a message with a string, as the firmware sendString
+*/
+
+void DeviceEmulator::sendString(const char* ident, const QByteArray& string)
+{
+    if (! config.measurementSend) return;
+    printLine(QByteArray(ident) + "," + string);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Add a telemetry line to the write file while recording
+
+The file stops growing when half of the emulated medium is used.
+*/
+
+void DeviceEmulator::record(const QByteArray& line)
+{
+    if (! config.recording || (writeFileHandle == EMULATOR_NO_HANDLE)) return;
+    QByteArray& file = files[writeFileName];
+    if (file.size() > (qint64)EMULATOR_CLUSTERS*EMULATOR_CLUSTER_SIZE/2) return;
+    file.append(line).append("\r\n");
+}
+
+void DeviceEmulator::recordSingle(const char* ident, int parameter)
+{
+    record(QByteArray(ident) + "," + QByteArray::number(parameter));
+}
+
+void DeviceEmulator::recordDual(const char* ident, int param1, int param2)
+{
+    record(QByteArray(ident) + "," + QByteArray::number(param1) + ","
+           + QByteArray::number(param2));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Pass bytes to the GUI link
+*/
+
+void DeviceEmulator::transmit(const QByteArray& data)
+{
+    bytesSent += data.size();
+    if (client != NULL) client->write(data);
+    else if (ptyMaster >= 0)
+    {
+        ptyPending.append(data);
+        onPtyWritable();
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Bytes sent that the GUI has not yet taken
+*/
+
+qint64 DeviceEmulator::pendingBytes() const
+{
+    if (client != NULL) return client->bytesToWrite();
+    return ptyPending.size() - ptyWritten;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Accept a GUI connection
+
+Only one GUI is served, as there is one serial line on the board. A new
+connection replaces the previous one.
+*/
+
+void DeviceEmulator::onNewConnection()
+{
+    QTcpSocket* next = server->nextPendingConnection();
+    if (next == NULL) return;
+    if (client != NULL)
+    {
+        disconnect(client, 0, this, 0);
+        client->abort();
+        client->deleteLater();
+    }
+    client = next;
+    input.clear();
+    discarding = false;
+    connect(client, SIGNAL(readyRead()), this, SLOT(onClientData()));
+    connect(client, SIGNAL(disconnected()), this, SLOT(onClientDisconnected()));
+}
+
+void DeviceEmulator::onClientData()
+{
+    if (client != NULL) receive(client->readAll());
+}
+
+void DeviceEmulator::onClientDisconnected()
+{
+    if (client == NULL) return;
+    client->deleteLater();
+    client = NULL;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Read from the pseudo terminal
+*/
+
+void DeviceEmulator::onPtyReadable()
+{
+    char buffer[4096];
+    ssize_t count = ::read(ptyMaster, buffer, sizeof(buffer));
+    if (count > 0) receive(QByteArray(buffer, count));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Write pending bytes to the pseudo terminal
+
+Bytes are written until the terminal is full, and the rest wait for it to be
+writable again. The written part of the buffer is only removed once it is large,
+so that a slow reader does not cause the buffer to be moved on every write.
+*/
+
+void DeviceEmulator::onPtyWritable()
+{
+    while (ptyWritten < ptyPending.size())
+    {
+        ssize_t count = ::write(ptyMaster, ptyPending.constData() + ptyWritten,
+                                ptyPending.size() - ptyWritten);
+        if (count <= 0) break;
+        ptyWritten += count;
+    }
+    if (ptyWritten >= ptyPending.size())
+    {
+        ptyPending.clear();
+        ptyWritten = 0;
+    }
+    else if (ptyWritten > 65536)
+    {
+        ptyPending.remove(0, ptyWritten);
+        ptyWritten = 0;
+    }
+    ptyWrite->setEnabled(! ptyPending.isEmpty());
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Frame received bytes into command lines
+
+Lines end with CR or LF. Lines longer than the firmware buffer are discarded.
+Any byte received restarts the lapse time.
+*/
+
+void DeviceEmulator::receive(const QByteArray& data)
+{
+    lastReceived = clock.elapsed();
+    for (int i=0; i<data.size(); i++)
+    {
+        char character = data[i];
+        if ((character == '\r') || (character == '\n'))
+        {
+            if (! discarding && ! input.isEmpty()) parseSequencedCommand(input);
+            input.clear();
+            discarding = false;
+        }
+        else if (input.size() >= EMULATOR_MAX_LINE)
+        {
+            input.clear();
+            discarding = true;
+        }
+        else if (! discarding) input.append(character);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Act on a command line that may carry a sequence number
+
+As the firmware, a line "#n,c" is acted on as the command c and acknowledged
+with aK,n. A number among the last EMULATOR_SEQUENCE_HISTORY is a repeat and is
+acknowledged without acting on the command again.
+*/
+
+void DeviceEmulator::parseSequencedCommand(const QByteArray& line)
+{
+    if (! line.startsWith('#'))
+    {
+        parseCommand(line);
+        return;
+    }
+    int comma = line.indexOf(',');
+    bool ok = false;
+    int sequence = line.mid(1, comma-1).toInt(&ok);
+    if ((comma < 2) || ! ok || (sequence < 0) || (sequence > 255)) return;
+    if (! sequenceHistory.contains(sequence))
+    {
+        sequenceHistory.append(sequence);
+        if (sequenceHistory.size() > EMULATOR_SEQUENCE_HISTORY)
+            sequenceHistory.removeFirst();
+        parseCommand(line.mid(comma+1));
+    }
+    printLine("aK," + QByteArray::number(sequence));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Act on a command line, as the firmware parseCommand
+*/
+
+void DeviceEmulator::parseCommand(const QByteArray& line)
+{
+    commandsReceived++;
+    if (line.size() < 2) return;
+    switch (line[0])
+    {
+    case 'a': actionCommand(line); break;
+    case 'd': dataCommand(line); break;
+    case 'p': parameterCommand(line); break;
+    case 'f': fileCommand(line); break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Action commands
+
+Only setting switches, the ident and configuration transactions have any effect
+on the emulated device. A committed transaction is kept only in memory.
+*/
+
+void DeviceEmulator::actionCommand(const QByteArray& line)
+{
+    switch (line[1])
+    {
+    case 'S':
+        if (line.size() >= 4)
+        {
+            int battery = line[2] - '0';
+            int setting = line[3] - '0' - 1;
+            if ((battery >= 0) && (battery < 4) && (setting >= 0) && (setting < 3))
+                switches = (switches & ~(0x03 << 2*setting)) |
+                           (battery << 2*setting);
+        }
+        break;
+    case 'E':
+        sendString("dE", EMULATOR_IDENT);
+        break;
+    case 'K':
+        sequenceHistory.clear();
+        break;
+    case 'T':
+        configBackup = config;
+        transactionOpen = true;
+        transactionFailed = false;
+        transactionCount = 0;
+        transactionChecksum = 0;
+        break;
+    case 'P':
+    {
+        if (! transactionOpen) break;
+        int comma = line.indexOf(',');
+        QByteArray frame = line.mid(comma+1);
+        quint16 crc = qChecksum(frame.constData(), frame.size());
+        if ((comma < 3) || (line.mid(2, comma-2).toUInt() != crc))
+        {
+            transactionFailed = true;
+            break;
+        }
+        transactionChecksum += crc;
+        QList<QByteArray> items = frame.split(';');
+        for (int i=0; i<items.size(); i++)
+        {
+            if (items[i].isEmpty()) continue;
+            parameterCommand("p" + items[i]);
+            transactionCount++;
+        }
+        break;
+    }
+    case 'C':
+    {
+        if (! transactionOpen) break;
+        QList<QByteArray> expected = line.mid(2).split(',');
+        int count = transactionCount;
+        if (transactionFailed || (expected.size() != 2) ||
+            (expected[0].toInt() != transactionCount) ||
+            (expected[1].toUInt() != transactionChecksum))
+        {
+            memcpy(&config, &configBackup, EMULATOR_PARAMETERS_SIZE);
+            count = -1;
+        }
+        transactionOpen = false;
+        dataMessageSend("pW", count, transactionChecksum);
+        break;
+    }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Data request commands
+*/
+
+void DeviceEmulator::dataCommand(const QByteArray& line)
+{
+    switch (line[1])
+    {
+    case 'S':
+        sendResponse("dS", switches);
+        sendResponse("dD", controls());
+        break;
+    case 'B':
+    {
+        if (line.size() < 3) break;
+        int battery = line[2] - '1';
+        if ((battery < 0) || (battery > 2)) break;
+        char id[] = "pR0";
+        id[2] = line[2];
+        dataMessageSend(id, 0, 0);
+        id[1] = 'T';
+        dataMessageSend(id, config.batteryType[battery],
+                            config.batteryCapacity[battery]);
+        id[1] = 'F';
+        dataMessageSend(id, config.floatStageCurrentScale[battery],
+                            config.floatVoltage[battery]);
+        id[1] = 'A';
+        dataMessageSend(id, config.bulkCurrentLimitScale[battery],
+                            config.absorptionVoltage[battery]);
+        break;
+    }
+    case 'T':
+        dataMessageSend("pts", config.monitorStrategy, 0);
+        dataMessageSend("ptV", config.lowVoltage, config.criticalVoltage);
+        dataMessageSend("ptS", config.lowSoC, config.criticalSoC);
+        dataMessageSend("ptF", config.floatBulkSoC, 0);
+        break;
+    case 'C':
+        dataMessageSend("pcs", config.chargerStrategy, 0);
+        dataMessageSend("pcR", config.restTime, config.absorptionTime);
+        dataMessageSend("pcD", config.minDutyCycle, 0);
+        dataMessageSend("pcF", config.floatTime, config.floatBulkSoC);
+        break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Parameter setting commands
+
+Setting the time moves the device clock of synthetic telemetry. A replayed log
+keeps its own times.
+*/
+
+void DeviceEmulator::parameterCommand(const QByteArray& line)
+{
+    char sign = (line.size() > 2) ? line[2] : 0;
+    int battery = sign - '1';
+    bool validBattery = (battery >= 0) && (battery < 3);
+    switch (line[1])
+    {
+    case 'a':
+        if (sign == '-') config.autoTrack = false;
+        else if (sign == '+') config.autoTrack = true;
+        break;
+    case 'c':
+        if (sign == '-') config.enableSend = false;
+        else if (sign == '+') config.enableSend = true;
+        break;
+    case 'd':
+        if (sign == '-') config.debugMessageSend = false;
+        else if (sign == '+') config.debugMessageSend = true;
+        break;
+    case 'H':
+    {
+        QDateTime time = QDateTime::fromString(QString::fromLatin1(line.mid(2)),
+                                               Qt::ISODate);
+        if (! time.isValid()) break;
+        qint64 elapsed = deviceElapsed();
+        timeOffset = time.toMSecsSinceEpoch() - elapsed;
+        nextBlock = elapsed + EMULATOR_BLOCK_TIME;
+        break;
+    }
+    case 'M':
+        if (sign == '-') config.measurementSend = false;
+        else if (sign == '+') config.measurementSend = true;
+        break;
+    case 'r':
+        if (sign == '-') config.recording = false;
+        else if ((sign == '+') && (writeFileHandle != EMULATOR_NO_HANDLE))
+            config.recording = true;
+        break;
+    case 'T':
+        if (validBattery && (line.size() > 3))
+        {
+            int type = line[3] - '0';
+            if ((type < 0) || (type > 2)) break;
+            config.batteryType[battery] = type;
+            config.batteryCapacity[battery] = asciiToInt(line, 4);
+            if (config.batteryCapacity[battery] < 1)
+                config.batteryCapacity[battery] = 1;
+        }
+        break;
+    case 'I':
+        if (validBattery)
+            config.bulkCurrentLimitScale[battery] = asciiToInt(line, 3);
+        break;
+    case 'A':
+        if (validBattery) config.absorptionVoltage[battery] = asciiToInt(line, 3);
+        break;
+    case 'f':
+        if (validBattery)
+            config.floatStageCurrentScale[battery] = asciiToInt(line, 3);
+        break;
+    case 'F':
+        if (validBattery) config.floatVoltage[battery] = asciiToInt(line, 3);
+        break;
+    case 's':
+        if ((sign >= '0') && (sign <= '3')) config.monitorStrategy = sign - '0';
+        break;
+    case 'v': config.lowVoltage = asciiToInt(line, 2); break;
+    case 'V': config.criticalVoltage = asciiToInt(line, 2); break;
+    case 'x': config.lowSoC = asciiToInt(line, 2); break;
+    case 'X': config.criticalSoC = asciiToInt(line, 2); break;
+    case 'S':
+        if ((sign >= '0') && (sign <= '1')) config.chargerStrategy = sign - '0';
+        break;
+    case 'R': config.restTime = asciiToInt(line, 2); break;
+    case 'G': config.absorptionTime = asciiToInt(line, 2); break;
+    case 'D': config.minDutyCycle = asciiToInt(line, 2); break;
+    case 'e': config.floatTime = asciiToInt(line, 2); break;
+    case 'B': config.floatBulkSoC = asciiToInt(line, 2); break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Directory entry in the form sent by the firmware
+
+The entry is a comma, the type, the size as eight hex digits and the name.
+
+@param[in] index: position of the file in the directory.
+@returns the entry, empty if there are no more.
+*/
+
+QByteArray DeviceEmulator::directoryEntry(int index) const
+{
+    if ((index < 0) || (index >= files.size())) return QByteArray();
+    QMap<QString,QByteArray>::const_iterator file = files.constBegin() + index;
+    return ",f" + QByteArray::number(file.value().size(), 16).toUpper()
+                      .rightJustified(8, '0') + file.key().toLatin1();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief File commands
+
+Files are held in memory in a single root directory. One file can be open for
+writing and one for reading, with fixed handles.
+*/
+
+void DeviceEmulator::fileCommand(const QByteArray& line)
+{
+    QString name = QString::fromLatin1(line.mid(2));
+    switch (line[1])
+    {
+    case 'F':
+    {
+        qint64 used = 0;
+        QMap<QString,QByteArray>::const_iterator file;
+        for (file = files.constBegin(); file != files.constEnd(); ++file)
+            used += (file.value().size() + EMULATOR_CLUSTER_SIZE - 1)
+                    /EMULATOR_CLUSTER_SIZE;
+        dataMessageSend("fF", EMULATOR_CLUSTERS - used, EMULATOR_CLUSTER_SIZE);
+        sendResponse("fE", FR_OK);
+        break;
+    }
+    case 'W':
+        if (name.length() >= 12) break;
+        if (writeFileHandle != EMULATOR_NO_HANDLE)
+        {
+            sendResponse("fW", EMULATOR_NO_HANDLE);
+            sendResponse("fE", FR_TOO_MANY_OPEN_FILES);
+            break;
+        }
+        if (! files.contains(name)) files.insert(name, QByteArray());
+        writeFileName = name;
+        writeFileHandle = EMULATOR_WRITE_HANDLE;
+        sendResponse("fW", writeFileHandle);
+        sendResponse("fE", FR_OK);
+        break;
+    case 'R':
+        if (name.length() >= 12) break;
+        if (! files.contains(name))
+        {
+            sendResponse("fR", EMULATOR_NO_HANDLE);
+            sendResponse("fE", FR_NO_FILE);
+            break;
+        }
+        readFileName = name;
+        readFileHandle = EMULATOR_READ_HANDLE;
+        readPosition = 0;
+        sendResponse("fR", readFileHandle);
+        sendResponse("fE", FR_OK);
+        break;
+    case 'C':
+    {
+        int handle = asciiToInt(line, 2);
+        int status = FR_OK;
+        if ((handle == writeFileHandle) && (handle != EMULATOR_NO_HANDLE))
+        {
+            writeFileHandle = EMULATOR_NO_HANDLE;
+            writeFileName.clear();
+        }
+        else if ((handle == readFileHandle) && (handle != EMULATOR_NO_HANDLE))
+        {
+            readFileHandle = EMULATOR_NO_HANDLE;
+            readFileName.clear();
+        }
+        else status = FR_INT_ERR;
+        sendResponse("fE", status);
+        break;
+    }
+/* The firmware takes the number of records and the handle from the same field,
+and sends each record with its own line end followed by another. */
+    case 'G':
+    {
+        int handle = asciiToInt(line, 2);
+        int records = handle;
+        if (records < 1) records = 1;
+        QString fileName;
+        if (handle == readFileHandle) fileName = readFileName;
+        else if (handle == writeFileHandle) fileName = writeFileName;
+        if (fileName.isEmpty() || (handle == EMULATOR_NO_HANDLE))
+        {
+            sendResponse("fE", FR_INT_ERR);
+            break;
+        }
+        const QByteArray& file = files[fileName];
+        int status = FR_OK;
+        while (records > 0)
+        {
+            int end = file.indexOf('\n', readPosition);
+            if (end < 0)
+            {
+                status = FR_DENIED;
+                break;
+            }
+            sendString("fG", file.mid(readPosition, end+1-readPosition));
+            readPosition = end+1;
+            records--;
+        }
+        sendResponse("fE", status);
+        break;
+    }
+/* A bulk read chunk is sent in full as it is not gated by measurementSend. */
+    case 'B':
+    {
+        if ((readFileHandle == EMULATOR_NO_HANDLE) || ! files.contains(readFileName))
+        {
+            sendResponse("fE", FR_INVALID_OBJECT);
+            break;
+        }
+        int chunk = asciiToInt(line, 2);
+        QByteArray data = files[readFileName].mid(chunk*EMULATOR_BULK_SIZE,
+                                                  EMULATOR_BULK_SIZE);
+        printLine("fb," + QByteArray::number(chunk) + ","
+                  + QByteArray::number(data.size()) + ","
+                  + QByteArray::number(qChecksum(data.constData(), data.size()))
+                  + "," + data.toBase64());
+        sendResponse("fE", FR_OK);
+        break;
+    }
+    case 'D':
+    {
+        QByteArray listing = "fD";
+        int status = FR_NO_PATH;
+        if (name.isEmpty() || (name == "/"))
+        {
+            for (int i=0; i<files.size(); i++) listing.append(directoryEntry(i));
+            status = FR_OK;
+        }
+        printLine(listing);
+        sendResponse("fE", status);
+        break;
+    }
+    case 'd':
+    {
+        if (! name.isEmpty()) directoryIndex = 0;
+        printLine("fd" + directoryEntry(directoryIndex));
+        if (directoryIndex < files.size()) directoryIndex++;
+        sendResponse("fE", FR_OK);
+        break;
+    }
+    case 'L':
+    {
+        int token = asciiToInt(line, 2);
+        QString directory = name.section(',', 1);
+        QByteArray page;
+        int status = FR_NO_PATH;
+        int next = 0;
+        if (directory.isEmpty() || (directory == "/"))
+        {
+            int index = token;
+            while ((index < files.size()) && (index-token < EMULATOR_DIRECTORY_BATCH))
+                page.append(directoryEntry(index++));
+/* As the firmware, a full page does not look ahead for the end. */
+            if (index-token == EMULATOR_DIRECTORY_BATCH) next = index;
+            status = FR_OK;
+        }
+        printLine("fL," + QByteArray::number(next) + page);
+        sendResponse("fE", status);
+        break;
+    }
+    case 'M':
+        sendResponse("fE", FR_OK);
+        break;
+    case 's':
+    {
+        QByteArray status = "fs," + QByteArray::number(controls()) + ","
+                            + QByteArray::number(writeFileHandle) + ",";
+        if (writeFileHandle != EMULATOR_NO_HANDLE)
+            status.append(writeFileName.toLatin1()).append(",");
+        status.append(QByteArray::number(readFileHandle));
+        if (readFileHandle != EMULATOR_NO_HANDLE)
+            status.append(",").append(readFileName.toLatin1());
+        printLine(status);
+        break;
+    }
+    case 'X':
+        if (! files.contains(name)) sendResponse("fE", FR_NO_FILE);
+        else if ((name == writeFileName) || (name == readFileName))
+            sendResponse("fE", FR_DENIED);
+        else
+        {
+            files.remove(name);
+            directoryIndex = 0;
+            sendResponse("fE", FR_OK);
+        }
+        break;
+    }
+}
@@ -0,0 +1,233 @@
+/*          Power Management Device Emulator Header
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#ifndef POWER_MANAGEMENT_EMULATOR_H
+#define POWER_MANAGEMENT_EMULATOR_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QSocketNotifier>
+#include <cstddef>
+
+#define DEFAULT_TCP_PORT    6666
+#define MAX_SPEED           1000
+
+// Ident sent in response to aE, as the firmware
+#define EMULATOR_IDENT      "Battery Management System,"\
+                            "1.07b - 10.2.1 - 0.13c - 2019-07-07,1"
+// Time in ms between checks for messages due to be sent
+#define EMULATOR_TICK       10
+// Device time in ms between telemetry blocks, as the firmware monitor task
+#define EMULATOR_BLOCK_TIME 1000
+// Time in ms without any received line before sending stops, as the firmware
+#define EMULATOR_LAPSE_TIME 10000
+// Longest command line accepted, as the firmware
+#define EMULATOR_MAX_LINE   255
+// Bytes waiting to be taken by the GUI before telemetry is dropped
+#define EMULATOR_MAX_PENDING 1048576
+// Gaps in a replayed log longer than this (ms) are shortened to one block
+#define EMULATOR_MAX_GAP    60000
+// Emulated storage medium
+#define EMULATOR_CLUSTERS   60000
+#define EMULATOR_CLUSTER_SIZE 4096
+// File handles given to the write and read files
+#define EMULATOR_WRITE_HANDLE 0
+#define EMULATOR_READ_HANDLE  1
+#define EMULATOR_NO_HANDLE    0xFF
+// Bytes in each chunk of a bulk file read, as the firmware FILE_BULK_SIZE
+#define EMULATOR_BULK_SIZE    256
+// Directory entries in each page of a listing, as the firmware DIRECTORY_BATCH
+#define EMULATOR_DIRECTORY_BATCH 16
+// Sequence numbers remembered to detect repeats, as the firmware
+#define EMULATOR_SEQUENCE_HISTORY 16
+// Bytes of the configurable parameters at the start of EmulatorConfig
+#define EMULATOR_PARAMETERS_SIZE offsetof(EmulatorConfig, autoTrack)
+
+// FatFs status codes returned in fE responses
+#define FR_OK               0
+#define FR_INT_ERR          2
+#define FR_NO_FILE          4
+#define FR_NO_PATH          5
+#define FR_DENIED           7
+#define FR_INVALID_OBJECT   9
+#define FR_TOO_MANY_OPEN_FILES 18
+
+//-----------------------------------------------------------------------------
+/** @brief Configuration values held by the firmware object dictionary.
+
+Defaults are those of the firmware setGlobalDefaults. The configurable
+parameters come first, ahead of the tracking, recording and sending controls,
+so that a configuration transaction can roll them back alone.
+*/
+
+struct EmulatorConfig
+{
+    int batteryType[3];
+    int batteryCapacity[3];
+    int absorptionVoltage[3];
+    int floatVoltage[3];
+    int floatStageCurrentScale[3];
+    int bulkCurrentLimitScale[3];
+    int monitorStrategy;
+    int lowVoltage;
+    int criticalVoltage;
+    int lowSoC;
+    int criticalSoC;
+    int floatBulkSoC;
+    int chargerStrategy;
+    int restTime;
+    int absorptionTime;
+    int minDutyCycle;
+    int floatTime;
+    bool autoTrack;
+    bool recording;
+    bool measurementSend;
+    bool debugMessageSend;
+    bool enableSend;
+};
+
+//-----------------------------------------------------------------------------
+/** @brief Emulation of the BMS serial interface.
+
+Serves one GUI at a time, either on a TCP port or on a pseudo terminal that the
+GUI opens as a serial port. A telemetry block is sent for each second of device
+time, either replayed from a raw log or generated from a simple model of the
+batteries, loads and panel. Device time runs at a multiple of real time so that
+the GUIs and capture tools can be loaded well beyond the rate of the board.
+
+Commands are answered with the same lines as the firmware. Sending stops when
+nothing has been received for ten seconds, unless told to send always.
+*/
+
+class DeviceEmulator : public QObject
+{
+    Q_OBJECT
+public:
+    DeviceEmulator(QObject* parent = 0);
+    ~DeviceEmulator();
+    bool listenTcp(quint16 port);
+    QString openPty();
+    bool loadReplay(QString fileName, QString* error);
+    void setSpeed(int rate);
+    void setLoop(bool repeat);
+    void setAlwaysSend(bool always);
+    void start();
+    void stop();
+    static void signalHandler(int signal);
+private slots:
+    void onNewConnection();
+    void onClientData();
+    void onClientDisconnected();
+    void onPtyReadable();
+    void onPtyWritable();
+    void onTick();
+private:
+// Message formats of the firmware
+    void printLine(const QByteArray& line);
+    void dataMessageSend(const char* ident, int param1, int param2);
+    void sendResponse(const char* ident, int parameter);
+    void sendString(const char* ident, const QByteArray& string);
+    void record(const QByteArray& line);
+    void recordSingle(const char* ident, int parameter);
+    void recordDual(const char* ident, int param1, int param2);
+    void transmit(const QByteArray& data);
+    qint64 pendingBytes() const;
+    qint64 deviceElapsed() const;
+    void receive(const QByteArray& data);
+    void parseSequencedCommand(const QByteArray& line);
+    void parseCommand(const QByteArray& line);
+    void actionCommand(const QByteArray& line);
+    void dataCommand(const QByteArray& line);
+    void parameterCommand(const QByteArray& line);
+    void fileCommand(const QByteArray& line);
+    QByteArray directoryEntry(int index) const;
+    void sendSyntheticBlock(qint64 time);
+    bool sendReplayBlock();
+    int controls() const;
+    void setDefaults();
+// Links
+    QTcpServer* server;
+    QTcpSocket* client;
+    int ptyMaster;
+    int ptySlave;
+    QSocketNotifier* ptyRead;
+    QSocketNotifier* ptyWrite;
+    QByteArray ptyPending;
+    int ptyWritten;
+    QByteArray input;
+    bool discarding;
+    QList<int> sequenceHistory;
+// Device state
+    EmulatorConfig config;
+    EmulatorConfig configBackup;
+    bool transactionOpen;
+    bool transactionFailed;
+    int transactionCount;
+    quint16 transactionChecksum;
+    int switches;
+    int decision;
+    int indicators;
+    double charge[3];
+    qint64 timeOffset;
+// Emulated files
+    QMap<QString,QByteArray> files;
+    QString writeFileName;
+    QString readFileName;
+    int writeFileHandle;
+    int readFileHandle;
+    int readPosition;
+    int directoryIndex;
+// Replay of a raw log
+    QList<QByteArray> replayLines;
+    QList<qint64> replayTimes;
+    int replayIndex;
+    qint64 replayStart;
+    bool loop;
+// Pacing
+    QTimer tick;
+    QElapsedTimer clock;
+    qint64 lastReceived;
+    qint64 nextBlock;
+    int speed;
+    bool alwaysSend;
+// Statistics
+    qint64 linesSent;
+    qint64 bytesSent;
+    qint64 blocksSent;
+    qint64 blocksDropped;
+    qint64 commandsReceived;
+};
+
+#endif
@@ -0,0 +1,144 @@
+/*       Power Management Device Emulator Main Program
+
+Emulates the serial interface of the BMS for testing the GUIs and capture tools
+without the board.
+
+Call with power-management-emulator [options]
+
+-t   serve a pseudo terminal in place of the TCP port
+-p   TCP port (6666 default)
+-l   raw log file to replay in place of synthetic telemetry
+-L   start the replay again when the log ends
+-s   speed as a multiple of real time (1 to 1000, 1 default)
+-k   send without waiting for the keep-alive from the GUI
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include <unistd.h>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include "power-management-emulator.h"
+#include <QCoreApplication>
+
+//-----------------------------------------------------------------------------
+/** @brief Power Management Device Emulator Main Program
+
+*/
+
+int main(int argc,char ** argv)
+{
+/* Interpret any command line options */
+    int c;
+    opterr = 0;
+    bool usePty = false;
+    uint tcpPort = DEFAULT_TCP_PORT;
+    QString replayFile;
+    bool loop = false;
+    int speed = 1;
+    bool alwaysSend = false;
+    while ((c = getopt (argc, argv, "tp:l:Ls:k")) != -1)
+    {
+        switch (c)
+        {
+// Pseudo terminal
+        case 't':
+            usePty = true;
+            break;
+// TCP port number
+        case 'p':
+            tcpPort = atoi(optarg);
+            break;
+// Raw log to replay
+        case 'l':
+            replayFile = optarg;
+            break;
+// Repeat the replay
+        case 'L':
+            loop = true;
+            break;
+// Speed as a multiple of real time
+        case 's':
+            speed = atoi(optarg);
+            if ((speed < 1) || (speed > MAX_SPEED))
+            {
+                fprintf (stderr, "Invalid speed %i.\n", speed);
+                return 1;
+            }
+            break;
+// Ignore the keep-alive
+        case 'k':
+            alwaysSend = true;
+            break;
+// Unknown
+        case '?':
+            if ((optopt == 'p') || (optopt == 'l') || (optopt == 's'))
+                fprintf (stderr, "Option -%c requires an argument.\n", optopt);
+            else if (isprint (optopt))
+                fprintf (stderr, "Unknown option `-%c'.\n", optopt);
+            else
+                fprintf (stderr,"Unknown option character `\\x%x'.\n",optopt);
+            default: return 1;
+        }
+    }
+
+    QCoreApplication application(argc,argv);
+    DeviceEmulator emulator;
+    if (! replayFile.isEmpty())
+    {
+        QString error;
+        if (! emulator.loadReplay(replayFile,&error))
+        {
+            fprintf (stderr, "%s\n", qPrintable(error));
+            return 1;
+        }
+    }
+    if (usePty)
+    {
+        QString device = emulator.openPty();
+        if (device.isEmpty())
+        {
+            fprintf (stderr, "Could not create a pseudo terminal.\n");
+            return 1;
+        }
+        printf ("Serial port %s\n", qPrintable(device));
+    }
+    else if (! emulator.listenTcp(tcpPort))
+    {
+        fprintf (stderr, "Could not listen on port %u.\n", tcpPort);
+        return 1;
+    }
+    else printf ("Listening on port %u\n", tcpPort);
+    fflush(stdout);
+    emulator.setSpeed(speed);
+    emulator.setLoop(loop);
+    emulator.setAlwaysSend(alwaysSend);
+    signal(SIGINT, DeviceEmulator::signalHandler);
+    signal(SIGTERM, DeviceEmulator::signalHandler);
+    emulator.start();
+    return application.exec();
+}
@@ -0,0 +1,17 @@
+PROJECT =       Power Management Device Emulator
+TEMPLATE =      app
+TARGET          = power-management-emulator
+DEPENDPATH      += .
+QT              -= gui
+QT              += network
+
+OBJECTS_DIR     = obj
+MOC_DIR         = moc
+LANGUAGE        = C++
+CONFIG          += qt warn_on release console
+CONFIG          -= app_bundle
+
+# Input
+HEADERS         += power-management-emulator.h
+SOURCES         += power-management.cpp
+SOURCES         += power-management-emulator.cpp
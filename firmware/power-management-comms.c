@@ -59,16 +59,53 @@ Initial 29 September 2013
 #include "power-management-time.h"
 #include "ff.h"
 
+/*--------------------------------------------------------------------------*/
+/* Local Types */
+/* The configurable parameters, those set by parameter commands within a
+configuration transaction. Transient state such as the sending and recording
+controls is left out, so that a rollback does not undo changes to it made
+during the transaction. Ordered from largest to smallest with a spare byte,
+so that the structure holds no padding. */
+struct ConfigParameters
+{
+    uint16_t batteryCapacity[NUM_BATS];
+    int16_t absorptionVoltage[NUM_BATS];
+    int16_t floatVoltage[NUM_BATS];
+    int16_t floatStageCurrentScale[NUM_BATS];
+    int16_t bulkCurrentLimitScale[NUM_BATS];
+    int16_t alphaR;
+    int16_t alphaV;
+    int16_t alphaC;
+    int16_t lowVoltage;
+    int16_t criticalVoltage;
+    int16_t lowSoC;
+    int16_t criticalSoC;
+    int16_t floatBulkSoC;
+    int16_t restTime;
+    uint16_t absorptionTime;
+    int16_t minDutyCycle;
+    int16_t floatTime;
+    uint8_t batteryType[NUM_BATS];
+    uint8_t monitorStrategy;
+    uint8_t chargerStrategy;
+    uint8_t spare;
+};
+
 /*--------------------------------------------------------------------------*/
 /* Local Prototypes */
 static void initGlobals(void);
 static void parseCommand(uint8_t* line);
+static void parseSequencedCommand(uint8_t* line);
+static void clearSequenceHistory(void);
 static void resetCallback(xTimerHandle resethandle);
 static void lapseCommsCallback(xTimerHandle lapseCommsTimer);
 static void commsPrintInt(int32_t value);
 static void commsPrintHex(uint32_t value);
 static void commsPrintString(char *ch);
 static void commsPrintChar(char *ch);
+static void commsPrintBase64(uint8_t* data, uint16_t length);
+static void saveConfigParameters(struct ConfigParameters* parameters);
+static void restoreConfigParameters(struct ConfigParameters* parameters);
 
 /*--------------------------------------------------------------------------*/
 /* Global Variables */
@@ -86,6 +123,7 @@ xSemaphoreHandle commsSendSemaphore, commsEmptySemaphore;
 /* FreeRTOS queue to receive command responses, defined in File */
 extern xQueueHandle fileReceiveQueue;
 extern xSemaphoreHandle fileSendSemaphore;
+extern uint8_t fileBulkBuffer[];
 
 /*--------------------------------------------------------------------------*/
 /* Local Variables */
@@ -96,6 +134,17 @@ static uint8_t writeFileHandle;
 static uint8_t readFileHandle;
 static int lapseCommsID;
 static xTimerHandle lapseCommsTimer;
+/* Configuration transaction: the configurable parameters as they were when
+opened, and the progress of the parameter frames received since. */
+static struct ConfigParameters configBackup;
+static bool transactionOpen;
+static bool transactionFailed;
+static uint16_t transactionCount;
+static uint16_t transactionChecksum;
+/* Sequence numbers of the last commands acknowledged, to recognise those sent
+again after their acknowledgement was lost. */
+static uint16_t sequenceHistory[COMMS_SEQUENCE_HISTORY];
+static uint8_t sequenceIndex;
 
 /*--------------------------------------------------------------------------*/
 /** @brief Communications Receive Task
@@ -108,8 +157,8 @@ void prvCommsTask(void *pvParameters)
 {
     pvParameters = pvParameters;
 
-    static uint8_t line[80];
-    static uint8_t characterPosition = 0;
+    static uint8_t line[COMMS_LINE_SIZE];
+    static uint16_t characterPosition = 0;
 
     initGlobals();
 
@@ -123,12 +172,12 @@ seconds */
 indefinitely waiting for input. */
         char character;
         xQueueReceive(commsReceiveQueue,&character,portMAX_DELAY);
-        if ((character == 0x0D) || (character == 0x0A) || (characterPosition > 78))
+        if ((character == 0x0D) || (character == 0x0A) || (characterPosition > COMMS_LINE_SIZE-2))
         {
             if (lapseCommsTimer != NULL) xTimerReset(lapseCommsTimer,0);
             line[characterPosition] = 0;
             characterPosition = 0;
-            parseCommand(line);
+            parseSequencedCommand(line);
         }
         else line[characterPosition++] = character;
     }
@@ -163,6 +212,136 @@ static void initGlobals(void)
     readFileName[0] = 0;
     writeFileHandle = 0xFF;
     readFileHandle = 0xFF;
+    transactionOpen = false;
+    clearSequenceHistory();
+}
+
+/*--------------------------------------------------------------------------*/
+/** @brief Forget the sequence numbers of commands already acknowledged
+
+*/
+
+static void clearSequenceHistory(void)
+{
+    uint8_t i;
+    for (i=0; i<COMMS_SEQUENCE_HISTORY; i++) sequenceHistory[i] = 0xFFFF;
+    sequenceIndex = 0;
+}
+
+/*--------------------------------------------------------------------------*/
+/** @brief Copy the configurable parameters out of the configuration
+
+@param[out] parameters: struct ConfigParameters* copy of the parameters.
+*/
+
+static void saveConfigParameters(struct ConfigParameters* parameters)
+{
+    uint8_t i;
+    for (i=0; i<NUM_BATS; i++)
+    {
+        parameters->batteryCapacity[i] = configData.config.batteryCapacity[i];
+        parameters->absorptionVoltage[i] = configData.config.absorptionVoltage[i];
+        parameters->floatVoltage[i] = configData.config.floatVoltage[i];
+        parameters->floatStageCurrentScale[i] =
+            configData.config.floatStageCurrentScale[i];
+        parameters->bulkCurrentLimitScale[i] =
+            configData.config.bulkCurrentLimitScale[i];
+        parameters->batteryType[i] = (uint8_t)configData.config.batteryType[i];
+    }
+    parameters->alphaR = configData.config.alphaR;
+    parameters->alphaV = configData.config.alphaV;
+    parameters->alphaC = configData.config.alphaC;
+    parameters->lowVoltage = configData.config.lowVoltage;
+    parameters->criticalVoltage = configData.config.criticalVoltage;
+    parameters->lowSoC = configData.config.lowSoC;
+    parameters->criticalSoC = configData.config.criticalSoC;
+    parameters->floatBulkSoC = configData.config.floatBulkSoC;
+    parameters->restTime = configData.config.restTime;
+    parameters->absorptionTime = configData.config.absorptionTime;
+    parameters->minDutyCycle = configData.config.minDutyCycle;
+    parameters->floatTime = configData.config.floatTime;
+    parameters->monitorStrategy = configData.config.monitorStrategy;
+    parameters->chargerStrategy = configData.config.chargerStrategy;
+    parameters->spare = 0;
+}
+
+/*--------------------------------------------------------------------------*/
+/** @brief Copy the configurable parameters back into the configuration
+
+@param[in] parameters: struct ConfigParameters* parameters to restore.
+*/
+
+static void restoreConfigParameters(struct ConfigParameters* parameters)
+{
+    uint8_t i;
+    for (i=0; i<NUM_BATS; i++)
+    {
+        configData.config.batteryCapacity[i] = parameters->batteryCapacity[i];
+        configData.config.absorptionVoltage[i] = parameters->absorptionVoltage[i];
+        configData.config.floatVoltage[i] = parameters->floatVoltage[i];
+        configData.config.floatStageCurrentScale[i] =
+            parameters->floatStageCurrentScale[i];
+        configData.config.bulkCurrentLimitScale[i] =
+            parameters->bulkCurrentLimitScale[i];
+        configData.config.batteryType[i] = (battery_Type)parameters->batteryType[i];
+    }
+    configData.config.alphaR = parameters->alphaR;
+    configData.config.alphaV = parameters->alphaV;
+    configData.config.alphaC = parameters->alphaC;
+    configData.config.lowVoltage = parameters->lowVoltage;
+    configData.config.criticalVoltage = parameters->criticalVoltage;
+    configData.config.lowSoC = parameters->lowSoC;
+    configData.config.criticalSoC = parameters->criticalSoC;
+    configData.config.floatBulkSoC = parameters->floatBulkSoC;
+    configData.config.restTime = parameters->restTime;
+    configData.config.absorptionTime = parameters->absorptionTime;
+    configData.config.minDutyCycle = parameters->minDutyCycle;
+    configData.config.floatTime = parameters->floatTime;
+    configData.config.monitorStrategy = parameters->monitorStrategy;
+    configData.config.chargerStrategy = parameters->chargerStrategy;
+}
+
+/*--------------------------------------------------------------------------*/
+/** @brief Parse a command line that may carry a sequence number.
+
+A line "#n,c" carries a sequence number n (0-255) ahead of an ordinary command
+c. The command is acted on and then acknowledged with "aK,n", so that the host
+can keep several commands outstanding and send again any not acknowledged.
+
+A command whose number is among the last COMMS_SEQUENCE_HISTORY received has
+been sent again because its acknowledgement was lost. It is acknowledged again
+but not repeated. Lines without a sequence number are parsed as before.
+
+@param[in] line: uint8_t* pointer to the command line in ASCII
+*/
+
+static void parseSequencedCommand(uint8_t* line)
+{
+    uint8_t i;
+    if (line[0] != '#')
+    {
+        parseCommand(line);
+        return;
+    }
+    char* command = (char*)line+1;
+    uint16_t sequence = asciiToInt(command);
+    while ((*command >= '0') && (*command <= '9')) command++;
+    if ((*command != ',') || (sequence > 255)) return;
+    command++;
+    bool repeated = false;
+    for (i=0; i<COMMS_SEQUENCE_HISTORY; i++)
+        if (sequenceHistory[i] == sequence) repeated = true;
+    if (! repeated)
+    {
+        sequenceHistory[sequenceIndex] = sequence;
+        sequenceIndex = (sequenceIndex+1) % COMMS_SEQUENCE_HISTORY;
+        parseCommand((uint8_t*)command);
+    }
+    if (! xSemaphoreTake(commsSendSemaphore,COMMS_SEND_DELAY)) return;
+    commsPrintString("aK,");
+    commsPrintInt(sequence);
+    commsPrintString("\r\n");
+    xSemaphoreGive(commsSendSemaphore);
 }
 
 /*--------------------------------------------------------------------------*/
@@ -171,7 +350,7 @@ static void initGlobals(void)
 Commands to and from the BMS are single line ASCII text strings consisting of
 a category character (a=action, d=data request, p=parameter, f=file) followed
 by an upper case command character and an arbitrary length set of parameters
-(limited to 80 character line length in total).
+(limited to COMMS_LINE_SIZE characters in total).
 
 Unrecognizable messages are just discarded.
 
@@ -226,6 +405,96 @@ released. The command is followed by an interface number n=0-5 being batteries
                 break;
             }
 /**
+<li> <b>T</b> Open a configuration transaction. The configurable parameters
+are saved so that they can be restored if any parameter frame of the
+transaction is lost. */
+        case 'T':
+            {
+                saveConfigParameters(&configBackup);
+                transactionOpen = true;
+                transactionFailed = false;
+                transactionCount = 0;
+                transactionChecksum = 0;
+                break;
+            }
+/**
+<li> <b>Pc,p;p;...</b> Set a frame of parameters within a transaction. Each p
+is a parameter command without its leading 'p', as "T1100". c is the CRC of
+all characters after the comma. A frame with a bad CRC is not applied and
+causes the transaction to be rolled back when committed. The CRCs of the frames
+applied are summed, so that the sum does not depend on the order of arrival. */
+        case 'P':
+            {
+                if (! transactionOpen) break;
+                char* item = (char*)line+2;
+                uint16_t crc = asciiToInt(item);
+                while ((*item >= '0') && (*item <= '9')) item++;
+                if ((*item != ',') ||
+                    (crc16((uint8_t*)item+1,stringLength(item+1)) != crc))
+                {
+                    transactionFailed = true;
+                    break;
+                }
+                transactionChecksum += crc;
+/* Each separator in turn is overwritten by 'p' to form a parameter command,
+and the following separator by a terminator while that command is parsed. */
+                while (*item > 0)
+                {
+                    char* end = item+1;
+                    while ((*end > 0) && (*end != ';')) end++;
+                    char separator = *end;
+                    *end = 0;
+                    *item = 'p';
+                    if (item[1] > 0)
+                    {
+                        parseCommand((uint8_t*)item);
+                        transactionCount++;
+                    }
+                    *end = separator;
+                    item = end;
+                }
+                break;
+            }
+/**
+<li> <b>Cn,s</b> Commit a configuration transaction of n parameters whose
+frames have CRCs summing to s. The configuration is written to FLASH once if all
+frames were applied and they match n and s, otherwise the parameters saved when
+the transaction was opened are restored. A frame that was lost and is sent
+again only after the commit therefore rolls the transaction back rather than
+leaving a partial set in FLASH. The response pW carries the number of
+parameters written, or -1 if rolled back, and the sum of the frame CRCs
+applied. */
+        case 'C':
+            {
+                if (! transactionOpen) break;
+                char* item = (char*)line+2;
+                int32_t expectedCount = asciiToInt(item);
+                uint16_t expectedChecksum = 0;
+                int32_t count = transactionCount;
+                while ((*item >= '0') && (*item <= '9')) item++;
+                if (*item == ',') expectedChecksum = asciiToInt(item+1);
+                if (transactionFailed || (*item != ',') ||
+                    (expectedCount != transactionCount) ||
+                    (expectedChecksum != transactionChecksum))
+                {
+                    restoreConfigParameters(&configBackup);
+                    count = -1;
+                }
+                else writeConfigBlock();
+                transactionOpen = false;
+                dataMessageSend("pW",count,transactionChecksum);
+                break;
+            }
+/**
+<li> <b>K</b> Start a new numbering of sequenced commands. Sent by the host when
+it connects, so that its first numbers are not mistaken for repeats of those
+used by an earlier connection. */
+        case 'K':
+            {
+                clearSequenceHistory();
+                break;
+            }
+/**
 <li> <b>E</b> Send an ident response */
         case 'E':
             {
@@ -562,8 +831,10 @@ Rfilename   - Open file read only. Filename is 8.3 string style. Returns handle.
 Xfilename   - Delete the file. Filename is 8.3 string style.
 Cxx         - Close file. x is the file handle.
 Gxx         - Read a record from read or write file.
+Bn          - Bulk read of chunk n of the read file.
 Ddirname    - Get a directory listing. Directory name is 8.3 string style.
 d[dirname]  - Get the first (if dirname present) or next entry in directory.
+Ln,dirname  - Get a page of entries in directory starting at entry n.
 s           - Get status of open files and configData.config.recording flag
 M           - Mount the SD card.
 All commands return an error status byte at the end.
@@ -753,6 +1024,58 @@ request. */
                 break;
             }
 /**
+<li> <b>Bn</b> Bulk read of chunk n of the read file. The chunk of FILE_BULK_SIZE
+bytes starting at n times FILE_BULK_SIZE is sent as "fb,n,length,crc,data" with
+the data in base64 and the CRC over the bytes before encoding. A length less
+than FILE_BULK_SIZE marks the end of the file. Each chunk stands alone, so the
+GUI can ask for several before the first arrives and ask again for any that
+are lost or corrupted. The whole line must fit in the send queue, as
+commsPrintChar resets the queue rather than wait on a full one with the Tx
+interrupt disabled. FILE_BULK_SIZE is chosen so that the encoded line of about
+370 characters fits inside COMMS_QUEUE_SIZE, and the chunk waits for the queue
+to empty before it is sent. Other messages may be sent between chunks. */
+            case 'B':
+            {
+                if (! xSemaphoreTake(commsSendSemaphore,COMMS_SEND_TIMEOUT))
+                    break;
+                uint8_t fileStatus = FR_INT_ERR;
+                uint32_t chunk = asciiToInt((char*)line+2);
+                if (xSemaphoreTake(fileSendSemaphore,COMMS_FILE_TIMEOUT))
+                {
+                    uint8_t parameters[5];
+                    uint8_t i;
+                    parameters[0] = readFileHandle;
+                    for (i=0; i<4; i++) parameters[i+1] = (chunk >> 8*i) & 0xFF;
+                    sendFileCommand('B',5,parameters);
+                    uint16_t numRead = 0;
+                    for (i=0; i<2; i++)
+                    {
+                        uint8_t lengthByte = 0;
+                        xQueueReceive(fileReceiveQueue,&lengthByte,portMAX_DELAY);
+                        numRead |= (lengthByte << 8*i);
+                    }
+                    xQueueReceive(fileReceiveQueue,&fileStatus,portMAX_DELAY);
+                    if (fileStatus == FR_OK)
+                    {
+                        while (uxQueueMessagesWaiting(commsSendQueue) > 0)
+                            xSemaphoreTake(commsEmptySemaphore,portMAX_DELAY);
+                        commsPrintString("fb,");
+                        commsPrintInt(chunk);
+                        commsPrintString(",");
+                        commsPrintInt(numRead);
+                        commsPrintString(",");
+                        commsPrintInt(crc16(fileBulkBuffer,numRead));
+                        commsPrintString(",");
+                        commsPrintBase64(fileBulkBuffer,numRead);
+                        commsPrintString("\r\n");
+                    }
+                    xSemaphoreGive(fileSendSemaphore);
+                }
+                xSemaphoreGive(commsSendSemaphore);
+                sendResponse("fE",(uint8_t)fileStatus);
+                break;
+            }
+/**
 <li> <b>Dd</b> Get a directory listing d=dirname. Directory name is 8.3 string
 style. Gets all items in the directory and sends the type,size and name, each
 group preceded by a comma. The file command requests each entry in turn,
@@ -867,6 +1190,97 @@ no further entries found in the directory, then an empty string is sent back. */
                 break;
             }
 /**
+<li> <b>Ln,d</b> Get a page of the directory listing d=dirname starting from
+entry n, which is zero for the first page. Up to DIRECTORY_BATCH entries are
+sent in one message "fL,t,entries" with each entry being the type, size and
+name preceded by a comma as for the full listing. t is the continuation token
+to send as n for the next page, or zero when the listing has ended. The file
+task keeps its place in the directory so a page following on from the last
+does not read the directory again from the start. */
+            case 'L':
+            {
+                if (! xSemaphoreTake(commsSendSemaphore,COMMS_SEND_TIMEOUT))
+                    break;
+                uint8_t fileStatus = FR_INT_ERR;
+                if (xSemaphoreTake(fileSendSemaphore,COMMS_FILE_TIMEOUT))
+                {
+                    static char batch[DIRECTORY_BATCH*DIRECTORY_ENTRY_SIZE+1];
+                    uint16_t length = 0;
+                    uint8_t count = 0;
+                    bool ended = false;
+                    uint16_t token = asciiToInt((char*)line+2);
+                    char* name = (char*)line+2;
+                    while ((*name >= '0') && (*name <= '9')) name++;
+                    if (*name == ',') name++;
+                    uint8_t parameters[15];
+                    uint8_t i = 0;
+                    parameters[0] = token & 0xFF;
+                    parameters[1] = (token >> 8) & 0xFF;
+                    while ((i < 12) && (name[i] > 0))
+                    {
+                        parameters[i+2] = name[i];
+                        i++;
+                    }
+                    for (; i<13; i++) parameters[i+2] = 0;
+                    sendFileCommand('L',15,parameters);
+                    do
+                    {
+                        char type = 0;
+/* Single character entry type */
+                        xQueueReceive(fileReceiveQueue,&type,portMAX_DELAY);
+                        char character;
+/* Four bytes of file size */
+                        uint32_t fileSize = 0;
+                        for (i=0; i<4; i++)
+                        {
+                            character = 0;
+                            xQueueReceive(fileReceiveQueue,&character,portMAX_DELAY);
+                            fileSize = (fileSize << 8) + (uint8_t)character;
+                        }
+/* Filename. If the first character of name is zero then the listing is ended */
+                        character = 0;
+                        xQueueReceive(fileReceiveQueue,&character,portMAX_DELAY);
+                        ended = (character == 0);
+                        if (! ended)
+                        {
+                            batch[length++] = ',';
+                            batch[length++] = type;
+                            for (i=0; i<8; i++)
+                                batch[length++] =
+                                    "0123456789ABCDEF"[(fileSize >> (28-4*i)) & 0xF];
+                            while (character > 0)
+                            {
+                                if (length < DIRECTORY_BATCH*DIRECTORY_ENTRY_SIZE)
+                                    batch[length++] = character;
+                                character = 0;
+                                xQueueReceive(fileReceiveQueue,&character,portMAX_DELAY);
+                            }
+                            count++;
+                        }
+                        xQueueReceive(fileReceiveQueue,&fileStatus,portMAX_DELAY);
+/* Send a zero parameter to ask for the next entry */
+                        if (! ended && (count < DIRECTORY_BATCH))
+                        {
+                            uint8_t eol = 0;
+                            sendFileCommand('D',1,&eol);
+                        }
+                    }
+                    while (! ended && (count < DIRECTORY_BATCH));
+                    batch[length] = 0;
+                    xSemaphoreGive(fileSendSemaphore);
+/* Wait for room for the whole page so that it is not dropped. */
+                    while (uxQueueMessagesWaiting(commsSendQueue) > 0)
+                        xSemaphoreTake(commsEmptySemaphore,portMAX_DELAY);
+                    commsPrintString("fL,");
+                    commsPrintInt(ended ? 0 : token+count);
+                    commsPrintString(batch);
+                    commsPrintString("\r\n");
+                }
+                xSemaphoreGive(commsSendSemaphore);
+                sendResponse("fE",(uint8_t)fileStatus);
+                break;
+            }
+/**
 <li> <b>M</b> Register (mount or remount) the SD card. */
             case 'M':
             {
@@ -1261,6 +1675,37 @@ void commsPrintString(char *ch)
         while(*ch) commsPrintChar(ch++);
 }
 
+/*--------------------------------------------------------------------------*/
+/** @brief Print a Block of Bytes in Base64
+
+Each group of three bytes is sent as four characters, with the last group
+padded by '='. Characters are queued one at a time, so the caller must make
+sure that the whole line fits in the free space of the send queue.
+
+@param[in] data: uint8_t* block of bytes.
+@param[in] length: uint16_t number of bytes.
+*/
+
+void commsPrintBase64(uint8_t* data, uint16_t length)
+{
+    static const char* alphabet =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    uint16_t i;
+    for (i=0; i<length; i+=3)
+    {
+        uint32_t group = data[i] << 16;
+        if (i+1 < length) group |= data[i+1] << 8;
+        if (i+2 < length) group |= data[i+2];
+        char character[4];
+        character[0] = alphabet[(group >> 18) & 0x3F];
+        character[1] = alphabet[(group >> 12) & 0x3F];
+        character[2] = (i+1 < length) ? alphabet[(group >> 6) & 0x3F] : '=';
+        character[3] = (i+2 < length) ? alphabet[group & 0x3F] : '=';
+        uint8_t j;
+        for (j=0; j<4; j++) commsPrintChar(character+j);
+    }
+}
+
 /*--------------------------------------------------------------------------*/
 /** @brief Print a Character
 
@@ -34,11 +34,21 @@ Initial 29 September 2013
 #include <stdbool.h>
 
 #define COMMS_QUEUE_SIZE            512
+/* Longest command line, enough for a frame of configuration parameters */
+#define COMMS_LINE_SIZE             256
+/* Sequence numbers of acknowledged commands remembered to detect repeats. The
+host must keep fewer commands than this outstanding. */
+#define COMMS_SEQUENCE_HISTORY      16
 #define COMMS_SEND_DELAY            ((portTickType)1000/portTICK_RATE_MS)
 #define COMMS_SEND_TIMEOUT          ((portTickType)2000/portTICK_RATE_MS)
 
 #define COMMS_FILE_TIMEOUT          ((portTickType)1000/portTICK_RATE_MS)
 
+/* Directory entries sent in each page of a listing, and the most characters
+in an entry (comma, type, size, 8.3 name) */
+#define DIRECTORY_BATCH             16
+#define DIRECTORY_ENTRY_SIZE        22
+
 /*--------------------------------------------------------------------------*/
 /* Prototypes */
 /*--------------------------------------------------------------------------*/
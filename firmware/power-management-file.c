@@ -72,12 +72,16 @@ static void initFile(void);
 static void parseFileCommand(char *line);
 static uint8_t findFileHandle(void);
 static void deleteFileHandle(uint8_t fileHandle);
+static FRESULT sendDirectoryEntry(FRESULT fileStatus);
 
 /* FreeRTOS queues and intercommunication variables */
 xQueueHandle fileSendQueue, fileReceiveQueue;
 /* This semaphore must be used to protect messages until they have been queued
 in their entirety */
 xSemaphoreHandle fileSendSemaphore;
+/* Chunk read for a bulk transfer. This is passed by the buffer rather than over
+the queue and belongs to the holder of the fileSendSemaphore. */
+uint8_t fileBulkBuffer[FILE_BULK_SIZE];
 
 /* Local Variables */
 /* ChaN FAT */
@@ -89,6 +93,10 @@ static bool fileUsable;
 static uint8_t filemap=0;           /* map of open file handles */
 static uint8_t writeFileHandle;
 static uint8_t readFileHandle;
+/* Directory being listed, and the number of entries read from it */
+static DIR directory;
+static char directoryName[14];
+static uint16_t directoryPosition;
 /*--------------------------------------------------------------------------*/
 /** @brief File Management Task
 
@@ -163,6 +171,9 @@ R - open a file for reading. Returns a file handle.
 C - close a file.
 S - store a block of data.
 G - retrieve a block of data.
+D - directory listing, first or next entry.
+L - directory listing from a given entry.
+B - retrieve a chunk of data for a bulk transfer.
 F - Free space on drive
 
 All commands return a status value at the end of any other data sent.
@@ -320,6 +331,36 @@ differ from the number requested if EOF reached. */
             }
             break;
         }
+/* Get a chunk of data from a file for a bulk transfer. */
+/* Parameters are the filehandle followed by the chunk number as four bytes,
+lowest first. The chunk is read from the chunk number times FILE_BULK_SIZE so
+that any chunk can be asked for again after a loss. The data is left in
+fileBulkBuffer. Returns the number read as two bytes, lowest first, which is
+less than FILE_BULK_SIZE at the end of the file. */
+        case 'B':
+        {
+            uint8_t fileHandle = line[2];
+            DWORD chunk = 0;
+            UINT numRead = 0;
+            uint8_t i;
+            for (i=0; i<4; i++) chunk |= ((DWORD)(uint8_t)line[3+i] << 8*i);
+            if ((fileHandle >= MAX_OPEN_FILES) ||
+                ((filemap & (1 << fileHandle)) == 0))
+                fileStatus = FR_INVALID_OBJECT;
+            else
+            {
+/* A seek beyond the end of a read only file stops at the end. */
+                fileStatus = f_lseek(&file[fileHandle], chunk*FILE_BULK_SIZE);
+                if (fileStatus == FR_OK)
+                    fileStatus = f_read(&file[fileHandle],fileBulkBuffer,
+                                        FILE_BULK_SIZE,&numRead);
+            }
+            uint8_t lengthByte = numRead & 0xFF;
+            xQueueSendToBack(fileReceiveQueue,&lengthByte,FILE_SEND_TIMEOUT);
+            lengthByte = (numRead >> 8) & 0xFF;
+            xQueueSendToBack(fileReceiveQueue,&lengthByte,FILE_SEND_TIMEOUT);
+            break;
+        }
 /* Directory listing. */
 /* If the name is given, the directory specified is opened and the first entry
 returned. Subsequent calls with zero length name will return subsequent entries.
@@ -330,42 +371,44 @@ Preceding the name a type character:
 will be sent. */
         case 'D':
         {
-            uint8_t i = 0;
-            uint8_t numRead = 0;
-            static DIR directory;
-            FILINFO fileInfo;
             fileStatus = FR_OK;
-            if (line[2] != 0) fileStatus = f_opendir(&directory, line+2);
-            if (fileStatus == FR_OK)
-            {
-                fileStatus = f_readdir(&directory, &fileInfo);
-                numRead = stringLength(fileInfo.fname);
-            }
-            char type = 'f';
-            if (fileInfo.fattrib == AM_DIR) type = 'd';
-            if (fileInfo.fname[0] == 0) type = 'e';
-            if (fileStatus != FR_OK)
+            if (line[2] != 0)
             {
-                numRead = 0;
-                fileInfo.fname[0] = 0;
-                type = 'n';
+                fileStatus = f_opendir(&directory, line+2);
+                directoryName[0] = 0;
+                if (fileStatus == FR_OK) stringCopy(directoryName, line+2);
+                directoryPosition = 0;
             }
-/* If space on the queue, send the type (char), four bytes of file size (MSB
-first) and null terminated filename */
-            if ((uint16_t)uxQueueSpacesAvailable(fileReceiveQueue) >= numRead+2)
+            fileStatus = sendDirectoryEntry(fileStatus);
+            break;
+        }
+/* Directory listing from a given entry. */
+/* Parameters are the entry number as two bytes, lowest first, followed by the
+directory name. The entry is returned as for D, and subsequent entries are
+returned by D with a zero length name. The directory is only opened again and
+read up to the entry if the entry does not follow on from the last one read,
+so a listing taken a page at a time reads each entry once. */
+        case 'L':
+        {
+            uint16_t entry = (uint8_t)line[2] | ((uint8_t)line[3] << 8);
+            fileStatus = FR_OK;
+            if ((entry != directoryPosition) || (directoryName[0] == 0) ||
+                ! stringEqual(line+4, directoryName) ||
+                (stringLength(line+4) != stringLength(directoryName)))
             {
-                xQueueSendToBack(fileReceiveQueue,&type,FILE_SEND_TIMEOUT);
-                uint8_t fileSizeByte = (fileInfo.fsize >> 24) & 0xFF;
-                xQueueSendToBack(fileReceiveQueue,&fileSizeByte,FILE_SEND_TIMEOUT);
-                fileSizeByte = (fileInfo.fsize >> 16) & 0xFF;
-                xQueueSendToBack(fileReceiveQueue,&fileSizeByte,FILE_SEND_TIMEOUT);
-                fileSizeByte = (fileInfo.fsize >> 8) & 0xFF;
-                xQueueSendToBack(fileReceiveQueue,&fileSizeByte,FILE_SEND_TIMEOUT);
-                fileSizeByte = fileInfo.fsize & 0xFF;
-                xQueueSendToBack(fileReceiveQueue,&fileSizeByte,FILE_SEND_TIMEOUT);
-                for (i=0; i<numRead+1; i++)
-                    xQueueSendToBack(fileReceiveQueue,fileInfo.fname+i,FILE_SEND_TIMEOUT);
+                fileStatus = f_opendir(&directory, line+4);
+                directoryName[0] = 0;
+                if (fileStatus == FR_OK) stringCopy(directoryName, line+4);
+                directoryPosition = 0;
+                FILINFO skipInfo;
+                while ((fileStatus == FR_OK) && (directoryPosition < entry))
+                {
+                    fileStatus = f_readdir(&directory, &skipInfo);
+                    if ((fileStatus != FR_OK) || (skipInfo.fname[0] == 0)) break;
+                    directoryPosition++;
+                }
             }
+            fileStatus = sendDirectoryEntry(fileStatus);
             break;
         }
 /* Read the free space on the drive. */
@@ -455,6 +498,60 @@ Checks the filename and handle for the write and read files, if they are open. *
     xQueueSendToBack(fileReceiveQueue,&fileStatus,FILE_SEND_TIMEOUT);
 }
 
+/*--------------------------------------------------------------------------*/
+/** @brief Read and Send the Next Directory Entry
+
+The next entry is read from the open directory and sent back on the queue as
+the type (char), four bytes of file size (MSB first) and null terminated
+filename. The type is f = file, d = directory, n = error e = end. At the end,
+or on error, a zero length name is sent.
+
+@param[in] fileStatus: FRESULT status of opening the directory, if it was.
+@returns FRESULT status of the read.
+*/
+
+static FRESULT sendDirectoryEntry(FRESULT fileStatus)
+{
+    uint8_t i = 0;
+    uint8_t numRead = 0;
+    FILINFO fileInfo;
+    fileInfo.fname[0] = 0;
+    fileInfo.fsize = 0;
+    fileInfo.fattrib = 0;
+    if (fileStatus == FR_OK)
+    {
+        fileStatus = f_readdir(&directory, &fileInfo);
+        numRead = stringLength(fileInfo.fname);
+    }
+    char type = 'f';
+    if (fileInfo.fattrib == AM_DIR) type = 'd';
+    if (fileInfo.fname[0] == 0) type = 'e';
+    else directoryPosition++;
+    if (fileStatus != FR_OK)
+    {
+        numRead = 0;
+        fileInfo.fname[0] = 0;
+        type = 'n';
+    }
+/* If space on the queue, send the type (char), four bytes of file size (MSB
+first) and null terminated filename */
+    if ((uint16_t)uxQueueSpacesAvailable(fileReceiveQueue) >= numRead+2)
+    {
+        xQueueSendToBack(fileReceiveQueue,&type,FILE_SEND_TIMEOUT);
+        uint8_t fileSizeByte = (fileInfo.fsize >> 24) & 0xFF;
+        xQueueSendToBack(fileReceiveQueue,&fileSizeByte,FILE_SEND_TIMEOUT);
+        fileSizeByte = (fileInfo.fsize >> 16) & 0xFF;
+        xQueueSendToBack(fileReceiveQueue,&fileSizeByte,FILE_SEND_TIMEOUT);
+        fileSizeByte = (fileInfo.fsize >> 8) & 0xFF;
+        xQueueSendToBack(fileReceiveQueue,&fileSizeByte,FILE_SEND_TIMEOUT);
+        fileSizeByte = fileInfo.fsize & 0xFF;
+        xQueueSendToBack(fileReceiveQueue,&fileSizeByte,FILE_SEND_TIMEOUT);
+        for (i=0; i<numRead+1; i++)
+            xQueueSendToBack(fileReceiveQueue,fileInfo.fname+i,FILE_SEND_TIMEOUT);
+    }
+    return fileStatus;
+}
+
 /*--------------------------------------------------------------------------*/
 /** @brief Find a file handle
 
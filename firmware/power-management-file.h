@@ -32,6 +32,9 @@ Initial 1 October 2013
 #define FILE_SEND_TIMEOUT          ((portTickType)2000/portTICK_RATE_MS)
 
 #define MAX_OPEN_FILES              2
+/* Bytes read for each chunk of a bulk transfer. The base64 line of a chunk of
+this size is about 370 characters, well inside COMMS_QUEUE_SIZE. */
+#define FILE_BULK_SIZE              256
 
 /*--------------------------------------------------------------------------*/
 /* Prototypes */
@@ -156,5 +156,33 @@ uint16_t stringEqual(char* string1,char* string2)
     return 1;
 }
 
+/*--------------------------------------------------------------------------*/
+/** @brief CRC-16 of a Block of Bytes
+
+This is the ISO 3309 (X.25) CRC as computed by qChecksum in the GUI, taken bit
+by bit to avoid a table.
+
+@param[in] data: uint8_t* block of bytes.
+@param[in] length: uint16_t number of bytes.
+@returns uint16_t: CRC of the block.
+*/
+
+uint16_t crc16(uint8_t* data, uint16_t length)
+{
+    uint16_t crc = 0xFFFF;
+    uint16_t i;
+    uint8_t bit;
+    for (i=0; i<length; i++)
+    {
+        crc ^= data[i];
+        for (bit=0; bit<8; bit++)
+        {
+            if (crc & 1) crc = (crc >> 1) ^ 0x8408;
+            else crc >>= 1;
+        }
+    }
+    return ~crc;
+}
+
 /**@}*/
 
@@ -35,6 +35,7 @@ void stringAppend(char* string, char* appendage);
 void stringCopy(char* string, char* original);
 uint16_t stringLength(char* string);
 uint16_t stringEqual(char* string1,char* string2);
+uint16_t crc16(uint8_t* data, uint16_t length);
 
 #endif
 
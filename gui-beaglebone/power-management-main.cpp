@@ -35,7 +35,6 @@ detailed monitoring and for configuration.
 
 #include "power-management.h"
 #include "power-management-main.h"
-#include "serialport.h"
 #include <QApplication>
 #include <QString>
 #include <QLineEdit>
@@ -46,11 +45,13 @@ detailed monitoring and for configuration.
 #include <QFileDialog>
 #include <QStandardItemModel>
 #include <QDateTime>
+#include <QRadioButton>
 #include <QDate>
 #include <QTimer>
 #include <QDir>
 #include <QFile>
 #include <QDebug>
+#include <cstdio>
 #include <cstdlib>
 #include <iostream>
 #include <unistd.h>
@@ -58,25 +59,30 @@ detailed monitoring and for configuration.
 //-----------------------------------------------------------------------------
 /** Power Management Main Window Constructor
 
+@param[in] device Serial device name.
 @param[in] parent Parent widget.
 */
 
-PowerManagementGui::PowerManagementGui(QWidget* parent) : QDialog(parent)
+PowerManagementGui::PowerManagementGui(QString device, QWidget* parent)
+                    : QDialog(parent), dispatcher(this)
 {
 // Build the User Interface display from the Ui class in ui_mainwindowform.h
     PowerManagementMainUi.setupUi(this);
-    socket = new SerialPort(SERIAL_PORT);
-    connect(socket, SIGNAL(readyRead()), this, SLOT(onDataAvailable()));
-// Attempt to initialise the serial port with the default setting
+// Start on the live values. The other tabs are built when first shown.
+    PowerManagementMainUi.tabWidget->setCurrentIndex(0);
+    startTime = QDateTime::currentMSecsSinceEpoch();
+    firstValueShown = false;
+    initDispatcher();
+// The port is read in the link thread when data arrives, and decoded messages
+// are taken here in batches, so nothing polls the port while it is idle.
+    socket = new Link();
+    connect(socket, SIGNAL(messagesAvailable()), this, SLOT(onMessagesAvailable()));
+// Attempt to initialise the serial port with the default setting. The port is
+// opened in the link thread and the result arrives at onLinkOpened.
     synchronized = false;
-    baudrate = 4;
-    if (socket->initPort(baudrate,100))
-        synchronized = true;
-    else
-        errorMessage = QString("Unable to access the serial port\n"
-                            "Check the connections and power.\n"
-                            "You may need root privileges?");
-    response.clear();
+    baudrate = SERIAL_BAUDRATE;
+    connect(socket, SIGNAL(opened(bool)), this, SLOT(onLinkOpened(bool)));
+    socket->openSerial(device, baudrate);
 
 // Initialize the Main GUI
     initGui();
@@ -87,16 +93,16 @@ PowerManagementGui::PowerManagementGui(QWidget* parent) : QDialog(parent)
     connect(PowerManagementMainUi.tabWidget,SIGNAL(currentChanged(int)),
             this,SLOT(tabChanged(int)));
 
-// Contact the remote unit and turn its transmissions on.
+// Contact the remote unit and turn its transmissions on. This is started from
+// the event loop so that the window is shown without waiting for it.
     if (socket != NULL)
     {
-/* Turn on microcontroller communications */
-        on_connectButton_clicked();
-// Setup a 1 second timer to check for active communications
+        responseReceived = false;
+        retryTime = STARTUP_RETRY_TIME;
         timer = new QTimer(this);
+        timer->setSingleShot(true);
         connect(timer, SIGNAL(timeout()), this, SLOT(checkCommunications()));
-        timer->start(1000);
-        responseReceived = false;
+        timer->start(0);
     }
 }
 
@@ -108,8 +114,7 @@ PowerManagementGui::~PowerManagementGui()
     if (socket != NULL)
     {
         socket->write("pc-\n\r");
-        if (socket != NULL) socket->close();
-        if (socket != NULL) delete socket;
+        delete socket;
     }
 }
 
@@ -121,42 +126,25 @@ PowerManagementGui::~PowerManagementGui()
 void PowerManagementGui::initGui()
 {
 // Uncheck all buttons in case the microcontroller doesn't respond.
-    PowerManagementMainUi.load1Battery1->setAutoExclusive(false);
-    PowerManagementMainUi.load1Battery1->setChecked(false);
-    PowerManagementMainUi.load1Battery1->setAutoExclusive(true);
-    PowerManagementMainUi.load1Battery1->setEnabled(false);
-    PowerManagementMainUi.load2Battery1->setAutoExclusive(false);
-    PowerManagementMainUi.load2Battery1->setChecked(false);
-    PowerManagementMainUi.load2Battery1->setAutoExclusive(true);
-    PowerManagementMainUi.load2Battery1->setEnabled(false);
-    PowerManagementMainUi.panelBattery1->setAutoExclusive(false);
-    PowerManagementMainUi.panelBattery1->setChecked(false);
-    PowerManagementMainUi.panelBattery1->setAutoExclusive(true);
-    PowerManagementMainUi.panelBattery1->setEnabled(false);
-    PowerManagementMainUi.load1Battery2->setAutoExclusive(false);
-    PowerManagementMainUi.load1Battery2->setChecked(false);
-    PowerManagementMainUi.load1Battery2->setAutoExclusive(true);
-    PowerManagementMainUi.load1Battery2->setEnabled(false);
-    PowerManagementMainUi.load2Battery2->setAutoExclusive(false);
-    PowerManagementMainUi.load2Battery2->setChecked(false);
-    PowerManagementMainUi.load2Battery2->setAutoExclusive(true);
-    PowerManagementMainUi.load2Battery2->setEnabled(false);
-    PowerManagementMainUi.panelBattery2->setAutoExclusive(false);
-    PowerManagementMainUi.panelBattery2->setChecked(false);
-    PowerManagementMainUi.panelBattery2->setAutoExclusive(true);
-    PowerManagementMainUi.panelBattery2->setEnabled(false);
-    PowerManagementMainUi.load1Battery3->setAutoExclusive(false);
-    PowerManagementMainUi.load1Battery3->setChecked(false);
-    PowerManagementMainUi.load1Battery3->setAutoExclusive(true);
-    PowerManagementMainUi.load1Battery3->setEnabled(false);
-    PowerManagementMainUi.load2Battery3->setAutoExclusive(false);
-    PowerManagementMainUi.load2Battery3->setChecked(false);
-    PowerManagementMainUi.load2Battery3->setAutoExclusive(true);
-    PowerManagementMainUi.load2Battery3->setEnabled(false);
-    PowerManagementMainUi.panelBattery3->setAutoExclusive(false);
-    PowerManagementMainUi.panelBattery3->setChecked(false);
-    PowerManagementMainUi.panelBattery3->setAutoExclusive(true);
-    PowerManagementMainUi.panelBattery3->setEnabled(false);
+    QRadioButton* sourceButtons[] =
+        {
+            PowerManagementMainUi.load1Battery1,
+            PowerManagementMainUi.load2Battery1,
+            PowerManagementMainUi.panelBattery1,
+            PowerManagementMainUi.load1Battery2,
+            PowerManagementMainUi.load2Battery2,
+            PowerManagementMainUi.panelBattery2,
+            PowerManagementMainUi.load1Battery3,
+            PowerManagementMainUi.load2Battery3,
+            PowerManagementMainUi.panelBattery3
+        };
+    for (uint i=0; i<sizeof(sourceButtons)/sizeof(sourceButtons[0]); i++)
+    {
+        sourceButtons[i]->setAutoExclusive(false);
+        sourceButtons[i]->setChecked(false);
+        sourceButtons[i]->setAutoExclusive(true);
+        sourceButtons[i]->setEnabled(false);
+    }
     PowerManagementMainUi.load1Current->clear();
     PowerManagementMainUi.load1Voltage->clear();
     PowerManagementMainUi.load2Current->clear();
@@ -184,40 +172,140 @@ void PowerManagementGui::initGui()
         setText("R");
 }
 
+//-----------------------------------------------------------------------------
+/** @brief Build the Recording Tab
+
+The tab is left empty by the main form so that it costs nothing at startup. Its
+contents are built here when it is first shown and connected to their slots.
+Widgets added to a tab already on screen are only shown with it, so the tab is
+hidden while they are built.
+*/
+
+void PowerManagementGui::buildRecordingTab()
+{
+    PowerManagementMainUi.recordingTab->hide();
+    PowerManagementRecordingUi.setupUi(PowerManagementMainUi.recordingTab);
+    PowerManagementMainUi.recordingTab->show();
+    connect(PowerManagementRecordingUi.newFileButton,SIGNAL(clicked()),
+            this,SLOT(onNewFileButtonClicked()));
+    connect(PowerManagementRecordingUi.recordFileButton,SIGNAL(clicked()),
+            this,SLOT(onRecordFileButtonClicked()));
+    connect(PowerManagementRecordingUi.startRecordingButton,SIGNAL(clicked()),
+            this,SLOT(onStartRecordingButtonClicked()));
+    connect(PowerManagementRecordingUi.stopRecordingButton,SIGNAL(clicked()),
+            this,SLOT(onStopRecordingButtonClicked()));
+    connect(PowerManagementRecordingUi.closeRecordingFileButton,SIGNAL(clicked()),
+            this,SLOT(onCloseRecordingFileButtonClicked()));
+    connect(PowerManagementRecordingUi.registerButton,SIGNAL(clicked()),
+            this,SLOT(onRegisterButtonClicked()));
+    connect(PowerManagementRecordingUi.refreshListButton,SIGNAL(clicked()),
+            this,SLOT(onRefreshListButtonClicked()));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Build the Configuration Tabs
+
+The configuration tabs are built together when any of them is first shown, as
+the settings requested for them fill all of them. The tab on screen is hidden
+while they are built, as for the recording tab.
+*/
+
+void PowerManagementGui::buildConfigurationTabs()
+{
+    QWidget* shownTab = PowerManagementMainUi.tabWidget->currentWidget();
+    shownTab->hide();
+    PowerManagementGeneralUi.setupUi(PowerManagementMainUi.generalTab);
+    PowerManagementBatteriesUi.setupUi(PowerManagementMainUi.batteriesTab);
+    PowerManagementCalibrationUi.setupUi(PowerManagementMainUi.calibrationTab);
+    PowerManagementSoCUi.setupUi(PowerManagementMainUi.socTab);
+    PowerManagementChargingUi.setupUi(PowerManagementMainUi.chargingTab);
+    shownTab->show();
+    connect(PowerManagementGeneralUi.timeSetButton,SIGNAL(clicked()),
+            this,SLOT(onTimeSetButtonClicked()));
+    connect(PowerManagementGeneralUi.debugMessageCheckbox,SIGNAL(clicked()),
+            this,SLOT(onDebugMessageCheckboxClicked()));
+    connect(PowerManagementGeneralUi.dataMessageCheckbox,SIGNAL(clicked()),
+            this,SLOT(onDataMessageCheckboxClicked()));
+    connect(PowerManagementGeneralUi.echoTestButton,SIGNAL(clicked()),
+            this,SLOT(onEchoTestButtonClicked()));
+    connect(PowerManagementBatteriesUi.queryBatteryButton,SIGNAL(clicked()),
+            this,SLOT(onQueryBatteryButtonClicked()));
+    connect(PowerManagementBatteriesUi.resetMissing1Button,SIGNAL(clicked()),
+            this,SLOT(onResetMissing1ButtonClicked()));
+    connect(PowerManagementBatteriesUi.resetMissing2Button,SIGNAL(clicked()),
+            this,SLOT(onResetMissing2ButtonClicked()));
+    connect(PowerManagementBatteriesUi.resetMissing3Button,SIGNAL(clicked()),
+            this,SLOT(onResetMissing3ButtonClicked()));
+    connect(PowerManagementCalibrationUi.forceZeroCurrent1,SIGNAL(clicked()),
+            this,SLOT(onForceZeroCurrent1Clicked()));
+    connect(PowerManagementCalibrationUi.forceZeroCurrent2,SIGNAL(clicked()),
+            this,SLOT(onForceZeroCurrent2Clicked()));
+    connect(PowerManagementCalibrationUi.forceZeroCurrent3,SIGNAL(clicked()),
+            this,SLOT(onForceZeroCurrent3Clicked()));
+    connect(PowerManagementCalibrationUi.calibrateButton,SIGNAL(clicked()),
+            this,SLOT(onCalibrateButtonClicked()));
+    connect(PowerManagementSoCUi.setTrackOptionButton,SIGNAL(clicked()),
+            this,SLOT(onSetTrackOptionButtonClicked()));
+    connect(PowerManagementChargingUi.absorptionMuteCheckbox,SIGNAL(clicked()),
+            this,SLOT(onAbsorptionMuteCheckboxClicked()));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Report the result of opening the serial port
+
+@param[in] ok true if the port was opened.
+*/
+
+void PowerManagementGui::onLinkOpened(bool ok)
+{
+    synchronized = ok;
+    if (ok) return;
+    errorMessage = QString("Unable to access the serial port\n"
+                        "Check the connections and power.\n"
+                        "You may need root privileges?");
+    displayErrorMessage(errorMessage);
+}
+
 //-----------------------------------------------------------------------------
 /** @brief Check if communications is active
 
 This is called when a previously established timer has timed out. The timer is
-set at the start of the GUI after a message is sent to the remote. This checks
-to see if a response had been received. If not, then the message is sent again.
+first set to run as soon as the GUI is up, to send the first message to the
+remote. Each time it checks to see if a response had been received. If not,
+then the message is sent again, with the interval doubled each time from
+STARTUP_RETRY_TIME up to COMMS_RETRY_TIME.
 */
 
 void PowerManagementGui::checkCommunications()
 {
     if (! responseReceived)
     {
-/* Try again to turn on microcontroller communications */
+/* Try to turn on microcontroller communications */
         on_connectButton_clicked();
+        timer->start(retryTime);
+        retryTime = qMin(retryTime*2, COMMS_RETRY_TIME);
     }
     else
     {
-// Stop the timer
-        timer->stop();
-        delete timer;
+// Finished with the timer
+        timer->deleteLater();
+        timer = NULL;
     }
 }
 
 //-----------------------------------------------------------------------------
 /** @brief Selection of New Tab
 
-This is called when the displayed tab is changed. It initializes the tab
-contents and requests data from the remote system. The recording tab and any of
-the configuration tabs will trigger this.
+This is called when the displayed tab is changed. It builds the tab contents,
+initializes them and requests data from the remote system. The recording tab
+and any of the configuration tabs will trigger this.
 
 Ensure that this is changed if the tab order is changed.
 
-We need to do this to avoid all parameters being requested at once, as the
-remote system queues become overloaded.
+This avoids building widgets and requesting parameters that may never be looked
+at. The requests
+that are made are paced by the link so that the remote system queues are not
+overloaded.
 */
 
 void PowerManagementGui::tabChanged(int index)
@@ -226,12 +314,14 @@ void PowerManagementGui::tabChanged(int index)
     if ((index == 1) && ! recordingInitialised)
     {
         recordingInitialised = true;
+        buildRecordingTab();
         initRecording();
     }
 // Later ones are the configuration tabs
     if ((index > 1) && ! configInitialised)
     {
         configInitialised = true;
+        buildConfigurationTabs();
         initCalibration();
     }
 }
@@ -239,1038 +329,1220 @@ void PowerManagementGui::tabChanged(int index)
 //-----------------------------------------------------------------------------
 /** @brief Handle incoming serial data
 
-This is called when data appears in the serial buffer. Data is pulled in until
-a newline occurs, at which point the assembled command QString is processed.
+This is called when the link has decoded messages waiting. All waiting messages
+are taken at once, so a burst of lines costs one event.
 
 All incoming messages are processed here and passed to other windows as
 appropriate.
 */
 
-void PowerManagementGui::onDataAvailable()
+void PowerManagementGui::onMessagesAvailable()
 {
-    QByteArray data = socket->readAll();
-    int n=0;
-    while (n < data.size())
-    {
-        if ((data.at(n) != '\r') && (data.at(n) != '\n')) response += data.at(n);
-        if (data.at(n) == '\n')
-        {
-// The current time is saved to ms precision followed by the line.
-            tick.restart();
-            processResponse(response);
-            response.clear();
-        }
-        n++;
-    }
+    if (socket == NULL) return;
+    Message message;
+    while (socket->takeMessage(&message)) processResponse(message);
 }
 
 //-----------------------------------------------------------------------------
 /** @brief Process the incoming serial data
 
-Parse the line and take action on the command received.
+Take action on the decoded message received. The dispatch table calls the
+handlers for the message id and category.
 */
 
-void PowerManagementGui::processResponse(const QString response)
+void PowerManagementGui::processResponse(const Message& message)
 {
     responseReceived = true;        // indicate that comms is happening
-    QStringList breakdown = response.split(",");
-    int size = breakdown.size();
-    QString firstField;
-    firstField = breakdown[0].simplified();
-    QString secondField;
-    if (size > 1) secondField = breakdown[1].simplified();
+    dispatcher.dispatch(message);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Show the first battery voltage without waiting for the refresh
+
+The time is reported once the frame holding it has been painted.
+*/
+
+void PowerManagementGui::showFirstValue()
+{
+    if (firstValueShown) return;
+    firstValueShown = true;
+    display.refresh();
+    QTimer::singleShot(0, this, SLOT(reportFirstValue()));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Report the time taken to show the first battery voltage
+
+This runs from the event loop after the repaint posted by the refresh has been
+handled. The time taken since the start of the program is printed, as the
+measure of how quickly the GUI becomes usable.
+*/
+
+void PowerManagementGui::reportFirstValue()
+{
+    printf("First battery voltage shown after %lld ms\n",
+           QDateTime::currentMSecsSinceEpoch() - startTime);
+    fflush(stdout);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the time the program started
+
+@param[in] time Time in ms since the epoch.
+*/
+
+void PowerManagementGui::setStartTime(qint64 time)
+{
+    startTime = time;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the rate at which the display is refreshed
+
+Changed values are drawn at most this many times per second, regardless of the
+rate at which messages arrive.
+
+@param[in] rate Refreshes per second.
+*/
+
+void PowerManagementGui::setRefreshRate(int rate)
+{
+    display.setRefreshRate(rate);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Register the Message Handlers
+
+Each message id is routed to the handlers below. Messages for the recording and
+configuration tabs are passed by category, along with the data messages the
+configuration tab also needs.
+*/
+
+void PowerManagementGui::initDispatcher()
+{
+    dispatcher.add(messageTime,&PowerManagementGui::processTime);
+    dispatcher.add(messageQuiescent,&PowerManagementGui::processTime);
+    dispatcher.add(messageLoad1,&PowerManagementGui::processLoad1);
+    dispatcher.add(messageLoad2,&PowerManagementGui::processLoad2);
+    dispatcher.add(messagePanel,&PowerManagementGui::processPanel);
+    dispatcher.add(messageBattery1,&PowerManagementGui::processBattery1);
+    dispatcher.add(messageBattery2,&PowerManagementGui::processBattery2);
+    dispatcher.add(messageBattery3,&PowerManagementGui::processBattery3);
+    dispatcher.add(messageControls,&PowerManagementGui::processControls);
+    dispatcher.add(messageSwitches,&PowerManagementGui::processSwitches);
+    dispatcher.add(messageSwitchesTrack,&PowerManagementGui::processSwitches);
+    dispatcher.add(messageIndicators,&PowerManagementGui::processIndicators);
+    dispatcher.add(messageState1,&PowerManagementGui::processState1);
+    dispatcher.add(messageState2,&PowerManagementGui::processState2);
+    dispatcher.add(messageState3,&PowerManagementGui::processState3);
+    dispatcher.add(messageCharge1,&PowerManagementGui::processCharge1);
+    dispatcher.add(messageCharge2,&PowerManagementGui::processCharge2);
+    dispatcher.add(messageCharge3,&PowerManagementGui::processCharge3);
+    dispatcher.add(messageTemperature,&PowerManagementGui::processTemperature);
+    dispatcher.add(messageState1,&PowerManagementGui::configureMessageReceived);
+    dispatcher.add(messageState2,&PowerManagementGui::configureMessageReceived);
+    dispatcher.add(messageState3,&PowerManagementGui::configureMessageReceived);
+    dispatcher.add(messageControls,&PowerManagementGui::configureMessageReceived);
+    dispatcher.addCategory(categoryFile,&PowerManagementGui::recordMessageReceived);
+    dispatcher.addCategory(categoryParameter,
+                           &PowerManagementGui::configureMessageReceived);
+    dispatcher.addCategory(categoryDebug,&PowerManagementGui::processDebug);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Keep Communications Alive
+
+When the time field is received, send back a short message to keep comms
+alive. Also check for calibration as time messages stop during this process.
+*/
+
+void PowerManagementGui::processTime(const Message& message)
+{
+    Q_UNUSED(message);
+    socket->write("pc+\n\r");
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Load 1 Current and Voltage
+*/
+
+void PowerManagementGui::processLoad1(const Message& message)
+{
+    int size = message.size;
     QString current, voltage;
-/* When the time field is received, send back a short message to keep comms
-alive. Also check for calibration as time messages stop during this process. */
-    if ((size > 0) && ((firstField == "pH") || (firstField == "pQ")))
+    getCurrentVoltage(message,&current,&voltage);
+    if (PowerManagementMainUi.load1PushButton->isChecked())
     {
-        socket->write("pc+\n\r");
-    }
-// Load 1 current/voltage values
-    if ((size > 0) && (firstField == "dL1"))
-    {
-        getCurrentVoltage(breakdown,&current,&voltage);
-        if (PowerManagementMainUi.load1PushButton->isChecked())
+        if (testIndicator(load1UnderVoltage) || testIndicator(load1OverCurrent))
         {
-            if (testIndicator(load1UnderVoltage) || testIndicator(load1OverCurrent))
-            {
-                PowerManagementMainUi.load1Current->setText(QString("---"));
-                PowerManagementMainUi.load1Voltage->setText(QString("---"));
-            }
-            else
-            {
-                if (size > 1)
-                    PowerManagementMainUi.load1Current->setText(current);
-                if (size > 2)
-                    PowerManagementMainUi.load1Voltage->setText(voltage);
-            }
+            display.setText(PowerManagementMainUi.load1Current,QString("---"));
+            display.setText(PowerManagementMainUi.load1Voltage,QString("---"));
         }
         else
         {
-            PowerManagementMainUi.load1Current->clear();
-            PowerManagementMainUi.load1Voltage->clear();
+            if (size > 1)
+                display.setText(PowerManagementMainUi.load1Current,current);
+            if (size > 2)
+                display.setText(PowerManagementMainUi.load1Voltage,voltage);
         }
     }
-// Load 2 current/voltage values
-    if ((size > 0) && (firstField == "dL2"))
+    else
     {
-        getCurrentVoltage(breakdown,&current,&voltage);
-        if (PowerManagementMainUi.load2PushButton->isChecked())
+        display.clear(PowerManagementMainUi.load1Current);
+        display.clear(PowerManagementMainUi.load1Voltage);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Load 2 Current and Voltage
+*/
+
+void PowerManagementGui::processLoad2(const Message& message)
+{
+    int size = message.size;
+    QString current, voltage;
+    getCurrentVoltage(message,&current,&voltage);
+    if (PowerManagementMainUi.load2PushButton->isChecked())
+    {
+        if (testIndicator(load2UnderVoltage) || testIndicator(load2OverCurrent))
         {
-            if (testIndicator(load2UnderVoltage) || testIndicator(load2OverCurrent))
-            {
-                PowerManagementMainUi.load2Current->setText(QString("---"));
-                PowerManagementMainUi.load2Voltage->setText(QString("---"));
-            }
-            else
-            {
-                if (size > 1)
-                    PowerManagementMainUi.load2Current->setText(current);
-                if (size > 2)
-                    PowerManagementMainUi.load2Voltage->setText(voltage);
-            }
+            display.setText(PowerManagementMainUi.load2Current,QString("---"));
+            display.setText(PowerManagementMainUi.load2Voltage,QString("---"));
         }
         else
         {
-            PowerManagementMainUi.load2Current->clear();
-            PowerManagementMainUi.load2Voltage->clear();
+            if (size > 1)
+                display.setText(PowerManagementMainUi.load2Current,current);
+            if (size > 2)
+                display.setText(PowerManagementMainUi.load2Voltage,voltage);
         }
     }
-// Panel current/voltage values
-    if ((size > 0) && (firstField == "dM1"))
+    else
+    {
+        display.clear(PowerManagementMainUi.load2Current);
+        display.clear(PowerManagementMainUi.load2Voltage);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Panel Current and Voltage
+*/
+
+void PowerManagementGui::processPanel(const Message& message)
+{
+    int size = message.size;
+    QString current, voltage;
+    getCurrentVoltage(message,&current,&voltage);
+    if (PowerManagementMainUi.panelPushButton->isChecked())
     {
-        getCurrentVoltage(breakdown,&current,&voltage);
-        if (PowerManagementMainUi.panelPushButton->isChecked())
+        if (testIndicator(panelUnderVoltage) || testIndicator(panelOverCurrent))
         {
-            if (testIndicator(panelUnderVoltage) || testIndicator(panelOverCurrent))
-            {
-                PowerManagementMainUi.panelCurrent->setText(QString("---"));
-                PowerManagementMainUi.panelVoltage->setText(QString("---"));
-            }
-            else
-            {
-                if (size > 1)
-                    PowerManagementMainUi.panelCurrent->setText(current);
-                if (size > 2)
-                    PowerManagementMainUi.panelVoltage->setText(voltage);
-            }
+            display.setText(PowerManagementMainUi.panelCurrent,QString("---"));
+            display.setText(PowerManagementMainUi.panelVoltage,QString("---"));
         }
         else
         {
-            PowerManagementMainUi.panelCurrent->clear();
-            PowerManagementMainUi.panelVoltage->clear();
+            if (size > 1)
+                display.setText(PowerManagementMainUi.panelCurrent,current);
+            if (size > 2)
+                display.setText(PowerManagementMainUi.panelVoltage,voltage);
         }
     }
-// Battery 1 current/voltage values
-    if ((size > 0) && (firstField == "dB1"))
+    else
     {
-        getCurrentVoltage(breakdown,&current,&voltage);
-        if (PowerManagementMainUi.battery1PushButton->isChecked())
+        display.clear(PowerManagementMainUi.panelCurrent);
+        display.clear(PowerManagementMainUi.panelVoltage);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Battery 1 Current and Voltage
+*/
+
+void PowerManagementGui::processBattery1(const Message& message)
+{
+    int size = message.size;
+    QString current, voltage;
+    getCurrentVoltage(message,&current,&voltage);
+    if (PowerManagementMainUi.battery1PushButton->isChecked())
+    {
+        if (testIndicator(battery1UnderVoltage) || testIndicator(battery1OverCurrent))
         {
-            if (testIndicator(battery1UnderVoltage) || testIndicator(battery1OverCurrent))
-            {
-                PowerManagementMainUi.battery1Current->setText(QString("---"));
-                PowerManagementMainUi.battery1Voltage->setText(QString("---"));
-            }
-            else
-            {
-                if (size > 1)
-                    PowerManagementMainUi.battery1Current->setText(current);
-                if (size > 2)
-                    PowerManagementMainUi.battery1Voltage->setText(voltage);
-            }
+            display.setText(PowerManagementMainUi.battery1Current,QString("---"));
+            display.setText(PowerManagementMainUi.battery1Voltage,QString("---"));
         }
         else
         {
-            PowerManagementMainUi.battery1Current->clear();
-            PowerManagementMainUi.battery1Voltage->clear();
+            if (size > 1)
+                display.setText(PowerManagementMainUi.battery1Current,current);
+            if (size > 2)
+            {
+                display.setText(PowerManagementMainUi.battery1Voltage,voltage);
+                showFirstValue();
+            }
         }
     }
-// Battery 2 current/voltage values
-    if ((size > 0) && (firstField == "dB2"))
+    else
+    {
+        display.clear(PowerManagementMainUi.battery1Current);
+        display.clear(PowerManagementMainUi.battery1Voltage);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Battery 2 Current and Voltage
+*/
+
+void PowerManagementGui::processBattery2(const Message& message)
+{
+    int size = message.size;
+    QString current, voltage;
+    getCurrentVoltage(message,&current,&voltage);
+    if (PowerManagementMainUi.battery2PushButton->isChecked())
     {
-        getCurrentVoltage(breakdown,&current,&voltage);
-        if (PowerManagementMainUi.battery2PushButton->isChecked())
+        if (testIndicator(battery2UnderVoltage) || testIndicator(battery2OverCurrent))
         {
-            if (testIndicator(battery2UnderVoltage) || testIndicator(battery2OverCurrent))
-            {
-                PowerManagementMainUi.battery2Current->setText(QString("---"));
-                PowerManagementMainUi.battery2Voltage->setText(QString("---"));
-            }
-            else
-            {
-                if (size > 1)
-                    PowerManagementMainUi.battery2Current->setText(current);
-                if (size > 2)
-                    PowerManagementMainUi.battery2Voltage->setText(voltage);
-            }
+            display.setText(PowerManagementMainUi.battery2Current,QString("---"));
+            display.setText(PowerManagementMainUi.battery2Voltage,QString("---"));
         }
         else
         {
-            PowerManagementMainUi.battery2Current->clear();
-            PowerManagementMainUi.battery2Voltage->clear();
+            if (size > 1)
+                display.setText(PowerManagementMainUi.battery2Current,current);
+            if (size > 2)
+            {
+                display.setText(PowerManagementMainUi.battery2Voltage,voltage);
+                showFirstValue();
+            }
         }
     }
-// Battery 3 current/voltage values
-    if ((size > 0) && (firstField == "dB3"))
+    else
     {
-        getCurrentVoltage(breakdown,&current,&voltage);
-        if (PowerManagementMainUi.battery3PushButton->isChecked())
+        display.clear(PowerManagementMainUi.battery2Current);
+        display.clear(PowerManagementMainUi.battery2Voltage);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Battery 3 Current and Voltage
+*/
+
+void PowerManagementGui::processBattery3(const Message& message)
+{
+    int size = message.size;
+    QString current, voltage;
+    getCurrentVoltage(message,&current,&voltage);
+    if (PowerManagementMainUi.battery3PushButton->isChecked())
+    {
+        if (testIndicator(battery3UnderVoltage) || testIndicator(battery3OverCurrent))
         {
-            if (testIndicator(battery3UnderVoltage) || testIndicator(battery3OverCurrent))
-            {
-                PowerManagementMainUi.battery3Current->setText(QString("---"));
-                PowerManagementMainUi.battery3Voltage->setText(QString("---"));
-            }
-            else
-            {
-                if (size > 1)
-                    PowerManagementMainUi.battery3Current->setText(current);
-                if (size > 2)
-                    PowerManagementMainUi.battery3Voltage->setText(voltage);
-            }
+            display.setText(PowerManagementMainUi.battery3Current,QString("---"));
+            display.setText(PowerManagementMainUi.battery3Voltage,QString("---"));
         }
         else
         {
-            PowerManagementMainUi.battery3Current->clear();
-            PowerManagementMainUi.battery3Voltage->clear();
+            if (size > 1)
+                display.setText(PowerManagementMainUi.battery3Current,current);
+            if (size > 2)
+            {
+                display.setText(PowerManagementMainUi.battery3Voltage,voltage);
+                showFirstValue();
+            }
         }
     }
-// Restore the current software settings.
-// Bit 0 = autotrack
-    if ((size > 0) && (firstField == "dD"))
-    {
-        bool autoTrackOn = ((secondField.toInt() & 0x01) > 0);
-        PowerManagementMainUi.autoTrackPushButton->setChecked(autoTrackOn);
-        disableRadioButtons(autoTrackOn);
-    }
-// Read all the microcontroller's switch settings and set display accordingly
-// Upper case S is used for initialization and after calibration.
-// Disable unused batteries and associated buttons, and set checkboxes.
-// Lower case s is used for autotrack to allow switch settings to be observed.
-// In that case the original settings of the checkboxes are preserved.
-    if ((size > 0) && ((firstField == "dS") || (firstField == "ds")))
-    {
-        unsigned int settings = secondField.toInt();
-        unsigned int load1Setting = (settings & 0x03);
-        unsigned int load2Setting = ((settings >> 2) & 0x03);
-        unsigned int panelSetting = ((settings >> 4) & 0x03);
-        bool battery1Enabled = ((load1Setting == 1) || (load2Setting == 1)\
-                                       || (panelSetting == 1));
-        bool battery2Enabled = ((load1Setting == 2) || (load2Setting == 2)\
-                                       || (panelSetting == 2));
-        bool battery3Enabled = ((load1Setting == 3) || (load2Setting == 3)\
-                                       || (panelSetting == 3));
+    else
+    {
+        display.clear(PowerManagementMainUi.battery3Current);
+        display.clear(PowerManagementMainUi.battery3Voltage);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Software Controls
+
+Restore the current software settings.
+Bit 0 = autotrack
+*/
+
+void PowerManagementGui::processControls(const Message& message)
+{
+    QString secondField;
+    if (message.size > 1) secondField = message.fields[1].simplified();
+    bool autoTrackOn = ((secondField.toInt() & 0x01) > 0);
+    PowerManagementMainUi.autoTrackPushButton->setChecked(autoTrackOn);
+    disableRadioButtons(autoTrackOn);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Switch Settings
+
+Read all the microcontroller's switch settings and set display accordingly
+Upper case S is used for initialization and after calibration.
+Disable unused batteries and associated buttons, and set checkboxes.
+Lower case s is used for autotrack to allow switch settings to be observed.
+In that case the original settings of the checkboxes are preserved.
+*/
+
+void PowerManagementGui::processSwitches(const Message& message)
+{
+    QString secondField;
+    if (message.size > 1) secondField = message.fields[1].simplified();
+    unsigned int settings = secondField.toInt();
+    unsigned int load1Setting = (settings & 0x03);
+    unsigned int load2Setting = ((settings >> 2) & 0x03);
+    unsigned int panelSetting = ((settings >> 4) & 0x03);
+    bool battery1Enabled = ((load1Setting == 1) || (load2Setting == 1)\
+                                   || (panelSetting == 1));
+    bool battery2Enabled = ((load1Setting == 2) || (load2Setting == 2)\
+                                   || (panelSetting == 2));
+    bool battery3Enabled = ((load1Setting == 3) || (load2Setting == 3)\
+                                   || (panelSetting == 3));
 // Disable a battery if none of the load/panels are selected for it
-        if (firstField == "dS")
-        {
-            PowerManagementMainUi.battery1PushButton->setChecked(battery1Enabled);
-            PowerManagementMainUi.battery2PushButton->setChecked(battery2Enabled);
-            PowerManagementMainUi.battery3PushButton->setChecked(battery3Enabled);
-            PowerManagementMainUi.load1Battery1->setEnabled(battery1Enabled);
-            PowerManagementMainUi.load1Battery2->setEnabled(battery2Enabled);
-            PowerManagementMainUi.load1Battery3->setEnabled(battery3Enabled);
-            PowerManagementMainUi.load2Battery1->setEnabled(battery1Enabled);
-            PowerManagementMainUi.load2Battery2->setEnabled(battery2Enabled);
-            PowerManagementMainUi.load2Battery3->setEnabled(battery3Enabled);
-            PowerManagementMainUi.panelBattery1->setEnabled(battery1Enabled);
-            PowerManagementMainUi.panelBattery2->setEnabled(battery2Enabled);
-            PowerManagementMainUi.panelBattery3->setEnabled(battery3Enabled);
-        }
+    if (message.id == messageSwitches)
+    {
+        PowerManagementMainUi.battery1PushButton->setChecked(battery1Enabled);
+        PowerManagementMainUi.battery2PushButton->setChecked(battery2Enabled);
+        PowerManagementMainUi.battery3PushButton->setChecked(battery3Enabled);
+        PowerManagementMainUi.load1Battery1->setEnabled(battery1Enabled);
+        PowerManagementMainUi.load1Battery2->setEnabled(battery2Enabled);
+        PowerManagementMainUi.load1Battery3->setEnabled(battery3Enabled);
+        PowerManagementMainUi.load2Battery1->setEnabled(battery1Enabled);
+        PowerManagementMainUi.load2Battery2->setEnabled(battery2Enabled);
+        PowerManagementMainUi.load2Battery3->setEnabled(battery3Enabled);
+        PowerManagementMainUi.panelBattery1->setEnabled(battery1Enabled);
+        PowerManagementMainUi.panelBattery2->setEnabled(battery2Enabled);
+        PowerManagementMainUi.panelBattery3->setEnabled(battery3Enabled);
+    }
 // Set each of the switch settings
-        if (firstField == "dS")
-            PowerManagementMainUi.load1PushButton->setChecked(true);
-        bool load1Battery1enabled = PowerManagementMainUi.load1Battery1->isEnabled();
-        bool load1Battery2enabled = PowerManagementMainUi.load1Battery2->isEnabled();
-        bool load1Battery3enabled = PowerManagementMainUi.load1Battery3->isEnabled();
-        PowerManagementMainUi.load1Battery1->setEnabled(true);
-        PowerManagementMainUi.load1Battery2->setEnabled(true);
-        PowerManagementMainUi.load1Battery3->setEnabled(true);
-        switch (load1Setting)
-        {
+    if (message.id == messageSwitches)
+        PowerManagementMainUi.load1PushButton->setChecked(true);
+    bool load1Battery1enabled = PowerManagementMainUi.load1Battery1->isEnabled();
+    bool load1Battery2enabled = PowerManagementMainUi.load1Battery2->isEnabled();
+    bool load1Battery3enabled = PowerManagementMainUi.load1Battery3->isEnabled();
+    PowerManagementMainUi.load1Battery1->setEnabled(true);
+    PowerManagementMainUi.load1Battery2->setEnabled(true);
+    PowerManagementMainUi.load1Battery3->setEnabled(true);
+    switch (load1Setting)
+    {
 // No battery allocated to load 1
-            case 0:
-                PowerManagementMainUi.load1Battery1->setAutoExclusive(false);
-                PowerManagementMainUi.load1Battery1->setChecked(false);
-                PowerManagementMainUi.load1Battery1->setAutoExclusive(true);
-                PowerManagementMainUi.load1Battery2->setAutoExclusive(false);
-                PowerManagementMainUi.load1Battery2->setChecked(false);
-                PowerManagementMainUi.load1Battery2->setAutoExclusive(true);
-                PowerManagementMainUi.load1Battery3->setAutoExclusive(false);
-                PowerManagementMainUi.load1Battery3->setChecked(false);
-                PowerManagementMainUi.load1Battery3->setAutoExclusive(true);
-                break;
-            case 1:
-                PowerManagementMainUi.load1Battery1->setAutoExclusive(true);
-                PowerManagementMainUi.load1Battery1->setChecked(true);
-                break;            
-            case 2:
-                PowerManagementMainUi.load1Battery2->setAutoExclusive(true);
-                PowerManagementMainUi.load1Battery2->setChecked(true);
-                break;            
-            case 3:
-                PowerManagementMainUi.load1Battery3->setAutoExclusive(true);
-                PowerManagementMainUi.load1Battery3->setChecked(true);
-                break;
-            }
-        if (! load1Battery1enabled) PowerManagementMainUi.load1Battery1->setEnabled(false);
-        if (! load1Battery2enabled) PowerManagementMainUi.load1Battery2->setEnabled(false);
-        if (! load1Battery3enabled) PowerManagementMainUi.load1Battery3->setEnabled(false);
-
-        if (firstField == "dS")
-            PowerManagementMainUi.load2PushButton->setChecked(true);
-        bool load2Battery1enabled = PowerManagementMainUi.load2Battery1->isEnabled();
-        bool load2Battery2enabled = PowerManagementMainUi.load2Battery2->isEnabled();
-        bool load2Battery3enabled = PowerManagementMainUi.load2Battery3->isEnabled();
-        PowerManagementMainUi.load2Battery1->setEnabled(true);
-        PowerManagementMainUi.load2Battery2->setEnabled(true);
-        PowerManagementMainUi.load2Battery3->setEnabled(true);
-        switch (load2Setting)
-            {
+        case 0:
+            PowerManagementMainUi.load1Battery1->setAutoExclusive(false);
+            PowerManagementMainUi.load1Battery1->setChecked(false);
+            PowerManagementMainUi.load1Battery1->setAutoExclusive(true);
+            PowerManagementMainUi.load1Battery2->setAutoExclusive(false);
+            PowerManagementMainUi.load1Battery2->setChecked(false);
+            PowerManagementMainUi.load1Battery2->setAutoExclusive(true);
+            PowerManagementMainUi.load1Battery3->setAutoExclusive(false);
+            PowerManagementMainUi.load1Battery3->setChecked(false);
+            PowerManagementMainUi.load1Battery3->setAutoExclusive(true);
+            break;
+        case 1:
+            PowerManagementMainUi.load1Battery1->setAutoExclusive(true);
+            PowerManagementMainUi.load1Battery1->setChecked(true);
+            break;            
+        case 2:
+            PowerManagementMainUi.load1Battery2->setAutoExclusive(true);
+            PowerManagementMainUi.load1Battery2->setChecked(true);
+            break;            
+        case 3:
+            PowerManagementMainUi.load1Battery3->setAutoExclusive(true);
+            PowerManagementMainUi.load1Battery3->setChecked(true);
+            break;
+        }
+    if (! load1Battery1enabled) PowerManagementMainUi.load1Battery1->setEnabled(false);
+    if (! load1Battery2enabled) PowerManagementMainUi.load1Battery2->setEnabled(false);
+    if (! load1Battery3enabled) PowerManagementMainUi.load1Battery3->setEnabled(false);
+
+    if (message.id == messageSwitches)
+        PowerManagementMainUi.load2PushButton->setChecked(true);
+    bool load2Battery1enabled = PowerManagementMainUi.load2Battery1->isEnabled();
+    bool load2Battery2enabled = PowerManagementMainUi.load2Battery2->isEnabled();
+    bool load2Battery3enabled = PowerManagementMainUi.load2Battery3->isEnabled();
+    PowerManagementMainUi.load2Battery1->setEnabled(true);
+    PowerManagementMainUi.load2Battery2->setEnabled(true);
+    PowerManagementMainUi.load2Battery3->setEnabled(true);
+    switch (load2Setting)
+        {
 // No battery allocated to load 2
-            case 0:
-                PowerManagementMainUi.load2Battery1->setAutoExclusive(false);
-                PowerManagementMainUi.load2Battery1->setChecked(false);
-                PowerManagementMainUi.load2Battery1->setAutoExclusive(true);
-                PowerManagementMainUi.load2Battery2->setAutoExclusive(false);
-                PowerManagementMainUi.load2Battery2->setChecked(false);
-                PowerManagementMainUi.load2Battery2->setAutoExclusive(true);
-                PowerManagementMainUi.load2Battery3->setAutoExclusive(false);
-                PowerManagementMainUi.load2Battery3->setChecked(false);
-                PowerManagementMainUi.load2Battery3->setAutoExclusive(true);
-                break;
-            case 1:
-                PowerManagementMainUi.load2Battery1->setAutoExclusive(true);
-                PowerManagementMainUi.load2Battery1->setChecked(true);
-                break;            
-            case 2:
-                PowerManagementMainUi.load2Battery2->setAutoExclusive(true);
-                PowerManagementMainUi.load2Battery2->setChecked(true);
-                break;            
-            case 3:
-                PowerManagementMainUi.load2Battery3->setAutoExclusive(true);
-                PowerManagementMainUi.load2Battery3->setChecked(true);
-                break;
-            }
-        if (! load2Battery1enabled) PowerManagementMainUi.load2Battery1->setEnabled(false);
-        if (! load2Battery2enabled) PowerManagementMainUi.load2Battery2->setEnabled(false);
-        if (! load2Battery3enabled) PowerManagementMainUi.load2Battery3->setEnabled(false);
+        case 0:
+            PowerManagementMainUi.load2Battery1->setAutoExclusive(false);
+            PowerManagementMainUi.load2Battery1->setChecked(false);
+            PowerManagementMainUi.load2Battery1->setAutoExclusive(true);
+            PowerManagementMainUi.load2Battery2->setAutoExclusive(false);
+            PowerManagementMainUi.load2Battery2->setChecked(false);
+            PowerManagementMainUi.load2Battery2->setAutoExclusive(true);
+            PowerManagementMainUi.load2Battery3->setAutoExclusive(false);
+            PowerManagementMainUi.load2Battery3->setChecked(false);
+            PowerManagementMainUi.load2Battery3->setAutoExclusive(true);
+            break;
+        case 1:
+            PowerManagementMainUi.load2Battery1->setAutoExclusive(true);
+            PowerManagementMainUi.load2Battery1->setChecked(true);
+            break;            
+        case 2:
+            PowerManagementMainUi.load2Battery2->setAutoExclusive(true);
+            PowerManagementMainUi.load2Battery2->setChecked(true);
+            break;            
+        case 3:
+            PowerManagementMainUi.load2Battery3->setAutoExclusive(true);
+            PowerManagementMainUi.load2Battery3->setChecked(true);
+            break;
+        }
+    if (! load2Battery1enabled) PowerManagementMainUi.load2Battery1->setEnabled(false);
+    if (! load2Battery2enabled) PowerManagementMainUi.load2Battery2->setEnabled(false);
+    if (! load2Battery3enabled) PowerManagementMainUi.load2Battery3->setEnabled(false);
 
-        if (firstField == "dS")
-            PowerManagementMainUi.panelBattery1->setChecked(true);
-        bool panelBattery1enabled = PowerManagementMainUi.panelBattery1->isEnabled();
-        bool panelBattery2enabled = PowerManagementMainUi.panelBattery2->isEnabled();
-        bool panelBattery3enabled = PowerManagementMainUi.panelBattery3->isEnabled();
-        PowerManagementMainUi.panelBattery1->setEnabled(true);
-        PowerManagementMainUi.panelBattery2->setEnabled(true);
-        PowerManagementMainUi.panelBattery3->setEnabled(true);
-        switch (panelSetting)
-            {
+    if (message.id == messageSwitches)
+        PowerManagementMainUi.panelBattery1->setChecked(true);
+    bool panelBattery1enabled = PowerManagementMainUi.panelBattery1->isEnabled();
+    bool panelBattery2enabled = PowerManagementMainUi.panelBattery2->isEnabled();
+    bool panelBattery3enabled = PowerManagementMainUi.panelBattery3->isEnabled();
+    PowerManagementMainUi.panelBattery1->setEnabled(true);
+    PowerManagementMainUi.panelBattery2->setEnabled(true);
+    PowerManagementMainUi.panelBattery3->setEnabled(true);
+    switch (panelSetting)
+        {
 // No battery allocated to the panel
-            case 0:
-                PowerManagementMainUi.panelBattery1->setAutoExclusive(false);
-                PowerManagementMainUi.panelBattery1->setChecked(false);
-                PowerManagementMainUi.panelBattery1->setAutoExclusive(true);
-                PowerManagementMainUi.panelBattery2->setAutoExclusive(false);
-                PowerManagementMainUi.panelBattery2->setChecked(false);
-                PowerManagementMainUi.panelBattery2->setAutoExclusive(true);
-                PowerManagementMainUi.panelBattery3->setAutoExclusive(false);
-                PowerManagementMainUi.panelBattery3->setChecked(false);
-                PowerManagementMainUi.panelBattery3->setAutoExclusive(true);
-                break;
+        case 0:
+            PowerManagementMainUi.panelBattery1->setAutoExclusive(false);
+            PowerManagementMainUi.panelBattery1->setChecked(false);
+            PowerManagementMainUi.panelBattery1->setAutoExclusive(true);
+            PowerManagementMainUi.panelBattery2->setAutoExclusive(false);
+            PowerManagementMainUi.panelBattery2->setChecked(false);
+            PowerManagementMainUi.panelBattery2->setAutoExclusive(true);
+            PowerManagementMainUi.panelBattery3->setAutoExclusive(false);
+            PowerManagementMainUi.panelBattery3->setChecked(false);
+            PowerManagementMainUi.panelBattery3->setAutoExclusive(true);
+            break;
 // Battery x allocated to the panel
-            case 1:
-                PowerManagementMainUi.panelBattery1->setAutoExclusive(true);
-                PowerManagementMainUi.panelBattery1->setChecked(true);
-                break;            
-            case 2:
-                PowerManagementMainUi.panelBattery2->setAutoExclusive(true);
-                PowerManagementMainUi.panelBattery2->setChecked(true);
-                break;            
-            case 3:
-                PowerManagementMainUi.panelBattery3->setAutoExclusive(true);
-                PowerManagementMainUi.panelBattery3->setChecked(true);
-                break;
-        }
-        if (! panelBattery1enabled) PowerManagementMainUi.panelBattery1->setEnabled(false);
-        if (! panelBattery2enabled) PowerManagementMainUi.panelBattery2->setEnabled(false);
-        if (! panelBattery3enabled) PowerManagementMainUi.panelBattery3->setEnabled(false);
+        case 1:
+            PowerManagementMainUi.panelBattery1->setAutoExclusive(true);
+            PowerManagementMainUi.panelBattery1->setChecked(true);
+            break;            
+        case 2:
+            PowerManagementMainUi.panelBattery2->setAutoExclusive(true);
+            PowerManagementMainUi.panelBattery2->setChecked(true);
+            break;            
+        case 3:
+            PowerManagementMainUi.panelBattery3->setAutoExclusive(true);
+            PowerManagementMainUi.panelBattery3->setChecked(true);
+            break;
     }
-// Overload and undervoltage indicators from the I/Fs
-// Battery 1, Battery 2, Battery 3, Load 1, Load 2, Panel
-// ON is low.
-    if ((size > 0) && (firstField == "dI"))
+    if (! panelBattery1enabled) PowerManagementMainUi.panelBattery1->setEnabled(false);
+    if (! panelBattery2enabled) PowerManagementMainUi.panelBattery2->setEnabled(false);
+    if (! panelBattery3enabled) PowerManagementMainUi.panelBattery3->setEnabled(false);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Interface Indicators
+
+Overload and undervoltage indicators from the I/Fs
+Battery 1, Battery 2, Battery 3, Load 1, Load 2, Panel
+ON is low.
+*/
+
+void PowerManagementGui::processIndicators(const Message& message)
+{
+    QString secondField;
+    if (message.size > 1) secondField = message.fields[1].simplified();
+    indicators = secondField.toInt();
+    if (testIndicator(battery1OverCurrent))
     {
-        indicators = secondField.toInt();
-        if (testIndicator(battery1OverCurrent))
-        {
-            PowerManagementMainUi.battery1OverCurrent->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.battery1OverCurrent->
-                setText("OC");
-        }
-        else
-        {
-            PowerManagementMainUi.battery1OverCurrent->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery1OverCurrent->
-                setText("");
-        }
-        if (testIndicator(battery1UnderVoltage))
-        {
-            PowerManagementMainUi.battery1UnderVoltage->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.battery1UnderVoltage->
-                setText("UV");
-        }
-        else
-        {
-            PowerManagementMainUi.battery1UnderVoltage->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery1UnderVoltage->
-                setText("");
-        }
-        if (testIndicator(battery2OverCurrent))
-        {
-            PowerManagementMainUi.battery2OverCurrent->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.battery2OverCurrent->
-                setText("OC");
-        }
-        else
-        {
-            PowerManagementMainUi.battery2OverCurrent->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery2OverCurrent->
-                setText("");
-        }
-        if (testIndicator(battery2UnderVoltage))
-        {
-            PowerManagementMainUi.battery2UnderVoltage->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.battery2UnderVoltage->
-                setText("UV");
-        }
-        else
-        {
-            PowerManagementMainUi.battery2UnderVoltage->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery2UnderVoltage->
-                setText("");
-        }
-        if (testIndicator(battery3OverCurrent))
-        {
-            PowerManagementMainUi.battery3OverCurrent->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.battery3OverCurrent->
-                setText("OC");
-        }
-        else
-        {
-            PowerManagementMainUi.battery3OverCurrent->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery3OverCurrent->
-                setText("");
-        }
-        if (testIndicator(battery3UnderVoltage))
-        {
-            PowerManagementMainUi.battery3UnderVoltage->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.battery3UnderVoltage->
-                setText("UV");
-        }
-        else
-        {
-            PowerManagementMainUi.battery3UnderVoltage->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery3UnderVoltage->
-                setText("");
-        }
-        if (testIndicator(load1OverCurrent))
-        {
-            PowerManagementMainUi.load1OverCurrent->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.load1OverCurrent->
-                setText("OC");
-        }
-        else
-        {
-            PowerManagementMainUi.load1OverCurrent->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.load1OverCurrent->
-                setText("");
-        }
-        if (testIndicator(load1UnderVoltage))
-        {
-            PowerManagementMainUi.load1UnderVoltage->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.load1UnderVoltage->
-                setText("UV");
-        }
-        else
-        {
-            PowerManagementMainUi.load1UnderVoltage->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.load1UnderVoltage->
-                setText("");
-        }
-        if (testIndicator(load2OverCurrent))
-        {
-            PowerManagementMainUi.load2OverCurrent->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.load2OverCurrent->
-                setText("OC");
-        }
-        else
-        {
-            PowerManagementMainUi.load2OverCurrent->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.load2OverCurrent->
-                setText("");
-        }
-        if (testIndicator(load2UnderVoltage))
-        {
-            PowerManagementMainUi.load2UnderVoltage->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.load2UnderVoltage->
-                setText("UV");
-        }
-        else
-        {
-            PowerManagementMainUi.load2UnderVoltage->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.load2UnderVoltage->
-                setText("");
-        }
-        if (testIndicator(panelOverCurrent))
-        {
-            PowerManagementMainUi.panelOverCurrent->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.panelOverCurrent->
-                setText("OC");
-        }
-        else
-        {
-            PowerManagementMainUi.panelOverCurrent->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.panelOverCurrent->
-                setText("");
-        }
-        if (testIndicator(panelUnderVoltage))
-        {
-            PowerManagementMainUi.panelUnderVoltage->
-                setStyleSheet("color:white; color:white; background-color:red;");
-            PowerManagementMainUi.panelUnderVoltage->
-                setText("UV");
-        }
-        else
-        {
-            PowerManagementMainUi.panelUnderVoltage->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.panelUnderVoltage->
-                setText("");
-        }
+        display.setStyleSheet(PowerManagementMainUi.battery1OverCurrent,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.battery1OverCurrent,
+            "OC");
     }
-/* Battery 1 Fill, Health and Operational State Indicators */
-    if ((size > 0) && (firstField == "dO1"))
+    else
     {
-        int opState = secondField.toInt() & 0x03;
-        int fillState = (secondField.toInt() >> 2) & 0x03;
-        int chargingState = (secondField.toInt() >> 4) & 0x03;
-        int healthState = (secondField.toInt() >> 6) & 0x03;
-        if (fillState == 0)         // Normal
-        {
-            PowerManagementMainUi.battery1Fill->
-                setStyleSheet("background-color:lightgreen;");
-        }
-        else if (fillState == 1)    // Low
-        {
-            PowerManagementMainUi.battery1Fill->
-                setStyleSheet("background-color:yellow;");
-        }
-        else if (fillState == 2)    // Critical
-        {
-            PowerManagementMainUi.battery1Fill->
-                setStyleSheet("background-color:red;");
-        }
-        else if (fillState == 3)    // Faulty
-        {
-            PowerManagementMainUi.battery1Fill->
-                setStyleSheet("background-color:black;");
-        }
-        else                        // Invalid
-        {
-            PowerManagementMainUi.battery1Fill->
-                setStyleSheet("background-color:white;");
-        }
-        if (PowerManagementMainUi.autoTrackPushButton->isChecked())
-        {
-            if (opState == 0)
-            {
-                PowerManagementMainUi.battery1Op->
-                    setText("L");
-            }
-            else if (opState == 1)
-            {
-                PowerManagementMainUi.battery1Op->
-                    setText("C");
-            }
-            else
-            {
-                PowerManagementMainUi.battery1Op->
-                    setText("I");
-            }
-        }
-        else
-        {
-            PowerManagementMainUi.battery1Op->
-                setText("");
-        }
-        if (chargingState == 0)
-        {
-            PowerManagementMainUi.battery1Charging->
-                setStyleSheet("background-color:orange;");
-            PowerManagementMainUi.battery1Charging->
-                setText("B");
-        }
-        else if (chargingState == 1)
-        {
-            PowerManagementMainUi.battery1Charging->
-                setStyleSheet("background-color:yellow;");
-            PowerManagementMainUi.battery1Charging->
-                setText("A");
-        }
-        else if (chargingState == 2)
-        {
-            PowerManagementMainUi.battery1Charging->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery1Charging->
-                setText("F");
-        }
-        else if (chargingState == 3)
-        {
-            PowerManagementMainUi.battery1Charging->
-                setStyleSheet("background-color:pink;");
-            PowerManagementMainUi.battery1Charging->
-                setText("R");
-        }
-        else if (chargingState == 4)
-        {
-            PowerManagementMainUi.battery1Charging->
-                setStyleSheet("background-color:lightblue;");
-            PowerManagementMainUi.battery1Charging->
-                setText("E");
-        }
-        else
-        {
-            PowerManagementMainUi.battery1Charging->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery1Charging->
-                setText(" ");
-        }
-        if (healthState == 0)
-        {
-            PowerManagementMainUi.battery1Health->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery1Health->
-                setText("");
-        }
-        else if (healthState == 1)
-        {
-            PowerManagementMainUi.battery1Health->
-                setStyleSheet("background-color:orange;");
-            PowerManagementMainUi.battery1Health->
-                setText("F");
-        }
-        else
-        {
-            PowerManagementMainUi.battery1Health->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery1Health->
-                setText("X");
-            PowerManagementMainUi.battery1Charging->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery1Charging->
-                setText("");
-            PowerManagementMainUi.battery1Fill->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery1Fill->
-                setText("");
-            PowerManagementMainUi.battery1Op->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery1Op->
-                setText("");
-            PowerManagementMainUi.battery1Charge->
-                setText(QString(""));
-            PowerManagementMainUi.battery1Current->setText(QString(""));
-            PowerManagementMainUi.battery1Voltage->setText(QString(""));
-        }
+        display.setStyleSheet(PowerManagementMainUi.battery1OverCurrent,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery1OverCurrent,
+            "");
+    }
+    if (testIndicator(battery1UnderVoltage))
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1UnderVoltage,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.battery1UnderVoltage,
+            "UV");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1UnderVoltage,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery1UnderVoltage,
+            "");
+    }
+    if (testIndicator(battery2OverCurrent))
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2OverCurrent,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.battery2OverCurrent,
+            "OC");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2OverCurrent,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery2OverCurrent,
+            "");
+    }
+    if (testIndicator(battery2UnderVoltage))
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2UnderVoltage,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.battery2UnderVoltage,
+            "UV");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2UnderVoltage,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery2UnderVoltage,
+            "");
+    }
+    if (testIndicator(battery3OverCurrent))
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3OverCurrent,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.battery3OverCurrent,
+            "OC");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3OverCurrent,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery3OverCurrent,
+            "");
+    }
+    if (testIndicator(battery3UnderVoltage))
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3UnderVoltage,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.battery3UnderVoltage,
+            "UV");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3UnderVoltage,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery3UnderVoltage,
+            "");
+    }
+    if (testIndicator(load1OverCurrent))
+    {
+        display.setStyleSheet(PowerManagementMainUi.load1OverCurrent,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.load1OverCurrent,
+            "OC");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.load1OverCurrent,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.load1OverCurrent,
+            "");
+    }
+    if (testIndicator(load1UnderVoltage))
+    {
+        display.setStyleSheet(PowerManagementMainUi.load1UnderVoltage,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.load1UnderVoltage,
+            "UV");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.load1UnderVoltage,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.load1UnderVoltage,
+            "");
+    }
+    if (testIndicator(load2OverCurrent))
+    {
+        display.setStyleSheet(PowerManagementMainUi.load2OverCurrent,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.load2OverCurrent,
+            "OC");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.load2OverCurrent,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.load2OverCurrent,
+            "");
+    }
+    if (testIndicator(load2UnderVoltage))
+    {
+        display.setStyleSheet(PowerManagementMainUi.load2UnderVoltage,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.load2UnderVoltage,
+            "UV");
     }
-/* Battery 2 Fill, Health and Operational State Indicators */
-    if ((size > 0) && (firstField == "dO2"))
+    else
     {
-        int opState = secondField.toInt() & 0x03;
-        int fillState = (secondField.toInt() >> 2) & 0x03;
-        int chargingState = (secondField.toInt() >> 4) & 0x03;
-        int healthState = (secondField.toInt() >> 6) & 0x03;
-        if (fillState == 0)         // Normal
-        {
-            PowerManagementMainUi.battery2Fill->
-                setStyleSheet("background-color:lightgreen;");
-        }
-        else if (fillState == 1)    // Low
-        {
-            PowerManagementMainUi.battery2Fill->
-                setStyleSheet("background-color:yellow;");
-        }
-        else if (fillState == 2)    // Critical
-        {
-            PowerManagementMainUi.battery2Fill->
-                setStyleSheet("background-color:red;");
-        }
-        else if (fillState == 3)    // Faulty
-        {
-            PowerManagementMainUi.battery2Fill->
-                setStyleSheet("background-color:black;");
-        }
-        else                        // Invalid
-        {
-            PowerManagementMainUi.battery2Fill->
-                setStyleSheet("background-color:white;");
-        }
-        if (PowerManagementMainUi.autoTrackPushButton->isChecked())
-        {
-            if (opState == 0)
-            {
-                PowerManagementMainUi.battery2Op->
-                    setText("L");
-            }
-            else if (opState == 1)
-            {
-                PowerManagementMainUi.battery2Op->
-                    setText("C");
-            }
-            else
-            {
-                PowerManagementMainUi.battery2Op->
-                    setText("I");
-            }
-        }
-        else
-        {
-            PowerManagementMainUi.battery2Op->
-                setText("");
-        }
-        if (chargingState == 0)
-        {
-            PowerManagementMainUi.battery2Charging->
-                setStyleSheet("background-color:orange;");
-            PowerManagementMainUi.battery2Charging->
-                setText("B");
-        }
-        else if (chargingState == 1)
-        {
-            PowerManagementMainUi.battery2Charging->
-                setStyleSheet("background-color:yellow;");
-            PowerManagementMainUi.battery2Charging->
-                setText("A");
-        }
-        else if (chargingState == 2)
-        {
-            PowerManagementMainUi.battery2Charging->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery2Charging->
-                setText("F");
-        }
-        else if (chargingState == 3)
-        {
-            PowerManagementMainUi.battery2Charging->
-                setStyleSheet("background-color:pink;");
-            PowerManagementMainUi.battery2Charging->
-                setText("R");
-        }
-        else if (chargingState == 4)
-        {
-            PowerManagementMainUi.battery2Charging->
-                setStyleSheet("background-color:lightblue;");
-            PowerManagementMainUi.battery2Charging->
-                setText("E");
-        }
-        else
-        {
-            PowerManagementMainUi.battery2Charging->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery2Charging->
-                setText(" ");
-        }
-        if (healthState == 0)
-        {
-            PowerManagementMainUi.battery2Health->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery2Health->
-                setText("");
-        }
-        else if (healthState == 1)
-        {
-            PowerManagementMainUi.battery2Health->
-                setStyleSheet("background-color:orange;");
-            PowerManagementMainUi.battery2Health->
-                setText("F");
-        }
-        else
-        {
-            PowerManagementMainUi.battery2Health->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery2Health->
-                setText("X");
-            PowerManagementMainUi.battery2Charging->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery2Charging->
-                setText("");
-            PowerManagementMainUi.battery2Fill->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery2Fill->
-                setText("");
-            PowerManagementMainUi.battery2Op->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery2Op->
-                setText("");
-            PowerManagementMainUi.battery2Charge->
-                setText(QString(""));
-            PowerManagementMainUi.battery2Current->setText(QString(""));
-            PowerManagementMainUi.battery2Voltage->setText(QString(""));
-        }
+        display.setStyleSheet(PowerManagementMainUi.load2UnderVoltage,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.load2UnderVoltage,
+            "");
     }
-/* Battery 3 Fill, Health and Operational State Indicators */
-    if ((size > 0) && (firstField == "dO3"))
+    if (testIndicator(panelOverCurrent))
     {
-        int opState = secondField.toInt() & 0x03;
-        int fillState = (secondField.toInt() >> 2) & 0x03;
-        int chargingState = (secondField.toInt() >> 4) & 0x03;
-        int healthState = (secondField.toInt() >> 6) & 0x03;
-        if (fillState == 0)         // Normal
-        {
-            PowerManagementMainUi.battery3Fill->
-                setStyleSheet("background-color:lightgreen;");
-        }
-        else if (fillState == 1)    // Low
-        {
-            PowerManagementMainUi.battery3Fill->
-                setStyleSheet("background-color:yellow;");
-        }
-        else if (fillState == 2)    // Critical
-        {
-            PowerManagementMainUi.battery3Fill->
-                setStyleSheet("background-color:red;");
-        }
-        else if (fillState == 3)    // Faulty
-        {
-            PowerManagementMainUi.battery3Fill->
-                setStyleSheet("background-color:black;");
-        }
-        else                        // Invalid
+        display.setStyleSheet(PowerManagementMainUi.panelOverCurrent,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.panelOverCurrent,
+            "OC");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.panelOverCurrent,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.panelOverCurrent,
+            "");
+    }
+    if (testIndicator(panelUnderVoltage))
+    {
+        display.setStyleSheet(PowerManagementMainUi.panelUnderVoltage,
+            "color:white; color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.panelUnderVoltage,
+            "UV");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.panelUnderVoltage,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.panelUnderVoltage,
+            "");
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Battery 1 Fill, Health and Operational State Indicators
+*/
+
+void PowerManagementGui::processState1(const Message& message)
+{
+    QString secondField;
+    if (message.size > 1) secondField = message.fields[1].simplified();
+    int opState = secondField.toInt() & 0x03;
+    int fillState = (secondField.toInt() >> 2) & 0x03;
+    int chargingState = (secondField.toInt() >> 4) & 0x03;
+    int healthState = (secondField.toInt() >> 6) & 0x03;
+    if (fillState == 0)         // Normal
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Fill,
+            "background-color:lightgreen;");
+    }
+    else if (fillState == 1)    // Low
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Fill,
+            "background-color:yellow;");
+    }
+    else if (fillState == 2)    // Critical
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Fill,
+            "background-color:red;");
+    }
+    else if (fillState == 3)    // Faulty
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Fill,
+            "background-color:black;");
+    }
+    else                        // Invalid
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Fill,
+            "background-color:white;");
+    }
+    if (PowerManagementMainUi.autoTrackPushButton->isChecked())
+    {
+        if (opState == 0)
         {
-            PowerManagementMainUi.battery3Fill->
-                setStyleSheet("background-color:white;");
+            display.setText(PowerManagementMainUi.battery1Op,
+                "L");
         }
-        if (PowerManagementMainUi.autoTrackPushButton->isChecked())
+        else if (opState == 1)
         {
-            if (opState == 0)
-            {
-                PowerManagementMainUi.battery3Op->
-                    setText("L");
-            }
-            else if (opState == 1)
-            {
-                PowerManagementMainUi.battery3Op->
-                    setText("C");
-            }
-            else
-            {
-                PowerManagementMainUi.battery3Op->
-                    setText("I");
-            }
+            display.setText(PowerManagementMainUi.battery1Op,
+                "C");
         }
         else
         {
-            PowerManagementMainUi.battery3Op->
-                setText("");
-        }
-        if (chargingState == 0)
-        {
-            PowerManagementMainUi.battery3Charging->
-                setStyleSheet("background-color:orange;");
-            PowerManagementMainUi.battery3Charging->
-                setText("B");
+            display.setText(PowerManagementMainUi.battery1Op,
+                "I");
         }
-        else if (chargingState == 1)
-        {
-            PowerManagementMainUi.battery3Charging->
-                setStyleSheet("background-color:yellow;");
-            PowerManagementMainUi.battery3Charging->
-                setText("A");
-        }
-        else if (chargingState == 2)
-        {
-            PowerManagementMainUi.battery3Charging->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery3Charging->
-                setText("F");
-        }
-        else if (chargingState == 3)
+    }
+    else
+    {
+        display.setText(PowerManagementMainUi.battery1Op,
+            "");
+    }
+    if (chargingState == 0)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Charging,
+            "background-color:orange;");
+        display.setText(PowerManagementMainUi.battery1Charging,
+            "B");
+    }
+    else if (chargingState == 1)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Charging,
+            "background-color:yellow;");
+        display.setText(PowerManagementMainUi.battery1Charging,
+            "A");
+    }
+    else if (chargingState == 2)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Charging,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery1Charging,
+            "F");
+    }
+    else if (chargingState == 3)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Charging,
+            "background-color:pink;");
+        display.setText(PowerManagementMainUi.battery1Charging,
+            "R");
+    }
+    else if (chargingState == 4)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Charging,
+            "background-color:lightblue;");
+        display.setText(PowerManagementMainUi.battery1Charging,
+            "E");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Charging,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery1Charging,
+            " ");
+    }
+    if (healthState == 0)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Health,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery1Health,
+            "");
+    }
+    else if (healthState == 1)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Health,
+            "background-color:orange;");
+        display.setText(PowerManagementMainUi.battery1Health,
+            "F");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Health,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery1Health,
+            "X");
+        display.setStyleSheet(PowerManagementMainUi.battery1Charging,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery1Charging,
+            "");
+        display.setStyleSheet(PowerManagementMainUi.battery1Fill,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery1Fill,
+            "");
+        display.setStyleSheet(PowerManagementMainUi.battery1Op,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery1Op,
+            "");
+        display.setText(PowerManagementMainUi.battery1Charge,
+            QString(""));
+        display.setText(PowerManagementMainUi.battery1Current,QString(""));
+        display.setText(PowerManagementMainUi.battery1Voltage,QString(""));
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Battery 2 Fill, Health and Operational State Indicators
+*/
+
+void PowerManagementGui::processState2(const Message& message)
+{
+    QString secondField;
+    if (message.size > 1) secondField = message.fields[1].simplified();
+    int opState = secondField.toInt() & 0x03;
+    int fillState = (secondField.toInt() >> 2) & 0x03;
+    int chargingState = (secondField.toInt() >> 4) & 0x03;
+    int healthState = (secondField.toInt() >> 6) & 0x03;
+    if (fillState == 0)         // Normal
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Fill,
+            "background-color:lightgreen;");
+    }
+    else if (fillState == 1)    // Low
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Fill,
+            "background-color:yellow;");
+    }
+    else if (fillState == 2)    // Critical
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Fill,
+            "background-color:red;");
+    }
+    else if (fillState == 3)    // Faulty
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Fill,
+            "background-color:black;");
+    }
+    else                        // Invalid
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Fill,
+            "background-color:white;");
+    }
+    if (PowerManagementMainUi.autoTrackPushButton->isChecked())
+    {
+        if (opState == 0)
         {
-            PowerManagementMainUi.battery3Charging->
-                setStyleSheet("background-color:pink;");
-            PowerManagementMainUi.battery3Charging->
-                setText("R");
+            display.setText(PowerManagementMainUi.battery2Op,
+                "L");
         }
-        else if (chargingState == 4)
+        else if (opState == 1)
         {
-            PowerManagementMainUi.battery3Charging->
-                setStyleSheet("background-color:lightblue;");
-            PowerManagementMainUi.battery3Charging->
-                setText("E");
+            display.setText(PowerManagementMainUi.battery2Op,
+                "C");
         }
         else
         {
-            PowerManagementMainUi.battery3Charging->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery3Charging->
-                setText(" ");
+            display.setText(PowerManagementMainUi.battery2Op,
+                "I");
         }
-        if (healthState == 0)
+    }
+    else
+    {
+        display.setText(PowerManagementMainUi.battery2Op,
+            "");
+    }
+    if (chargingState == 0)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Charging,
+            "background-color:orange;");
+        display.setText(PowerManagementMainUi.battery2Charging,
+            "B");
+    }
+    else if (chargingState == 1)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Charging,
+            "background-color:yellow;");
+        display.setText(PowerManagementMainUi.battery2Charging,
+            "A");
+    }
+    else if (chargingState == 2)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Charging,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery2Charging,
+            "F");
+    }
+    else if (chargingState == 3)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Charging,
+            "background-color:pink;");
+        display.setText(PowerManagementMainUi.battery2Charging,
+            "R");
+    }
+    else if (chargingState == 4)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Charging,
+            "background-color:lightblue;");
+        display.setText(PowerManagementMainUi.battery2Charging,
+            "E");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Charging,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery2Charging,
+            " ");
+    }
+    if (healthState == 0)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Health,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery2Health,
+            "");
+    }
+    else if (healthState == 1)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Health,
+            "background-color:orange;");
+        display.setText(PowerManagementMainUi.battery2Health,
+            "F");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Health,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery2Health,
+            "X");
+        display.setStyleSheet(PowerManagementMainUi.battery2Charging,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery2Charging,
+            "");
+        display.setStyleSheet(PowerManagementMainUi.battery2Fill,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery2Fill,
+            "");
+        display.setStyleSheet(PowerManagementMainUi.battery2Op,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery2Op,
+            "");
+        display.setText(PowerManagementMainUi.battery2Charge,
+            QString(""));
+        display.setText(PowerManagementMainUi.battery2Current,QString(""));
+        display.setText(PowerManagementMainUi.battery2Voltage,QString(""));
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Battery 3 Fill, Health and Operational State Indicators
+*/
+
+void PowerManagementGui::processState3(const Message& message)
+{
+    QString secondField;
+    if (message.size > 1) secondField = message.fields[1].simplified();
+    int opState = secondField.toInt() & 0x03;
+    int fillState = (secondField.toInt() >> 2) & 0x03;
+    int chargingState = (secondField.toInt() >> 4) & 0x03;
+    int healthState = (secondField.toInt() >> 6) & 0x03;
+    if (fillState == 0)         // Normal
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3Fill,
+            "background-color:lightgreen;");
+    }
+    else if (fillState == 1)    // Low
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3Fill,
+            "background-color:yellow;");
+    }
+    else if (fillState == 2)    // Critical
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3Fill,
+            "background-color:red;");
+    }
+    else if (fillState == 3)    // Faulty
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3Fill,
+            "background-color:black;");
+    }
+    else                        // Invalid
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3Fill,
+            "background-color:white;");
+    }
+    if (PowerManagementMainUi.autoTrackPushButton->isChecked())
+    {
+        if (opState == 0)
         {
-            PowerManagementMainUi.battery3Health->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery3Health->
-                setText("");
+            display.setText(PowerManagementMainUi.battery3Op,
+                "L");
         }
-        else if (healthState == 1)
+        else if (opState == 1)
         {
-            PowerManagementMainUi.battery3Health->
-                setStyleSheet("background-color:orange;");
-            PowerManagementMainUi.battery3Health->
-                setText("F");
+            display.setText(PowerManagementMainUi.battery3Op,
+                "C");
         }
         else
         {
-            PowerManagementMainUi.battery3Health->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery3Health->
-                setText("X");
-            PowerManagementMainUi.battery3Charging->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery3Charging->
-                setText("");
-            PowerManagementMainUi.battery3Fill->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery3Fill->
-                setText("");
-            PowerManagementMainUi.battery3Op->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery3Op->
-                setText("");
-            PowerManagementMainUi.battery3Charge->
-                setText(QString(""));
-            PowerManagementMainUi.battery3Current->setText(QString(""));
-            PowerManagementMainUi.battery3Voltage->setText(QString(""));
+            display.setText(PowerManagementMainUi.battery3Op,
+                "I");
         }
     }
-/* SoC estimates */
-    if ((size > 0) && (firstField == "dC1"))
+    else
     {
-        if (PowerManagementMainUi.battery1PushButton->isChecked())
-        {
-            if (size > 1) PowerManagementMainUi.battery1Charge
-                ->setText(QString("%1").arg(secondField
-                        .toFloat()/256,0,'f',0).append('%'));
-        }
-        else
-        {
-            PowerManagementMainUi.battery1Charge->clear();
-        }
+        display.setText(PowerManagementMainUi.battery3Op,
+            "");
     }
-    if ((size > 0) && (firstField == "dC2"))
+    if (chargingState == 0)
     {
-        if (PowerManagementMainUi.battery2PushButton->isChecked())
-        {
-            if (size > 1) PowerManagementMainUi.battery2Charge
-                ->setText(QString("%1").arg(secondField
-                        .toFloat()/256,0,'f',0).append('%'));
-        }
-        else
-        {
-            PowerManagementMainUi.battery2Charge->clear();
-        }
+        display.setStyleSheet(PowerManagementMainUi.battery3Charging,
+            "background-color:orange;");
+        display.setText(PowerManagementMainUi.battery3Charging,
+            "B");
     }
-    if ((size > 0) && (firstField == "dC3"))
+    else if (chargingState == 1)
     {
-        if (PowerManagementMainUi.battery3PushButton->isChecked())
-        {
-            if (size > 1) PowerManagementMainUi.battery3Charge
-                ->setText(QString("%1").arg(secondField
-                        .toFloat()/256,0,'f',0).append('%'));
-        }
-        else
-        {
-            PowerManagementMainUi.battery3Charge->clear();
-        }
+        display.setStyleSheet(PowerManagementMainUi.battery3Charging,
+            "background-color:yellow;");
+        display.setText(PowerManagementMainUi.battery3Charging,
+            "A");
+    }
+    else if (chargingState == 2)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3Charging,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery3Charging,
+            "F");
     }
-    if ((size > 0) && (firstField == "dT"))
+    else if (chargingState == 3)
     {
-        if (size > 1) PowerManagementMainUi.temperature
-            ->setText(QString("%1").arg(secondField
-                .toFloat()/256,0,'f',1).append(QChar(0x00B0)).append("C"));
+        display.setStyleSheet(PowerManagementMainUi.battery3Charging,
+            "background-color:pink;");
+        display.setText(PowerManagementMainUi.battery3Charging,
+            "R");
     }
-/* Messages for the File Task start with f */
-    if ((size > 0) && (firstField.left(1) == "f"))
+    else if (chargingState == 4)
     {
-        recordMessageReceived(response);
+        display.setStyleSheet(PowerManagementMainUi.battery3Charging,
+            "background-color:lightblue;");
+        display.setText(PowerManagementMainUi.battery3Charging,
+            "E");
     }
-/* Messages for the Configure Task start with p or dO or dD (debug) */
-    if ((size > 0) && ((firstField.left(1) == "p") || (firstField.left(2) == "dO")))
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3Charging,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery3Charging,
+            " ");
+    }
+    if (healthState == 0)
     {
-        configureMessageReceived(response);
+        display.setStyleSheet(PowerManagementMainUi.battery3Health,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery3Health,
+            "");
     }
-    if ((size > 0) && (firstField.left(2) == "dD"))
+    else if (healthState == 1)
     {
-        configureMessageReceived(response);
+        display.setStyleSheet(PowerManagementMainUi.battery3Health,
+            "background-color:orange;");
+        display.setText(PowerManagementMainUi.battery3Health,
+            "F");
     }
-/* This allows debug messages to be displayed on the terminal. */
-    if ((size > 0) && (firstField.left(1) == "D"))
+    else
     {
-        qDebug() << response;
+        display.setStyleSheet(PowerManagementMainUi.battery3Health,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery3Health,
+            "X");
+        display.setStyleSheet(PowerManagementMainUi.battery3Charging,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery3Charging,
+            "");
+        display.setStyleSheet(PowerManagementMainUi.battery3Fill,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery3Fill,
+            "");
+        display.setStyleSheet(PowerManagementMainUi.battery3Op,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery3Op,
+            "");
+        display.setText(PowerManagementMainUi.battery3Charge,
+            QString(""));
+        display.setText(PowerManagementMainUi.battery3Current,QString(""));
+        display.setText(PowerManagementMainUi.battery3Voltage,QString(""));
     }
 }
 
 //-----------------------------------------------------------------------------
-/** @brief Convert Voltage and Current Strings for Display
+/** @brief Battery 1 SoC Estimate
+*/
 
-The current and voltage values are obtained from the command string breakdown
-converted to a QString form suitable for display. The breakdown is
-0 - command, 1 - current, 2- voltage.
+void PowerManagementGui::processCharge1(const Message& message)
+{
+    int size = message.size;
+    QString secondField;
+    if (size > 1) secondField = message.fields[1].simplified();
+    if (PowerManagementMainUi.battery1PushButton->isChecked())
+    {
+        if (size > 1) display.setText(PowerManagementMainUi.battery1Charge,
+            QString("%1").arg(secondField
+                    .toFloat()/256,0,'f',0).append('%'));
+    }
+    else
+    {
+        display.clear(PowerManagementMainUi.battery1Charge);
+    }
+}
 
-An entry is saved in the save file if it is open.
+//-----------------------------------------------------------------------------
+/** @brief Battery 2 SoC Estimate
 */
 
-void PowerManagementGui::getCurrentVoltage(const QStringList breakdown,
-                                           QString* sCurrent, QString* sVoltage)
+void PowerManagementGui::processCharge2(const Message& message)
+{
+    int size = message.size;
+    QString secondField;
+    if (size > 1) secondField = message.fields[1].simplified();
+    if (PowerManagementMainUi.battery2PushButton->isChecked())
+    {
+        if (size > 1) display.setText(PowerManagementMainUi.battery2Charge,
+            QString("%1").arg(secondField
+                    .toFloat()/256,0,'f',0).append('%'));
+    }
+    else
+    {
+        display.clear(PowerManagementMainUi.battery2Charge);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Battery 3 SoC Estimate
+*/
+
+void PowerManagementGui::processCharge3(const Message& message)
 {
-    int size = breakdown.size();
-    QString entry = breakdown[0].simplified();
-    if (size > 1)
+    int size = message.size;
+    QString secondField;
+    if (size > 1) secondField = message.fields[1].simplified();
+    if (PowerManagementMainUi.battery3PushButton->isChecked())
     {
-        float fCurrent = breakdown[1].simplified().toFloat()/256;
-        *sCurrent = QString("%1").arg(fCurrent,0,'f',2);
-        entry = entry.append(",").append(*sCurrent);
+        if (size > 1) display.setText(PowerManagementMainUi.battery3Charge,
+            QString("%1").arg(secondField
+                    .toFloat()/256,0,'f',0).append('%'));
     }
-    if (size > 2)
+    else
     {
-        float fVoltage = breakdown[2].simplified().toFloat()/256;
-        *sVoltage = QString("%1").arg(fVoltage,0,'f',2);
-        entry = entry.append(",").append(*sVoltage);
+        display.clear(PowerManagementMainUi.battery3Charge);
     }
 }
+
+//-----------------------------------------------------------------------------
+/** @brief Temperature
+*/
+
+void PowerManagementGui::processTemperature(const Message& message)
+{
+    int size = message.size;
+    QString secondField;
+    if (size > 1) secondField = message.fields[1].simplified();
+    if (size > 1) display.setText(PowerManagementMainUi.temperature,
+        QString("%1").arg(secondField
+            .toFloat()/256,0,'f',1).append(QChar(0x00B0)).append("C"));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Debug Messages
+
+This allows debug messages to be displayed on the terminal.
+*/
+
+void PowerManagementGui::processDebug(const Message& message)
+{
+    qDebug() << message.line;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Convert Voltage and Current Strings for Display
+
+The current and voltage values are obtained from the decoded message and
+converted to a QString form suitable for display. The fields are
+0 - command, 1 - current, 2- voltage.
+*/
+
+void PowerManagementGui::getCurrentVoltage(const Message& message,
+                                           QString* sCurrent, QString* sVoltage)
+{
+    if (message.size > 1)
+        *sCurrent = QString("%1").arg((float)message.value[1]/256,0,'f',2);
+    if (message.size > 2)
+        *sVoltage = QString("%1").arg((float)message.value[2]/256,0,'f',2);
+}
 //-----------------------------------------------------------------------------
 /** @brief Test indicators on the Interface Cards.
 
@@ -1728,8 +2000,7 @@ void PowerManagementGui::on_shutdownButton_clicked()
     if (socket != NULL)
     {
         socket->write("pc-\n\r");
-        if (socket != NULL) socket->close();
-        if (socket != NULL) delete socket;
+        delete socket;
     }
     accept();
 }
@@ -1744,36 +2015,36 @@ void PowerManagementGui::on_shutdownButton_clicked()
 void PowerManagementGui::initCalibration()
 {
 // Set the calibrate progress bar to invisible
-    PowerManagementMainUi.calibrateProgressBar->setVisible(false);
-    PowerManagementMainUi.calibrateProgressBar->setValue(0);
+    PowerManagementCalibrationUi.calibrateProgressBar->setVisible(false);
+    PowerManagementCalibrationUi.calibrateProgressBar->setValue(0);
 // Set the battery type combobox entries and default value
-    PowerManagementMainUi.battery1TypeCombo->addItem("Wet Cell");
-    PowerManagementMainUi.battery1TypeCombo->addItem("Gel Cell");
-    PowerManagementMainUi.battery1TypeCombo->addItem("AGM Cell");
-    PowerManagementMainUi.battery1TypeCombo->setCurrentIndex(1);
-    PowerManagementMainUi.battery2TypeCombo->addItem("Wet Cell");
-    PowerManagementMainUi.battery2TypeCombo->addItem("Gel Cell");
-    PowerManagementMainUi.battery2TypeCombo->addItem("AGM Cell");
-    PowerManagementMainUi.battery2TypeCombo->setCurrentIndex(1);
-    PowerManagementMainUi.battery3TypeCombo->addItem("Wet Cell");
-    PowerManagementMainUi.battery3TypeCombo->addItem("Gel Cell");
-    PowerManagementMainUi.battery3TypeCombo->addItem("AGM Cell");
-    PowerManagementMainUi.battery3TypeCombo->setCurrentIndex(1);
+    PowerManagementBatteriesUi.battery1TypeCombo->addItem("Wet Cell");
+    PowerManagementBatteriesUi.battery1TypeCombo->addItem("Gel Cell");
+    PowerManagementBatteriesUi.battery1TypeCombo->addItem("AGM Cell");
+    PowerManagementBatteriesUi.battery1TypeCombo->setCurrentIndex(1);
+    PowerManagementBatteriesUi.battery2TypeCombo->addItem("Wet Cell");
+    PowerManagementBatteriesUi.battery2TypeCombo->addItem("Gel Cell");
+    PowerManagementBatteriesUi.battery2TypeCombo->addItem("AGM Cell");
+    PowerManagementBatteriesUi.battery2TypeCombo->setCurrentIndex(1);
+    PowerManagementBatteriesUi.battery3TypeCombo->addItem("Wet Cell");
+    PowerManagementBatteriesUi.battery3TypeCombo->addItem("Gel Cell");
+    PowerManagementBatteriesUi.battery3TypeCombo->addItem("AGM Cell");
+    PowerManagementBatteriesUi.battery3TypeCombo->setCurrentIndex(1);
 // Set the resistance display default (with Unicode Omega)
-    PowerManagementMainUi.battery1Resistance
+    PowerManagementBatteriesUi.battery1Resistance
             ->setText(QString("0 m").append(QChar(0x03A9)));
-    PowerManagementMainUi.battery2Resistance
+    PowerManagementBatteriesUi.battery2Resistance
             ->setText(QString("0 m").append(QChar(0x03A9)));
-    PowerManagementMainUi.battery3Resistance
+    PowerManagementBatteriesUi.battery3Resistance
             ->setText(QString("0 m").append(QChar(0x03A9)));
 /* Ask for battery parameters to fill display */
-    on_queryBatteryButton_clicked();
+    onQueryBatteryButtonClicked();
 /* Ask for control settings */
-    socket->write("dS\n\r");
+    socket->write("dS\n\r", linkPriorityLow);
 /* Ask for monitor strategy parameter settings */
-    socket->write("dT\n\r");
+    socket->write("dT\n\r", linkPriorityLow);
 /* Ask for charge parameter settings */
-    socket->write("dC\n\r");
+    socket->write("dC\n\r", linkPriorityLow);
 }
 
 //-----------------------------------------------------------------------------
@@ -1801,9 +2072,9 @@ This causes the end device to initiate the calibration sequence. The window
 cannot be closed until a result is received or a timeout period is reached.
 */
 
-void PowerManagementGui::on_calibrateButton_clicked()
+void PowerManagementGui::onCalibrateButtonClicked()
 {
-    PowerManagementMainUi.calibrateProgressBar->setVisible(true);
+    PowerManagementCalibrationUi.calibrateProgressBar->setVisible(true);
     this->setEnabled(false);
     QApplication::processEvents();
     socket->write("pC\n\r");
@@ -1813,14 +2084,16 @@ void PowerManagementGui::on_calibrateButton_clicked()
 //-----------------------------------------------------------------------------
 /** @brief Query Battery Parameters
 
-Resistance, type and capacity of the batteries are requested.
+Resistance, type and capacity of the batteries are requested. The requests
+only fill the display, so they are sent at low priority behind any commands
+from the user.
 */
 
-void PowerManagementGui::on_queryBatteryButton_clicked()
+void PowerManagementGui::onQueryBatteryButtonClicked()
 {
-    socket->write("dB1\n\r");
-    socket->write("dB2\n\r");
-    socket->write("dB3\n\r");
+    socket->write("dB1\n\r", linkPriorityLow);
+    socket->write("dB2\n\r", linkPriorityLow);
+    socket->write("dB3\n\r", linkPriorityLow);
 }
 //-----------------------------------------------------------------------------
 /** @brief Set Tracking Strategy Options
@@ -1829,10 +2102,10 @@ void PowerManagementGui::on_queryBatteryButton_clicked()
 0x02 The option allowing or preventing a battery being maintained in isolation.
 */
 
-void PowerManagementGui::on_setTrackOptionButton_clicked()
+void PowerManagementGui::onSetTrackOptionButtonClicked()
 {
     int option = 0;
-    if (PowerManagementMainUi.loadChargeCheckBox->isChecked())
+    if (PowerManagementSoCUi.loadChargeCheckBox->isChecked())
     {
         option |= 0x01;
     }
@@ -1840,7 +2113,7 @@ void PowerManagementGui::on_setTrackOptionButton_clicked()
     {
         option &= ~0x01;
     }
-    if (PowerManagementMainUi.isolationMaintainCheckBox->isChecked())
+    if (PowerManagementSoCUi.isolationMaintainCheckBox->isChecked())
     {
         option |= 0x02;
     }
@@ -1850,7 +2123,7 @@ void PowerManagementGui::on_setTrackOptionButton_clicked()
     }
     QString command = "ps";
     socket->write(command.append(QString("%1").arg(option,1)).append("\n\r")
-                         .toAscii().constData());
+                         .toLatin1().constData());
 /* Write to FLASH */
     socket->write("aW\n\r");
 /* Ask for monitor strategy parameter settings */
@@ -1864,10 +2137,10 @@ This stops the charge algorithm from entering absorption phase for the purpose
 of reducing EMI.
 */
 
-void PowerManagementGui::on_absorptionMuteCheckbox_clicked()
+void PowerManagementGui::onAbsorptionMuteCheckboxClicked()
 {
     int option = 0;
-    if (PowerManagementMainUi.absorptionMuteCheckbox->isChecked())
+    if (PowerManagementChargingUi.absorptionMuteCheckbox->isChecked())
     {
         option |= 0x01;
     }
@@ -1877,7 +2150,7 @@ void PowerManagementGui::on_absorptionMuteCheckbox_clicked()
     }
     QString command = "pS";
     socket->write(command.append(QString("%1").arg(option,1)).append("\n\r")
-                         .toAscii().constData());
+                         .toLatin1().constData());
 }
 
 //-----------------------------------------------------------------------------
@@ -1886,13 +2159,13 @@ void PowerManagementGui::on_absorptionMuteCheckbox_clicked()
 The current time is read and transmitted to set time in the remote system.
 */
 
-void PowerManagementGui::on_timeSetButton_clicked()
+void PowerManagementGui::onTimeSetButtonClicked()
 {
     QDateTime localDateTime = QDateTime::currentDateTime();
     localDateTime.setTimeSpec(Qt::UTC);
     socket->write("pH");
     socket->write(localDateTime.toString(Qt::ISODate).append("\n\r")
-                               .toAscii().constData());
+                               .toLatin1().constData());
 }
 
 //-----------------------------------------------------------------------------
@@ -1900,9 +2173,9 @@ void PowerManagementGui::on_timeSetButton_clicked()
 
 */
 
-void PowerManagementGui::on_debugMessageCheckbox_clicked()
+void PowerManagementGui::onDebugMessageCheckboxClicked()
 {
-    if (PowerManagementMainUi.debugMessageCheckbox->isChecked())
+    if (PowerManagementGeneralUi.debugMessageCheckbox->isChecked())
         socket->write("pd+\n\r");
     else
         socket->write("pd-\n\r");
@@ -1913,9 +2186,9 @@ void PowerManagementGui::on_debugMessageCheckbox_clicked()
 
 */
 
-void PowerManagementGui::on_dataMessageCheckbox_clicked()
+void PowerManagementGui::onDataMessageCheckboxClicked()
 {
-    if (PowerManagementMainUi.dataMessageCheckbox->isChecked())
+    if (PowerManagementGeneralUi.dataMessageCheckbox->isChecked())
         socket->write("pM+\n\r");
     else
         socket->write("pM-\n\r");
@@ -1926,7 +2199,7 @@ void PowerManagementGui::on_dataMessageCheckbox_clicked()
 
 */
 
-void PowerManagementGui::on_echoTestButton_clicked()
+void PowerManagementGui::onEchoTestButtonClicked()
 {
     socket->write("aE\n\r");
     socket->write("dS\n\r");
@@ -1937,16 +2210,16 @@ void PowerManagementGui::on_echoTestButton_clicked()
 
 */
 
-void PowerManagementGui::on_resetMissing1Button_clicked()
+void PowerManagementGui::onResetMissing1ButtonClicked()
 {
-    if (PowerManagementMainUi.resetMissing1Button->text() == "X")
+    if (PowerManagementBatteriesUi.resetMissing1Button->text() == "X")
     {
-        PowerManagementMainUi.resetMissing1Button->setText("");
+        PowerManagementBatteriesUi.resetMissing1Button->setText("");
         socket->write("pm1-\n\r");
     }
     else
     {
-        PowerManagementMainUi.resetMissing1Button->setText("X");
+        PowerManagementBatteriesUi.resetMissing1Button->setText("X");
         socket->write("pm1+\n\r");
     }
 }
@@ -1956,16 +2229,16 @@ void PowerManagementGui::on_resetMissing1Button_clicked()
 
 */
 
-void PowerManagementGui::on_resetMissing2Button_clicked()
+void PowerManagementGui::onResetMissing2ButtonClicked()
 {
-    if (PowerManagementMainUi.resetMissing2Button->text() == "X")
+    if (PowerManagementBatteriesUi.resetMissing2Button->text() == "X")
     {
-        PowerManagementMainUi.resetMissing2Button->setText("");
+        PowerManagementBatteriesUi.resetMissing2Button->setText("");
         socket->write("pm2-\n\r");
     }
     else
     {
-        PowerManagementMainUi.resetMissing2Button->setText("X");
+        PowerManagementBatteriesUi.resetMissing2Button->setText("X");
         socket->write("pm2+\n\r");
     }
 }
@@ -1975,16 +2248,16 @@ void PowerManagementGui::on_resetMissing2Button_clicked()
 
 */
 
-void PowerManagementGui::on_resetMissing3Button_clicked()
+void PowerManagementGui::onResetMissing3ButtonClicked()
 {
-    if (PowerManagementMainUi.resetMissing3Button->text() == "X")
+    if (PowerManagementBatteriesUi.resetMissing3Button->text() == "X")
     {
-        PowerManagementMainUi.resetMissing3Button->setText("");
+        PowerManagementBatteriesUi.resetMissing3Button->setText("");
         socket->write("pm3-\n\r");
     }
     else
     {
-        PowerManagementMainUi.resetMissing3Button->setText("X");
+        PowerManagementBatteriesUi.resetMissing3Button->setText("X");
         socket->write("pm3+\n\r");
     }
 }
@@ -1997,7 +2270,7 @@ known that the current is zero. Watch out for a battery carrying about 200mA of
 quiescent current.
 */
 
-void PowerManagementGui::on_forceZeroCurrent1_clicked()
+void PowerManagementGui::onForceZeroCurrent1Clicked()
 {
     socket->write("pz1\n\r");
 }
@@ -2010,7 +2283,7 @@ known that the current is zero. Watch out for a battery carrying about 200mA of
 quiescent current.
 */
 
-void PowerManagementGui::on_forceZeroCurrent2_clicked()
+void PowerManagementGui::onForceZeroCurrent2Clicked()
 {
     socket->write("pz2\n\r");
 }
@@ -2023,7 +2296,7 @@ known that the current is zero. Watch out for a battery carrying about 200mA of
 quiescent current.
 */
 
-void PowerManagementGui::on_forceZeroCurrent3_clicked()
+void PowerManagementGui::onForceZeroCurrent3Clicked()
 {
     socket->write("pz3\n\r");
 }
@@ -2034,22 +2307,23 @@ void PowerManagementGui::on_forceZeroCurrent3_clicked()
 After a command is sent, response messages from the remote are passed here for
 processing. Appropriate fields on the form are updated.
 
-@todo This interprets response as done in main. See if this can be made
-independent of formats.
+The message has been decoded by processResponse.
 */
 
-void PowerManagementGui::configureMessageReceived(const QString response)
+void PowerManagementGui::configureMessageReceived(const Message& message)
 {
-    QStringList breakdown = response.split(",");
-    int size = breakdown.size();
-    if (size <= 0) return;
-    QChar command = breakdown[0].at(1);
-    QChar battery = breakdown[0].at(2);
-    QChar parameter = breakdown[0].at(2);
+    if (! configInitialised) return;
+    const QStringList& breakdown = message.fields;
+    int size = message.size;
+    if (message.ident.size() < 2) return;
+    QChar command = message.ident.at(1);
+    QChar battery;
+    if (message.ident.size() > 2) battery = message.ident.at(2);
+    QChar parameter = battery;
     int controlByte = 0;
     if (size > 1) controlByte = breakdown[1].simplified().toInt();
 // Error Code
-    switch (command.toAscii())
+    switch (command.toLatin1())
     {
 // Show Measured Quiescent Current
         case 'Q':
@@ -2058,15 +2332,15 @@ void PowerManagementGui::configureMessageReceived(const QString response)
             quiescentCurrent = breakdown[1].simplified();
             int test = breakdown[2].simplified().toInt();
             if (test < 6)
-                PowerManagementMainUi.calibrateProgressBar->setValue(test+1);
+                PowerManagementCalibrationUi.calibrateProgressBar->setValue(test+1);
             else
             {
-                PowerManagementMainUi.quiescentCurrent
+                PowerManagementCalibrationUi.quiescentCurrent
                         ->setText(QString("%1 A").arg(quiescentCurrent.
                                   toFloat()/256,0,'f',3));
                 this->setEnabled(true);
-                PowerManagementMainUi.calibrateProgressBar->setVisible(false);
-                PowerManagementMainUi.calibrateProgressBar->setValue(0);
+                PowerManagementCalibrationUi.calibrateProgressBar->setVisible(false);
+                PowerManagementCalibrationUi.calibrateProgressBar->setValue(0);
             }
             break;
         }
@@ -2078,13 +2352,13 @@ void PowerManagementGui::configureMessageReceived(const QString response)
                                          .simplified().toFloat()/65.536,0,'f',0)
                                          .append(QChar(0x03A9));
             if (battery == '1')
-                PowerManagementMainUi.battery1Resistance
+                PowerManagementBatteriesUi.battery1Resistance
                     ->setText(batteryResistance);
             else if (battery == '2')
-                PowerManagementMainUi.battery2Resistance
+                PowerManagementBatteriesUi.battery2Resistance
                     ->setText(batteryResistance);
             else if (battery == '3')
-                PowerManagementMainUi.battery3Resistance
+                PowerManagementBatteriesUi.battery3Resistance
                     ->setText(batteryResistance);
             break;
         }
@@ -2096,23 +2370,23 @@ void PowerManagementGui::configureMessageReceived(const QString response)
             int batteryCapacity = breakdown[2].simplified().toInt();
             if (battery == '1')
             {
-                PowerManagementMainUi.battery1TypeCombo
+                PowerManagementBatteriesUi.battery1TypeCombo
                     ->setCurrentIndex(batteryType);
-                PowerManagementMainUi.battery1CapacityLabel
+                PowerManagementBatteriesUi.battery1CapacityLabel
                     ->setText(QString("%1").arg(batteryCapacity,1));
             }
             else if (battery == '2')
             {
-                PowerManagementMainUi.battery2TypeCombo
+                PowerManagementBatteriesUi.battery2TypeCombo
                     ->setCurrentIndex(batteryType);
-                PowerManagementMainUi.battery2CapacityLabel
+                PowerManagementBatteriesUi.battery2CapacityLabel
                     ->setText(QString("%1").arg(batteryCapacity,1));
             }
             else if (battery == '3')
             {
-                PowerManagementMainUi.battery3TypeCombo
+                PowerManagementBatteriesUi.battery3TypeCombo
                     ->setCurrentIndex(batteryType);
-                PowerManagementMainUi.battery3CapacityLabel
+                PowerManagementBatteriesUi.battery3CapacityLabel
                     ->setText(QString("%1").arg(batteryCapacity,1));
             }
             break;
@@ -2125,31 +2399,31 @@ void PowerManagementGui::configureMessageReceived(const QString response)
             float bulkCurrentScale = breakdown[1].simplified().toFloat();
             if (battery == '1')
             {
-                PowerManagementMainUi.battery1AbsorptionVoltage
+                PowerManagementBatteriesUi.battery1AbsorptionVoltage
                     ->setText(QString("%1").arg(absorptionVoltage,0,'f',3));
-                float battery1Capacity = (float)PowerManagementMainUi.
+                float battery1Capacity = (float)PowerManagementBatteriesUi.
                             battery1CapacityLabel->text().toInt();
-                PowerManagementMainUi.battery1AbsorptionCurrent
+                PowerManagementBatteriesUi.battery1AbsorptionCurrent
                     ->setText(QString("%1")
                             .arg(battery1Capacity/bulkCurrentScale,0,'f',3));
             }
             else if (battery == '2')
             {
-                PowerManagementMainUi.battery2AbsorptionVoltage
+                PowerManagementBatteriesUi.battery2AbsorptionVoltage
                     ->setText(QString("%1").arg(absorptionVoltage,0,'f',3));
-                float battery2Capacity = (float)PowerManagementMainUi.
+                float battery2Capacity = (float)PowerManagementBatteriesUi.
                             battery2CapacityLabel->text().toInt();
-                PowerManagementMainUi.battery2AbsorptionCurrent
+                PowerManagementBatteriesUi.battery2AbsorptionCurrent
                     ->setText(QString("%1")
                             .arg(battery2Capacity/bulkCurrentScale,0,'f',3));
             }
             else if (battery == '3')
             {
-                PowerManagementMainUi.battery3AbsorptionVoltage
+                PowerManagementBatteriesUi.battery3AbsorptionVoltage
                     ->setText(QString("%1").arg(absorptionVoltage,0,'f',3));
-                float battery3Capacity = (float)PowerManagementMainUi.
+                float battery3Capacity = (float)PowerManagementBatteriesUi.
                             battery3CapacityLabel->text().toInt();
-                PowerManagementMainUi.battery3AbsorptionCurrent
+                PowerManagementBatteriesUi.battery3AbsorptionCurrent
                     ->setText(QString("%1")
                             .arg(battery3Capacity/bulkCurrentScale,0,'f',3));
             }
@@ -2163,31 +2437,31 @@ void PowerManagementGui::configureMessageReceived(const QString response)
             float floatCurrentScale = breakdown[1].simplified().toFloat();
             if (battery == '1')
             {
-                PowerManagementMainUi.battery1FloatVoltage
+                PowerManagementBatteriesUi.battery1FloatVoltage
                     ->setText(QString("%1").arg(floatVoltage,0,'f',3));
-                float battery1Capacity = (float)PowerManagementMainUi.
+                float battery1Capacity = (float)PowerManagementBatteriesUi.
                             battery1CapacityLabel->text().toInt();
-                PowerManagementMainUi.battery1FloatCurrent
+                PowerManagementBatteriesUi.battery1FloatCurrent
                     ->setText(QString("%1")
                             .arg(battery1Capacity/floatCurrentScale,0,'f',3));
             }
             else if (battery == '2')
             {
-                PowerManagementMainUi.battery2FloatVoltage
+                PowerManagementBatteriesUi.battery2FloatVoltage
                     ->setText(QString("%1").arg(floatVoltage,0,'f',3));
-                float battery2Capacity = (float)PowerManagementMainUi.
+                float battery2Capacity = (float)PowerManagementBatteriesUi.
                             battery2CapacityLabel->text().toInt();
-                PowerManagementMainUi.battery2FloatCurrent
+                PowerManagementBatteriesUi.battery2FloatCurrent
                     ->setText(QString("%1")
                             .arg(battery2Capacity/floatCurrentScale,0,'f',3));
             }
             else if (battery == '3')
             {
-                PowerManagementMainUi.battery3FloatVoltage
+                PowerManagementBatteriesUi.battery3FloatVoltage
                     ->setText(QString("%1").arg(floatVoltage,0,'f',3));
-                float battery3Capacity = (float)PowerManagementMainUi.
+                float battery3Capacity = (float)PowerManagementBatteriesUi.
                             battery3CapacityLabel->text().toInt();
-                PowerManagementMainUi.battery3FloatCurrent
+                PowerManagementBatteriesUi.battery3FloatCurrent
                     ->setText(QString("%1")
                             .arg(battery3Capacity/floatCurrentScale,0,'f',3));
             }
@@ -2199,14 +2473,14 @@ void PowerManagementGui::configureMessageReceived(const QString response)
             if (size < 2) break;
             bool dataMessage = ((controlByte & (1<<3)) > 0);
             if (dataMessage)
-                PowerManagementMainUi.dataMessageCheckbox->setChecked(true);
+                PowerManagementGeneralUi.dataMessageCheckbox->setChecked(true);
             else
-                PowerManagementMainUi.dataMessageCheckbox->setChecked(false);
+                PowerManagementGeneralUi.dataMessageCheckbox->setChecked(false);
             bool debugMessage = ((controlByte & (1<<4)) > 0);
             if (debugMessage)
-                PowerManagementMainUi.debugMessageCheckbox->setChecked(true);
+                PowerManagementGeneralUi.debugMessageCheckbox->setChecked(true);
             else
-                PowerManagementMainUi.debugMessageCheckbox->setChecked(false);
+                PowerManagementGeneralUi.debugMessageCheckbox->setChecked(false);
             break;
         }
 // Show current time settings from the system
@@ -2215,8 +2489,8 @@ void PowerManagementGui::configureMessageReceived(const QString response)
             if (size < 2) break;
             QDateTime systemTime =
                 QDateTime::fromString(breakdown[1].simplified(),Qt::ISODate);
-            PowerManagementMainUi.date->setText(systemTime.date().toString("dd.MM.yyyy"));
-            PowerManagementMainUi.time->setText(systemTime.time().toString("H.mm.ss"));
+            PowerManagementGeneralUi.date->setText(systemTime.date().toString("dd.MM.yyyy"));
+            PowerManagementGeneralUi.time->setText(systemTime.time().toString("H.mm.ss"));
             break;
         }
 // Operational State values for "reset missing" buttons.
@@ -2227,63 +2501,63 @@ void PowerManagementGui::configureMessageReceived(const QString response)
             {
                 if (healthState == 0)
                 {
-                    PowerManagementMainUi.resetMissing1Button->
+                    PowerManagementBatteriesUi.resetMissing1Button->
                         setStyleSheet("background-color:lightgreen;");
-                    PowerManagementMainUi.resetMissing1Button->setText("");
+                    PowerManagementBatteriesUi.resetMissing1Button->setText("");
                 }
                 else if (healthState == 1)
                 {
-                    PowerManagementMainUi.resetMissing1Button->
+                    PowerManagementBatteriesUi.resetMissing1Button->
                         setStyleSheet("background-color:orange;");
-                    PowerManagementMainUi.resetMissing1Button->setText("");
+                    PowerManagementBatteriesUi.resetMissing1Button->setText("");
                 }
                 else if (healthState == 2)
                 {
-                    PowerManagementMainUi.resetMissing1Button->
+                    PowerManagementBatteriesUi.resetMissing1Button->
                         setStyleSheet("background-color:white;");
-                    PowerManagementMainUi.resetMissing1Button->setText("X");
+                    PowerManagementBatteriesUi.resetMissing1Button->setText("X");
                 }
             }
             else if (battery == '2')
             {
                 if (healthState == 0)
                 {
-                    PowerManagementMainUi.resetMissing2Button->
+                    PowerManagementBatteriesUi.resetMissing2Button->
                         setStyleSheet("background-color:lightgreen;");
-                    PowerManagementMainUi.resetMissing2Button->setText("");
+                    PowerManagementBatteriesUi.resetMissing2Button->setText("");
                 }
                 else if (healthState == 1)
                 {
-                    PowerManagementMainUi.resetMissing2Button->
+                    PowerManagementBatteriesUi.resetMissing2Button->
                         setStyleSheet("background-color:orange;");
-                    PowerManagementMainUi.resetMissing2Button->setText("");
+                    PowerManagementBatteriesUi.resetMissing2Button->setText("");
                 }
                 else if (healthState == 2)
                 {
-                    PowerManagementMainUi.resetMissing2Button->
+                    PowerManagementBatteriesUi.resetMissing2Button->
                         setStyleSheet("background-color:white;");
-                    PowerManagementMainUi.resetMissing2Button->setText("X");
+                    PowerManagementBatteriesUi.resetMissing2Button->setText("X");
                 }
             }
             else if (battery == '3')
             {
                 if (healthState == 0)
                 {
-                    PowerManagementMainUi.resetMissing3Button->
+                    PowerManagementBatteriesUi.resetMissing3Button->
                         setStyleSheet("background-color:lightgreen;");
-                    PowerManagementMainUi.resetMissing3Button->setText("");
+                    PowerManagementBatteriesUi.resetMissing3Button->setText("");
                 }
                 else if (healthState == 1)
                 {
-                    PowerManagementMainUi.resetMissing3Button->
+                    PowerManagementBatteriesUi.resetMissing3Button->
                         setStyleSheet("background-color:orange;");
-                    PowerManagementMainUi.resetMissing3Button->setText("");
+                    PowerManagementBatteriesUi.resetMissing3Button->setText("");
                 }
                 else if (healthState == 2)
                 {
-                    PowerManagementMainUi.resetMissing3Button->
+                    PowerManagementBatteriesUi.resetMissing3Button->
                         setStyleSheet("background-color:white;");
-                    PowerManagementMainUi.resetMissing3Button->setText("X");
+                    PowerManagementBatteriesUi.resetMissing3Button->setText("X");
                 }
             }
             break;
@@ -2297,9 +2571,9 @@ void PowerManagementGui::configureMessageReceived(const QString response)
             {
                 float lowVoltage = (float)breakdown[1].simplified().toInt()/256;
                 float criticalVoltage = (float)breakdown[2].simplified().toInt()/256;
-                PowerManagementMainUi.lowVoltageEdit
+                PowerManagementSoCUi.lowVoltageEdit
                     ->setText(QString("%1").arg(lowVoltage,1));
-                PowerManagementMainUi.criticalVoltageEdit
+                PowerManagementSoCUi.criticalVoltageEdit
                     ->setText(QString("%1").arg(criticalVoltage,1));
             }
 // Low SoC and critical SoC thresholds.
@@ -2307,9 +2581,9 @@ void PowerManagementGui::configureMessageReceived(const QString response)
             {
                 int lowSoC = (float)breakdown[1].simplified().toInt()/256;
                 int criticalSoC = (float)breakdown[2].simplified().toInt()/256;
-                PowerManagementMainUi.lowSoCEdit
+                PowerManagementSoCUi.lowSoCEdit
                     ->setText(QString("%1").arg(lowSoC,1));
-                PowerManagementMainUi.criticalSoCEdit
+                PowerManagementSoCUi.criticalSoCEdit
                     ->setText(QString("%1").arg(criticalSoC,1));
             }
 /* Monitor strategy byte. Bit 0 is to allow charger and load on the same
@@ -2318,10 +2592,10 @@ battery; bit 1 is to maintain an isolated battery in normal conditions. */
             {
                 int monitorStrategy = (float)breakdown[1].simplified().toInt();
                 bool separateLoad = (monitorStrategy & 1) > 0;
-                PowerManagementMainUi.loadChargeCheckBox
+                PowerManagementSoCUi.loadChargeCheckBox
                     ->setChecked(separateLoad);
                 bool preserveIsolation = (monitorStrategy & 2) > 0;
-                PowerManagementMainUi.isolationMaintainCheckBox
+                PowerManagementSoCUi.isolationMaintainCheckBox
                     ->setChecked(preserveIsolation);
             }
             break;
@@ -2334,24 +2608,24 @@ battery; bit 1 is to maintain an isolated battery in normal conditions. */
             {
                 int restTime = (float)breakdown[1].simplified().toInt();
                 int absorptionTime = (float)breakdown[2].simplified().toInt();
-                PowerManagementMainUi.restTimeLabel
+                PowerManagementChargingUi.restTimeLabel
                     ->setText(QString("%1").arg(restTime,1));
-                PowerManagementMainUi.absorptionTimeLabel
+                PowerManagementChargingUi.absorptionTimeLabel
                     ->setText(QString("%1").arg(absorptionTime,1));
             }
             else if (parameter == 'D')
             {
                 int dutyCycleMin = (float)breakdown[1].simplified().toInt()/256;
-                PowerManagementMainUi.minimumDutyCycleLabel
+                PowerManagementChargingUi.minimumDutyCycleLabel
                     ->setText(QString("%1").arg(dutyCycleMin,1));
             }
             else if (parameter == 'F')
             {
                 int floatTime = (float)breakdown[1].simplified().toInt()/3600;
                 int floatSoC = (float)breakdown[2].simplified().toInt()/256;
-                PowerManagementMainUi.floatDelayLabel
+                PowerManagementChargingUi.floatDelayLabel
                     ->setText(QString("%1").arg(floatTime,1));
-                PowerManagementMainUi.floatBulkSoCLabel
+                PowerManagementChargingUi.floatBulkSoCLabel
                     ->setText(QString("%1").arg(floatSoC,1));
             }
 /* Charger strategy byte. Bit 0 is to suppress the absortion phase for EMI. */
@@ -2359,7 +2633,7 @@ battery; bit 1 is to maintain an isolated battery in normal conditions. */
             {
                 int chargerStrategy = (float)breakdown[1].simplified().toInt();
                 bool suppressAbsorptionPhase = (chargerStrategy & 1) > 0;
-                PowerManagementMainUi.absorptionMuteCheckbox
+                PowerManagementChargingUi.absorptionMuteCheckbox
                     ->setChecked(suppressAbsorptionPhase);
             }
             break;
@@ -2401,17 +2675,17 @@ void PowerManagementGui::initRecording()
     requestRecordingStatus();
 // Ask for the microcontroller SD card free space (process response later)
     getFreeSpace();
-    PowerManagementMainUi.recordFileName->clear();
+    PowerManagementRecordingUi.recordFileName->clear();
     model = new QStandardItemModel(0, 2, this);
     rowCount = 0;
-    PowerManagementMainUi.fileTableView->setModel(model);
-    PowerManagementMainUi.fileTableView->setGridStyle(Qt::NoPen);
-    PowerManagementMainUi.fileTableView->setShowGrid(false);
-    QHeaderView *verticalHeader = PowerManagementMainUi.fileTableView->verticalHeader();
-    verticalHeader->setResizeMode(QHeaderView::Fixed);
+    PowerManagementRecordingUi.fileTableView->setModel(model);
+    PowerManagementRecordingUi.fileTableView->setGridStyle(Qt::NoPen);
+    PowerManagementRecordingUi.fileTableView->setShowGrid(false);
+    QHeaderView *verticalHeader = PowerManagementRecordingUi.fileTableView->verticalHeader();
+    verticalHeader->setSectionResizeMode(QHeaderView::Fixed);
     verticalHeader->setDefaultSectionSize(18);
 // Signal to process a click on a directory item
-    connect(PowerManagementMainUi.fileTableView,
+    connect(PowerManagementRecordingUi.fileTableView,
                      SIGNAL(clicked(const QModelIndex)),
                      this,SLOT(onListItemClicked(const QModelIndex)));
 // Send a command to refresh the directory
@@ -2426,9 +2700,9 @@ A filename is created based on the day and month, plus a postfix character if
 this name already exists.
 */
 
-void PowerManagementGui::on_newFileButton_clicked()
+void PowerManagementGui::onNewFileButtonClicked()
 {
-    PowerManagementMainUi.recordFileName->clear();
+    PowerManagementRecordingUi.recordFileName->clear();
     QString fileName = "D" + QDate::currentDate().toString("MMdd");
 /* Check listing to see if the filename exists, and if so, increment
 the character at the filename end to make it unique.
@@ -2446,13 +2720,13 @@ character, followed by .TXT */
             {
                 fileName = fileName.left(5);
                 if (itemName[5] == '.') postfix = 'A';
-                else postfix = QChar(itemName[5].toAscii()+1);
+                else postfix = QChar(itemName[5].toLatin1()+1);
                 fileName.append(QString(postfix));
             }
         }
     }
     fileName.append(".TXT");
-    PowerManagementMainUi.recordFileName->setText(fileName);
+    PowerManagementRecordingUi.recordFileName->setText(fileName);
 }
 
 //-----------------------------------------------------------------------------
@@ -2463,13 +2737,13 @@ Display filename in edit box, or enter a directory and redisplay.
 
 void PowerManagementGui::onListItemClicked(const QModelIndex & index)
 {
-    PowerManagementMainUi.recordFileName->clear();
+    PowerManagementRecordingUi.recordFileName->clear();
     QStandardItem *item = model->itemFromIndex(index);
     QString fileName = item->text();
     QChar type = item->data().toChar();
     if (type == 'f')
     {
-        PowerManagementMainUi.recordFileName->setText(fileName);
+        PowerManagementRecordingUi.recordFileName->setText(fileName);
     }
     if (type == 'd')
         socket->write(QString("fD%1\n\r").arg(fileName).toLocal8Bit().data());
@@ -2483,9 +2757,9 @@ Response is a status that indicates if the file was opened/created and the
 recording started. This is processed later.
 */
 
-void PowerManagementGui::on_recordFileButton_clicked()
+void PowerManagementGui::onRecordFileButtonClicked()
 {
-    QString fileName = PowerManagementMainUi.recordFileName->text();
+    QString fileName = PowerManagementRecordingUi.recordFileName->text();
     if (fileName.right(4) == ".TXT")
     {
         socket->write("fW");
@@ -2504,7 +2778,7 @@ command to start recording is sent. Response is a status that indicates if the
 file was opened/created and the recording started. This is processed later.
 */
 
-void PowerManagementGui::on_startRecordingButton_clicked()
+void PowerManagementGui::onStartRecordingButtonClicked()
 {
     if (writeFileHandle < 0xFF)
     {
@@ -2519,7 +2793,7 @@ void PowerManagementGui::on_startRecordingButton_clicked()
 
 */
 
-void PowerManagementGui::on_stopRecordingButton_clicked()
+void PowerManagementGui::onStopRecordingButtonClicked()
 {
     socket->write("pr-\n\r");
     requestRecordingStatus();
@@ -2531,7 +2805,7 @@ void PowerManagementGui::on_stopRecordingButton_clicked()
 If recording is in progress it is stopped and the write file is closed.
 */
 
-void PowerManagementGui::on_closeRecordingFileButton_clicked()
+void PowerManagementGui::onCloseRecordingFileButtonClicked()
 {
     if (writeFileHandle < 0xFF)
     {
@@ -2551,22 +2825,22 @@ void PowerManagementGui::on_closeRecordingFileButton_clicked()
 After a command is sent, response messages from the remote are passed here for
 processing. Appropriate fields on the form are updated.
 
-@todo This interprets response as done in main. See if this can be made
-independent of formats.
+The message has been decoded by processResponse.
 */
 
-void PowerManagementGui::recordMessageReceived(const QString response)
+void PowerManagementGui::recordMessageReceived(const Message& message)
 {
-    QStringList breakdown = response.split(",");
-    QString command = breakdown[0].right(1);
+    if (! recordingInitialised) return;
+    const QStringList& breakdown = message.fields;
+    QString command = message.ident.right(1);
 // Error Code
-    switch (command[0].toAscii())
+    switch (command[0].toLatin1())
     {
 // Show Free Space
         case 'F':
         {
             int freeSpace = breakdown[2].toInt()*breakdown[1].toInt()/2048;
-            PowerManagementMainUi.diskSpaceAvailable->setText(QString("%1 M")\
+            PowerManagementRecordingUi.diskSpaceAvailable->setText(QString("%1 M")\
                                                     .arg(freeSpace, 0, 10));
             break;
         }
@@ -2657,25 +2931,25 @@ no directory name. */
             if (breakdown.size() <= 1) break;
             recordingOn = (breakdown[1].toInt() & 0x02) > 0;
             if (recordingOn)  // recording on
-                PowerManagementMainUi.startRecordingButton->
+                PowerManagementRecordingUi.startRecordingButton->
                     setStyleSheet("background-color:lightgreen;");
             else
-                PowerManagementMainUi.startRecordingButton->
+                PowerManagementRecordingUi.startRecordingButton->
                     setStyleSheet("background-color:lightpink;");
             if (breakdown.size() <= 2) break;
             writeFileHandle = breakdown[2].toInt();
             writeFileOpen = (writeFileHandle < 255);
             if (writeFileOpen)
             {
-                PowerManagementMainUi.recordFileButton->
+                PowerManagementRecordingUi.recordFileButton->
                     setStyleSheet("background-color:lightgreen;");
-                PowerManagementMainUi.recordFileName->setText(breakdown[3]);
+                PowerManagementRecordingUi.recordFileName->setText(breakdown[3]);
             }
             else
             {
-                PowerManagementMainUi.recordFileButton->
+                PowerManagementRecordingUi.recordFileButton->
                     setStyleSheet("background-color:lightpink;");
-                PowerManagementMainUi.recordFileName->setText(QString("D%1.TXT")
+                PowerManagementRecordingUi.recordFileName->setText(QString("D%1.TXT")
                     .arg(QDate::currentDate().toString("MMdd")));
             }
             if (breakdown.size() <= 3) break;
@@ -2684,7 +2958,7 @@ no directory name. */
 // Open a file for recording.
         case 'W':
         {
-            writeFileHandle = extractValue(response);
+            writeFileHandle = extractValue(message.line);
             break;
         }
         case 'E':
@@ -2738,7 +3012,7 @@ int PowerManagementGui::extractValue(const QString &response)
 
 */
 
-void PowerManagementGui::on_registerButton_clicked()
+void PowerManagementGui::onRegisterButtonClicked()
 {
     socket->write("fM/\n\r");
     refreshDirectory();
@@ -2749,7 +3023,7 @@ void PowerManagementGui::on_registerButton_clicked()
 
 */
 
-void PowerManagementGui::on_refreshListButton_clicked()
+void PowerManagementGui::onRefreshListButtonClicked()
 {
     refreshDirectory();
 }
@@ -41,8 +41,17 @@
 #define Vscale (1+R4/R5)/(1+R9/R7)
 
 #include "ui_power-management.h"
+#include "ui_power-management-recording.h"
+#include "ui_power-management-general.h"
+#include "ui_power-management-batteries.h"
+#include "ui_power-management-calibration.h"
+#include "ui_power-management-soc.h"
+#include "ui_power-management-charging.h"
 #include "power-management.h"
-#include "serialport.h"
+#include "power-management-link.h"
+#include "power-management-message.h"
+#include "power-management-dispatch.h"
+#include "power-management-display.h"
 #include <QDir>
 #include <QFile>
 #include <QTime>
@@ -68,15 +77,19 @@ class PowerManagementGui : public QDialog
 {
     Q_OBJECT
 public:
-    PowerManagementGui(QWidget* parent = 0);
+    PowerManagementGui(QString device, QWidget* parent = 0);
     ~PowerManagementGui();
     bool success();
     QString error();
+    void setStartTime(qint64 time);
+    void setRefreshRate(int rate);
 protected:
 private slots:
     void tabChanged(int index);
-    void onDataAvailable();
+    void onMessagesAvailable();
+    void onLinkOpened(bool ok);
     void checkCommunications();
+    void reportFirstValue();
     void on_load1Battery1_pressed();
     void on_load1Battery2_pressed();
     void on_load1Battery3_pressed();
@@ -106,52 +119,84 @@ private slots:
     void disableRadioButtons(bool enable);
     void on_shutdownButton_clicked();
 // Configuration
-    void on_timeSetButton_clicked();
-    void on_debugMessageCheckbox_clicked();
-    void on_dataMessageCheckbox_clicked();
-    void on_echoTestButton_clicked();
-    void on_queryBatteryButton_clicked();
-    void on_resetMissing1Button_clicked();
-    void on_resetMissing2Button_clicked();
-    void on_resetMissing3Button_clicked();
-    void on_forceZeroCurrent1_clicked();
-    void on_forceZeroCurrent2_clicked();
-    void on_forceZeroCurrent3_clicked();
+    void onTimeSetButtonClicked();
+    void onDebugMessageCheckboxClicked();
+    void onDataMessageCheckboxClicked();
+    void onEchoTestButtonClicked();
+    void onQueryBatteryButtonClicked();
+    void onResetMissing1ButtonClicked();
+    void onResetMissing2ButtonClicked();
+    void onResetMissing3ButtonClicked();
+    void onForceZeroCurrent1Clicked();
+    void onForceZeroCurrent2Clicked();
+    void onForceZeroCurrent3Clicked();
     void initCalibration();
     void on_connectButton_clicked();
-    void on_calibrateButton_clicked();
-    void on_setTrackOptionButton_clicked();
-    void on_absorptionMuteCheckbox_clicked();
-    void configureMessageReceived(const QString text);
+    void onCalibrateButtonClicked();
+    void onSetTrackOptionButtonClicked();
+    void onAbsorptionMuteCheckboxClicked();
+    void configureMessageReceived(const Message& message);
 // Recording
-    void on_newFileButton_clicked();
+    void onNewFileButtonClicked();
     void onListItemClicked(const QModelIndex & index);
-    void on_recordFileButton_clicked();
-    void on_startRecordingButton_clicked();
-    void on_stopRecordingButton_clicked();
-    void on_closeRecordingFileButton_clicked();
-    void on_registerButton_clicked();
-    void recordMessageReceived(const QString text);
-    void on_refreshListButton_clicked();
+    void onRecordFileButtonClicked();
+    void onStartRecordingButtonClicked();
+    void onStopRecordingButtonClicked();
+    void onCloseRecordingFileButtonClicked();
+    void onRegisterButtonClicked();
+    void recordMessageReceived(const Message& message);
+    void onRefreshListButtonClicked();
 private:
 // User Interface object instance
     Ui::PowerManagementDialog PowerManagementMainUi;
+// Contents of the other tabs, built when first shown
+    Ui::PowerManagementRecordingTab PowerManagementRecordingUi;
+    Ui::PowerManagementGeneralTab PowerManagementGeneralUi;
+    Ui::PowerManagementBatteriesTab PowerManagementBatteriesUi;
+    Ui::PowerManagementCalibrationTab PowerManagementCalibrationUi;
+    Ui::PowerManagementSoCTab PowerManagementSoCUi;
+    Ui::PowerManagementChargingTab PowerManagementChargingUi;
     bool responseReceived;
     QTimer *timer;
-    uint baudrate;
+    int retryTime;
+    qint64 startTime;
+    bool firstValueShown;
+    qint32 baudrate;
     bool synchronized;
     QString errorMessage;
-    QString response;
-    SerialPort* socket;           //!< Serial port object pointer
+    Link* socket;                 //!< Serial link object pointer
     quint16 blockSize;
-    QTime tick;
     int load1Current;
     int load1Voltage;
     unsigned int indicators;
     void initGui();
-    void processResponse(const QString response);
-    void getCurrentVoltage(const QStringList breakdown,QString* sVoltage,
-                           QString* sCurrent);
+    void buildRecordingTab();
+    void buildConfigurationTabs();
+    void processResponse(const Message& message);
+    void showFirstValue();
+    void getCurrentVoltage(const Message& message, QString* sCurrent,
+                           QString* sVoltage);
+    void initDispatcher();
+    void processTime(const Message& message);
+    void processLoad1(const Message& message);
+    void processLoad2(const Message& message);
+    void processPanel(const Message& message);
+    void processBattery1(const Message& message);
+    void processBattery2(const Message& message);
+    void processBattery3(const Message& message);
+    void processControls(const Message& message);
+    void processSwitches(const Message& message);
+    void processIndicators(const Message& message);
+    void processState1(const Message& message);
+    void processState2(const Message& message);
+    void processState3(const Message& message);
+    void processCharge1(const Message& message);
+    void processCharge2(const Message& message);
+    void processCharge3(const Message& message);
+    void processTemperature(const Message& message);
+    void processDebug(const Message& message);
+    MessageDispatcher<PowerManagementGui> dispatcher;
+    DisplayState display;
     void displayErrorMessage(const QString message);
     void ssleep(int seconds);
     char timeTick;
@@ -7,6 +7,11 @@
 This is the touchscreen user interface to the Solar-Battery Power Management
 System.on BeagleBone.
 
+Call with power-management [options]
+
+-P   serial port (/dev/ttyUSB0 default)
+-r   rate: display refreshes per second (1 to 60, 20 default)
+
 @note
 Compiler: gcc (Ubuntu 4.6.3-1ubuntu5) 4.6.3
 @note
@@ -34,9 +39,14 @@ Uses: Qt version 4.8.1
  *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
  ***************************************************************************/
 
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
 #include "power-management-main.h"
 #include <QApplication>
 #include <QMessageBox>
+#include <QDateTime>
 
 //-----------------------------------------------------------------------------
 /** @brief Power Management GUI Main Program
@@ -45,9 +55,45 @@ Uses: Qt version 4.8.1
 
 int main(int argc,char ** argv)
 {
+    qint64 startTime = QDateTime::currentMSecsSinceEpoch();
+/* Interpret any command line options */
+    int c;
+    opterr = 0;
+    QString serialDevice = SERIAL_PORT;
+    int refreshRate = DISPLAY_REFRESH_RATE;
+    while ((c = getopt (argc, argv, "P:r:")) != -1)
+    {
+        switch (c)
+        {
+// Serial Port Device
+        case 'P':
+            serialDevice = optarg;
+            break;
+// Display refresh rate
+        case 'r':
+            refreshRate = atoi(optarg);
+            if ((refreshRate < 1) || (refreshRate > DISPLAY_MAX_REFRESH_RATE))
+            {
+                fprintf (stderr, "Invalid refresh rate %i.\n", refreshRate);
+                return 1;
+            }
+            break;
+// Unknown
+        case '?':
+            if ((optopt == 'P') || (optopt == 'r'))
+                fprintf (stderr, "Option -%c requires an argument.\n", optopt);
+            else if (isprint (optopt))
+                fprintf (stderr, "Unknown option `-%c'.\n", optopt);
+            else
+                fprintf (stderr,"Unknown option character `\\x%x'.\n",optopt);
+            default: return 1;
+        }
+    }
     QApplication application(argc,argv);
     application.setOverrideCursor(Qt::BlankCursor);
-    PowerManagementGui powerManagementGui;
+    PowerManagementGui powerManagementGui(serialDevice);
+    powerManagementGui.setStartTime(startTime);
+    powerManagementGui.setRefreshRate(refreshRate);
     if (powerManagementGui.success())
     {
         powerManagementGui.setWindowFlags(Qt::X11BypassWindowManagerHint);
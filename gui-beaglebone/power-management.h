@@ -28,10 +28,13 @@
 #ifndef POWER_MANAGEMENT_H
 #define POWER_MANAGEMENT_H
 
-// Need to tell qextserialport we are in POSIX
-#define _TTY_POSIX_
-
 // Particular serial port to use
 #define SERIAL_PORT "/dev/ttyUSB0"
+#define SERIAL_BAUDRATE 38400
+
+// Time in ms before the first attempt to contact the BMS is repeated. The time
+// is doubled on each attempt up to COMMS_RETRY_TIME.
+#define STARTUP_RETRY_TIME 250
+#define COMMS_RETRY_TIME 1000
 
 #endif
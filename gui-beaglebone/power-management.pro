@@ -2,7 +2,7 @@ PROJECT =       Power Management GUI
 TEMPLATE =      app
 TARGET          += 
 DEPENDPATH      += .
-include(../auxiliary/qextserialport-v1.2/src/qextserialport.pri)
+INCLUDEPATH     += ../gui
 
 OBJECTS_DIR     = obj
 MOC_DIR         = moc
@@ -10,14 +10,30 @@ UI_HEADERS_DIR  = ui
 UI_SOURCES_DIR  = ui
 LANGUAGE        = C++
 CONFIG          += qt warn_on release
+QT              += widgets
+QT              += serialport
 QT              += network
 
 RESOURCES       = power-management-gui.qrc
 # Input
 FORMS           += power-management.ui
+FORMS           += power-management-recording.ui
+FORMS           += power-management-general.ui
+FORMS           += power-management-batteries.ui
+FORMS           += power-management-calibration.ui
+FORMS           += power-management-soc.ui
+FORMS           += power-management-charging.ui
 HEADERS         += power-management-main.h
-HEADERS         += serialport.h
+HEADERS         += ../gui/power-management-message.h
+HEADERS         += ../gui/power-management-dispatch.h
+HEADERS         += ../gui/power-management-display.h
+HEADERS         += ../gui/power-management-link.h
+HEADERS         += ../gui/power-management-capture.h
 SOURCES         += power-management.cpp
 SOURCES         += power-management-main.cpp
-SOURCES         += serialport.cpp
+SOURCES         += ../gui/power-management-message.cpp
+SOURCES         += ../gui/power-management-dispatch.cpp
+SOURCES         += ../gui/power-management-display.cpp
+SOURCES         += ../gui/power-management-link.cpp
+SOURCES         += ../gui/power-management-capture.cpp
 
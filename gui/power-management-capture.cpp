@@ -0,0 +1,395 @@
+/*       Power Management Capture Writer
+
+Lines received from the BMS are saved to the capture file from a thread of
+their own. The GUI only appends each line to a queue.
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include "power-management-capture.h"
+#include "power-management-message.h"
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QDataStream>
+#include <unistd.h>
+
+//-----------------------------------------------------------------------------
+/** Capture Writer Constructor
+*/
+
+CaptureWriter::CaptureWriter(QObject* parent) : QThread(parent)
+{
+    stopping = false;
+    syncInterval = CAPTURE_SYNC_INTERVAL;
+    timestamps = false;
+    fileFormat = captureText;
+    nextIndexTime = 0;
+    lastElapsed = 0;
+    sessionStart = 0;
+}
+
+CaptureWriter::~CaptureWriter()
+{
+    close();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Open the capture file and start the writer thread
+
+A session file is always started afresh, with its header, and its times are
+taken from now.
+
+@param[in] fileName Name of the file to be written.
+@param[in] append Add to the end of an existing text file rather than replace it.
+@returns true if the file was opened.
+*/
+
+bool CaptureWriter::open(QString fileName, bool append)
+{
+    if (isOpen()) return false;
+    file.setFileName(fileName);
+    QIODevice::OpenMode mode = QIODevice::WriteOnly;
+    if (append && (fileFormat == captureText)) mode |= QIODevice::Append;
+    if (! file.open(mode)) return false;
+    if (fileFormat == captureSession)
+    {
+        QDataStream stream(&file);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream << (quint32)SESSION_MAGIC << (quint32)SESSION_VERSION
+               << (qint64)QDateTime::currentMSecsSinceEpoch();
+        indexTimes.clear();
+        indexOffsets.clear();
+        nextIndexTime = 0;
+        lastElapsed = 0;
+        sessionStart = monotonicTime();
+    }
+    stopping = false;
+    depth.store(0);
+    maxDepth.store(0);
+    latency.store(0);
+    worstLatency.store(0);
+    written.store(0);
+    dropped.store(0);
+    start();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Write out all queued lines, stop the thread and close the file
+*/
+
+void CaptureWriter::close()
+{
+    if (! isOpen()) return;
+    mutex.lock();
+    stopping = true;
+    wake.wakeOne();
+    mutex.unlock();
+    wait();
+    if (fileFormat == captureSession) writeIndex();
+    file.close();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Check if a capture is in progress
+*/
+
+bool CaptureWriter::isOpen() const
+{
+    return file.isOpen();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the time between synchronising the file to the device
+
+@param[in] interval Time in ms. Zero synchronises after every batch.
+*/
+
+void CaptureWriter::setSyncInterval(int interval)
+{
+    QMutexLocker locker(&mutex);
+    syncInterval = interval;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Put the host time in front of each line
+
+The time is that at which the line was received, to ms precision.
+*/
+
+void CaptureWriter::setTimestamps(bool enable)
+{
+    QMutexLocker locker(&mutex);
+    timestamps = enable;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the format of the file
+
+Takes effect when the file is next opened.
+*/
+
+void CaptureWriter::setFormat(CaptureFormat format)
+{
+    if (! isOpen()) fileFormat = format;
+}
+
+CaptureFormat CaptureWriter::captureFormat() const
+{
+    return fileFormat;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Queue a line for writing
+
+The writer is woken early if a full batch is waiting, otherwise it writes the
+queue at CAPTURE_WRITE_INTERVAL.
+
+@param[in] line The line received, without line ending.
+@param[in] time Host time in ms since epoch at which it was received.
+@param[in] stamp Monotonic time in us at which it was framed, from
+           monotonicTime.
+*/
+
+void CaptureWriter::writeLine(const QString& line, qint64 time, qint64 stamp)
+{
+    if (! isOpen()) return;
+    CaptureLine entry;
+    entry.line = line;
+    entry.time = time;
+    entry.stamp = stamp;
+    entry.type = sessionReceived;
+    entry.elapsed = 0;
+    queueLine(entry);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Queue a line sent to the BMS
+
+Only a session keeps the lines sent. May be called from any thread.
+
+@param[in] line The line sent, without line ending.
+*/
+
+void CaptureWriter::writeSent(const QString& line)
+{
+    if (! isOpen() || (fileFormat != captureSession)) return;
+    CaptureLine entry;
+    entry.line = line;
+    entry.time = QDateTime::currentMSecsSinceEpoch();
+    entry.stamp = monotonicTime();
+    entry.type = sessionSent;
+    entry.elapsed = 0;
+    queueLine(entry);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Add a line to the queue
+
+The session time is the stamp of the line relative to the opening of the
+file. Under the lock it is kept from falling below the last time queued, so
+that the times in the file never go backwards when lines are queued from more
+than one thread or a sent line is queued ahead of an earlier received one.
+*/
+
+void CaptureWriter::queueLine(const CaptureLine& line)
+{
+    CaptureLine entry = line;
+    QMutexLocker locker(&mutex);
+    if (fileFormat == captureSession)
+    {
+        entry.elapsed = qMax(entry.stamp - sessionStart, lastElapsed);
+        lastElapsed = entry.elapsed;
+    }
+    if (pending.size() >= CAPTURE_MAX_LINES)
+    {
+        dropped.fetchAndAddRelaxed(1);
+        return;
+    }
+    pending.append(entry);
+    int size = pending.size();
+    depth.store(size);
+    if (size > maxDepth.load()) maxDepth.store(size);
+    if (size >= CAPTURE_BATCH_LINES) wake.wakeOne();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Writer thread
+
+The queue is taken as a whole under the lock and written outside it, so that
+the GUI is never held up by the file.
+*/
+
+void CaptureWriter::run()
+{
+    QElapsedTimer syncTimer;
+    syncTimer.start();
+    bool unsynced = false;
+    mutex.lock();
+    forever
+    {
+        if (pending.isEmpty() && ! stopping)
+            wake.wait(&mutex, CAPTURE_WRITE_INTERVAL);
+        QList<CaptureLine> batch;
+        batch.swap(pending);
+        depth.store(0);
+        bool stop = stopping;
+        int interval = syncInterval;
+        bool stamp = timestamps;
+        mutex.unlock();
+        if (! batch.isEmpty())
+        {
+            QElapsedTimer writeTimer;
+            writeTimer.start();
+            if (fileFormat == captureSession)
+                file.write(formatSession(batch, file.pos()));
+            else file.write(format(batch, stamp));
+            file.flush();
+            qint64 time = writeTimer.nsecsElapsed()/1000;
+            latency.store(time);
+            if (time > worstLatency.load()) worstLatency.store(time);
+            written.fetchAndAddRelaxed(batch.size());
+            unsynced = true;
+        }
+        if (unsynced && (stop || (syncTimer.elapsed() >= interval)))
+        {
+            fsync(file.handle());
+            syncTimer.restart();
+            unsynced = false;
+        }
+        mutex.lock();
+        if (stop && pending.isEmpty()) break;
+    }
+    mutex.unlock();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Build the text of a batch of lines
+*/
+
+QByteArray CaptureWriter::format(const QList<CaptureLine>& batch,
+                                 bool stamp) const
+{
+    QString text;
+    for (int i=0; i<batch.size(); i++)
+    {
+        if (stamp)
+            text.append(QDateTime::fromMSecsSinceEpoch(batch[i].time)
+                        .toString("yyyy-MM-ddThh:mm:ss.zzz,"));
+        text.append(batch[i].line).append("\r\n");
+    }
+    return text.toLocal8Bit();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Capture statistics
+
+Latencies are the time in microseconds to write and flush one batch.
+*/
+
+int CaptureWriter::queueDepth() const
+{
+    return depth.load();
+}
+
+int CaptureWriter::maxQueueDepth() const
+{
+    return maxDepth.load();
+}
+
+qint64 CaptureWriter::lastLatency() const
+{
+    return latency.load();
+}
+
+qint64 CaptureWriter::maxLatency() const
+{
+    return worstLatency.load();
+}
+
+qint64 CaptureWriter::linesWritten() const
+{
+    return written.load();
+}
+
+qint64 CaptureWriter::linesDropped() const
+{
+    return dropped.load();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Build the blocks of a batch of lines for a session file
+
+The first block at or after each index interval is entered in the index.
+Called only from the writer thread.
+
+@param[in] batch Lines to be written.
+@param[in] offset File position at which the blocks will be written.
+*/
+
+QByteArray CaptureWriter::formatSession(const QList<CaptureLine>& batch,
+                                        qint64 offset)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    for (int i=0; i<batch.size(); i++)
+    {
+        if (batch[i].elapsed >= nextIndexTime)
+        {
+            indexTimes.append(batch[i].elapsed);
+            indexOffsets.append(offset + data.size());
+            nextIndexTime = batch[i].elapsed + SESSION_INDEX_INTERVAL;
+        }
+        QByteArray line = batch[i].line.toLatin1();
+        stream << (quint32)line.size() << (quint8)batch[i].type
+               << (qint64)batch[i].elapsed;
+        stream.writeRawData(line.constData(), line.size());
+    }
+    return data;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief End a session file with its index and trailer
+
+The index block holds the time and file offset of each entry. The duration is
+the time of the last block written.
+*/
+
+void CaptureWriter::writeIndex()
+{
+    qint64 indexOffset = file.pos();
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << (quint32)(indexTimes.size()*16) << (quint8)sessionIndex
+           << (qint64)lastElapsed;
+    for (int i=0; i<indexTimes.size(); i++)
+        stream << (qint64)indexTimes[i] << (qint64)indexOffsets[i];
+    stream << (qint64)indexOffset << (qint64)lastElapsed
+           << (quint32)SESSION_TRAILER_MAGIC;
+    file.flush();
+    fsync(file.handle());
+}
@@ -0,0 +1,147 @@
+/*          Power Management GUI Capture Writer Header
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#ifndef POWER_MANAGEMENT_CAPTURE_H
+#define POWER_MANAGEMENT_CAPTURE_H
+
+#include <QThread>
+#include <QFile>
+#include <QString>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+
+// Lines queued before the writer is woken early
+#define CAPTURE_BATCH_LINES 256
+// Longest time in ms that a line waits in the queue
+#define CAPTURE_WRITE_INTERVAL 500
+// Most lines held in the queue. Further lines are dropped and counted.
+#define CAPTURE_MAX_LINES 65536
+// Default time in ms between forcing the file to the storage device
+#define CAPTURE_SYNC_INTERVAL 5000
+
+// Session file layout. All values are little endian.
+// Header: magic, version, host start time in ms since epoch.
+// Block: payload length (4), type (1), time in us since the start (8), payload.
+// Trailer, written on close: index block offset (8), duration in us (8), magic.
+#define SESSION_MAGIC       0x53534d42
+#define SESSION_VERSION     1
+#define SESSION_TRAILER_MAGIC 0x58534d42
+#define SESSION_HEADER_SIZE 16
+#define SESSION_BLOCK_HEADER_SIZE 13
+#define SESSION_TRAILER_SIZE 20
+// Time in us between index entries
+#define SESSION_INDEX_INTERVAL 1000000
+// File name ending that selects the session format
+#define SESSION_SUFFIX      ".bms"
+
+// Format of the capture file, and the types of session blocks
+typedef enum {captureText, captureSession} CaptureFormat;
+typedef enum {sessionReceived, sessionSent, sessionIndex} SessionBlockType;
+
+//-----------------------------------------------------------------------------
+/** @brief Writer of received lines to a capture file in its own thread.
+
+Lines are queued by the GUI and written in batches by the writer thread, so
+that slow storage holds up neither the GUI nor the link. Each batch is written
+with a single call and the file is synchronised to the device at a set
+interval rather than on every line. A host timestamp can be placed in front of
+each line.
+
+The queue is bounded so that a stalled device cannot use up memory. The queue
+depth and the time taken by each batch write are kept so that the GUI can
+report them.
+
+In the session format the lines sent to the BMS are saved as well as those
+received, each in a binary block with its time on the monotonic clock of
+monotonicTime, relative to the opening of the file. Received lines carry the
+time at which the link framed them, so that a stall in the GUI does not
+distort the timing. An index of the file offset of the first block in
+each second is written at the end when the file is closed, so that a player
+can seek quickly. A file left without its index can still be played.
+*/
+
+class CaptureWriter : public QThread
+{
+public:
+    CaptureWriter(QObject* parent = 0);
+    ~CaptureWriter();
+    bool open(QString fileName, bool append = false);
+    void close();
+    bool isOpen() const;
+    void setSyncInterval(int interval);
+    void setTimestamps(bool enable);
+    void setFormat(CaptureFormat format);
+    CaptureFormat captureFormat() const;
+    void writeLine(const QString& line, qint64 time, qint64 stamp);
+    void writeSent(const QString& line);
+    int queueDepth() const;
+    int maxQueueDepth() const;
+    qint64 lastLatency() const;
+    qint64 maxLatency() const;
+    qint64 linesWritten() const;
+    qint64 linesDropped() const;
+protected:
+    void run();
+private:
+    struct CaptureLine
+    {
+        QString line;
+        qint64 time;
+        qint64 stamp;
+        qint64 elapsed;
+        SessionBlockType type;
+    };
+    void queueLine(const CaptureLine& entry);
+    QByteArray format(const QList<CaptureLine>& batch, bool stamp) const;
+    QByteArray formatSession(const QList<CaptureLine>& batch, qint64 offset);
+    void writeIndex();
+    QFile file;
+    QMutex mutex;
+    QWaitCondition wake;
+    QList<CaptureLine> pending;
+    bool stopping;
+    int syncInterval;
+    bool timestamps;
+    CaptureFormat fileFormat;
+    qint64 sessionStart;
+    QList<qint64> indexTimes;
+    QList<qint64> indexOffsets;
+    qint64 nextIndexTime;
+    qint64 lastElapsed;
+    QAtomicInt depth;
+    QAtomicInt maxDepth;
+    QAtomicInteger<qint64> latency;
+    QAtomicInteger<qint64> worstLatency;
+    QAtomicInteger<qint64> written;
+    QAtomicInteger<qint64> dropped;
+};
+
+#endif
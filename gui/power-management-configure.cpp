@@ -51,21 +51,14 @@ algorithmic configurations, calibration and general operational configuration.
 //-----------------------------------------------------------------------------
 /** Power Management Configuration Window Constructor
 
-@param[in] socket TCP Socket object pointer
+@param[in] socket Serial or TCP link object pointer
 @param[in] parent Parent widget.
 */
 
-#ifdef SERIAL
-PowerManagementConfigGui::PowerManagementConfigGui(QSerialPort* p, QWidget* parent)
+PowerManagementConfigGui::PowerManagementConfigGui(Link* p, QWidget* parent)
                                                     : QDialog(parent)
 {
     socket = p;
-#else
-PowerManagementConfigGui::PowerManagementConfigGui(QTcpSocket* tcpSocket, QWidget* parent)
-                                                    : QDialog(parent)
-{
-    socket = tcpSocket;
-#endif
 // Build the User Interface display from the Ui class in ui_mainwindowform.h
     PowerManagementConfigUi.setupUi(this);
     PowerManagementConfigUi.battery1AbsorptionCurrent->setDecimals(2);
@@ -103,16 +96,18 @@ PowerManagementConfigGui::PowerManagementConfigGui(QTcpSocket* tcpSocket, QWidge
             ->setText(QString("0 m").append(QChar(0x03A9)));
     PowerManagementConfigUi.battery3Resistance
             ->setText(QString("0 m").append(QChar(0x03A9)));
+    connect(socket, SIGNAL(commandFailed(QByteArray)),
+            this, SLOT(onCommandFailed(QByteArray)));
 /* Ask for identification */
     socket->write("aE\n\r");
 /* Ask for battery parameters to fill display */
     on_queryBatteryButton_clicked();
 /* Ask for switch control settings */
-    socket->write("dS\n\r");
+    socket->write("dS\n\r", linkPriorityLow);
 /* Ask for monitor strategy parameter settings */
-    socket->write("dT\n\r");
+    socket->write("dT\n\r", linkPriorityLow);
 /* Ask for charger strategy parameter settings */
-    socket->write("dC\n\r");
+    socket->write("dC\n\r", linkPriorityLow);
 }
 
 PowerManagementConfigGui::~PowerManagementConfigGui()
@@ -131,20 +126,22 @@ void PowerManagementConfigGui::on_calibrateButton_clicked()
     PowerManagementConfigUi.calibrateProgressBar->setVisible(true);
     this->setEnabled(false);
     QApplication::processEvents();
-    socket->write("pC\n\r");
+    socket->sendCommand("pC");
 }
 
 //-----------------------------------------------------------------------------
 /** @brief Query Battery Parameters
 
 Resistance, type and capacity and parameters of the batteries are returned.
+The requests only fill the display, so they are sent at low priority behind
+any commands from the user.
 */
 
 void PowerManagementConfigGui::on_queryBatteryButton_clicked()
 {
-    socket->write("dB1\n\r");
-    socket->write("dB2\n\r");
-    socket->write("dB3\n\r");
+    socket->write("dB1\n\r", linkPriorityLow);
+    socket->write("dB2\n\r", linkPriorityLow);
+    socket->write("dB3\n\r", linkPriorityLow);
 }
 //-----------------------------------------------------------------------------
 /** @brief Set Battery Parameters
@@ -160,94 +157,174 @@ void PowerManagementConfigGui::on_setBatteryButton_clicked()
                 ->value();
     int battery3Capacity = PowerManagementConfigUi.battery3CapacitySpinBox
                 ->value();
+    QStringList parameters;
 // Set type and capacity. Capacity is an integer unscaled.
     QString typeSet1 = "pT1";
     typeSet1.append(QString("%1").arg(PowerManagementConfigUi.battery1TypeCombo
                 ->currentIndex(),1));
     typeSet1.append(QString("%1").arg(battery1Capacity,-0));
-    socket->write(typeSet1.append("\n\r").toLatin1().constData());
+    parameters << typeSet1;
     QString typeSet2 = "pT2";
     typeSet2.append(QString("%1").arg(PowerManagementConfigUi.battery2TypeCombo
                 ->currentIndex(),1));
     typeSet2.append(QString("%1").arg(battery2Capacity,-0));
-    socket->write(typeSet2.append("\n\r").toLatin1().constData());
+    parameters << typeSet2;
     QString typeSet3 = "pT3";
     typeSet3.append(QString("%1").arg(PowerManagementConfigUi.battery3TypeCombo
                 ->currentIndex(),1));
     typeSet3.append(QString("%1").arg(battery3Capacity,-0));
-    socket->write(typeSet3.append("\n\r").toLatin1().constData());
+    parameters << typeSet3;
 /* Set bulk current limit scales. These are the scaling factors relating the
 battery capacity to the bulk current limit. */
     QString bulkISet1 = "pI1";
     bulkISet1.append(QString("%1")
                 .arg((unsigned int)(battery1Capacity/
                  PowerManagementConfigUi.battery1AbsorptionCurrent->value()),-0));
-    socket->write(bulkISet1.append("\n\r").toLatin1().constData());
+    parameters << bulkISet1;
     QString bulkISet2 = "pI2";
     bulkISet2.append(QString("%1")
                 .arg((unsigned int)(battery2Capacity/
                  PowerManagementConfigUi.battery2AbsorptionCurrent->value()),-0));
-    socket->write(bulkISet2.append("\n\r").toLatin1().constData());
+    parameters << bulkISet2;
     QString bulkISet3 = "pI3";
     bulkISet3.append(QString("%1")
                 .arg((unsigned int)(battery3Capacity/
                  PowerManagementConfigUi.battery3AbsorptionCurrent->value()),-0));
-    socket->write(bulkISet3.append("\n\r").toLatin1().constData());
+    parameters << bulkISet3;
 // Set gassing voltage limits
     QString gassingVSet1 = "pA1";
     gassingVSet1.append(QString("%1")
                 .arg((unsigned int)(PowerManagementConfigUi.battery1AbsorptionVoltage
                 ->value()*256),-0));
-    socket->write(gassingVSet1.append("\n\r").toLatin1().constData());
+    parameters << gassingVSet1;
     QString gassingVSet2 = "pA2";
     gassingVSet2.append(QString("%1")
                 .arg((unsigned int)(PowerManagementConfigUi.battery2AbsorptionVoltage
                 ->value()*256),-0));
-    socket->write(gassingVSet2.append("\n\r").toLatin1().constData());
+    parameters << gassingVSet2;
     QString gassingVSet3 = "pA3";
     gassingVSet3.append(QString("%1")
                 .arg((unsigned int)(PowerManagementConfigUi.battery3AbsorptionVoltage
                 ->value()*256),-0));
-    socket->write(gassingVSet3.append("\n\r").toLatin1().constData());
+    parameters << gassingVSet3;
 // Set float voltage limits
     QString floatVSet1 = "pF1";
     floatVSet1.append(QString("%1")
                 .arg((unsigned int)(PowerManagementConfigUi.battery1FloatVoltage
                 ->value()*256),-0));
-    socket->write(floatVSet1.append("\n\r").toLatin1().constData());
+    parameters << floatVSet1;
     QString floatVSet2 = "pF2";
     floatVSet2.append(QString("%1")
                 .arg((unsigned int)(PowerManagementConfigUi.battery2FloatVoltage
                 ->value()*256),-0));
-    socket->write(floatVSet2.append("\n\r").toLatin1().constData());
+    parameters << floatVSet2;
     QString floatVSet3 = "pF3";
     floatVSet3.append(QString("%1")
                 .arg((unsigned int)(PowerManagementConfigUi.battery3FloatVoltage
                 ->value()*256),-0));
-    socket->write(floatVSet3.append("\n\r").toLatin1().constData());
+    parameters << floatVSet3;
 /* Set float current scales. These are the scaling factors relating the
 battery capacity to the float current trigger. */
     QString floatISet1 = "pf1";
     floatISet1.append(QString("%1")
                 .arg((unsigned int)(battery1Capacity/
                  PowerManagementConfigUi.battery1FloatCurrent->value()),-0));
-    socket->write(floatISet1.append("\n\r").toLatin1().constData());
+    parameters << floatISet1;
     QString floatISet2 = "pf2";
     floatISet2.append(QString("%1")
                 .arg((unsigned int)(battery2Capacity/
                  PowerManagementConfigUi.battery2FloatCurrent->value()),-0));
-    socket->write(floatISet2.append("\n\r").toLatin1().constData());
+    parameters << floatISet2;
     QString floatISet3 = "pf3";
     floatISet3.append(QString("%1")
                 .arg((unsigned int)(battery3Capacity/
                  PowerManagementConfigUi.battery3FloatCurrent->value()),-0));
-    socket->write(floatISet3.append("\n\r").toLatin1().constData());
+    parameters << floatISet3;
 /* Write to FLASH */
-    socket->write("aW\n\r");
+    writeConfiguration(parameters);
 /* Refresh display of set parameters */
     on_queryBatteryButton_clicked();
 }
 
+//-----------------------------------------------------------------------------
+/** @brief Write a set of parameters to FLASH as one transaction
+
+The parameters are sent in frames of as many as fit a command line, each with
+the CRC of its contents, between commands that open and commit a transaction.
+All are sequenced commands, so they are pipelined and any lost are sent again.
+The commit carries the number of parameters and the sum of the frame CRCs, so
+that a frame still being sent again when the commit arrives is not left out.
+The BMS writes FLASH once when all frames have arrived intact and match the
+commit, otherwise it restores the configuration it had before. Either way it
+answers with pW, giving the number of parameters written and the sum of the
+CRCs of the frames it applied.
+
+@param[in] parameters: parameter commands, each starting with 'p'.
+*/
+
+void PowerManagementConfigGui::writeConfiguration(const QStringList& parameters)
+{
+    socket->sendCommand("aT");
+    quint16 checksum = 0;
+    QByteArray frame;
+    for (int i=0; i<parameters.size(); i++)
+    {
+        QByteArray item = parameters[i].mid(1).toLatin1();
+        if (! frame.isEmpty() && (frame.size()+item.size()+1 > CONFIGURE_FRAME_SIZE))
+        {
+            checksum += sendConfigurationFrame(frame);
+            frame.clear();
+        }
+        if (! frame.isEmpty()) frame.append(';');
+        frame.append(item);
+    }
+    if (! frame.isEmpty()) checksum += sendConfigurationFrame(frame);
+    socket->sendCommand("aC" + QByteArray::number(parameters.size()) + ","
+                        + QByteArray::number(checksum));
+    ConfigurationWrite write;
+    write.count = parameters.size();
+    write.checksum = checksum;
+    pendingWrites.append(write);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send one frame of parameters within a transaction
+
+@param[in] frame: parameters without their leading 'p', separated by ';'.
+@returns CRC of the frame.
+*/
+
+quint16 PowerManagementConfigGui::sendConfigurationFrame(const QByteArray& frame)
+{
+    quint16 crc = qChecksum(frame.constData(),frame.size());
+    QByteArray command = "aP";
+    command.append(QByteArray::number(crc));
+    command.append(',').append(frame);
+    socket->sendCommand(command);
+    return crc;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief A sequenced command was never acknowledged
+
+A calibration that did not start releases the window. A transaction that was
+not committed will not be answered.
+*/
+
+void PowerManagementConfigGui::onCommandFailed(QByteArray command)
+{
+    displayErrorMessage(QString("No acknowledgement of %1")
+                        .arg(QString::fromLatin1(command.left(2))));
+    if (command == "pC")
+    {
+        this->setEnabled(true);
+        PowerManagementConfigUi.calibrateProgressBar->setVisible(false);
+        PowerManagementConfigUi.calibrateProgressBar->setValue(0);
+    }
+    else if (command.startsWith("aC") && ! pendingWrites.isEmpty())
+        pendingWrites.removeFirst();
+}
+
 //-----------------------------------------------------------------------------
 /** @brief Battery 1 type changed
 
@@ -455,31 +532,27 @@ void PowerManagementConfigGui::on_setTrackOptionButton_clicked()
     {
         option &= ~0x02;
     }
+    QStringList parameters;
     QString command = "ps";
-    socket->write(command.append(QString("%1").arg(option,1)).append("\n\r")
-                         .toLatin1().constData());
+    parameters << command.append(QString("%1").arg(option,1));
     command = "pv";
     int lowVoltage = (int)(PowerManagementConfigUi.
                                 lowVoltageDoubleSpinBox->value()*256);
-    socket->write(command.append(QString("%1").arg(lowVoltage,2)).append("\n\r")
-                         .toLatin1().constData());
+    parameters << command.append(QString("%1").arg(lowVoltage,2));
     command = "pV";
     int criticalVoltage = (int)(PowerManagementConfigUi.
                                 criticalVoltageDoubleSpinBox->value()*256);
-    socket->write(command.append(QString("%1").arg(criticalVoltage,2)).append("\n\r")
-                         .toLatin1().constData());
+    parameters << command.append(QString("%1").arg(criticalVoltage,2));
     command = "px";
     int lowSoC = (int)(PowerManagementConfigUi.
                                 lowSoCSpinBox->value())*256;
-    socket->write(command.append(QString("%1").arg(lowSoC,2)).append("\n\r")
-                         .toLatin1().constData());
+    parameters << command.append(QString("%1").arg(lowSoC,2));
     command = "pX";
     int criticalSoC = (int)(PowerManagementConfigUi.
                                 criticalSoCSpinBox->value())*256;
-    socket->write(command.append(QString("%1").arg(criticalSoC,2)).append("\n\r")
-                         .toLatin1().constData());
+    parameters << command.append(QString("%1").arg(criticalSoC,2));
 /* Write to FLASH */
-    socket->write("aW\n\r");
+    writeConfiguration(parameters);
 /* Ask for monitor strategy parameter settings */
     socket->write("dT\n\r");
 }
@@ -492,28 +565,24 @@ void PowerManagementConfigGui::on_setTrackOptionButton_clicked()
 void PowerManagementConfigGui::on_setChargeOptionButton_clicked()
 {
     on_absorptionMuteCheckbox_clicked();
+    QStringList parameters;
     QString command = "pR";
     int restTime = PowerManagementConfigUi.restTimeSpinBox->value();
-    socket->write(command.append(QString("%1").arg(restTime,2)).append("\n\r")
-                         .toLatin1().constData());
+    parameters << command.append(QString("%1").arg(restTime,2));
     command = "pG";
     int absorptionTime = PowerManagementConfigUi.absorptionTimeSpinBox->value();
-    socket->write(command.append(QString("%1").arg(absorptionTime,2)).append("\n\r")
-                         .toLatin1().constData());
+    parameters << command.append(QString("%1").arg(absorptionTime,2));
     command = "pD";
     int dutyCycleMin = PowerManagementConfigUi.minimumDutyCycleSpinBox->value()*256;
-    socket->write(command.append(QString("%1").arg(dutyCycleMin,2)).append("\n\r")
-                         .toLatin1().constData());
+    parameters << command.append(QString("%1").arg(dutyCycleMin,2));
     command = "pe";
     int floatTime = PowerManagementConfigUi.floatDelaySpinBox->value();
-    socket->write(command.append(QString("%1").arg(floatTime,2)).append("\n\r")
-                         .toLatin1().constData());
+    parameters << command.append(QString("%1").arg(floatTime,2));
     command = "pB";
     int floatSoC = PowerManagementConfigUi.floatBulkSoCSpinBox->value()*256;
-    socket->write(command.append(QString("%1").arg(floatSoC,2)).append("\n\r")
-                         .toLatin1().constData());
+    parameters << command.append(QString("%1").arg(floatSoC,2));
 /* Write to FLASH */
-    socket->write("aW\n\r");
+    writeConfiguration(parameters);
 /* Ask for charger strategy parameter settings */
     socket->write("dC\n\r");
 }
@@ -708,16 +777,15 @@ processing. Appropriate fields on the form are updated.
 The message type can be p (parameter) or one of three cases d (data message).
 The function doesn't check the type, only the command.
 
-@todo This interprets response as done in main. See if this can be made
-independent of formats.
+The message has been decoded by the main window.
 */
 
-void PowerManagementConfigGui::onMessageReceived(const QString &response)
+void PowerManagementConfigGui::onMessageReceived(const Message &message)
 {
-    QStringList breakdown = response.split(",");
-    int size = breakdown.size();
-    if (size <= 0) return;
-    QChar command = breakdown[0].at(1);
+    const QStringList& breakdown = message.fields;
+    int size = message.size;
+    if (message.ident.size() < 2) return;
+    QChar command = message.ident.at(1);
 // Check for ident response
     if (command == 'E')
     {
@@ -726,13 +794,38 @@ void PowerManagementConfigGui::onMessageReceived(const QString &response)
         PowerManagementConfigUi.boardVersion->setText("Interface Board Version: " + breakdown[3]);
         return;
     }
-    QChar battery = breakdown[0].at(2);
-    QChar parameter = breakdown[0].at(2);
+    QChar battery;
+    if (message.ident.size() > 2) battery = message.ident.at(2);
+    QChar parameter = battery;
     int controlByte = 0;
     if (size > 1) controlByte = breakdown[1].simplified().toInt();
 // Error Code
     switch (command.toLatin1())
     {
+// Result of a configuration transaction, checked against the frames sent
+        case 'W':
+        {
+            if ((size < 3) || pendingWrites.isEmpty()) break;
+            int count = breakdown[1].simplified().toInt();
+            quint16 checksum = breakdown[2].simplified().toUInt();
+            ConfigurationWrite expected = pendingWrites.takeFirst();
+            if (count < 0)
+                displayErrorMessage("Configuration not written, a frame was lost or corrupted");
+            else if ((count != expected.count) || (checksum != expected.checksum))
+                displayErrorMessage(QString("Configuration written with %1 of "
+                                            "%2 parameters, checksum %3 not %4")
+                                    .arg(count).arg(expected.count)
+                                    .arg(checksum,4,16,QChar('0'))
+                                    .arg(expected.checksum,4,16,QChar('0')));
+            else
+            {
+                PowerManagementConfigUi.errorLabel->clear();
+                QMessageBox::information(this, "Configuration written",
+                    QString("%1 parameters written to FLASH, checksum %2")
+                    .arg(count).arg(checksum,4,16,QChar('0')));
+            }
+            break;
+        }
 // Show Measured Quiescent Current
         case 'Q':
         {
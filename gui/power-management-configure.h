@@ -30,12 +30,25 @@
 #define _TTY_POSIX_
 
 #include "power-management.h"
+#include "power-management-message.h"
+#include "power-management-link.h"
 #include "ui_power-management-configure.h"
-#include <QSerialPort>
 #include <QSerialPortInfo>
 #include <QDialog>
 #include <QtNetwork>
-#include <QTcpSocket>
+
+// Most characters of parameters sent in one frame of a configuration write
+#define CONFIGURE_FRAME_SIZE 200
+
+//-----------------------------------------------------------------------------
+/** @brief Configuration write awaiting its result from the BMS.
+*/
+
+struct ConfigurationWrite
+{
+    int count;                  //!< Parameters sent
+    quint16 checksum;           //!< Sum of the CRCs of the frames sent
+};
 
 //-----------------------------------------------------------------------------
 /** @brief Power Management Configure Window.
@@ -46,11 +59,7 @@ class PowerManagementConfigGui : public QDialog
 {
     Q_OBJECT
 public:
-#ifdef SERIAL
-    PowerManagementConfigGui(QSerialPort*, QWidget* parent = 0);
-#else
-    PowerManagementConfigGui(QTcpSocket* socket, QWidget* parent = 0);
-#endif
+    PowerManagementConfigGui(Link* socket, QWidget* parent = 0);
     ~PowerManagementConfigGui();
     QString error();
 private slots:
@@ -77,19 +86,19 @@ private slots:
     void on_setTrackOptionButton_clicked();
     void on_setChargeOptionButton_clicked();
     void on_absorptionMuteCheckbox_clicked();
-    void onMessageReceived(const QString &text);
+    void onMessageReceived(const Message &message);
+    void onCommandFailed(QByteArray command);
     void displayErrorMessage(const QString message);
 private:
+    void writeConfiguration(const QStringList& parameters);
+    quint16 sendConfigurationFrame(const QByteArray& frame);
 // User Interface object instance
     Ui::PowerManagementConfigDialog PowerManagementConfigUi;
-#ifdef SERIAL
-    QSerialPort *socket;           //!< Serial port object pointer
-#else
-    QTcpSocket *socket;
-#endif
+    Link *socket;                  //!< Serial or TCP link object pointer
     QString errorMessage;
     QString response;           // String to build a line of characters
     QString quiescentCurrent;
+    QList<ConfigurationWrite> pendingWrites; // Transactions not answered
 };
 
 #endif
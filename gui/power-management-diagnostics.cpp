@@ -0,0 +1,152 @@
+/*       Power Management Link Diagnostics Window
+
+The rates and losses on the link to the BMS are shown so that baud rates and
+the telemetry sent can be chosen to suit each site.
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include "power-management-diagnostics.h"
+#include <QDateTime>
+#include <QHeaderView>
+#include <QStringList>
+
+// Table rows ahead of the rate of each message identity
+typedef enum {rowBytesRead, rowBytesWritten, rowBytesWaiting, rowLines, rowUtilisation,
+              rowMalformed, rowDropped, rowTimeGaps,
+              rowCommandsSent, rowCommandsAcknowledged, rowCommandsRepeated,
+              rowCommandsFailed, rowRoundTrip,
+              rowCaptureQueue, rowCaptureLatency, rowCaptureLines,
+              rowCaptureDropped, rowMessages} DiagnosticsRow;
+
+//-----------------------------------------------------------------------------
+/** Power Management Link Diagnostics Window Constructor
+
+@param[in] link Link to the BMS.
+@param[in] writer Capture file writer of the main window.
+@param[in] baudrate Baud rate of the serial line, used also for a TCP link.
+@param[in] parent Parent widget.
+*/
+
+PowerManagementDiagnosticsGui::PowerManagementDiagnosticsGui(Link* link,
+                                    const CaptureWriter* writer,
+                                    qint32 baudrate, QWidget* parent)
+                                    : QDialog(parent)
+{
+    PowerManagementDiagnosticsUi.setupUi(this);
+    socket = link;
+    capture = writer;
+    statistics.setBaudrate(baudrate);
+    QStringList names;
+    names << "Bytes read/s" << "Bytes written/s" << "Bytes waiting to send"
+          << "Lines/s"
+          << "Line utilisation" << "Malformed lines" << "Messages dropped"
+          << "Time records missed" << "Commands sent"
+          << "Commands acknowledged" << "Commands repeated"
+          << "Commands failed" << "Round trip (last/mean/max)"
+          << "Capture queue (now/max)" << "Capture write time (last/max)"
+          << "Capture lines written" << "Capture lines dropped";
+    for (int i=0; i<numberMessageIds; i++)
+        names << LinkStatistics::identName((MessageId)i).append("/s");
+    model = new QStandardItemModel(names.size(), 2, this);
+    model->setHorizontalHeaderLabels(QStringList() << "Item" << "Value");
+    for (int row=0; row<names.size(); row++)
+    {
+        model->setItem(row, 0, new QStandardItem(names[row]));
+        model->setItem(row, 1, new QStandardItem());
+    }
+    PowerManagementDiagnosticsUi.diagnosticsTableView->setModel(model);
+    PowerManagementDiagnosticsUi.diagnosticsTableView->horizontalHeader()
+        ->setSectionResizeMode(QHeaderView::Stretch);
+    if (! socket.isNull())
+        statistics.sample(socket, QDateTime::currentMSecsSinceEpoch());
+    refreshTimer.setInterval(DIAGNOSTICS_REFRESH_INTERVAL);
+    connect(&refreshTimer, SIGNAL(timeout()), this, SLOT(onRefresh()));
+    refreshTimer.start();
+}
+
+PowerManagementDiagnosticsGui::~PowerManagementDiagnosticsGui()
+{
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Refresh the table
+
+Rates are over the interval since the last refresh.
+*/
+
+void PowerManagementDiagnosticsGui::onRefresh()
+{
+    if (socket.isNull())
+    {
+        PowerManagementDiagnosticsUi.errorLabel->setText("Link closed");
+        return;
+    }
+    statistics.sample(socket, QDateTime::currentMSecsSinceEpoch());
+    setValue(rowBytesRead, QString("%1").arg(statistics.bytesReadRate(),0,'f',0));
+    setValue(rowBytesWritten, QString("%1").arg(statistics.bytesWrittenRate(),0,'f',0));
+    setValue(rowBytesWaiting, QString("%1").arg(socket->bytesWaiting()));
+    setValue(rowLines, QString("%1").arg(statistics.linesRate(),0,'f',1));
+    if (statistics.utilisation() < 0) setValue(rowUtilisation, "-");
+    else setValue(rowUtilisation, QString("%1%")
+                  .arg(statistics.utilisation()*100,0,'f',1));
+    setValue(rowMalformed, QString("%1").arg(socket->linesMalformed()));
+    setValue(rowDropped, QString("%1").arg(socket->framesDropped()));
+    setValue(rowTimeGaps, QString("%1").arg(socket->timeGaps()));
+    setValue(rowCommandsSent, QString("%1").arg(socket->commandsSent()));
+    setValue(rowCommandsAcknowledged, QString("%1").arg(socket->commandsAcknowledged()));
+    setValue(rowCommandsRepeated, QString("%1").arg(socket->commandsRepeated()));
+    setValue(rowCommandsFailed, QString("%1").arg(socket->commandsFailed()));
+    setValue(rowRoundTrip, QString("%1 / %2 / %3 ms").arg(socket->roundTripLast())
+             .arg(socket->roundTripMean(),0,'f',0).arg(socket->roundTripMax()));
+    setValue(rowCaptureQueue, QString("%1 / %2").arg(capture->queueDepth())
+             .arg(capture->maxQueueDepth()));
+    setValue(rowCaptureLatency, QString("%1 / %2 us").arg(capture->lastLatency())
+             .arg(capture->maxLatency()));
+    setValue(rowCaptureLines, QString("%1").arg(capture->linesWritten()));
+    setValue(rowCaptureDropped, QString("%1").arg(capture->linesDropped()));
+    for (int i=0; i<numberMessageIds; i++)
+        setValue(rowMessages+i, QString("%1")
+                 .arg(statistics.messageRate((MessageId)i),0,'f',1));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the text of a value only if it has changed
+*/
+
+void PowerManagementDiagnosticsGui::setValue(int row, const QString& text)
+{
+    QStandardItem* item = model->item(row, 1);
+    if (item->text() != text) item->setText(text);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Close the window
+*/
+
+void PowerManagementDiagnosticsGui::on_closeButton_clicked()
+{
+    close();
+}
@@ -0,0 +1,74 @@
+/*          Power Management GUI Link Diagnostics Header
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#ifndef POWER_MANAGEMENT_DIAGNOSTICS_H
+#define POWER_MANAGEMENT_DIAGNOSTICS_H
+
+#include "power-management-link.h"
+#include "power-management-capture.h"
+#include "power-management-statistics.h"
+#include "ui_power-management-diagnostics.h"
+#include <QDialog>
+#include <QTimer>
+#include <QPointer>
+#include <QStandardItemModel>
+
+// Time in ms between refreshes of the diagnostics, over which rates are taken
+#define DIAGNOSTICS_REFRESH_INTERVAL 1000
+
+//-----------------------------------------------------------------------------
+/** @brief Power Management Link Diagnostics Window.
+
+Shows the traffic on the link, its losses, the times taken to acknowledge
+sequenced commands and the state of the capture file writer. The values are
+read from the counters on a timer, so the window costs nothing per message.
+The window stops showing values when the link it was opened on is closed.
+*/
+
+class PowerManagementDiagnosticsGui : public QDialog
+{
+    Q_OBJECT
+public:
+    PowerManagementDiagnosticsGui(Link* socket, const CaptureWriter* capture,
+                                  qint32 baudrate, QWidget* parent = 0);
+    ~PowerManagementDiagnosticsGui();
+private slots:
+    void onRefresh();
+    void on_closeButton_clicked();
+private:
+// User Interface object instance
+    Ui::PowerManagementDiagnosticsDialog PowerManagementDiagnosticsUi;
+    void setValue(int row, const QString& text);
+    QPointer<Link> socket;      // Cleared if the link is closed
+    const CaptureWriter* capture;
+    LinkStatistics statistics;
+    QStandardItemModel* model;
+    QTimer refreshTimer;
+};
+
+#endif
@@ -0,0 +1,142 @@
+/*       Power Management GUI Message Dispatch Benchmark
+
+Measures the rate at which decoded messages are dispatched, compared with the
+test of every ident in turn that the dispatch table replaced.
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+#include "power-management-dispatch.h"
+#include <QStringList>
+#include <QElapsedTimer>
+#include <cstdio>
+
+//-----------------------------------------------------------------------------
+/** @brief Receiver that counts the messages reaching each handler.
+*/
+
+class BenchmarkReceiver
+{
+public:
+    BenchmarkReceiver() : handled(0), forwarded(0) {}
+    void count(const Message& message)
+    {
+        handled += message.value[1] & 1;
+    }
+    void forward(const Message& message)
+    {
+        forwarded += message.size;
+    }
+    long long handled;
+    long long forwarded;
+};
+
+//-----------------------------------------------------------------------------
+/** @brief Route a message by testing the ident against each message in turn.
+
+This follows the processResponse tests as they were before the dispatch table,
+including the repeated left() calls for routing to the other windows. The
+message is decoded beforehand, so only the routing is compared with the table.
+*/
+
+static void chainDispatch(const Message& message, BenchmarkReceiver* receiver)
+{
+    static const char* idents[] = {"pH", "dL1", "dL2", "dM1", "dB1", "dB2",
+                                   "dB3", "dD", "dS", "dI", "dO1", "dO2",
+                                   "dO3", "dC1", "dC2", "dC3", "dT"};
+    int size = message.size;
+    QString firstField = message.ident;
+    for (unsigned int i=0; i<sizeof(idents)/sizeof(idents[0]); i++)
+        if ((size > 0) && (firstField == idents[i])) receiver->count(message);
+    if ((size > 0) && (firstField.left(1) == "f")) receiver->forward(message);
+    if ((size > 0) && ((firstField.left(1) == "p") || (firstField.left(2) == "dO")
+                                                   || (firstField.left(2) == "dE")
+                                                   || (firstField.left(2) == "dD")))
+        receiver->forward(message);
+    if ((size > 0) && (firstField.left(1) == "D")) receiver->forward(message);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Measure messages dispatched per second.
+
+A typical block of messages from one time tick is decoded once and repeated.
+The same messages are routed through the dispatch table and through the old
+chain of tests, to the same handlers, and the rate of each is printed to stdout
+with the totals counted by the handlers, which must agree.
+
+@param[in] count: number of messages to process in each test.
+*/
+
+void benchmarkDispatch(int count)
+{
+    QStringList block;
+    block << "pH,2026-10-16T12:00:00" << "dB1,-1234,3245" << "dB2,567,3301"
+          << "dB3,12,3290" << "dL1,2345,3200" << "dL2,123,3198"
+          << "dM1,4567,4800" << "dO1,17" << "dO2,33" << "dO3,0"
+          << "dC1,23040" << "dC2,25600" << "dC3,19200" << "dT,6400"
+          << "dI,4095" << "dD,3" << "ds,57" << "pc+" << "fE,0";
+    QList<Message> messages;
+    for (int i=0; i<block.size(); i++) messages << decodeMessage(block[i],0);
+
+// The table routes to the handlers that the chain of tests reaches
+    BenchmarkReceiver tableReceiver;
+    MessageDispatcher<BenchmarkReceiver> dispatcher(&tableReceiver);
+    static const MessageId counted[] = {messageTime, messageLoad1, messageLoad2,
+        messagePanel, messageBattery1, messageBattery2, messageBattery3,
+        messageControls, messageSwitches, messageIndicators, messageState1,
+        messageState2, messageState3, messageCharge1, messageCharge2,
+        messageCharge3, messageTemperature};
+    for (unsigned int i=0; i<sizeof(counted)/sizeof(counted[0]); i++)
+        dispatcher.add(counted[i],&BenchmarkReceiver::count);
+    static const MessageId forwarded[] = {messageState1, messageState2,
+        messageState3, messageIdent, messageControls};
+    for (unsigned int i=0; i<sizeof(forwarded)/sizeof(forwarded[0]); i++)
+        dispatcher.add(forwarded[i],&BenchmarkReceiver::forward);
+    dispatcher.addCategory(categoryParameter,&BenchmarkReceiver::forward);
+    dispatcher.addCategory(categoryFile,&BenchmarkReceiver::forward);
+    dispatcher.addCategory(categoryDebug,&BenchmarkReceiver::forward);
+    BenchmarkReceiver chainReceiver;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int n=0; n<count; n++)
+        dispatcher.dispatch(messages[n % messages.size()]);
+    qint64 tableTime = timer.nsecsElapsed();
+    timer.restart();
+    for (int n=0; n<count; n++)
+        chainDispatch(messages[n % messages.size()],&chainReceiver);
+    qint64 chainTime = timer.nsecsElapsed();
+
+    double tableRate = 0;
+    if (tableTime > 0) tableRate = (double)count*1e9/tableTime;
+    double chainRate = 0;
+    if (chainTime > 0) chainRate = (double)count*1e9/chainTime;
+    fprintf(stdout,"%d messages\n",count);
+    fprintf(stdout,"  dispatch table:     %.0f messages/s (check %lld)\n",
+            tableRate,tableReceiver.handled+tableReceiver.forwarded);
+    fprintf(stdout,"  test each ident:    %.0f messages/s (check %lld)\n",
+            chainRate,chainReceiver.handled+chainReceiver.forwarded);
+    fflush(stdout);
+}
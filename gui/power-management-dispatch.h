@@ -0,0 +1,75 @@
+/*          Power Management GUI Message Dispatch Header
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+#ifndef POWER_MANAGEMENT_DISPATCH_H
+#define POWER_MANAGEMENT_DISPATCH_H
+
+#include "power-management-message.h"
+#include <QVector>
+
+//-----------------------------------------------------------------------------
+/** @brief Table of message handlers of a window.
+
+Handlers are member functions of the receiver registered against a message id
+or a message category. The id found when the message is decoded indexes the
+table directly, so each message goes straight to its handlers without testing
+the ident against every known message. Handlers for the id are called in the
+order registered, followed by those for the category.
+
+Used by both the Qt5 GUI and the BeagleBone GUI.
+*/
+
+template <class T>
+class MessageDispatcher
+{
+public:
+    typedef void (T::*Handler)(const Message& message);
+    MessageDispatcher(T* target) : receiver(target) {}
+    void add(MessageId id, Handler handler)
+    {
+        idHandlers[id].append(handler);
+    }
+    void addCategory(MessageCategory category, Handler handler)
+    {
+        categoryHandlers[category].append(handler);
+    }
+    void dispatch(const Message& message) const
+    {
+        const QVector<Handler>& byId = idHandlers[message.id];
+        for (int i=0; i<byId.size(); i++) (receiver->*byId[i])(message);
+        const QVector<Handler>& byCategory = categoryHandlers[message.category];
+        for (int i=0; i<byCategory.size(); i++) (receiver->*byCategory[i])(message);
+    }
+private:
+    T* receiver;
+    QVector<Handler> idHandlers[numberMessageIds];
+    QVector<Handler> categoryHandlers[numberMessageCategories];
+};
+
+void benchmarkDispatch(int count);
+
+#endif
@@ -0,0 +1,163 @@
+/*       Power Management Display State
+
+Values for the telemetry widgets are collected here and drawn at a limited
+rate.
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include "power-management-display.h"
+#include <QLabel>
+#include <QAbstractButton>
+#include <QVariant>
+
+//-----------------------------------------------------------------------------
+/** Display State Constructor
+
+The refresh timer is single shot. It is started by the first change after a
+refresh.
+*/
+
+DisplayState::DisplayState(QObject* parent) : QObject(parent)
+{
+    refreshTimer.setSingleShot(true);
+    setRefreshRate(DISPLAY_REFRESH_RATE);
+    connect(&refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the number of refreshes per second
+
+@param[in] rate Refreshes per second, limited to 1 to DISPLAY_MAX_REFRESH_RATE.
+*/
+
+void DisplayState::setRefreshRate(int rate)
+{
+    if (rate < 1) rate = 1;
+    if (rate > DISPLAY_MAX_REFRESH_RATE) rate = DISPLAY_MAX_REFRESH_RATE;
+    refreshTimer.setInterval(1000/rate);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the text to be shown on a widget
+
+@param[in] widget A label or button.
+@param[in] text The text.
+*/
+
+void DisplayState::setText(QWidget* widget, const QString& text)
+{
+    DisplayValue* entry = value(widget);
+    entry->text = text;
+    entry->hasText = true;
+    markChanged(widget, entry);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the style sheet to be applied to a widget
+*/
+
+void DisplayState::setStyleSheet(QWidget* widget, const QString& style)
+{
+    DisplayValue* entry = value(widget);
+    entry->style = style;
+    entry->hasStyle = true;
+    markChanged(widget, entry);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Clear the text of a widget
+*/
+
+void DisplayState::clear(QWidget* widget)
+{
+    setText(widget, QString());
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Draw the changed values
+
+The value is compared with that shown by the widget, as other code may also
+set the widget directly, so a widget is only touched if it shows something
+different.
+*/
+
+void DisplayState::refresh()
+{
+    for (int i=0; i<changed.size(); i++)
+    {
+        QWidget* widget = changed[i];
+        DisplayValue& entry = values[widget];
+        entry.changed = false;
+        if (entry.hasStyle && (widget->styleSheet() != entry.style))
+            widget->setStyleSheet(entry.style);
+        if (! entry.hasText) continue;
+        QLabel* label = qobject_cast<QLabel*>(widget);
+        QAbstractButton* button = qobject_cast<QAbstractButton*>(widget);
+        if (label != NULL)
+        {
+            if (label->text() != entry.text) label->setText(entry.text);
+        }
+        else if (button != NULL)
+        {
+            if (button->text() != entry.text) button->setText(entry.text);
+        }
+        else if (widget->property("text").toString() != entry.text)
+            widget->setProperty("text", entry.text);
+    }
+    changed.clear();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Find or create the value held for a widget
+*/
+
+DisplayState::DisplayValue* DisplayState::value(QWidget* widget)
+{
+    QHash<QWidget*, DisplayValue>::iterator entry = values.find(widget);
+    if (entry == values.end())
+    {
+        DisplayValue initial;
+        initial.hasText = false;
+        initial.hasStyle = false;
+        initial.changed = false;
+        entry = values.insert(widget, initial);
+    }
+    return &entry.value();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Queue a widget for the next refresh and start the tick if needed
+*/
+
+void DisplayState::markChanged(QWidget* widget, DisplayValue* entry)
+{
+    if (! entry->changed)
+    {
+        entry->changed = true;
+        changed.append(widget);
+    }
+    if (! refreshTimer.isActive()) refreshTimer.start();
+}
@@ -0,0 +1,82 @@
+/*          Power Management GUI Display State Header
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#ifndef POWER_MANAGEMENT_DISPLAY_H
+#define POWER_MANAGEMENT_DISPLAY_H
+
+#include <QObject>
+#include <QWidget>
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QTimer>
+
+// Default and greatest rate at which the display is refreshed, per second
+#define DISPLAY_REFRESH_RATE 20
+#define DISPLAY_MAX_REFRESH_RATE 60
+
+//-----------------------------------------------------------------------------
+/** @brief Latest values shown on the telemetry widgets of a window.
+
+Message handlers write the text and style sheet intended for a widget here
+rather than to the widget. Only the latest value is kept. The widgets are
+updated on a refresh tick, and only those whose value differs from what is
+shown are touched, so the cost of drawing no longer grows with the message
+rate. The tick only runs when something has changed.
+
+Used by both the Qt5 GUI and the BeagleBone GUI.
+*/
+
+class DisplayState : public QObject
+{
+    Q_OBJECT
+public:
+    DisplayState(QObject* parent = 0);
+    void setRefreshRate(int rate);
+    void setText(QWidget* widget, const QString& text);
+    void setStyleSheet(QWidget* widget, const QString& style);
+    void clear(QWidget* widget);
+public slots:
+    void refresh();
+private:
+    struct DisplayValue
+    {
+        QString text;
+        QString style;
+        bool hasText;
+        bool hasStyle;
+        bool changed;
+    };
+    DisplayValue* value(QWidget* widget);
+    void markChanged(QWidget* widget, DisplayValue* entry);
+    QHash<QWidget*, DisplayValue> values;
+    QList<QWidget*> changed;
+    QTimer refreshTimer;
+};
+
+#endif
@@ -0,0 +1,384 @@
+/*       Power Management Bulk Download
+
+A file on the BMS storage medium is copied to a local file in chunks of half a
+sector, with several chunks in flight at a time.
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include "power-management-download.h"
+#include <QFileInfo>
+#include <QTextStream>
+
+//-----------------------------------------------------------------------------
+/** Bulk Download Constructor
+
+@param[in] p Serial or TCP link object pointer
+@param[in] parent Parent object.
+*/
+
+BulkDownload::BulkDownload(Link* p, QObject* parent) : QObject(parent)
+{
+    socket = p;
+    active = false;
+    complete = false;
+    nextRequest = 0;
+    nextWrite = 0;
+    lastChunk = -1;
+    written = 0;
+    rateBytes = 0;
+    rateTime = 0;
+    currentRate = 0;
+    repeated = 0;
+    corrupted = 0;
+    connect(&tick, SIGNAL(timeout()), this, SLOT(onTick()));
+}
+
+BulkDownload::~BulkDownload()
+{
+    if (file.isOpen()) file.close();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Start or resume the download
+
+The remote file must already be open for reading. If the marker shows that the
+local file is a partial download of the same remote file, whole chunks already
+in it are kept and the download continues from the end of them. Otherwise the
+download starts from the beginning, replacing any existing local file only if
+asked to.
+
+@param[in] fileName Name of the local file.
+@param[in] remoteName Name of the remote file.
+@param[in] remoteSize Size of the remote file, 0 if not known.
+@param[in] replace Replace an existing local file that cannot be resumed.
+@returns false if the local file exists and cannot be resumed or replaced, or
+         could not be opened.
+*/
+
+bool BulkDownload::start(QString fileName, QString remoteName, qint64 remoteSize,
+                         bool replace)
+{
+    if (active) return true;
+    errorMessage.clear();
+    bool resume = canResume(fileName, remoteName, remoteSize);
+    if (! resume && ! replace && (QFileInfo(fileName).size() > 0))
+    {
+        errorMessage = QString("%1 is not a partial download of %2")
+                        .arg(fileName).arg(remoteName);
+        return false;
+    }
+    file.setFileName(fileName);
+    if (! file.open(QIODevice::ReadWrite))
+    {
+        errorMessage = QString("Could not open %1: %2")
+                        .arg(fileName).arg(file.errorString());
+        return false;
+    }
+    if (! resume) file.resize(0);
+    if (! writeMarker(remoteName, remoteSize))
+    {
+        file.close();
+        return false;
+    }
+    nextWrite = file.size()/DOWNLOAD_CHUNK_SIZE;
+    file.resize(nextWrite*DOWNLOAD_CHUNK_SIZE);
+    file.seek(file.size());
+    nextRequest = nextWrite;
+    lastChunk = -1;
+    complete = false;
+    inFlight.clear();
+    held.clear();
+    written = file.size();
+    repeated = 0;
+    corrupted = 0;
+    clock.start();
+    rateBytes = written;
+    rateTime = 0;
+    currentRate = 0;
+    active = true;
+    tick.start(DOWNLOAD_TICK);
+    fillWindow();
+    emit progress(written, currentRate);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Check that a local file is a partial download of a remote file
+
+@param[in] fileName Name of the local file.
+@param[in] remoteName Name of the remote file.
+@param[in] remoteSize Size of the remote file, 0 if not known.
+@returns true if the marker beside the local file names the same remote file
+         and size.
+*/
+
+bool BulkDownload::canResume(QString fileName, QString remoteName,
+                             qint64 remoteSize)
+{
+    QFile marker(fileName + DOWNLOAD_MARKER_SUFFIX);
+    if (! QFile::exists(fileName) ||
+        ! marker.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
+    QTextStream inStream(&marker);
+    QString name = inStream.readLine();
+    qint64 size = inStream.readLine().toLongLong();
+    return (name == remoteName) && (size == remoteSize);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Write the marker naming the remote file of a partial download
+
+@returns false if the marker could not be written.
+*/
+
+bool BulkDownload::writeMarker(QString remoteName, qint64 remoteSize)
+{
+    QFile marker(file.fileName() + DOWNLOAD_MARKER_SUFFIX);
+    if (! marker.open(QIODevice::WriteOnly | QIODevice::Truncate
+                                          | QIODevice::Text))
+    {
+        errorMessage = QString("Could not write %1: %2")
+                        .arg(marker.fileName()).arg(marker.errorString());
+        return false;
+    }
+    QTextStream outStream(&marker);
+    outStream << remoteName << "\n" << remoteSize << "\n";
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Remove the marker once the local file is complete or abandoned
+*/
+
+void BulkDownload::removeMarker()
+{
+    if (! file.fileName().isEmpty())
+        QFile::remove(file.fileName() + DOWNLOAD_MARKER_SUFFIX);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Stop asking for chunks, keeping those written
+
+Chunks still in flight are ignored when they arrive. The download can be
+resumed with start().
+*/
+
+void BulkDownload::pause()
+{
+    active = false;
+    tick.stop();
+    inFlight.clear();
+    held.clear();
+    if (file.isOpen()) file.close();
+    currentRate = 0;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Abandon the download and remove the partial local file
+
+A download that has finished is left alone.
+*/
+
+void BulkDownload::cancel()
+{
+    pause();
+    if (! complete && ! file.fileName().isEmpty())
+    {
+        file.remove();
+        removeMarker();
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Download state and statistics
+
+@returns isActive: true while chunks are being asked for.
+@returns error: description of the last failure, empty if none.
+@returns bytesWritten: size of the local file.
+@returns rate: bytes per second written over the last second or so.
+@returns chunksRepeated: chunks asked for again after a timeout.
+@returns chunksCorrupted: chunks dropped for a bad length or CRC.
+*/
+
+bool BulkDownload::isActive() const
+{
+    return active;
+}
+
+QString BulkDownload::error() const
+{
+    return errorMessage;
+}
+
+qint64 BulkDownload::bytesWritten() const
+{
+    return written;
+}
+
+qint64 BulkDownload::rate() const
+{
+    return currentRate;
+}
+
+qint64 BulkDownload::chunksRepeated() const
+{
+    return repeated;
+}
+
+qint64 BulkDownload::chunksCorrupted() const
+{
+    return corrupted;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Take a chunk from an fb message
+
+The message is "fb,chunk,length,crc,data" with the data in base64. A chunk that
+does not match its length or CRC is dropped and is asked for again on timeout.
+Duplicates of chunks already held or written are ignored.
+
+@param[in] message: decoded fb message.
+*/
+
+void BulkDownload::chunkReceived(const Message& message)
+{
+    if (! active || (message.size < 4)) return;
+    qint64 chunk = message.fields[1].toLongLong();
+    int length = message.value[2];
+    quint16 crc = message.fields[3].simplified().toUShort();
+    QByteArray data;
+    if (message.size > 4)
+        data = QByteArray::fromBase64(message.fields[4].trimmed().toLatin1());
+    if ((data.size() != length) ||
+        (qChecksum(data.constData(), data.size()) != crc))
+    {
+        corrupted++;
+        return;
+    }
+    inFlight.remove(chunk);
+    if ((chunk < nextWrite) || held.contains(chunk)) return;
+    held.insert(chunk, data);
+    if ((length < DOWNLOAD_CHUNK_SIZE) && ((lastChunk < 0) || (chunk < lastChunk)))
+        lastChunk = chunk;
+    flush();
+    if (! active) return;
+    if ((lastChunk >= 0) && (nextWrite > lastChunk))
+    {
+        pause();
+        complete = true;
+        removeMarker();
+        emit progress(written, 0);
+        emit finished();
+        return;
+    }
+    fillWindow();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Write the chunks that are now in order to the local file
+
+On a write failure the download is paused and reported as finished with an
+error.
+*/
+
+void BulkDownload::flush()
+{
+    while (held.contains(nextWrite))
+    {
+        QByteArray data = held.take(nextWrite);
+        if (file.write(data) != data.size())
+        {
+            errorMessage = QString("Could not write %1: %2")
+                            .arg(file.fileName()).arg(file.errorString());
+            pause();
+            emit finished();
+            return;
+        }
+        written += data.size();
+        nextWrite++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Ask for further chunks until the window is full
+
+No chunk past the end of the file is asked for once the end is known.
+*/
+
+void BulkDownload::fillWindow()
+{
+    while ((inFlight.size() < DOWNLOAD_WINDOW) &&
+           ((lastChunk < 0) || (nextRequest <= lastChunk)))
+    {
+        request(nextRequest);
+        inFlight.insert(nextRequest, clock.elapsed());
+        nextRequest++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send the request for a chunk
+*/
+
+void BulkDownload::request(qint64 chunk)
+{
+    socket->write(QString("fB%1\n\r").arg(chunk).toLocal8Bit());
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Ask again for lost chunks and update the throughput
+
+Chunks beyond the end of the file are forgotten. The requests also keep the
+BMS sending while the link is otherwise quiet.
+*/
+
+void BulkDownload::onTick()
+{
+    qint64 now = clock.elapsed();
+    QMap<qint64,qint64>::iterator i = inFlight.begin();
+    while (i != inFlight.end())
+    {
+        if ((lastChunk >= 0) && (i.key() > lastChunk))
+        {
+            i = inFlight.erase(i);
+            continue;
+        }
+        if (now - i.value() > DOWNLOAD_TIMEOUT)
+        {
+            request(i.key());
+            i.value() = now;
+            repeated++;
+        }
+        ++i;
+    }
+    fillWindow();
+    if (now - rateTime >= 1000)
+    {
+        currentRate = (written - rateBytes)*1000/(now - rateTime);
+        rateBytes = written;
+        rateTime = now;
+    }
+    emit progress(written, currentRate);
+}
@@ -0,0 +1,125 @@
+/*          Power Management GUI Bulk Download Header
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#ifndef POWER_MANAGEMENT_DOWNLOAD_H
+#define POWER_MANAGEMENT_DOWNLOAD_H
+
+#include "power-management-message.h"
+#include "power-management-link.h"
+#include <QObject>
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <QMap>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// Bytes in each chunk, as FILE_BULK_SIZE in the firmware
+#define DOWNLOAD_CHUNK_SIZE 256
+// Chunks asked for before the first has arrived
+#define DOWNLOAD_WINDOW     4
+// Time in ms after which a chunk that has not arrived is asked for again
+#define DOWNLOAD_TIMEOUT    3000
+// Time in ms between checks for lost chunks and updates of the throughput
+#define DOWNLOAD_TICK       500
+// Ending of the marker kept beside a partial local file
+#define DOWNLOAD_MARKER_SUFFIX ".partial"
+
+//-----------------------------------------------------------------------------
+/** @brief Download of a file from the BMS storage medium by bulk read.
+
+The remote file must first be opened for reading. Chunks are asked for with
+fB and arrive as fb messages with their number, length, CRC and data. A window
+of chunks is kept in flight so that the link is never idle waiting for a
+request. Chunks arriving out of order are held until the gap is filled, and
+each chunk is written to the local file as soon as it is in order. A chunk
+shorter than DOWNLOAD_CHUNK_SIZE ends the file.
+
+A chunk that fails its CRC is dropped. Any chunk not received within
+DOWNLOAD_TIMEOUT is asked for again, so the download continues by itself when a
+dropped link comes back. The local file only ever holds whole chunks in order,
+so a download that was paused or interrupted is resumed from the end of the
+local file.
+
+A marker file beside the local file records the remote file name and size
+while the download is unfinished. A download is only resumed when the marker
+matches the remote file, so that an unrelated local file is never appended to.
+Any other existing local file is only replaced when asked.
+*/
+
+class BulkDownload : public QObject
+{
+    Q_OBJECT
+public:
+    BulkDownload(Link* socket, QObject* parent = 0);
+    ~BulkDownload();
+    bool start(QString fileName, QString remoteName, qint64 remoteSize,
+               bool replace = false);
+    static bool canResume(QString fileName, QString remoteName,
+                          qint64 remoteSize);
+    void pause();
+    void cancel();
+    bool isActive() const;
+    QString error() const;
+    void chunkReceived(const Message& message);
+    qint64 bytesWritten() const;
+    qint64 rate() const;
+    qint64 chunksRepeated() const;
+    qint64 chunksCorrupted() const;
+signals:
+    void progress(qint64 bytes, qint64 rate);
+    void finished();
+private slots:
+    void onTick();
+private:
+    void request(qint64 chunk);
+    void fillWindow();
+    void flush();
+    bool writeMarker(QString remoteName, qint64 remoteSize);
+    void removeMarker();
+    Link *socket;                  //!< Serial or TCP link object pointer
+    QFile file;
+    QTimer tick;
+    QElapsedTimer clock;
+    bool active;
+    bool complete;
+    qint64 nextRequest;            //!< Next chunk not yet asked for
+    qint64 nextWrite;              //!< Next chunk to be written to the file
+    qint64 lastChunk;              //!< Short chunk ending the file, or -1
+    QMap<qint64,qint64> inFlight;  //!< Chunks asked for, and when
+    QMap<qint64,QByteArray> held;  //!< Chunks received out of order
+    qint64 written;
+    qint64 rateBytes;
+    qint64 rateTime;
+    qint64 currentRate;
+    qint64 repeated;
+    qint64 corrupted;
+    QString errorMessage;
+};
+
+#endif
@@ -0,0 +1,350 @@
+/*       Power Management Monitor History
+
+The currents and voltages of all interfaces are held for the monitor window in
+a ring buffer with decimated minimum and maximum levels for fast plotting of
+long periods.
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include "power-management-history.h"
+
+//-----------------------------------------------------------------------------
+/** Monitor History Constructor
+
+The history starts in memory with the default capacity.
+*/
+
+MonitorHistory::MonitorHistory()
+{
+    historyCapacity = 0;
+    count = 0;
+    times = NULL;
+    header = NULL;
+    for (int c=0; c<numberHistoryChannels; c++)
+    {
+        values[c] = NULL;
+        pending[c] = 0;
+    }
+    setCapacity(HISTORY_CAPACITY);
+}
+
+MonitorHistory::~MonitorHistory()
+{
+    if (header != NULL) file.unmap((uchar*)header);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the number of samples held
+
+Any samples held are discarded, unless the file already holds a history of the
+same capacity, in which case that history is continued.
+
+@param[in] size: number of samples.
+@param[in] fileName: file to hold the samples, or empty to hold them in memory.
+@returns false if the file could not be mapped. The history is then in memory.
+*/
+
+bool MonitorHistory::setCapacity(qint64 size, QString fileName)
+{
+    if (size < HISTORY_MIN_CAPACITY) size = HISTORY_MIN_CAPACITY;
+    if (header != NULL) file.unmap((uchar*)header);
+    if (file.isOpen()) file.close();
+    header = NULL;
+    historyCapacity = size;
+    count = 0;
+    errorMessage.clear();
+    if (! fileName.isEmpty())
+    {
+        qint64 bytes = sizeof(FileHeader) + size*sizeof(qint64)
+                     + size*numberHistoryChannels*sizeof(float);
+        file.setFileName(fileName);
+        if (file.open(QIODevice::ReadWrite) &&
+            ((file.size() == bytes) || file.resize(bytes)))
+            header = (FileHeader*)file.map(0, bytes);
+        if (header == NULL)
+        {
+            errorMessage = QString("Could not map history file %1: %2")
+                            .arg(fileName).arg(file.errorString());
+            file.close();
+        }
+    }
+    if (header == NULL)
+    {
+        timeStore.resize(size);
+        valueStore.resize(size*numberHistoryChannels);
+        times = timeStore.data();
+        for (int c=0; c<numberHistoryChannels; c++)
+            values[c] = valueStore.data() + c*size;
+    }
+    else
+    {
+        timeStore.clear();
+        valueStore.clear();
+        if ((header->magic != HISTORY_MAGIC) || (header->capacity != (quint64)size))
+        {
+            header->magic = HISTORY_MAGIC;
+            header->capacity = size;
+            header->count = 0;
+        }
+        count = header->count;
+        times = (qint64*)(header + 1);
+        float* store = (float*)(times + size);
+        for (int c=0; c<numberHistoryChannels; c++)
+            values[c] = store + c*size;
+    }
+    allocate();
+    return errorMessage.isEmpty();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Description of the last failure to map a file
+*/
+
+QString MonitorHistory::error() const
+{
+    return errorMessage;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Build the decimation levels
+
+Levels are added until one would hold fewer than HISTORY_MIN_BUCKETS buckets.
+Any samples already held, from a file, are then entered into the levels.
+*/
+
+void MonitorHistory::allocate()
+{
+    decimation.clear();
+    for (qint64 size = HISTORY_FACTOR; historyCapacity/size >= HISTORY_MIN_BUCKETS;
+         size *= HISTORY_FACTOR)
+    {
+        Level level;
+        level.size = size;
+/* Room for a partial bucket at each end of the samples held. */
+        level.capacity = historyCapacity/size + 2;
+        for (int c=0; c<numberHistoryChannels; c++)
+        {
+            level.minimum[c].resize(level.capacity);
+            level.maximum[c].resize(level.capacity);
+        }
+        decimation.append(level);
+    }
+    for (qint64 n = first(); n < end(); n++) updateLevels(n, n == first());
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Take the currents and voltages from a message
+
+The values are held until the panel message, which ends each block of data
+from the BMS, when they are added as one sample timed by the panel message.
+
+@param[in] message: any message, those without interface data are ignored.
+@returns true if a sample was added.
+*/
+
+bool MonitorHistory::collect(const Message& message)
+{
+    int channel;
+    switch (message.id)
+    {
+        case messageBattery1: channel = channelB1Current; break;
+        case messageBattery2: channel = channelB2Current; break;
+        case messageBattery3: channel = channelB3Current; break;
+        case messageLoad1: channel = channelL1Current; break;
+        case messageLoad2: channel = channelL2Current; break;
+        case messagePanel: channel = channelM1Current; break;
+        default: return false;
+    }
+    pending[channel] = (float)message.value[1]/256;
+    pending[channel+1] = (float)message.value[2]/256;
+    if (message.id != messagePanel) return false;
+    append(message.time, pending);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Add a sample, replacing the oldest if the history is full
+
+@param[in] time: host time in ms since the epoch.
+@param[in] sample: value of each channel.
+*/
+
+void MonitorHistory::append(qint64 time, const float* sample)
+{
+    qint64 slot = count % historyCapacity;
+    times[slot] = time;
+    for (int c=0; c<numberHistoryChannels; c++) values[c][slot] = sample[c];
+    updateLevels(count, false);
+    count++;
+    if (header != NULL) header->count = count;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Enter a sample into the minimum and maximum of its buckets
+
+@param[in] sample: sample number.
+@param[in] restart: start the buckets even if the sample is not the first in
+           them, as when rebuilding from the oldest sample held.
+*/
+
+void MonitorHistory::updateLevels(qint64 sample, bool restart)
+{
+    qint64 slot = sample % historyCapacity;
+    for (int l=0; l<decimation.size(); l++)
+    {
+        Level& level = decimation[l];
+        qint64 bucket = (sample/level.size) % level.capacity;
+        bool start = restart || ((sample % level.size) == 0);
+        for (int c=0; c<numberHistoryChannels; c++)
+        {
+            float value = values[c][slot];
+            float& minimum = level.minimum[c][bucket];
+            float& maximum = level.maximum[c][bucket];
+            if (start || (value < minimum)) minimum = value;
+            if (start || (value > maximum)) maximum = value;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Sample numbers held
+
+@returns capacity: the most samples that can be held.
+@returns first: the number of the oldest sample held.
+@returns end: one more than the number of the newest sample.
+*/
+
+qint64 MonitorHistory::capacity() const
+{
+    return historyCapacity;
+}
+
+qint64 MonitorHistory::first() const
+{
+    return (count > historyCapacity) ? count - historyCapacity : 0;
+}
+
+qint64 MonitorHistory::end() const
+{
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Time and values of a sample held
+
+@param[in] sample: sample number from first() to end()-1.
+*/
+
+qint64 MonitorHistory::time(qint64 sample) const
+{
+    return times[sample % historyCapacity];
+}
+
+float MonitorHistory::value(int channel, qint64 sample) const
+{
+    return values[channel][sample % historyCapacity];
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Find the first sample at or after a time
+
+@param[in] time: host time in ms since the epoch.
+@returns sample number, end() if all samples are earlier.
+*/
+
+qint64 MonitorHistory::find(qint64 time) const
+{
+    qint64 low = first();
+    qint64 high = end();
+    while (low < high)
+    {
+        qint64 middle = low + (high-low)/2;
+        if (times[middle % historyCapacity] < time) low = middle+1;
+        else high = middle;
+    }
+    return low;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Decimation levels
+
+Level 0 is the samples themselves. Each higher level holds buckets of
+bucketSize() samples.
+*/
+
+int MonitorHistory::levels() const
+{
+    return decimation.size() + 1;
+}
+
+qint64 MonitorHistory::bucketSize(int level) const
+{
+    if (level == 0) return 1;
+    return decimation[level-1].size;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Finest level showing a range of samples in a number of points
+
+@param[in] start: first sample number.
+@param[in] finish: one more than the last sample number.
+@param[in] maxPoints: number of buckets that can be shown.
+*/
+
+int MonitorHistory::level(qint64 start, qint64 finish, int maxPoints) const
+{
+    if (finish <= start) return 0;
+    for (int l=0; l<levels(); l++)
+    {
+        qint64 size = bucketSize(l);
+        if ((finish-1)/size - start/size + 1 <= maxPoints) return l;
+    }
+    return levels()-1;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Minimum and maximum of a channel over a bucket
+
+@param[in] level: decimation level.
+@param[in] channel: channel.
+@param[in] bucket: bucket number, being the sample number divided by the
+           bucket size of the level.
+*/
+
+float MonitorHistory::minimum(int level, int channel, qint64 bucket) const
+{
+    if (level == 0) return value(channel, bucket);
+    const Level& data = decimation[level-1];
+    return data.minimum[channel][bucket % data.capacity];
+}
+
+float MonitorHistory::maximum(int level, int channel, qint64 bucket) const
+{
+    if (level == 0) return value(channel, bucket);
+    const Level& data = decimation[level-1];
+    return data.maximum[channel][bucket % data.capacity];
+}
+
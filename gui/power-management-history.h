@@ -0,0 +1,126 @@
+/*          Power Management GUI Monitor History Header
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#ifndef POWER_MANAGEMENT_HISTORY_H
+#define POWER_MANAGEMENT_HISTORY_H
+
+#include "power-management-message.h"
+#include <QString>
+#include <QVector>
+#include <QList>
+#include <QFile>
+
+// Default number of samples held, one day at one sample per second
+#define HISTORY_CAPACITY    86400
+#define HISTORY_MIN_CAPACITY 600
+// Number of samples merged into one bucket at each decimation level
+#define HISTORY_FACTOR      4
+// Stop adding levels when a level would hold fewer buckets than this
+#define HISTORY_MIN_BUCKETS 256
+// Marks a history file as holding samples in this layout
+#define HISTORY_MAGIC       0x424d5331
+
+// Channels in the order of the monitor source selection
+typedef enum {channelB1Current, channelB1Voltage,
+              channelB2Current, channelB2Voltage,
+              channelB3Current, channelB3Voltage,
+              channelL1Current, channelL1Voltage,
+              channelL2Current, channelL2Voltage,
+              channelM1Current, channelM1Voltage,
+              numberHistoryChannels} HistoryChannel;
+
+//-----------------------------------------------------------------------------
+/** @brief History of the monitored currents and voltages.
+
+A ring buffer of samples with a host time and the twelve interface currents and
+voltages, held as an array for each so that one channel can be read without
+touching the others. A sample is taken each time the panel message ends a block.
+
+Samples are numbered from the first ever taken. Sample n is held at n modulo
+the capacity, and the samples held run from first() to end()-1.
+
+Each channel also has a ring of minimum and maximum values for each level of
+decimation, each HISTORY_FACTOR times coarser than the one below, kept up to
+date as samples arrive. A plot over any range uses the finest level that fits
+the pixels available, so its cost does not depend on the length of the range.
+
+The samples can be held in a memory mapped file in place of memory, so that a
+long history does not take up memory and is kept when the GUI is restarted.
+The decimation levels are rebuilt from the file when it is opened.
+*/
+
+class MonitorHistory
+{
+public:
+    MonitorHistory();
+    ~MonitorHistory();
+    bool setCapacity(qint64 size, QString fileName = QString());
+    QString error() const;
+    bool collect(const Message& message);
+    void append(qint64 time, const float* sample);
+    qint64 capacity() const;
+    qint64 first() const;
+    qint64 end() const;
+    qint64 time(qint64 sample) const;
+    float value(int channel, qint64 sample) const;
+    qint64 find(qint64 time) const;
+    int levels() const;
+    int level(qint64 start, qint64 finish, int maxPoints) const;
+    qint64 bucketSize(int level) const;
+    float minimum(int level, int channel, qint64 bucket) const;
+    float maximum(int level, int channel, qint64 bucket) const;
+private:
+    struct Level
+    {
+        qint64 size;
+        qint64 capacity;
+        QVector<float> minimum[numberHistoryChannels];
+        QVector<float> maximum[numberHistoryChannels];
+    };
+    struct FileHeader
+    {
+        quint64 magic;
+        quint64 capacity;
+        quint64 count;
+    };
+    void allocate();
+    void updateLevels(qint64 sample, bool restart);
+    qint64 historyCapacity;
+    qint64 count;
+    qint64* times;
+    float* values[numberHistoryChannels];
+    QVector<qint64> timeStore;
+    QVector<float> valueStore;
+    QFile file;
+    FileHeader* header;
+    QList<Level> decimation;
+    float pending[numberHistoryChannels];
+    QString errorMessage;
+};
+
+#endif
@@ -0,0 +1,753 @@
+/*       Power Management Communications Link
+
+The serial or TCP port is run in a thread of its own. Bytes received are framed
+into lines and decoded there, and the decoded messages are queued for the GUI.
+This keeps the GUI free of the per-byte work and stops a slow redraw from
+delaying the port. Writes from the windows are queued to the same thread.
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include "power-management-link.h"
+#include <QSerialPort>
+#include <QTcpSocket>
+#include <QDateTime>
+#include <QMetaObject>
+
+// Longest line accepted before the partial line is discarded as garbage
+#define LINK_MAX_LINE 1024
+
+//-----------------------------------------------------------------------------
+/** I/O Thread Worker Constructor
+
+@param[in] queue Queue for the decoded messages.
+@param[in] linkCounters Counters of link activity.
+*/
+
+LinkWorker::LinkWorker(MessageQueue* queue, LinkCounters* linkCounters)
+{
+    messages = queue;
+    counters = linkCounters;
+    port = NULL;
+    aborting.store(0);
+    nextSequence = 0;
+    retryTimer = new QTimer(this);
+    retryTimer->setInterval(LINK_RETRY_TICK);
+    connect(retryTimer, SIGNAL(timeout()), this, SLOT(onRetryTimeout()));
+    sendTimer = new QTimer(this);
+    sendTimer->setSingleShot(true);
+    connect(sendTimer, SIGNAL(timeout()), this, SLOT(schedule()));
+    bytesSent = 0;
+    bytesTaken = 0;
+    takenTime = 0;
+    setLineRate(LINK_TCP_BAUDRATE);
+    clock.start();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Open a serial port
+
+The opened signal gives the result.
+
+@param[in] device Serial device name.
+@param[in] baudrate Baud rate.
+*/
+
+void LinkWorker::openSerial(QString device, int baudrate)
+{
+    close();
+    QSerialPort* serialPort = new QSerialPort(device, this);
+    bool ok = serialPort->open(QIODevice::ReadWrite);
+    if (ok)
+    {
+        serialPort->setBaudRate(baudrate);
+        serialPort->setDataBits(QSerialPort::Data8);
+        serialPort->setParity(QSerialPort::NoParity);
+        serialPort->setStopBits(QSerialPort::OneStop);
+        serialPort->setFlowControl(QSerialPort::NoFlowControl);
+        connect(serialPort, SIGNAL(readyRead()), this, SLOT(onDataAvailable()));
+        connect(serialPort, SIGNAL(errorOccurred(QSerialPort::SerialPortError)),
+                this, SLOT(onSerialError(QSerialPort::SerialPortError)));
+        port = serialPort;
+        setLineRate(baudrate);
+        startSequence();
+    }
+    else delete serialPort;
+    emit opened(ok);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Connect to a remote TCP system
+
+Connection is retried for up to LINK_TCP_ATTEMPTS seconds. Only the I/O thread
+waits; writes made meanwhile are held in order and sent once connected. If no
+connection is made the socket is deleted, as for a serial port that does not
+open, so that later writes are dropped and sequenced commands fail.
+
+@param[in] address Remote address.
+@param[in] tcpPort Remote port.
+*/
+
+void LinkWorker::openTcp(QString address, quint16 tcpPort)
+{
+    close();
+    QTcpSocket* tcpSocket = new QTcpSocket(this);
+    connect(tcpSocket, SIGNAL(readyRead()), this, SLOT(onDataAvailable()));
+    port = tcpSocket;
+    bool ok = false;
+    for (int count=0; (count < LINK_TCP_ATTEMPTS) && (aborting.load() == 0); count++)
+    {
+        QThread::msleep(10);
+        tcpSocket->abort();
+        tcpSocket->connectToHost(address, tcpPort);
+        ok = tcpSocket->waitForConnected(1000);
+        if (ok) break;
+    }
+    if (ok)
+    {
+        connect(tcpSocket, SIGNAL(disconnected()), this, SIGNAL(closed()));
+        setLineRate(LINK_TCP_BAUDRATE);
+        startSequence();
+    }
+    else
+    {
+        tcpSocket->disconnect(this);
+        delete tcpSocket;
+        port = NULL;
+    }
+    emit opened(ok);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send data to the remote system
+
+@param[in] data Command with its line ending.
+@param[in] priority LinkPriority of the command.
+*/
+
+void LinkWorker::write(QByteArray data, int priority)
+{
+    if (port != NULL) queueLine(data, priority);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the rate the BMS is assumed to take bytes at
+
+Ten bits are sent for each byte, and the BMS is given LINK_SEND_SHARE of them.
+
+@param[in] baudrate Line rate.
+*/
+
+void LinkWorker::setLineRate(qint32 baudrate)
+{
+    takeRate = qMax(1, baudrate*LINK_SEND_SHARE/1000);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Hold a line for the scheduler
+
+@param[in] data Line with its line ending.
+@param[in] priority LinkPriority of the line.
+@param[in] sequence Sequence number of a sequenced command, -1 for others.
+*/
+
+void LinkWorker::queueLine(const QByteArray& data, int priority, int sequence)
+{
+    OutboundLine line;
+    line.data = data;
+    line.sequence = sequence;
+    outbound[priority].append(line);
+    counters->bytesWaiting.fetchAndAddRelaxed(data.size());
+    schedule();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send the lines waiting while the BMS has room for them
+
+The bytes taken by the BMS since the last call are estimated from its rate.
+Lines are sent from the highest priority queue first while the bytes still in
+the BMS queue would stay within LINK_REMOTE_BUFFER. A line longer than that is
+sent only once the BMS queue is estimated to be empty. Otherwise the timer is
+set for when there will be room.
+
+The time a sequenced command is actually sent is recorded here, so that its
+acknowledgement is not waited for while it is held.
+*/
+
+void LinkWorker::schedule()
+{
+    if (port == NULL) return;
+    qint64 now = clock.elapsed();
+    bytesTaken = qMin((double)bytesSent,
+                      bytesTaken + (double)(now - takenTime)*takeRate/1000);
+    takenTime = now;
+    for (int priority=0; priority<numberLinkPriorities; priority++)
+    {
+        while (! outbound[priority].isEmpty())
+        {
+            int size = outbound[priority].first().data.size();
+            double held = bytesSent - bytesTaken;
+            if ((held > 0) && (held + size > LINK_REMOTE_BUFFER))
+            {
+                sendTimer->start((int)((held + size - LINK_REMOTE_BUFFER)*1000
+                                       /takeRate) + 1);
+                return;
+            }
+            OutboundLine line = outbound[priority].takeFirst();
+            send(line.data);
+            bytesSent += size;
+            counters->bytesWaiting.fetchAndAddRelaxed(-size);
+            if (line.sequence < 0) continue;
+            for (int i=0; i<outstanding.size(); i++)
+            {
+                if (outstanding[i].sequence != line.sequence) continue;
+                outstanding[i].sent = now;
+                outstanding[i].mark = bytesSent;
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Write to the port and count the bytes sent
+*/
+
+void LinkWorker::send(const QByteArray& data)
+{
+    port->write(data);
+    counters->bytesWritten.fetchAndAddRelaxed(data.size());
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send a command with a sequence number
+
+The command is held until there is room in the window.
+
+@param[in] command Command without the line ending.
+*/
+
+void LinkWorker::sendCommand(QByteArray command)
+{
+    command = command.trimmed();
+    if (port == NULL)
+    {
+        counters->commandsFailed.fetchAndAddRelaxed(1);
+        emit commandFailed(command);
+        return;
+    }
+    waiting.append(command);
+    fillWindow();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Start numbering sequenced commands afresh on a new connection
+
+The BMS is told to forget the numbers it has seen. Commands still waiting for
+an acknowledgement go out again under new numbers ahead of the rest.
+*/
+
+void LinkWorker::startSequence()
+{
+    queueLine("aK\n\r", linkPriorityHigh);
+    nextSequence = 0;
+    while (! outstanding.isEmpty()) waiting.prepend(outstanding.takeLast().command);
+    fillWindow();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send waiting commands while the window has room
+
+The window slides only as the oldest outstanding command is acknowledged or
+given up, so a command held up by retransmission stops later numbers from
+running more than LINK_WINDOW ahead of it.
+*/
+
+void LinkWorker::fillWindow()
+{
+    while (! waiting.isEmpty())
+    {
+        if (! outstanding.isEmpty() &&
+            ((nextSequence - outstanding.first().sequence + 256) % 256
+                >= LINK_WINDOW)) break;
+        PendingCommand pending;
+        pending.sequence = nextSequence;
+        pending.command = waiting.takeFirst();
+        pending.attempts = 0;
+        nextSequence = (nextSequence+1) % 256;
+        outstanding.append(pending);
+        transmit(outstanding.last());
+    }
+    if (outstanding.isEmpty()) retryTimer->stop();
+    else if (! retryTimer->isActive()) retryTimer->start();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send a sequenced command, first time or again
+
+The command is given to the scheduler with high priority. Its sending time is
+set when it actually goes out.
+
+@param[in,out] pending Command, its attempts are updated.
+*/
+
+void LinkWorker::transmit(PendingCommand& pending)
+{
+    QByteArray line = "#" + QByteArray::number(pending.sequence) + ","
+                    + pending.command + "\n\r";
+    pending.sent = -1;
+    pending.attempts++;
+    if (pending.attempts == 1) counters->commandsSent.fetchAndAddRelaxed(1);
+    else counters->commandsRepeated.fetchAndAddRelaxed(1);
+    queueLine(line, linkPriorityHigh, pending.sequence);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send again commands not acknowledged in time
+
+A command that has been sent LINK_ATTEMPTS times is given up and reported.
+Commands still held by the scheduler are not timed.
+*/
+
+void LinkWorker::onRetryTimeout()
+{
+    if (port == NULL) return;
+    qint64 now = clock.elapsed();
+    for (int i=0; i<outstanding.size(); i++)
+    {
+        if (outstanding[i].sent < 0) continue;
+        if (now - outstanding[i].sent < LINK_ACK_TIMEOUT) continue;
+        if (outstanding[i].attempts < LINK_ATTEMPTS) transmit(outstanding[i]);
+        else
+        {
+            counters->commandsFailed.fetchAndAddRelaxed(1);
+            emit commandFailed(outstanding.takeAt(i--).command);
+        }
+    }
+    fillWindow();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Take the acknowledgement of a sequenced command
+
+Acknowledgements of commands already dealt with, as when both the first and a
+repeated sending were answered, are ignored.
+
+The acknowledgement of a first sending shows that the BMS has taken all bytes
+sent up to the command, which lets the scheduler send more.
+
+@param[in] sequence Sequence number acknowledged.
+*/
+
+void LinkWorker::acknowledge(int sequence)
+{
+    for (int i=0; i<outstanding.size(); i++)
+    {
+        if (outstanding[i].sequence != sequence) continue;
+        if (outstanding[i].attempts == 1)
+        {
+            qint64 roundTrip = clock.elapsed() - outstanding[i].sent;
+            counters->roundTripLast.store(roundTrip);
+            counters->roundTripTotal.fetchAndAddRelaxed(roundTrip);
+            counters->roundTripCount.fetchAndAddRelaxed(1);
+            if (roundTrip > counters->roundTripMax.load())
+                counters->roundTripMax.store(roundTrip);
+            if (outstanding[i].mark > bytesTaken) bytesTaken = outstanding[i].mark;
+        }
+        counters->commandsAcknowledged.fetchAndAddRelaxed(1);
+        outstanding.removeAt(i);
+        fillWindow();
+        schedule();
+        return;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Close the port
+
+Commands of high priority still held by the scheduler are sent at once, and
+data not yet sent is given a short time to go out, so that the commands sent
+on disconnect are not lost. Sequenced commands not yet acknowledged and low
+priority commands are discarded.
+*/
+
+void LinkWorker::close()
+{
+    retryTimer->stop();
+    sendTimer->stop();
+    outstanding.clear();
+    waiting.clear();
+    if (port != NULL)
+    {
+        for (int i=0; i<outbound[linkPriorityHigh].size(); i++)
+            if (outbound[linkPriorityHigh][i].sequence < 0)
+                send(outbound[linkPriorityHigh][i].data);
+    }
+    for (int priority=0; priority<numberLinkPriorities; priority++)
+        outbound[priority].clear();
+    counters->bytesWaiting.store(0);
+    bytesSent = 0;
+    bytesTaken = 0;
+    if (port == NULL) return;
+    port->disconnect(this);
+    if (port->bytesToWrite() > 0) port->waitForBytesWritten(100);
+    port->close();
+    delete port;
+    port = NULL;
+    buffer.clear();
+    lastTime = QDateTime();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Report loss of the serial port
+
+A resource error means that the device has gone away.
+*/
+
+void LinkWorker::onSerialError(QSerialPort::SerialPortError error)
+{
+    if (error == QSerialPort::ResourceError) emit closed();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Stop any connection attempt in progress
+
+Called from the GUI thread.
+*/
+
+void LinkWorker::abort()
+{
+    aborting.store(1);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Frame and decode the incoming data
+
+All bytes available are read in one call and each complete line is located with
+a search for the newline, rather than handling the data a byte at a time. The
+host time is taken when the line is framed. Carriage returns are discarded.
+Acknowledgements of sequenced commands are taken here.
+
+If the GUI has fallen so far behind that the queue is full, the message is
+dropped and counted. The GUI is signalled once after each batch if it has
+emptied the queue since it was last signalled.
+*/
+
+void LinkWorker::onDataAvailable()
+{
+    QByteArray data = port->readAll();
+    counters->bytesRead.fetchAndAddRelaxed(data.size());
+    buffer.append(data);
+    int start = 0;
+    int end;
+    bool queued = false;
+    while ((end = buffer.indexOf('\n', start)) >= 0)
+    {
+        QByteArray line = buffer.mid(start, end-start);
+        start = end+1;
+        line.replace("\r", "");
+        counters->linesRead.fetchAndAddRelaxed(1);
+        if (line.startsWith("aK,"))
+        {
+            acknowledge(line.mid(3).toInt());
+            continue;
+        }
+        Message message = decodeMessage(QString::fromLatin1(line),
+                                        QDateTime::currentMSecsSinceEpoch());
+        countMessage(message);
+        if (messages->push(message)) queued = true;
+        else counters->framesDropped.fetchAndAddRelaxed(1);
+    }
+    buffer.remove(0, start);
+    if (buffer.size() > LINK_MAX_LINE)
+    {
+        buffer.clear();
+        counters->framesDropped.fetchAndAddRelaxed(1);
+    }
+    if (queued && messages->needsSignal()) emit messagesAvailable();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Count a message by its identity and check its form
+
+The BMS time of each time record is compared with the one before to find the
+records lost.
+*/
+
+void LinkWorker::countMessage(const Message& message)
+{
+    counters->messages[message.id].fetchAndAddRelaxed(1);
+    bool malformed = (message.ident.size() < 2) ||
+                     (QByteArray("adpfD").indexOf(message.ident.at(0).toLatin1()) < 0);
+    for (int i=0; (i<message.line.size()) && ! malformed; i++)
+    {
+        ushort character = message.line.at(i).unicode();
+        if ((character < 0x20) || (character > 0x7E)) malformed = true;
+    }
+    if (malformed) counters->linesMalformed.fetchAndAddRelaxed(1);
+    if ((message.id != messageTime) || (message.size < 2)) return;
+    QDateTime time = QDateTime::fromString(message.fields[1].simplified(),
+                                           Qt::ISODate);
+    if (! time.isValid()) return;
+    if (lastTime.isValid())
+    {
+        qint64 step = lastTime.secsTo(time);
+        if ((step > 1) && (step <= LINK_MAX_TIME_GAP))
+            counters->timeGaps.fetchAndAddRelaxed(step-1);
+    }
+    lastTime = time;
+}
+
+//-----------------------------------------------------------------------------
+/** Communications Link Constructor
+
+The worker is created here and moved to the I/O thread, which is started
+immediately. The port is opened later in that thread.
+*/
+
+Link::Link(QObject* parent) : QObject(parent)
+{
+    serialBaudrate = 0;
+    recorder = NULL;
+    worker = new LinkWorker(&queue, &counters);
+    worker->moveToThread(&thread);
+    connect(worker, SIGNAL(opened(bool)), this, SIGNAL(opened(bool)));
+    connect(worker, SIGNAL(closed()), this, SIGNAL(closed()));
+    connect(worker, SIGNAL(messagesAvailable()), this, SIGNAL(messagesAvailable()));
+    connect(worker, SIGNAL(commandFailed(QByteArray)),
+            this, SIGNAL(commandFailed(QByteArray)));
+    thread.start();
+}
+
+Link::~Link()
+{
+    worker->abort();
+    QMetaObject::invokeMethod(worker, "close", Qt::BlockingQueuedConnection);
+    thread.quit();
+    thread.wait();
+    delete worker;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Start opening a serial port
+
+Returns immediately, as the I/O thread may still be busy with an earlier
+attempt to connect. The opened signal gives the result. Commands written
+meanwhile are sent once the port is open.
+
+@param[in] device Serial device name.
+@param[in] baudrate Baud rate.
+*/
+
+void Link::openSerial(QString device, qint32 baudrate)
+{
+    serialBaudrate = baudrate;
+    QMetaObject::invokeMethod(worker, "openSerial", Qt::QueuedConnection,
+                              Q_ARG(QString, device), Q_ARG(int, baudrate));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Start connecting to a remote TCP system
+
+Returns immediately. The opened signal gives the result.
+
+@param[in] address Remote address.
+@param[in] port Remote port.
+*/
+
+void Link::openTcp(QString address, quint16 port)
+{
+    serialBaudrate = 0;
+    QMetaObject::invokeMethod(worker, "openTcp", Qt::QueuedConnection,
+                              Q_ARG(QString, address), Q_ARG(quint16, port));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send data to the remote system
+
+The data is copied and queued to the I/O thread, so this may be called from
+the GUI without waiting on the port. It is sent when the BMS has room for it.
+
+@param[in] data Command with its line ending.
+@param[in] priority Low for requests that can wait behind other commands.
+@returns number of bytes queued.
+*/
+
+qint64 Link::write(const char* data, LinkPriority priority)
+{
+    return write(QByteArray(data), priority);
+}
+
+qint64 Link::write(const QByteArray& data, LinkPriority priority)
+{
+    if (recorder != NULL) recorder->writeSent(QString::fromLatin1(data.trimmed()));
+    QMetaObject::invokeMethod(worker, "write", Qt::QueuedConnection,
+                              Q_ARG(QByteArray, data), Q_ARG(int, priority));
+    return data.size();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Send a command that is acknowledged and sent again if lost
+
+Any number of commands may be sent without waiting. They go out in order, at
+most LINK_WINDOW numbers beyond the oldest awaiting acknowledgement. A command
+sent again may arrive after those that followed it.
+
+@param[in] command Command, with or without the line ending.
+*/
+
+void Link::sendCommand(const QByteArray& command)
+{
+    if (recorder != NULL) recorder->writeSent(QString::fromLatin1(command.trimmed()));
+    QMetaObject::invokeMethod(worker, "sendCommand", Qt::QueuedConnection,
+                              Q_ARG(QByteArray, command));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Give the commands sent to a capture writer
+
+Only a writer saving a session keeps them. The writer must outlive the link or
+be removed first.
+
+@param[in] writer Capture writer, NULL for none.
+*/
+
+void Link::setRecorder(CaptureWriter* writer)
+{
+    recorder = writer;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Take the next decoded message from the queue
+
+Called by the GUI until it returns false, after the messagesAvailable signal.
+When the queue is found empty the worker is allowed to signal again, and the
+queue is checked once more for a message that arrived meanwhile.
+
+@param[out] message The message taken.
+@returns true if a message was taken.
+*/
+
+bool Link::takeMessage(Message* message)
+{
+    if (queue.pop(message)) return true;
+    queue.clearSignal();
+    return queue.pop(message);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Baud rate of a serial link, zero for TCP
+*/
+
+qint32 Link::baudrate() const
+{
+    return serialBaudrate;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Link counters
+*/
+
+qint64 Link::bytesRead() const
+{
+    return counters.bytesRead.load();
+}
+
+qint64 Link::bytesWritten() const
+{
+    return counters.bytesWritten.load();
+}
+
+qint64 Link::bytesWaiting() const
+{
+    return counters.bytesWaiting.load();
+}
+
+qint64 Link::linesRead() const
+{
+    return counters.linesRead.load();
+}
+
+qint64 Link::linesMalformed() const
+{
+    return counters.linesMalformed.load();
+}
+
+qint64 Link::framesDropped() const
+{
+    return counters.framesDropped.load();
+}
+
+qint64 Link::messages(MessageId id) const
+{
+    return counters.messages[id].load();
+}
+
+qint64 Link::timeGaps() const
+{
+    return counters.timeGaps.load();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Sequenced command counters
+
+Round trip times are in ms, of commands acknowledged on their first sending.
+*/
+
+qint64 Link::commandsSent() const
+{
+    return counters.commandsSent.load();
+}
+
+qint64 Link::commandsAcknowledged() const
+{
+    return counters.commandsAcknowledged.load();
+}
+
+qint64 Link::commandsRepeated() const
+{
+    return counters.commandsRepeated.load();
+}
+
+qint64 Link::commandsFailed() const
+{
+    return counters.commandsFailed.load();
+}
+
+qint64 Link::roundTripLast() const
+{
+    return counters.roundTripLast.load();
+}
+
+qint64 Link::roundTripMax() const
+{
+    return counters.roundTripMax.load();
+}
+
+double Link::roundTripMean() const
+{
+    qint64 count = counters.roundTripCount.load();
+    if (count == 0) return 0;
+    return (double)counters.roundTripTotal.load()/count;
+}
@@ -0,0 +1,305 @@
+/*          Power Management GUI Communications Link Header
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+#ifndef POWER_MANAGEMENT_LINK_H
+#define POWER_MANAGEMENT_LINK_H
+
+#include "power-management-message.h"
+#include "power-management-capture.h"
+#include <QObject>
+#include <QThread>
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QIODevice>
+#include <QSerialPort>
+#include <QList>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QDateTime>
+
+// Number of decoded messages held for the GUI. Must be a power of two.
+#define LINK_QUEUE_SIZE 4096
+// Attempts made to reach a remote TCP system, one second each
+#define LINK_TCP_ATTEMPTS 100
+// Span of sequence numbers from the oldest command outstanding to the next to
+// be sent. Must be fewer than the firmware COMMS_SEQUENCE_HISTORY.
+#define LINK_WINDOW 8
+// Time in ms without an acknowledgement before a command is sent again
+#define LINK_ACK_TIMEOUT 500
+// Times a command is sent before it is given up
+#define LINK_ATTEMPTS 5
+// Interval in ms between checks for commands to send again
+#define LINK_RETRY_TICK 100
+// Steps in the BMS time longer than this (s) are taken as the clock being set
+// rather than time records lost
+#define LINK_MAX_TIME_GAP 3600
+// Bytes allowed in the BMS receive queue at once, half the firmware
+// COMMS_QUEUE_SIZE so that a burst never fills it
+#define LINK_REMOTE_BUFFER 256
+// Percentage of the line rate the BMS is assumed to take commands at, leaving
+// the rest of its time for the responses
+#define LINK_SEND_SHARE 50
+// Line rate assumed behind a TCP link, where the serial baud rate is unknown
+#define LINK_TCP_BAUDRATE 38400
+
+// Priorities of the commands sent. Those of the same priority go out in order.
+typedef enum {linkPriorityHigh, linkPriorityLow, numberLinkPriorities} LinkPriority;
+
+//-----------------------------------------------------------------------------
+/** @brief Single producer single consumer queue of decoded messages.
+
+A fixed ring of slots with one index owned by each side. The I/O thread only
+advances the tail and the GUI thread only advances the head, so no lock is
+needed. A push to a full queue fails and the caller counts the frame as dropped
+rather than blocking the link.
+
+The signalled flag lets the producer notify the consumer once per batch. It is
+set by the first push after the consumer has found the queue empty.
+*/
+
+class MessageQueue
+{
+public:
+    MessageQueue() : slots(LINK_QUEUE_SIZE), head(0), tail(0), signalled(0) {}
+    bool push(const Message& message)
+    {
+        int position = tail.load();
+        if ((position - head.loadAcquire()) >= LINK_QUEUE_SIZE) return false;
+        slots[position & (LINK_QUEUE_SIZE-1)] = message;
+        tail.storeRelease(position+1);
+        return true;
+    }
+    bool pop(Message* message)
+    {
+        int position = head.load();
+        if (position == tail.loadAcquire()) return false;
+        Message& slot = slots[position & (LINK_QUEUE_SIZE-1)];
+        *message = slot;
+// Release the strings here rather than when the slot is next written.
+        slot = Message();
+        head.storeRelease(position+1);
+        return true;
+    }
+    bool needsSignal()
+    {
+        return signalled.testAndSetOrdered(0,1);
+    }
+    void clearSignal()
+    {
+        signalled.storeRelease(0);
+    }
+private:
+    QVector<Message> slots;
+    QAtomicInt head;
+    QAtomicInt tail;
+    QAtomicInt signalled;
+};
+
+//-----------------------------------------------------------------------------
+/** @brief Counters kept by the I/O thread.
+
+Written only by the I/O thread and readable at any time from the GUI.
+
+Malformed lines are those with no ident of a known category or with characters
+that are not printable. Time gaps are the seconds missing between consecutive
+pH time records, which the BMS sends once a second.
+*/
+
+struct LinkCounters
+{
+    QAtomicInteger<qint64> bytesRead;
+    QAtomicInteger<qint64> bytesWritten;
+    QAtomicInteger<qint64> bytesWaiting;
+    QAtomicInteger<qint64> linesRead;
+    QAtomicInteger<qint64> linesMalformed;
+    QAtomicInteger<qint64> framesDropped;
+    QAtomicInteger<qint64> messages[numberMessageIds];
+    QAtomicInteger<qint64> timeGaps;
+    QAtomicInteger<qint64> commandsSent;
+    QAtomicInteger<qint64> commandsAcknowledged;
+    QAtomicInteger<qint64> commandsRepeated;
+    QAtomicInteger<qint64> commandsFailed;
+    QAtomicInteger<qint64> roundTripCount;
+    QAtomicInteger<qint64> roundTripTotal;
+    QAtomicInteger<qint64> roundTripLast;
+    QAtomicInteger<qint64> roundTripMax;
+};
+
+//-----------------------------------------------------------------------------
+/** @brief Serial or TCP port owned by the I/O thread.
+
+Received bytes are framed into lines and decoded in this thread. Messages are
+passed to the GUI through the queue, and the GUI is signalled only when it has
+emptied the queue since the last signal, so a burst of lines costs one event.
+
+Sequenced commands are numbered and sent while the next number is within
+LINK_WINDOW of the oldest still waiting for acknowledgement, so that a number
+sent again is always among those the BMS remembers. The acknowledgements are
+taken here and not passed on. A command not acknowledged within
+LINK_ACK_TIMEOUT is sent again with the same number, which the BMS recognises
+and does not act on twice. The round trip time is measured only for commands
+acknowledged on their first sending.
+
+All lines go out through a scheduler so that the BMS receive queue is never
+overrun. Lines wait in a queue for each priority and are sent, highest priority
+first, while the bytes estimated to be still in the BMS queue stay within
+LINK_REMOTE_BUFFER. The BMS is assumed to take bytes at LINK_SEND_SHARE of the
+line rate, and an acknowledgement shows that everything sent up to the command
+acknowledged has been taken.
+*/
+
+class LinkWorker : public QObject
+{
+    Q_OBJECT
+public:
+    LinkWorker(MessageQueue* queue, LinkCounters* counters);
+public slots:
+    void openSerial(QString device, int baudrate);
+    void openTcp(QString address, quint16 tcpPort);
+    void write(QByteArray data, int priority);
+    void sendCommand(QByteArray command);
+    void close();
+public:
+    void abort();
+signals:
+    void opened(bool ok);
+    void closed();
+    void messagesAvailable();
+    void commandFailed(QByteArray command);
+private slots:
+    void onDataAvailable();
+    void onSerialError(QSerialPort::SerialPortError error);
+    void onRetryTimeout();
+    void schedule();
+private:
+    struct PendingCommand
+    {
+        int sequence;
+        QByteArray command;
+        qint64 sent;
+        qint64 mark;
+        int attempts;
+    };
+    struct OutboundLine
+    {
+        QByteArray data;
+        int sequence;
+    };
+    void queueLine(const QByteArray& data, int priority, int sequence = -1);
+    void setLineRate(qint32 baudrate);
+    void send(const QByteArray& data);
+    void countMessage(const Message& message);
+    void startSequence();
+    void fillWindow();
+    void transmit(PendingCommand& pending);
+    void acknowledge(int sequence);
+    MessageQueue* messages;
+    LinkCounters* counters;
+    QIODevice* port;
+    QByteArray buffer;
+    QAtomicInt aborting;
+    QList<PendingCommand> outstanding;
+    QList<QByteArray> waiting;
+    int nextSequence;
+    QTimer* retryTimer;
+    QList<OutboundLine> outbound[numberLinkPriorities];
+    QTimer* sendTimer;
+    qint64 bytesSent;
+    double bytesTaken;
+    qint64 takenTime;
+    int takeRate;
+    QElapsedTimer clock;
+    QDateTime lastTime;
+};
+
+//-----------------------------------------------------------------------------
+/** @brief Communications link to the BMS as seen by the GUI windows.
+
+Runs the port in its own thread so that reading, framing and decoding never
+wait on the GUI, and a busy GUI never holds up the port. Writes may be made
+from the GUI thread at any time and are passed to the I/O thread in order.
+
+The closed signal is sent if the port is lost after it was opened, for example
+when a USB adapter is unplugged or the remote end drops the connection.
+
+Commands may be written as they are, or sent as sequenced commands which are
+acknowledged by the BMS and sent again if lost. Commands written with low
+priority, such as the requests that fill a window, wait behind all others. The
+commandFailed signal is sent for a sequenced command that was never
+acknowledged.
+
+Commands are also given to a recorder if one is set, which keeps them when it
+is saving a session.
+*/
+
+class Link : public QObject
+{
+    Q_OBJECT
+public:
+    Link(QObject* parent = 0);
+    ~Link();
+    void openSerial(QString device, qint32 baudrate);
+    void openTcp(QString address, quint16 port);
+    qint64 write(const char* data, LinkPriority priority = linkPriorityHigh);
+    qint64 write(const QByteArray& data, LinkPriority priority = linkPriorityHigh);
+    void sendCommand(const QByteArray& command);
+    void setRecorder(CaptureWriter* writer);
+    bool takeMessage(Message* message);
+    qint32 baudrate() const;
+    qint64 bytesRead() const;
+    qint64 bytesWritten() const;
+    qint64 bytesWaiting() const;
+    qint64 linesRead() const;
+    qint64 linesMalformed() const;
+    qint64 framesDropped() const;
+    qint64 messages(MessageId id) const;
+    qint64 timeGaps() const;
+    qint64 commandsSent() const;
+    qint64 commandsAcknowledged() const;
+    qint64 commandsRepeated() const;
+    qint64 commandsFailed() const;
+    qint64 roundTripLast() const;
+    qint64 roundTripMax() const;
+    double roundTripMean() const;
+signals:
+    void opened(bool ok);
+    void closed();
+    void messagesAvailable();
+    void commandFailed(QByteArray command);
+private:
+    QThread thread;
+    MessageQueue queue;
+    LinkCounters counters;
+    LinkWorker* worker;
+    qint32 serialBaudrate;
+    CaptureWriter* recorder;
+};
+
+#endif
@@ -40,6 +40,8 @@ socat /dev/ttyUSB0,echo=0,ispeed=115200,ospeed=115200,raw tcp-l:6666,reuseaddr,f
 #include "power-management-record.h"
 #include "power-management-monitor.h"
 #include "power-management-configure.h"
+#include "power-management-diagnostics.h"
+#include "power-management-replay.h"
 #include <QSerialPort>
 #include <QSerialPortInfo>
 #include <QApplication>
@@ -70,14 +72,15 @@ const qint32 bauds[8] = {1200,2400,4800,9600,19200,38400,57600,115200};
 */
 
 PowerManagementGui::PowerManagementGui(QString device, uint parameter,
-                                       QWidget* parent) : QDialog(parent)
+                                       QWidget* parent)
+                    : QDialog(parent), dispatcher(this)
 {
 // Build the User Interface display from the Ui class in ui_mainwindowform.h
     PowerManagementMainUi.setupUi(this);
     initMainWindow(PowerManagementMainUi);
+    initDispatcher();
 
     saveFile.clear();
-    response.clear();
 
     socket = NULL;
 #ifdef SERIAL
@@ -244,1050 +247,1189 @@ void PowerManagementGui::setSourceComboBox(int index)
 }
 
 //-----------------------------------------------------------------------------
-/** @brief Handle incoming serial data
+/** @brief Handle incoming messages
 
-This is called when data appears in the serial buffer. Data is pulled in until
-a newline occurs, at which point the assembled command QString is processed.
+This is called when the link has decoded messages waiting. The link frames and
+decodes the lines in its own thread, so here the queue is simply emptied.
 
 All incoming messages are processed here and passed to other windows as appropriate.
 */
 
-void PowerManagementGui::onDataAvailable()
+void PowerManagementGui::onMessagesAvailable()
 {
-#ifndef SERIAL
-    if (! validsocket()) return;
-#endif
-    QByteArray data = socket->readAll();
-    int n=0;
-    while (n < data.size())
-    {
-        if ((data.at(n) != '\r') && (data.at(n) != '\n')) response += data.at(n);
-        if (data.at(n) == '\n')
-        {
-// The current time is saved to ms precision followed by the line.
-            tick.restart();
-            processResponse(response);
-            response.clear();
-        }
-        n++;
-    }
+    if (socket == NULL) return;
+    Message message;
+    while (socket->takeMessage(&message)) processResponse(message);
 }
 
 //-----------------------------------------------------------------------------
 /** @brief Process the incoming serial data
 
-Parse the line and take action on the command received.
+Take action on the decoded message received. The dispatch table calls the
+handlers for the message id and category.
 */
 
-void PowerManagementGui::processResponse(const QString response)
+void PowerManagementGui::processResponse(const Message& message)
 {
-    QStringList breakdown = response.split(",");
-    int size = breakdown.size();
-    QString firstField;
-    firstField = breakdown[0].simplified();
-    QString secondField;
-    if (size > 1) secondField = breakdown[1].simplified();
+    if (! saveFile.isEmpty()) saveLine(message);
+    dispatcher.dispatch(message);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Register the Message Handlers
+
+Each message id is routed to the handlers below. Messages for the other windows
+are forwarded by category, along with the data messages they also need.
+*/
+
+void PowerManagementGui::initDispatcher()
+{
+    dispatcher.add(messageTime,&PowerManagementGui::processTime);
+    dispatcher.add(messageQuiescent,&PowerManagementGui::processTime);
+    dispatcher.add(messageLoad1,&PowerManagementGui::processLoad1);
+    dispatcher.add(messageLoad2,&PowerManagementGui::processLoad2);
+    dispatcher.add(messagePanel,&PowerManagementGui::processPanel);
+    dispatcher.add(messageBattery1,&PowerManagementGui::processBattery1);
+    dispatcher.add(messageBattery2,&PowerManagementGui::processBattery2);
+    dispatcher.add(messageBattery3,&PowerManagementGui::processBattery3);
+    dispatcher.add(messageControls,&PowerManagementGui::processControls);
+    dispatcher.add(messageSwitches,&PowerManagementGui::processSwitches);
+    dispatcher.add(messageSwitchesTrack,&PowerManagementGui::processSwitches);
+    dispatcher.add(messageIndicators,&PowerManagementGui::processIndicators);
+    dispatcher.add(messageState1,&PowerManagementGui::processState1);
+    dispatcher.add(messageState2,&PowerManagementGui::processState2);
+    dispatcher.add(messageState3,&PowerManagementGui::processState3);
+    dispatcher.add(messageCharge1,&PowerManagementGui::processCharge1);
+    dispatcher.add(messageCharge2,&PowerManagementGui::processCharge2);
+    dispatcher.add(messageCharge3,&PowerManagementGui::processCharge3);
+    dispatcher.add(messageTemperature,&PowerManagementGui::processTemperature);
+    dispatcher.add(messageState1,&PowerManagementGui::forwardConfigure);
+    dispatcher.add(messageState2,&PowerManagementGui::forwardConfigure);
+    dispatcher.add(messageState3,&PowerManagementGui::forwardConfigure);
+    dispatcher.add(messageIdent,&PowerManagementGui::forwardConfigure);
+    dispatcher.add(messageControls,&PowerManagementGui::forwardConfigure);
+    dispatcher.addCategory(categoryFile,&PowerManagementGui::forwardRecord);
+    dispatcher.addCategory(categoryParameter,&PowerManagementGui::forwardConfigure);
+    dispatcher.addCategory(categoryDebug,&PowerManagementGui::processDebug);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Keep Communications Alive
+
+When the time field is received, send back a short message to keep comms
+alive. Also check for calibration as time messages stop during this process.
+*/
+
+void PowerManagementGui::processTime(const Message& message)
+{
+    Q_UNUSED(message);
+    if (socket != NULL) socket->write("pc+\n\r");
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Load 1 Current and Voltage
+*/
+
+void PowerManagementGui::processLoad1(const Message& message)
+{
+    int size = message.size;
     QString current, voltage;
-    if (! saveFile.isEmpty()) saveLine(response);
-/* When the time field is received, send back a short message to keep comms
-alive. Also check for calibration as time messages stop during this process. */
-    if ((size > 0) && ((firstField == "pH") || (firstField == "pQ")))
-    {
-        socket->write("pc+\n\r");
-    }
-// Load 1 current/voltage values
-    if ((size > 0) && (firstField == "dL1"))
+    getCurrentVoltage(message,&current,&voltage);
+    if (PowerManagementMainUi.load1CheckBox->isChecked())
     {
-        getCurrentVoltage(breakdown,&current,&voltage);
-        if (PowerManagementMainUi.load1CheckBox->isChecked())
+        if (testIndicator(load1UnderVoltage) || testIndicator(load1OverCurrent))
         {
-            if (testIndicator(load1UnderVoltage) || testIndicator(load1OverCurrent))
-            {
-                PowerManagementMainUi.load1Current->setText(QString("---"));
-                PowerManagementMainUi.load1Voltage->setText(QString("---"));
-            }
-            else
-            {
-                if (size > 1)
-                    PowerManagementMainUi.load1Current->setText(current);
-                if (size > 2)
-                    PowerManagementMainUi.load1Voltage->setText(voltage);
-            }
+            display.setText(PowerManagementMainUi.load1Current,QString("---"));
+            display.setText(PowerManagementMainUi.load1Voltage,QString("---"));
         }
         else
         {
-            PowerManagementMainUi.load1Current->clear();
-            PowerManagementMainUi.load1Voltage->clear();
+            if (size > 1)
+                display.setText(PowerManagementMainUi.load1Current,current);
+            if (size > 2)
+                display.setText(PowerManagementMainUi.load1Voltage,voltage);
         }
     }
-// Load 2 current/voltage values
-    if ((size > 0) && (firstField == "dL2"))
+    else
     {
-        getCurrentVoltage(breakdown,&current,&voltage);
-        if (PowerManagementMainUi.load2CheckBox->isChecked())
+        display.clear(PowerManagementMainUi.load1Current);
+        display.clear(PowerManagementMainUi.load1Voltage);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Load 2 Current and Voltage
+*/
+
+void PowerManagementGui::processLoad2(const Message& message)
+{
+    int size = message.size;
+    QString current, voltage;
+    getCurrentVoltage(message,&current,&voltage);
+    if (PowerManagementMainUi.load2CheckBox->isChecked())
+    {
+        if (testIndicator(load2UnderVoltage) || testIndicator(load2OverCurrent))
         {
-            if (testIndicator(load2UnderVoltage) || testIndicator(load2OverCurrent))
-            {
-                PowerManagementMainUi.load2Current->setText(QString("---"));
-                PowerManagementMainUi.load2Voltage->setText(QString("---"));
-            }
-            else
-            {
-                if (size > 1)
-                    PowerManagementMainUi.load2Current->setText(current);
-                if (size > 2)
-                    PowerManagementMainUi.load2Voltage->setText(voltage);
-            }
+            display.setText(PowerManagementMainUi.load2Current,QString("---"));
+            display.setText(PowerManagementMainUi.load2Voltage,QString("---"));
         }
         else
         {
-            PowerManagementMainUi.load2Current->clear();
-            PowerManagementMainUi.load2Voltage->clear();
+            if (size > 1)
+                display.setText(PowerManagementMainUi.load2Current,current);
+            if (size > 2)
+                display.setText(PowerManagementMainUi.load2Voltage,voltage);
         }
     }
-// Panel current/voltage values
-    if ((size > 0) && (firstField == "dM1"))
+    else
+    {
+        display.clear(PowerManagementMainUi.load2Current);
+        display.clear(PowerManagementMainUi.load2Voltage);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Panel Current and Voltage
+*/
+
+void PowerManagementGui::processPanel(const Message& message)
+{
+    int size = message.size;
+    QString current, voltage;
+    getCurrentVoltage(message,&current,&voltage);
+    if (PowerManagementMainUi.panelCheckBox->isChecked())
     {
-        getCurrentVoltage(breakdown,&current,&voltage);
-        if (PowerManagementMainUi.panelCheckBox->isChecked())
+        if (testIndicator(panelUnderVoltage) || testIndicator(panelOverCurrent))
         {
-            if (testIndicator(panelUnderVoltage) || testIndicator(panelOverCurrent))
-            {
-                PowerManagementMainUi.panelCurrent->setText(QString("---"));
-                PowerManagementMainUi.panelVoltage->setText(QString("---"));
-            }
-            else
-            {
-                if (size > 1)
-                    PowerManagementMainUi.panelCurrent->setText(current);
-                if (size > 2)
-                    PowerManagementMainUi.panelVoltage->setText(voltage);
-            }
+            display.setText(PowerManagementMainUi.panelCurrent,QString("---"));
+            display.setText(PowerManagementMainUi.panelVoltage,QString("---"));
         }
         else
         {
-            PowerManagementMainUi.panelCurrent->clear();
-            PowerManagementMainUi.panelVoltage->clear();
+            if (size > 1)
+                display.setText(PowerManagementMainUi.panelCurrent,current);
+            if (size > 2)
+                display.setText(PowerManagementMainUi.panelVoltage,voltage);
         }
     }
-// Battery 1 current/voltage values
-    if ((size > 0) && (firstField == "dB1"))
+    else
     {
-        getCurrentVoltage(breakdown,&current,&voltage);
-        if (PowerManagementMainUi.battery1CheckBox->isChecked())
+        display.clear(PowerManagementMainUi.panelCurrent);
+        display.clear(PowerManagementMainUi.panelVoltage);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Battery 1 Current and Voltage
+*/
+
+void PowerManagementGui::processBattery1(const Message& message)
+{
+    int size = message.size;
+    QString current, voltage;
+    getCurrentVoltage(message,&current,&voltage);
+    if (PowerManagementMainUi.battery1CheckBox->isChecked())
+    {
+        if (testIndicator(battery1UnderVoltage) || testIndicator(battery1OverCurrent))
         {
-            if (testIndicator(battery1UnderVoltage) || testIndicator(battery1OverCurrent))
-            {
-                PowerManagementMainUi.battery1Current->setText(QString("---"));
-                PowerManagementMainUi.battery1Voltage->setText(QString("---"));
-            }
-            else
-            {
-                if (size > 1)
-                    PowerManagementMainUi.battery1Current->setText(current);
-                if (size > 2)
-                    PowerManagementMainUi.battery1Voltage->setText(voltage);
-            }
+            display.setText(PowerManagementMainUi.battery1Current,QString("---"));
+            display.setText(PowerManagementMainUi.battery1Voltage,QString("---"));
         }
         else
         {
-            PowerManagementMainUi.battery1Current->clear();
-            PowerManagementMainUi.battery1Voltage->clear();
+            if (size > 1)
+                display.setText(PowerManagementMainUi.battery1Current,current);
+            if (size > 2)
+                display.setText(PowerManagementMainUi.battery1Voltage,voltage);
         }
     }
-// Battery 2 current/voltage values
-    if ((size > 0) && (firstField == "dB2"))
+    else
     {
-        getCurrentVoltage(breakdown,&current,&voltage);
-        if (PowerManagementMainUi.battery2CheckBox->isChecked())
+        display.clear(PowerManagementMainUi.battery1Current);
+        display.clear(PowerManagementMainUi.battery1Voltage);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Battery 2 Current and Voltage
+*/
+
+void PowerManagementGui::processBattery2(const Message& message)
+{
+    int size = message.size;
+    QString current, voltage;
+    getCurrentVoltage(message,&current,&voltage);
+    if (PowerManagementMainUi.battery2CheckBox->isChecked())
+    {
+        if (testIndicator(battery2UnderVoltage) || testIndicator(battery2OverCurrent))
         {
-            if (testIndicator(battery2UnderVoltage) || testIndicator(battery2OverCurrent))
-            {
-                PowerManagementMainUi.battery2Current->setText(QString("---"));
-                PowerManagementMainUi.battery2Voltage->setText(QString("---"));
-            }
-            else
-            {
-                if (size > 1)
-                    PowerManagementMainUi.battery2Current->setText(current);
-                if (size > 2)
-                    PowerManagementMainUi.battery2Voltage->setText(voltage);
-            }
+            display.setText(PowerManagementMainUi.battery2Current,QString("---"));
+            display.setText(PowerManagementMainUi.battery2Voltage,QString("---"));
         }
         else
         {
-            PowerManagementMainUi.battery2Current->clear();
-            PowerManagementMainUi.battery2Voltage->clear();
+            if (size > 1)
+                display.setText(PowerManagementMainUi.battery2Current,current);
+            if (size > 2)
+                display.setText(PowerManagementMainUi.battery2Voltage,voltage);
         }
     }
-// Battery 3 current/voltage values
-    if ((size > 0) && (firstField == "dB3"))
+    else
     {
-        getCurrentVoltage(breakdown,&current,&voltage);
-        if (PowerManagementMainUi.battery3CheckBox->isChecked())
+        display.clear(PowerManagementMainUi.battery2Current);
+        display.clear(PowerManagementMainUi.battery2Voltage);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Battery 3 Current and Voltage
+*/
+
+void PowerManagementGui::processBattery3(const Message& message)
+{
+    int size = message.size;
+    QString current, voltage;
+    getCurrentVoltage(message,&current,&voltage);
+    if (PowerManagementMainUi.battery3CheckBox->isChecked())
+    {
+        if (testIndicator(battery3UnderVoltage) || testIndicator(battery3OverCurrent))
         {
-            if (testIndicator(battery3UnderVoltage) || testIndicator(battery3OverCurrent))
-            {
-                PowerManagementMainUi.battery3Current->setText(QString("---"));
-                PowerManagementMainUi.battery3Voltage->setText(QString("---"));
-            }
-            else
-            {
-                if (size > 1)
-                    PowerManagementMainUi.battery3Current->setText(current);
-                if (size > 2)
-                    PowerManagementMainUi.battery3Voltage->setText(voltage);
-            }
+            display.setText(PowerManagementMainUi.battery3Current,QString("---"));
+            display.setText(PowerManagementMainUi.battery3Voltage,QString("---"));
         }
         else
         {
-            PowerManagementMainUi.battery3Current->clear();
-            PowerManagementMainUi.battery3Voltage->clear();
+            if (size > 1)
+                display.setText(PowerManagementMainUi.battery3Current,current);
+            if (size > 2)
+                display.setText(PowerManagementMainUi.battery3Voltage,voltage);
         }
     }
-// Restore the current software settings.
-// Bit 0 = autotrack
-    if ((size > 0) && (firstField == "dD"))
-    {
-        bool autoTrackOn = ((secondField.toInt() & 0x01) > 0);
-        PowerManagementMainUi.autoTrackCheckBox->setChecked(autoTrackOn);
-        disableRadioButtons(autoTrackOn);
-    }
-// Read all the microcontroller's switch settings and set display accordingly
-// Upper case S is used for initialization and after calibration.
-// Disable unused batteries and associated buttons, and set checkboxes.
-// Lower case s is used for autotrack to allow switch settings to be observed.
-// In that case the original settings of the checkboxes are preserved.
-    if ((size > 0) && ((firstField == "dS") || (firstField == "ds")))
-    {
-        unsigned int settings = secondField.toInt();
-        unsigned int load1Setting = (settings & 0x03);
-        unsigned int load2Setting = ((settings >> 2) & 0x03);
-        unsigned int panelSetting = ((settings >> 4) & 0x03);
-        bool battery1Enabled = ((load1Setting == 1) || (load2Setting == 1)\
-                                       || (panelSetting == 1));
-        bool battery2Enabled = ((load1Setting == 2) || (load2Setting == 2)\
-                                       || (panelSetting == 2));
-        bool battery3Enabled = ((load1Setting == 3) || (load2Setting == 3)\
-                                       || (panelSetting == 3));
+    else
+    {
+        display.clear(PowerManagementMainUi.battery3Current);
+        display.clear(PowerManagementMainUi.battery3Voltage);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Software Controls
+
+Restore the current software settings.
+Bit 0 = autotrack
+*/
+
+void PowerManagementGui::processControls(const Message& message)
+{
+    QString secondField;
+    if (message.size > 1) secondField = message.fields[1].simplified();
+    bool autoTrackOn = ((secondField.toInt() & 0x01) > 0);
+    PowerManagementMainUi.autoTrackCheckBox->setChecked(autoTrackOn);
+    disableRadioButtons(autoTrackOn);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Switch Settings
+
+Read all the microcontroller's switch settings and set display accordingly
+Upper case S is used for initialization and after calibration.
+Disable unused batteries and associated buttons, and set checkboxes.
+Lower case s is used for autotrack to allow switch settings to be observed.
+In that case the original settings of the checkboxes are preserved.
+*/
+
+void PowerManagementGui::processSwitches(const Message& message)
+{
+    QString secondField;
+    if (message.size > 1) secondField = message.fields[1].simplified();
+    unsigned int settings = secondField.toInt();
+    unsigned int load1Setting = (settings & 0x03);
+    unsigned int load2Setting = ((settings >> 2) & 0x03);
+    unsigned int panelSetting = ((settings >> 4) & 0x03);
+    bool battery1Enabled = ((load1Setting == 1) || (load2Setting == 1)\
+                                   || (panelSetting == 1));
+    bool battery2Enabled = ((load1Setting == 2) || (load2Setting == 2)\
+                                   || (panelSetting == 2));
+    bool battery3Enabled = ((load1Setting == 3) || (load2Setting == 3)\
+                                   || (panelSetting == 3));
 // Disable a battery if none of the load/panels are selected for it
-        if (firstField == "dS")
-        {
-            PowerManagementMainUi.battery1CheckBox->setChecked(battery1Enabled);
-            PowerManagementMainUi.battery2CheckBox->setChecked(battery2Enabled);
-            PowerManagementMainUi.battery3CheckBox->setChecked(battery3Enabled);
-            PowerManagementMainUi.load1Battery1->setEnabled(battery1Enabled);
-            PowerManagementMainUi.load1Battery2->setEnabled(battery2Enabled);
-            PowerManagementMainUi.load1Battery3->setEnabled(battery3Enabled);
-            PowerManagementMainUi.load2Battery1->setEnabled(battery1Enabled);
-            PowerManagementMainUi.load2Battery2->setEnabled(battery2Enabled);
-            PowerManagementMainUi.load2Battery3->setEnabled(battery3Enabled);
-            PowerManagementMainUi.panelBattery1->setEnabled(battery1Enabled);
-            PowerManagementMainUi.panelBattery2->setEnabled(battery2Enabled);
-            PowerManagementMainUi.panelBattery3->setEnabled(battery3Enabled);
-        }
+    if (message.id == messageSwitches)
+    {
+        PowerManagementMainUi.battery1CheckBox->setChecked(battery1Enabled);
+        PowerManagementMainUi.battery2CheckBox->setChecked(battery2Enabled);
+        PowerManagementMainUi.battery3CheckBox->setChecked(battery3Enabled);
+        PowerManagementMainUi.load1Battery1->setEnabled(battery1Enabled);
+        PowerManagementMainUi.load1Battery2->setEnabled(battery2Enabled);
+        PowerManagementMainUi.load1Battery3->setEnabled(battery3Enabled);
+        PowerManagementMainUi.load2Battery1->setEnabled(battery1Enabled);
+        PowerManagementMainUi.load2Battery2->setEnabled(battery2Enabled);
+        PowerManagementMainUi.load2Battery3->setEnabled(battery3Enabled);
+        PowerManagementMainUi.panelBattery1->setEnabled(battery1Enabled);
+        PowerManagementMainUi.panelBattery2->setEnabled(battery2Enabled);
+        PowerManagementMainUi.panelBattery3->setEnabled(battery3Enabled);
+    }
 // Set each of the switch settings
-        if (firstField == "dS")
-            PowerManagementMainUi.load1CheckBox->setChecked(true);
-        bool load1Battery1enabled = PowerManagementMainUi.load1Battery1->isEnabled();
-        bool load1Battery2enabled = PowerManagementMainUi.load1Battery2->isEnabled();
-        bool load1Battery3enabled = PowerManagementMainUi.load1Battery3->isEnabled();
-        PowerManagementMainUi.load1Battery1->setEnabled(true);
-        PowerManagementMainUi.load1Battery2->setEnabled(true);
-        PowerManagementMainUi.load1Battery3->setEnabled(true);
-        switch (load1Setting)
-        {
+    if (message.id == messageSwitches)
+        PowerManagementMainUi.load1CheckBox->setChecked(true);
+    bool load1Battery1enabled = PowerManagementMainUi.load1Battery1->isEnabled();
+    bool load1Battery2enabled = PowerManagementMainUi.load1Battery2->isEnabled();
+    bool load1Battery3enabled = PowerManagementMainUi.load1Battery3->isEnabled();
+    PowerManagementMainUi.load1Battery1->setEnabled(true);
+    PowerManagementMainUi.load1Battery2->setEnabled(true);
+    PowerManagementMainUi.load1Battery3->setEnabled(true);
+    switch (load1Setting)
+    {
 // No battery allocated to load 1
-            case 0:
-                PowerManagementMainUi.load1Battery1->setAutoExclusive(false);
-                PowerManagementMainUi.load1Battery1->setChecked(false);
-                PowerManagementMainUi.load1Battery1->setAutoExclusive(true);
-                PowerManagementMainUi.load1Battery2->setAutoExclusive(false);
-                PowerManagementMainUi.load1Battery2->setChecked(false);
-                PowerManagementMainUi.load1Battery2->setAutoExclusive(true);
-                PowerManagementMainUi.load1Battery3->setAutoExclusive(false);
-                PowerManagementMainUi.load1Battery3->setChecked(false);
-                PowerManagementMainUi.load1Battery3->setAutoExclusive(true);
-                break;
-            case 1:
-                PowerManagementMainUi.load1Battery1->setAutoExclusive(true);
-                PowerManagementMainUi.load1Battery1->setChecked(true);
-                break;            
-            case 2:
-                PowerManagementMainUi.load1Battery2->setAutoExclusive(true);
-                PowerManagementMainUi.load1Battery2->setChecked(true);
-                break;            
-            case 3:
-                PowerManagementMainUi.load1Battery3->setAutoExclusive(true);
-                PowerManagementMainUi.load1Battery3->setChecked(true);
-                break;
-            }
-        if (! load1Battery1enabled) PowerManagementMainUi.load1Battery1->setEnabled(false);
-        if (! load1Battery2enabled) PowerManagementMainUi.load1Battery2->setEnabled(false);
-        if (! load1Battery3enabled) PowerManagementMainUi.load1Battery3->setEnabled(false);
-
-        if (firstField == "dS")
-            PowerManagementMainUi.load2CheckBox->setChecked(true);
-        bool load2Battery1enabled = PowerManagementMainUi.load2Battery1->isEnabled();
-        bool load2Battery2enabled = PowerManagementMainUi.load2Battery2->isEnabled();
-        bool load2Battery3enabled = PowerManagementMainUi.load2Battery3->isEnabled();
-        PowerManagementMainUi.load2Battery1->setEnabled(true);
-        PowerManagementMainUi.load2Battery2->setEnabled(true);
-        PowerManagementMainUi.load2Battery3->setEnabled(true);
-        switch (load2Setting)
-            {
+        case 0:
+            PowerManagementMainUi.load1Battery1->setAutoExclusive(false);
+            PowerManagementMainUi.load1Battery1->setChecked(false);
+            PowerManagementMainUi.load1Battery1->setAutoExclusive(true);
+            PowerManagementMainUi.load1Battery2->setAutoExclusive(false);
+            PowerManagementMainUi.load1Battery2->setChecked(false);
+            PowerManagementMainUi.load1Battery2->setAutoExclusive(true);
+            PowerManagementMainUi.load1Battery3->setAutoExclusive(false);
+            PowerManagementMainUi.load1Battery3->setChecked(false);
+            PowerManagementMainUi.load1Battery3->setAutoExclusive(true);
+            break;
+        case 1:
+            PowerManagementMainUi.load1Battery1->setAutoExclusive(true);
+            PowerManagementMainUi.load1Battery1->setChecked(true);
+            break;            
+        case 2:
+            PowerManagementMainUi.load1Battery2->setAutoExclusive(true);
+            PowerManagementMainUi.load1Battery2->setChecked(true);
+            break;            
+        case 3:
+            PowerManagementMainUi.load1Battery3->setAutoExclusive(true);
+            PowerManagementMainUi.load1Battery3->setChecked(true);
+            break;
+        }
+    if (! load1Battery1enabled) PowerManagementMainUi.load1Battery1->setEnabled(false);
+    if (! load1Battery2enabled) PowerManagementMainUi.load1Battery2->setEnabled(false);
+    if (! load1Battery3enabled) PowerManagementMainUi.load1Battery3->setEnabled(false);
+
+    if (message.id == messageSwitches)
+        PowerManagementMainUi.load2CheckBox->setChecked(true);
+    bool load2Battery1enabled = PowerManagementMainUi.load2Battery1->isEnabled();
+    bool load2Battery2enabled = PowerManagementMainUi.load2Battery2->isEnabled();
+    bool load2Battery3enabled = PowerManagementMainUi.load2Battery3->isEnabled();
+    PowerManagementMainUi.load2Battery1->setEnabled(true);
+    PowerManagementMainUi.load2Battery2->setEnabled(true);
+    PowerManagementMainUi.load2Battery3->setEnabled(true);
+    switch (load2Setting)
+        {
 // No battery allocated to load 2
-            case 0:
-                PowerManagementMainUi.load2Battery1->setAutoExclusive(false);
-                PowerManagementMainUi.load2Battery1->setChecked(false);
-                PowerManagementMainUi.load2Battery1->setAutoExclusive(true);
-                PowerManagementMainUi.load2Battery2->setAutoExclusive(false);
-                PowerManagementMainUi.load2Battery2->setChecked(false);
-                PowerManagementMainUi.load2Battery2->setAutoExclusive(true);
-                PowerManagementMainUi.load2Battery3->setAutoExclusive(false);
-                PowerManagementMainUi.load2Battery3->setChecked(false);
-                PowerManagementMainUi.load2Battery3->setAutoExclusive(true);
-                break;
-            case 1:
-                PowerManagementMainUi.load2Battery1->setAutoExclusive(true);
-                PowerManagementMainUi.load2Battery1->setChecked(true);
-                break;            
-            case 2:
-                PowerManagementMainUi.load2Battery2->setAutoExclusive(true);
-                PowerManagementMainUi.load2Battery2->setChecked(true);
-                break;            
-            case 3:
-                PowerManagementMainUi.load2Battery3->setAutoExclusive(true);
-                PowerManagementMainUi.load2Battery3->setChecked(true);
-                break;
-            }
-        if (! load2Battery1enabled) PowerManagementMainUi.load2Battery1->setEnabled(false);
-        if (! load2Battery2enabled) PowerManagementMainUi.load2Battery2->setEnabled(false);
-        if (! load2Battery3enabled) PowerManagementMainUi.load2Battery3->setEnabled(false);
-
-        if (firstField == "dS")
-            PowerManagementMainUi.panelBattery1->setChecked(true);
-        bool panelBattery1enabled = PowerManagementMainUi.panelBattery1->isEnabled();
-        bool panelBattery2enabled = PowerManagementMainUi.panelBattery2->isEnabled();
-        bool panelBattery3enabled = PowerManagementMainUi.panelBattery3->isEnabled();
-        PowerManagementMainUi.panelBattery1->setEnabled(true);
-        PowerManagementMainUi.panelBattery2->setEnabled(true);
-        PowerManagementMainUi.panelBattery3->setEnabled(true);
-        switch (panelSetting)
-            {
+        case 0:
+            PowerManagementMainUi.load2Battery1->setAutoExclusive(false);
+            PowerManagementMainUi.load2Battery1->setChecked(false);
+            PowerManagementMainUi.load2Battery1->setAutoExclusive(true);
+            PowerManagementMainUi.load2Battery2->setAutoExclusive(false);
+            PowerManagementMainUi.load2Battery2->setChecked(false);
+            PowerManagementMainUi.load2Battery2->setAutoExclusive(true);
+            PowerManagementMainUi.load2Battery3->setAutoExclusive(false);
+            PowerManagementMainUi.load2Battery3->setChecked(false);
+            PowerManagementMainUi.load2Battery3->setAutoExclusive(true);
+            break;
+        case 1:
+            PowerManagementMainUi.load2Battery1->setAutoExclusive(true);
+            PowerManagementMainUi.load2Battery1->setChecked(true);
+            break;            
+        case 2:
+            PowerManagementMainUi.load2Battery2->setAutoExclusive(true);
+            PowerManagementMainUi.load2Battery2->setChecked(true);
+            break;            
+        case 3:
+            PowerManagementMainUi.load2Battery3->setAutoExclusive(true);
+            PowerManagementMainUi.load2Battery3->setChecked(true);
+            break;
+        }
+    if (! load2Battery1enabled) PowerManagementMainUi.load2Battery1->setEnabled(false);
+    if (! load2Battery2enabled) PowerManagementMainUi.load2Battery2->setEnabled(false);
+    if (! load2Battery3enabled) PowerManagementMainUi.load2Battery3->setEnabled(false);
+
+    if (message.id == messageSwitches)
+        PowerManagementMainUi.panelBattery1->setChecked(true);
+    bool panelBattery1enabled = PowerManagementMainUi.panelBattery1->isEnabled();
+    bool panelBattery2enabled = PowerManagementMainUi.panelBattery2->isEnabled();
+    bool panelBattery3enabled = PowerManagementMainUi.panelBattery3->isEnabled();
+    PowerManagementMainUi.panelBattery1->setEnabled(true);
+    PowerManagementMainUi.panelBattery2->setEnabled(true);
+    PowerManagementMainUi.panelBattery3->setEnabled(true);
+    switch (panelSetting)
+        {
 // No battery allocated to the panel
-            case 0:
-                PowerManagementMainUi.panelBattery1->setAutoExclusive(false);
-                PowerManagementMainUi.panelBattery1->setChecked(false);
-                PowerManagementMainUi.panelBattery1->setAutoExclusive(true);
-                PowerManagementMainUi.panelBattery2->setAutoExclusive(false);
-                PowerManagementMainUi.panelBattery2->setChecked(false);
-                PowerManagementMainUi.panelBattery2->setAutoExclusive(true);
-                PowerManagementMainUi.panelBattery3->setAutoExclusive(false);
-                PowerManagementMainUi.panelBattery3->setChecked(false);
-                PowerManagementMainUi.panelBattery3->setAutoExclusive(true);
-                break;
+        case 0:
+            PowerManagementMainUi.panelBattery1->setAutoExclusive(false);
+            PowerManagementMainUi.panelBattery1->setChecked(false);
+            PowerManagementMainUi.panelBattery1->setAutoExclusive(true);
+            PowerManagementMainUi.panelBattery2->setAutoExclusive(false);
+            PowerManagementMainUi.panelBattery2->setChecked(false);
+            PowerManagementMainUi.panelBattery2->setAutoExclusive(true);
+            PowerManagementMainUi.panelBattery3->setAutoExclusive(false);
+            PowerManagementMainUi.panelBattery3->setChecked(false);
+            PowerManagementMainUi.panelBattery3->setAutoExclusive(true);
+            break;
 // Battery x allocated to the panel
-            case 1:
-                PowerManagementMainUi.panelBattery1->setAutoExclusive(true);
-                PowerManagementMainUi.panelBattery1->setChecked(true);
-                break;            
-            case 2:
-                PowerManagementMainUi.panelBattery2->setAutoExclusive(true);
-                PowerManagementMainUi.panelBattery2->setChecked(true);
-                break;            
-            case 3:
-                PowerManagementMainUi.panelBattery3->setAutoExclusive(true);
-                PowerManagementMainUi.panelBattery3->setChecked(true);
-                break;
-        }
-        if (! panelBattery1enabled) PowerManagementMainUi.panelBattery1->setEnabled(false);
-        if (! panelBattery2enabled) PowerManagementMainUi.panelBattery2->setEnabled(false);
-        if (! panelBattery3enabled) PowerManagementMainUi.panelBattery3->setEnabled(false);
+        case 1:
+            PowerManagementMainUi.panelBattery1->setAutoExclusive(true);
+            PowerManagementMainUi.panelBattery1->setChecked(true);
+            break;            
+        case 2:
+            PowerManagementMainUi.panelBattery2->setAutoExclusive(true);
+            PowerManagementMainUi.panelBattery2->setChecked(true);
+            break;            
+        case 3:
+            PowerManagementMainUi.panelBattery3->setAutoExclusive(true);
+            PowerManagementMainUi.panelBattery3->setChecked(true);
+            break;
     }
-// Overload and undervoltage indicators from the I/Fs
-// Battery 1, Battery 2, Battery 3, Load 1, Load 2, Panel
-// ON is low.
-    if ((size > 0) && (firstField == "dI"))
+    if (! panelBattery1enabled) PowerManagementMainUi.panelBattery1->setEnabled(false);
+    if (! panelBattery2enabled) PowerManagementMainUi.panelBattery2->setEnabled(false);
+    if (! panelBattery3enabled) PowerManagementMainUi.panelBattery3->setEnabled(false);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Interface Indicators
+
+Overload and undervoltage indicators from the I/Fs
+Battery 1, Battery 2, Battery 3, Load 1, Load 2, Panel
+ON is low.
+*/
+
+void PowerManagementGui::processIndicators(const Message& message)
+{
+    QString secondField;
+    if (message.size > 1) secondField = message.fields[1].simplified();
+    indicators = secondField.toInt();
+    if (testIndicator(battery1OverCurrent))
     {
-        indicators = secondField.toInt();
-        if (testIndicator(battery1OverCurrent))
-        {
-            PowerManagementMainUi.battery1OverCurrent->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.battery1OverCurrent->
-                setText("OC");
-        }
-        else
-        {
-            PowerManagementMainUi.battery1OverCurrent->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery1OverCurrent->
-                setText("");
-        }
-        if (testIndicator(battery1UnderVoltage))
-        {
-            PowerManagementMainUi.battery1UnderVoltage->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.battery1UnderVoltage->
-                setText("UV");
-        }
-        else
-        {
-            PowerManagementMainUi.battery1UnderVoltage->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery1UnderVoltage->
-                setText("");
-        }
-        if (testIndicator(battery2OverCurrent))
-        {
-            PowerManagementMainUi.battery2OverCurrent->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.battery2OverCurrent->
-                setText("OC");
-        }
-        else
-        {
-            PowerManagementMainUi.battery2OverCurrent->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery2OverCurrent->
-                setText("");
-        }
-        if (testIndicator(battery2UnderVoltage))
-        {
-            PowerManagementMainUi.battery2UnderVoltage->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.battery2UnderVoltage->
-                setText("UV");
-        }
-        else
-        {
-            PowerManagementMainUi.battery2UnderVoltage->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery2UnderVoltage->
-                setText("");
-        }
-        if (testIndicator(battery3OverCurrent))
-        {
-            PowerManagementMainUi.battery3OverCurrent->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.battery3OverCurrent->
-                setText("OC");
-        }
-        else
-        {
-            PowerManagementMainUi.battery3OverCurrent->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery3OverCurrent->
-                setText("");
-        }
-        if (testIndicator(battery3UnderVoltage))
-        {
-            PowerManagementMainUi.battery3UnderVoltage->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.battery3UnderVoltage->
-                setText("UV");
-        }
-        else
-        {
-            PowerManagementMainUi.battery3UnderVoltage->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery3UnderVoltage->
-                setText("");
-        }
-        if (testIndicator(load1OverCurrent))
-        {
-            PowerManagementMainUi.load1OverCurrent->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.load1OverCurrent->
-                setText("OC");
-        }
-        else
-        {
-            PowerManagementMainUi.load1OverCurrent->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.load1OverCurrent->
-                setText("");
-        }
-        if (testIndicator(load1UnderVoltage))
-        {
-            PowerManagementMainUi.load1UnderVoltage->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.load1UnderVoltage->
-                setText("UV");
-        }
-        else
-        {
-            PowerManagementMainUi.load1UnderVoltage->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.load1UnderVoltage->
-                setText("");
-        }
-        if (testIndicator(load2OverCurrent))
-        {
-            PowerManagementMainUi.load2OverCurrent->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.load2OverCurrent->
-                setText("OC");
-        }
-        else
-        {
-            PowerManagementMainUi.load2OverCurrent->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.load2OverCurrent->
-                setText("");
-        }
-        if (testIndicator(load2UnderVoltage))
-        {
-            PowerManagementMainUi.load2UnderVoltage->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.load2UnderVoltage->
-                setText("UV");
-        }
-        else
-        {
-            PowerManagementMainUi.load2UnderVoltage->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.load2UnderVoltage->
-                setText("");
-        }
-        if (testIndicator(panelOverCurrent))
-        {
-            PowerManagementMainUi.panelOverCurrent->
-                setStyleSheet("color:white; background-color:red;");
-            PowerManagementMainUi.panelOverCurrent->
-                setText("OC");
-        }
-        else
-        {
-            PowerManagementMainUi.panelOverCurrent->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.panelOverCurrent->
-                setText("");
-        }
-        if (testIndicator(panelUnderVoltage))
-        {
-            PowerManagementMainUi.panelUnderVoltage->
-                setStyleSheet("color:white; color:white; background-color:red;");
-            PowerManagementMainUi.panelUnderVoltage->
-                setText("UV");
-        }
-        else
-        {
-            PowerManagementMainUi.panelUnderVoltage->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.panelUnderVoltage->
-                setText("");
-        }
+        display.setStyleSheet(PowerManagementMainUi.battery1OverCurrent,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.battery1OverCurrent,
+            "OC");
     }
-/* Battery 1 Fill, Health and Operational State Indicators */
-    if ((size > 0) && (firstField == "dO1"))
+    else
     {
-        int opState = secondField.toInt() & 0x03;
-        int fillState = (secondField.toInt() >> 2) & 0x03;
-        int chargingState = (secondField.toInt() >> 4) & 0x03;
-        int healthState = (secondField.toInt() >> 6) & 0x03;
-        if (fillState == 0)         // Normal
-        {
-            PowerManagementMainUi.battery1Fill->
-                setStyleSheet("background-color:lightgreen;");
-        }
-        else if (fillState == 1)    // Low
-        {
-            PowerManagementMainUi.battery1Fill->
-                setStyleSheet("background-color:yellow;");
-        }
-        else if (fillState == 2)    // Critical
-        {
-            PowerManagementMainUi.battery1Fill->
-                setStyleSheet("background-color:red;");
-        }
-        else if (fillState == 3)    // Faulty
-        {
-            PowerManagementMainUi.battery1Fill->
-                setStyleSheet("background-color:black;");
-        }
-        else                        // Invalid
-        {
-            PowerManagementMainUi.battery1Fill->
-                setStyleSheet("background-color:white;");
-        }
-        if (PowerManagementMainUi.autoTrackCheckBox->isChecked())
-        {
-            if (opState == 0)
-            {
-                PowerManagementMainUi.battery1Op->
-                    setText("L");
-            }
-            else if (opState == 1)
-            {
-                PowerManagementMainUi.battery1Op->
-                    setText("C");
-            }
-            else
-            {
-                PowerManagementMainUi.battery1Op->
-                    setText("I");
-            }
-        }
-        else
-        {
-            PowerManagementMainUi.battery1Op->
-                setText("");
-        }
-        if (chargingState == 0)
-        {
-            PowerManagementMainUi.battery1Charging->
-                setStyleSheet("background-color:orange;");
-            PowerManagementMainUi.battery1Charging->
-                setText("B");
-        }
-        else if (chargingState == 1)
-        {
-            PowerManagementMainUi.battery1Charging->
-                setStyleSheet("background-color:yellow;");
-            PowerManagementMainUi.battery1Charging->
-                setText("A");
-        }
-        else if (chargingState == 2)
-        {
-            PowerManagementMainUi.battery1Charging->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery1Charging->
-                setText("F");
-        }
-        else if (chargingState == 3)
-        {
-            PowerManagementMainUi.battery1Charging->
-                setStyleSheet("background-color:pink;");
-            PowerManagementMainUi.battery1Charging->
-                setText("R");
-        }
-        else if (chargingState == 4)
-        {
-            PowerManagementMainUi.battery1Charging->
-                setStyleSheet("background-color:lightblue;");
-            PowerManagementMainUi.battery1Charging->
-                setText("E");
-        }
-        else
-        {
-            PowerManagementMainUi.battery1Charging->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery1Charging->
-                setText(" ");
-        }
-        if (healthState == 0)
-        {
-            PowerManagementMainUi.battery1Health->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery1Health->
-                setText("");
-        }
-        else if (healthState == 1)
-        {
-            PowerManagementMainUi.battery1Health->
-                setStyleSheet("background-color:orange;");
-            PowerManagementMainUi.battery1Health->
-                setText("F");
-        }
-        else if (healthState == 3)
-        {
-            PowerManagementMainUi.battery1Health->
-                setStyleSheet("background-color:red;");
-            PowerManagementMainUi.battery1Health->
-                setText("F");
-        }
-        else if (healthState == 2)
-        {
-            PowerManagementMainUi.battery1Health->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery1Health->
-                setText("X");
-            PowerManagementMainUi.battery1Charging->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery1Charging->
-                setText("");
-            PowerManagementMainUi.battery1Fill->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery1Fill->
-                setText("");
-            PowerManagementMainUi.battery1Op->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery1Op->
-                setText("");
-            PowerManagementMainUi.battery1Charge->
-                setText(QString(""));
-            PowerManagementMainUi.battery1Current->setText(QString(""));
-            PowerManagementMainUi.battery1Voltage->setText(QString(""));
-        }
+        display.setStyleSheet(PowerManagementMainUi.battery1OverCurrent,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery1OverCurrent,
+            "");
     }
-/* Battery 2 Fill, Health and Operational State Indicators */
-    if ((size > 0) && (firstField == "dO2"))
+    if (testIndicator(battery1UnderVoltage))
     {
-        int opState = secondField.toInt() & 0x03;
-        int fillState = (secondField.toInt() >> 2) & 0x03;
-        int chargingState = (secondField.toInt() >> 4) & 0x03;
-        int healthState = (secondField.toInt() >> 6) & 0x03;
-        if (fillState == 0)         // Normal
-        {
-            PowerManagementMainUi.battery2Fill->
-                setStyleSheet("background-color:lightgreen;");
-        }
-        else if (fillState == 1)    // Low
-        {
-            PowerManagementMainUi.battery2Fill->
-                setStyleSheet("background-color:yellow;");
-        }
-        else if (fillState == 2)    // Critical
-        {
-            PowerManagementMainUi.battery2Fill->
-                setStyleSheet("background-color:red;");
-        }
-        else if (fillState == 3)    // Faulty
-        {
-            PowerManagementMainUi.battery2Fill->
-                setStyleSheet("background-color:black;");
-        }
-        else                        // Invalid
-        {
-            PowerManagementMainUi.battery2Fill->
-                setStyleSheet("background-color:white;");
-        }
-        if (PowerManagementMainUi.autoTrackCheckBox->isChecked())
-        {
-            if (opState == 0)
-            {
-                PowerManagementMainUi.battery2Op->
-                    setText("L");
-            }
-            else if (opState == 1)
-            {
-                PowerManagementMainUi.battery2Op->
-                    setText("C");
-            }
-            else
-            {
-                PowerManagementMainUi.battery2Op->
-                    setText("I");
-            }
-        }
-        else
-        {
-            PowerManagementMainUi.battery2Op->
-                setText("");
-        }
-        if (chargingState == 0)
-        {
-            PowerManagementMainUi.battery2Charging->
-                setStyleSheet("background-color:orange;");
-            PowerManagementMainUi.battery2Charging->
-                setText("B");
-        }
-        else if (chargingState == 1)
-        {
-            PowerManagementMainUi.battery2Charging->
-                setStyleSheet("background-color:yellow;");
-            PowerManagementMainUi.battery2Charging->
-                setText("A");
-        }
-        else if (chargingState == 2)
-        {
-            PowerManagementMainUi.battery2Charging->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery2Charging->
-                setText("F");
-        }
-        else if (chargingState == 3)
-        {
-            PowerManagementMainUi.battery2Charging->
-                setStyleSheet("background-color:pink;");
-            PowerManagementMainUi.battery2Charging->
-                setText("R");
-        }
-        else if (chargingState == 4)
-        {
-            PowerManagementMainUi.battery2Charging->
-                setStyleSheet("background-color:lightblue;");
-            PowerManagementMainUi.battery2Charging->
-                setText("E");
-        }
-        else
-        {
-            PowerManagementMainUi.battery2Charging->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery2Charging->
-                setText(" ");
-        }
-        if (healthState == 0)
+        display.setStyleSheet(PowerManagementMainUi.battery1UnderVoltage,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.battery1UnderVoltage,
+            "UV");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1UnderVoltage,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery1UnderVoltage,
+            "");
+    }
+    if (testIndicator(battery2OverCurrent))
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2OverCurrent,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.battery2OverCurrent,
+            "OC");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2OverCurrent,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery2OverCurrent,
+            "");
+    }
+    if (testIndicator(battery2UnderVoltage))
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2UnderVoltage,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.battery2UnderVoltage,
+            "UV");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2UnderVoltage,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery2UnderVoltage,
+            "");
+    }
+    if (testIndicator(battery3OverCurrent))
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3OverCurrent,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.battery3OverCurrent,
+            "OC");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3OverCurrent,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery3OverCurrent,
+            "");
+    }
+    if (testIndicator(battery3UnderVoltage))
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3UnderVoltage,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.battery3UnderVoltage,
+            "UV");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3UnderVoltage,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery3UnderVoltage,
+            "");
+    }
+    if (testIndicator(load1OverCurrent))
+    {
+        display.setStyleSheet(PowerManagementMainUi.load1OverCurrent,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.load1OverCurrent,
+            "OC");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.load1OverCurrent,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.load1OverCurrent,
+            "");
+    }
+    if (testIndicator(load1UnderVoltage))
+    {
+        display.setStyleSheet(PowerManagementMainUi.load1UnderVoltage,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.load1UnderVoltage,
+            "UV");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.load1UnderVoltage,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.load1UnderVoltage,
+            "");
+    }
+    if (testIndicator(load2OverCurrent))
+    {
+        display.setStyleSheet(PowerManagementMainUi.load2OverCurrent,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.load2OverCurrent,
+            "OC");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.load2OverCurrent,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.load2OverCurrent,
+            "");
+    }
+    if (testIndicator(load2UnderVoltage))
+    {
+        display.setStyleSheet(PowerManagementMainUi.load2UnderVoltage,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.load2UnderVoltage,
+            "UV");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.load2UnderVoltage,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.load2UnderVoltage,
+            "");
+    }
+    if (testIndicator(panelOverCurrent))
+    {
+        display.setStyleSheet(PowerManagementMainUi.panelOverCurrent,
+            "color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.panelOverCurrent,
+            "OC");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.panelOverCurrent,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.panelOverCurrent,
+            "");
+    }
+    if (testIndicator(panelUnderVoltage))
+    {
+        display.setStyleSheet(PowerManagementMainUi.panelUnderVoltage,
+            "color:white; color:white; background-color:red;");
+        display.setText(PowerManagementMainUi.panelUnderVoltage,
+            "UV");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.panelUnderVoltage,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.panelUnderVoltage,
+            "");
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Battery 1 Fill, Health and Operational State Indicators
+*/
+
+void PowerManagementGui::processState1(const Message& message)
+{
+    QString secondField;
+    if (message.size > 1) secondField = message.fields[1].simplified();
+    int opState = secondField.toInt() & 0x03;
+    int fillState = (secondField.toInt() >> 2) & 0x03;
+    int chargingState = (secondField.toInt() >> 4) & 0x03;
+    int healthState = (secondField.toInt() >> 6) & 0x03;
+    if (fillState == 0)         // Normal
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Fill,
+            "background-color:lightgreen;");
+    }
+    else if (fillState == 1)    // Low
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Fill,
+            "background-color:yellow;");
+    }
+    else if (fillState == 2)    // Critical
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Fill,
+            "background-color:red;");
+    }
+    else if (fillState == 3)    // Faulty
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Fill,
+            "background-color:black;");
+    }
+    else                        // Invalid
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Fill,
+            "background-color:white;");
+    }
+    if (PowerManagementMainUi.autoTrackCheckBox->isChecked())
+    {
+        if (opState == 0)
         {
-            PowerManagementMainUi.battery2Health->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery2Health->
-                setText("");
+            display.setText(PowerManagementMainUi.battery1Op,
+                "L");
         }
-        else if (healthState == 1)
+        else if (opState == 1)
         {
-            PowerManagementMainUi.battery2Health->
-                setStyleSheet("background-color:orange;");
-            PowerManagementMainUi.battery2Health->
-                setText("F");
+            display.setText(PowerManagementMainUi.battery1Op,
+                "C");
         }
         else
         {
-            PowerManagementMainUi.battery2Health->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery2Health->
-                setText("X");
-            PowerManagementMainUi.battery2Charging->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery2Charging->
-                setText("");
-            PowerManagementMainUi.battery2Fill->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery2Fill->
-                setText("");
-            PowerManagementMainUi.battery2Op->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery2Op->
-                setText("");
-            PowerManagementMainUi.battery2Charge->
-                setText(QString(""));
-            PowerManagementMainUi.battery2Current->setText(QString(""));
-            PowerManagementMainUi.battery2Voltage->setText(QString(""));
+            display.setText(PowerManagementMainUi.battery1Op,
+                "I");
         }
     }
-/* Battery 3 Fill, Health and Operational State Indicators */
-    if ((size > 0) && (firstField == "dO3"))
+    else
+    {
+        display.setText(PowerManagementMainUi.battery1Op,
+            "");
+    }
+    if (chargingState == 0)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Charging,
+            "background-color:orange;");
+        display.setText(PowerManagementMainUi.battery1Charging,
+            "B");
+    }
+    else if (chargingState == 1)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Charging,
+            "background-color:yellow;");
+        display.setText(PowerManagementMainUi.battery1Charging,
+            "A");
+    }
+    else if (chargingState == 2)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Charging,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery1Charging,
+            "F");
+    }
+    else if (chargingState == 3)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Charging,
+            "background-color:pink;");
+        display.setText(PowerManagementMainUi.battery1Charging,
+            "R");
+    }
+    else if (chargingState == 4)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Charging,
+            "background-color:lightblue;");
+        display.setText(PowerManagementMainUi.battery1Charging,
+            "E");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Charging,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery1Charging,
+            " ");
+    }
+    if (healthState == 0)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Health,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery1Health,
+            "");
+    }
+    else if (healthState == 1)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Health,
+            "background-color:orange;");
+        display.setText(PowerManagementMainUi.battery1Health,
+            "F");
+    }
+    else if (healthState == 3)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Health,
+            "background-color:red;");
+        display.setText(PowerManagementMainUi.battery1Health,
+            "F");
+    }
+    else if (healthState == 2)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery1Health,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery1Health,
+            "X");
+        display.setStyleSheet(PowerManagementMainUi.battery1Charging,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery1Charging,
+            "");
+        display.setStyleSheet(PowerManagementMainUi.battery1Fill,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery1Fill,
+            "");
+        display.setStyleSheet(PowerManagementMainUi.battery1Op,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery1Op,
+            "");
+        display.setText(PowerManagementMainUi.battery1Charge,
+            QString(""));
+        display.setText(PowerManagementMainUi.battery1Current,QString(""));
+        display.setText(PowerManagementMainUi.battery1Voltage,QString(""));
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Battery 2 Fill, Health and Operational State Indicators
+*/
+
+void PowerManagementGui::processState2(const Message& message)
+{
+    QString secondField;
+    if (message.size > 1) secondField = message.fields[1].simplified();
+    int opState = secondField.toInt() & 0x03;
+    int fillState = (secondField.toInt() >> 2) & 0x03;
+    int chargingState = (secondField.toInt() >> 4) & 0x03;
+    int healthState = (secondField.toInt() >> 6) & 0x03;
+    if (fillState == 0)         // Normal
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Fill,
+            "background-color:lightgreen;");
+    }
+    else if (fillState == 1)    // Low
     {
-        int opState = secondField.toInt() & 0x03;
-        int fillState = (secondField.toInt() >> 2) & 0x03;
-        int chargingState = (secondField.toInt() >> 4) & 0x03;
-        int healthState = (secondField.toInt() >> 6) & 0x03;
-        if (fillState == 0)         // Normal
-        {
-            PowerManagementMainUi.battery3Fill->
-                setStyleSheet("background-color:lightgreen;");
-        }
-        else if (fillState == 1)    // Low
-        {
-            PowerManagementMainUi.battery3Fill->
-                setStyleSheet("background-color:yellow;");
-        }
-        else if (fillState == 2)    // Critical
-        {
-            PowerManagementMainUi.battery3Fill->
-                setStyleSheet("background-color:red;");
-        }
-        else if (fillState == 3)    // Faulty
-        {
-            PowerManagementMainUi.battery3Fill->
-                setStyleSheet("background-color:black;");
-        }
-        else                        // Invalid
-        {
-            PowerManagementMainUi.battery3Fill->
-                setStyleSheet("background-color:white;");
-        }
-        if (PowerManagementMainUi.autoTrackCheckBox->isChecked())
-        {
-            if (opState == 0)
-            {
-                PowerManagementMainUi.battery3Op->
-                    setText("L");
-            }
-            else if (opState == 1)
-            {
-                PowerManagementMainUi.battery3Op->
-                    setText("C");
-            }
-            else
-            {
-                PowerManagementMainUi.battery3Op->
-                    setText("I");
-            }
-        }
-        else
-        {
-            PowerManagementMainUi.battery3Op->
-                setText("");
-        }
-        if (chargingState == 0)
-        {
-            PowerManagementMainUi.battery3Charging->
-                setStyleSheet("background-color:orange;");
-            PowerManagementMainUi.battery3Charging->
-                setText("B");
-        }
-        else if (chargingState == 1)
-        {
-            PowerManagementMainUi.battery3Charging->
-                setStyleSheet("background-color:yellow;");
-            PowerManagementMainUi.battery3Charging->
-                setText("A");
-        }
-        else if (chargingState == 2)
-        {
-            PowerManagementMainUi.battery3Charging->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery3Charging->
-                setText("F");
-        }
-        else if (chargingState == 3)
+        display.setStyleSheet(PowerManagementMainUi.battery2Fill,
+            "background-color:yellow;");
+    }
+    else if (fillState == 2)    // Critical
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Fill,
+            "background-color:red;");
+    }
+    else if (fillState == 3)    // Faulty
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Fill,
+            "background-color:black;");
+    }
+    else                        // Invalid
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Fill,
+            "background-color:white;");
+    }
+    if (PowerManagementMainUi.autoTrackCheckBox->isChecked())
+    {
+        if (opState == 0)
         {
-            PowerManagementMainUi.battery3Charging->
-                setStyleSheet("background-color:pink;");
-            PowerManagementMainUi.battery3Charging->
-                setText("R");
+            display.setText(PowerManagementMainUi.battery2Op,
+                "L");
         }
-        else if (chargingState == 4)
+        else if (opState == 1)
         {
-            PowerManagementMainUi.battery3Charging->
-                setStyleSheet("background-color:lightblue;");
-            PowerManagementMainUi.battery3Charging->
-                setText("E");
+            display.setText(PowerManagementMainUi.battery2Op,
+                "C");
         }
         else
         {
-            PowerManagementMainUi.battery3Charging->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery3Charging->
-                setText(" ");
+            display.setText(PowerManagementMainUi.battery2Op,
+                "I");
         }
-        if (healthState == 0)
+    }
+    else
+    {
+        display.setText(PowerManagementMainUi.battery2Op,
+            "");
+    }
+    if (chargingState == 0)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Charging,
+            "background-color:orange;");
+        display.setText(PowerManagementMainUi.battery2Charging,
+            "B");
+    }
+    else if (chargingState == 1)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Charging,
+            "background-color:yellow;");
+        display.setText(PowerManagementMainUi.battery2Charging,
+            "A");
+    }
+    else if (chargingState == 2)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Charging,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery2Charging,
+            "F");
+    }
+    else if (chargingState == 3)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Charging,
+            "background-color:pink;");
+        display.setText(PowerManagementMainUi.battery2Charging,
+            "R");
+    }
+    else if (chargingState == 4)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Charging,
+            "background-color:lightblue;");
+        display.setText(PowerManagementMainUi.battery2Charging,
+            "E");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Charging,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery2Charging,
+            " ");
+    }
+    if (healthState == 0)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Health,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery2Health,
+            "");
+    }
+    else if (healthState == 1)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Health,
+            "background-color:orange;");
+        display.setText(PowerManagementMainUi.battery2Health,
+            "F");
+    }
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery2Health,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery2Health,
+            "X");
+        display.setStyleSheet(PowerManagementMainUi.battery2Charging,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery2Charging,
+            "");
+        display.setStyleSheet(PowerManagementMainUi.battery2Fill,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery2Fill,
+            "");
+        display.setStyleSheet(PowerManagementMainUi.battery2Op,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery2Op,
+            "");
+        display.setText(PowerManagementMainUi.battery2Charge,
+            QString(""));
+        display.setText(PowerManagementMainUi.battery2Current,QString(""));
+        display.setText(PowerManagementMainUi.battery2Voltage,QString(""));
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Battery 3 Fill, Health and Operational State Indicators
+*/
+
+void PowerManagementGui::processState3(const Message& message)
+{
+    QString secondField;
+    if (message.size > 1) secondField = message.fields[1].simplified();
+    int opState = secondField.toInt() & 0x03;
+    int fillState = (secondField.toInt() >> 2) & 0x03;
+    int chargingState = (secondField.toInt() >> 4) & 0x03;
+    int healthState = (secondField.toInt() >> 6) & 0x03;
+    if (fillState == 0)         // Normal
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3Fill,
+            "background-color:lightgreen;");
+    }
+    else if (fillState == 1)    // Low
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3Fill,
+            "background-color:yellow;");
+    }
+    else if (fillState == 2)    // Critical
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3Fill,
+            "background-color:red;");
+    }
+    else if (fillState == 3)    // Faulty
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3Fill,
+            "background-color:black;");
+    }
+    else                        // Invalid
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3Fill,
+            "background-color:white;");
+    }
+    if (PowerManagementMainUi.autoTrackCheckBox->isChecked())
+    {
+        if (opState == 0)
         {
-            PowerManagementMainUi.battery3Health->
-                setStyleSheet("background-color:lightgreen;");
-            PowerManagementMainUi.battery3Health->
-                setText("");
+            display.setText(PowerManagementMainUi.battery3Op,
+                "L");
         }
-        else if (healthState == 1)
+        else if (opState == 1)
         {
-            PowerManagementMainUi.battery3Health->
-                setStyleSheet("background-color:orange;");
-            PowerManagementMainUi.battery3Health->
-                setText("F");
+            display.setText(PowerManagementMainUi.battery3Op,
+                "C");
         }
         else
         {
-            PowerManagementMainUi.battery3Health->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery3Health->
-                setText("X");
-            PowerManagementMainUi.battery3Charging->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery3Charging->
-                setText("");
-            PowerManagementMainUi.battery3Fill->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery3Fill->
-                setText("");
-            PowerManagementMainUi.battery3Op->
-                setStyleSheet("background-color:white;");
-            PowerManagementMainUi.battery3Op->
-                setText("");
-            PowerManagementMainUi.battery3Charge->
-                setText(QString(""));
-            PowerManagementMainUi.battery3Current->setText(QString(""));
-            PowerManagementMainUi.battery3Voltage->setText(QString(""));
+            display.setText(PowerManagementMainUi.battery3Op,
+                "I");
         }
     }
-/* SoC estimates */
-    if ((size > 0) && (firstField == "dC1"))
+    else
     {
-        if (PowerManagementMainUi.battery1CheckBox->isChecked())
-        {
-            if (size > 1) PowerManagementMainUi.battery1Charge
-                ->setText(QString("%1").arg(secondField
-                        .toFloat()/256,0,'f',0).append('%'));
-        }
-        else
-        {
-            PowerManagementMainUi.battery1Charge->clear();
-        }
+        display.setText(PowerManagementMainUi.battery3Op,
+            "");
     }
-    if ((size > 0) && (firstField == "dC2"))
+    if (chargingState == 0)
     {
-        if (PowerManagementMainUi.battery2CheckBox->isChecked())
-        {
-            if (size > 1) PowerManagementMainUi.battery2Charge
-                ->setText(QString("%1").arg(secondField
-                        .toFloat()/256,0,'f',0).append('%'));
-        }
-        else
-        {
-            PowerManagementMainUi.battery2Charge->clear();
-        }
+        display.setStyleSheet(PowerManagementMainUi.battery3Charging,
+            "background-color:orange;");
+        display.setText(PowerManagementMainUi.battery3Charging,
+            "B");
     }
-    if ((size > 0) && (firstField == "dC3"))
+    else if (chargingState == 1)
     {
-        if (PowerManagementMainUi.battery3CheckBox->isChecked())
-        {
-            if (size > 1) PowerManagementMainUi.battery3Charge
-                ->setText(QString("%1").arg(secondField
-                        .toFloat()/256,0,'f',0).append('%'));
-        }
-        else
-        {
-            PowerManagementMainUi.battery3Charge->clear();
-        }
+        display.setStyleSheet(PowerManagementMainUi.battery3Charging,
+            "background-color:yellow;");
+        display.setText(PowerManagementMainUi.battery3Charging,
+            "A");
+    }
+    else if (chargingState == 2)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3Charging,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery3Charging,
+            "F");
     }
-    if ((size > 0) && (firstField == "dT"))
+    else if (chargingState == 3)
     {
-        if (size > 1) PowerManagementMainUi.temperature
-            ->setText(QString("%1").arg(secondField
-                .toFloat()/256,0,'f',1).append(QChar(0x00B0)).append("C"));
+        display.setStyleSheet(PowerManagementMainUi.battery3Charging,
+            "background-color:pink;");
+        display.setText(PowerManagementMainUi.battery3Charging,
+            "R");
     }
-/* Messages for the File Task start with f */
-    if ((size > 0) && (firstField.left(1) == "f"))
+    else if (chargingState == 4)
     {
-        emit this->recordMessageReceived(response);
+        display.setStyleSheet(PowerManagementMainUi.battery3Charging,
+            "background-color:lightblue;");
+        display.setText(PowerManagementMainUi.battery3Charging,
+            "E");
     }
-/* Messages for the Configure Task start with p or certain of the data responses */
-    if ((size > 0) && ((firstField.left(1) == "p") || (firstField.left(2) == "dO")
-                                                   || (firstField.left(2) == "dE")
-                                                   || (firstField.left(2) == "dD")))
+    else
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3Charging,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery3Charging,
+            " ");
+    }
+    if (healthState == 0)
+    {
+        display.setStyleSheet(PowerManagementMainUi.battery3Health,
+            "background-color:lightgreen;");
+        display.setText(PowerManagementMainUi.battery3Health,
+            "");
+    }
+    else if (healthState == 1)
     {
-        emit this->configureMessageReceived(response);
+        display.setStyleSheet(PowerManagementMainUi.battery3Health,
+            "background-color:orange;");
+        display.setText(PowerManagementMainUi.battery3Health,
+            "F");
     }
-/* This allows debug messages to be displayed on the terminal. */
-    if ((size > 0) && (firstField.left(1) == "D"))
+    else
     {
-        qDebug() << response;
-        if (! saveFile.isEmpty()) saveLine(response);
+        display.setStyleSheet(PowerManagementMainUi.battery3Health,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery3Health,
+            "X");
+        display.setStyleSheet(PowerManagementMainUi.battery3Charging,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery3Charging,
+            "");
+        display.setStyleSheet(PowerManagementMainUi.battery3Fill,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery3Fill,
+            "");
+        display.setStyleSheet(PowerManagementMainUi.battery3Op,
+            "background-color:white;");
+        display.setText(PowerManagementMainUi.battery3Op,
+            "");
+        display.setText(PowerManagementMainUi.battery3Charge,
+            QString(""));
+        display.setText(PowerManagementMainUi.battery3Current,QString(""));
+        display.setText(PowerManagementMainUi.battery3Voltage,QString(""));
     }
 }
 
 //-----------------------------------------------------------------------------
-/** @brief Convert Voltage and Current Strings for Display
+/** @brief Battery 1 SoC Estimate
+*/
 
-The current and voltage values are obtained from the command string breakdown
-converted to a QString form suitable for display. The breakdown is
-0 - command, 1 - current, 2- voltage.
+void PowerManagementGui::processCharge1(const Message& message)
+{
+    int size = message.size;
+    QString secondField;
+    if (size > 1) secondField = message.fields[1].simplified();
+    if (PowerManagementMainUi.battery1CheckBox->isChecked())
+    {
+        if (size > 1) display.setText(PowerManagementMainUi.battery1Charge,
+            QString("%1").arg(secondField
+                    .toFloat()/256,0,'f',0).append('%'));
+    }
+    else
+    {
+        display.clear(PowerManagementMainUi.battery1Charge);
+    }
+}
 
-An entry is saved in the save file if it is open.
-The entry is sent to the monitor window.
+//-----------------------------------------------------------------------------
+/** @brief Battery 2 SoC Estimate
 */
 
-void PowerManagementGui::getCurrentVoltage(const QStringList breakdown,
-                                           QString* sCurrent, QString* sVoltage)
+void PowerManagementGui::processCharge2(const Message& message)
+{
+    int size = message.size;
+    QString secondField;
+    if (size > 1) secondField = message.fields[1].simplified();
+    if (PowerManagementMainUi.battery2CheckBox->isChecked())
+    {
+        if (size > 1) display.setText(PowerManagementMainUi.battery2Charge,
+            QString("%1").arg(secondField
+                    .toFloat()/256,0,'f',0).append('%'));
+    }
+    else
+    {
+        display.clear(PowerManagementMainUi.battery2Charge);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Battery 3 SoC Estimate
+*/
+
+void PowerManagementGui::processCharge3(const Message& message)
 {
-    int size = breakdown.size();
-    QString entry = breakdown[0].simplified();
-    if (size > 1)
+    int size = message.size;
+    QString secondField;
+    if (size > 1) secondField = message.fields[1].simplified();
+    if (PowerManagementMainUi.battery3CheckBox->isChecked())
     {
-        float fCurrent = breakdown[1].simplified().toFloat()/256;
-        *sCurrent = QString("%1").arg(fCurrent,0,'f',2);
-        entry = entry.append(",").append(*sCurrent);
+        if (size > 1) display.setText(PowerManagementMainUi.battery3Charge,
+            QString("%1").arg(secondField
+                    .toFloat()/256,0,'f',0).append('%'));
     }
-    if (size > 2)
+    else
     {
-        float fVoltage = breakdown[2].simplified().toFloat()/256;
-        *sVoltage = QString("%1").arg(fVoltage,0,'f',2);
-        entry = entry.append(",").append(*sVoltage);
+        display.clear(PowerManagementMainUi.battery3Charge);
     }
-    emit this->monitorMessageReceived(entry);
-//    if (! saveFile.isEmpty()) saveLine(entry);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Temperature
+*/
+
+void PowerManagementGui::processTemperature(const Message& message)
+{
+    int size = message.size;
+    QString secondField;
+    if (size > 1) secondField = message.fields[1].simplified();
+    if (size > 1) display.setText(PowerManagementMainUi.temperature,
+        QString("%1").arg(secondField
+            .toFloat()/256,0,'f',1).append(QChar(0x00B0)).append("C"));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Pass File Messages to the Recording Window
+*/
+
+void PowerManagementGui::forwardRecord(const Message& message)
+{
+    emit this->recordMessageReceived(message);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Pass Messages to the Configure Window
+
+Messages for the Configure Task start with p or certain of the data responses
+*/
+
+void PowerManagementGui::forwardConfigure(const Message& message)
+{
+    emit this->configureMessageReceived(message);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Debug Messages
+
+This allows debug messages to be displayed on the terminal.
+*/
+
+void PowerManagementGui::processDebug(const Message& message)
+{
+    qDebug() << message.line;
+    if (! saveFile.isEmpty()) saveLine(message);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Convert Voltage and Current Strings for Display
+
+The current and voltage values are obtained from the decoded message and
+converted to a QString form suitable for display. The fields are
+0 - command, 1 - current, 2- voltage.
+
+The values are entered into the monitor history, and the message is sent
+unchanged to the monitor window, which uses the values at full precision.
+*/
+
+void PowerManagementGui::getCurrentVoltage(const Message& message,
+                                           QString* sCurrent, QString* sVoltage)
+{
+    if (message.size > 1)
+        *sCurrent = QString("%1").arg((float)message.value[1]/256,0,'f',2);
+    if (message.size > 2)
+        *sVoltage = QString("%1").arg((float)message.value[2]/256,0,'f',2);
+    history.collect(message);
+    emit this->monitorMessageReceived(message);
 }
 //-----------------------------------------------------------------------------
 /** @brief Test indicators on the Interface Cards.
@@ -1675,7 +1817,8 @@ void PowerManagementGui::on_battery3SoCReset_clicked()
 /** @brief Obtain a save file name and path and attempt to open it.
 
 The files are csv but the ending can be arbitrary to allow compatibility
-with the data processing application.
+with the data processing application. A file ending in SESSION_SUFFIX is saved
+as a session, which keeps the commands sent with times for replay.
 */
 
 void PowerManagementGui::on_saveFileButton_clicked()
@@ -1690,16 +1833,19 @@ void PowerManagementGui::on_saveFileButton_clicked()
     QString filename = QFileDialog::getSaveFileName(this,
                         "Acquisition Save Acquired Data",
                         QString(),
-                        "Comma Separated Variables (*.csv *.txt)");
+                        QString("Comma Separated Variables (*.csv *.txt);;"
+                                "Sessions (*%1)").arg(SESSION_SUFFIX));
     if (filename.isEmpty()) return;
 //    if (! filename.endsWith(".csv")) filename.append(".csv");
     QFileInfo fileInfo(filename);
     saveDirectory = fileInfo.absolutePath();
     saveFile = saveDirectory.filePath(filename);
-    outFile = new QFile(saveFile);             // Open file for output
-    if (! outFile->open(QIODevice::WriteOnly))
+    capture.setFormat(filename.endsWith(SESSION_SUFFIX) ? captureSession
+                                                        : captureText);
+    if (! capture.open(saveFile))              // Open file for output
     {
         displayErrorMessage("Could not open the output file");
+        saveFile.clear();
         return;
     }
 }
@@ -1707,8 +1853,10 @@ void PowerManagementGui::on_saveFileButton_clicked()
 //-----------------------------------------------------------------------------
 /** @brief Save a line to the opened save file.
 
+The line is queued to the capture writer thread along with the time it was
+received.
 */
-void PowerManagementGui::saveLine(QString line)
+void PowerManagementGui::saveLine(const Message& message)
 {
 //! Check that the save file has been defined and is open.
     if (saveFile.isEmpty())
@@ -1716,18 +1864,18 @@ void PowerManagementGui::saveLine(QString line)
         displayErrorMessage("Output File not defined");
         return;
     }
-    if (! outFile->isOpen())
+    if (! capture.isOpen())
     {
         displayErrorMessage("Output File not open");
         return;
     }
-    QTextStream out(outFile);
-    out << line << "\r\n";
+    capture.writeLine(message.line, message.time, message.stamp);
 }
 
 //-----------------------------------------------------------------------------
 /** @brief Close the save file.
 
+The number of lines saved and the performance of the writer are shown.
 */
 void PowerManagementGui::on_closeFileButton_clicked()
 {
@@ -1736,10 +1884,15 @@ void PowerManagementGui::on_closeFileButton_clicked()
         displayErrorMessage("File already closed");
     else
     {
-        outFile->close();
-        delete outFile;
+        capture.close();
 //! Save the name to prevent the same file being used.
         saveFile = QString();
+        QMessageBox::information(this, "Save file closed",
+                                 QString("Saved %1 lines, queue peak %2, "
+                                         "slowest write %3ms")
+                                 .arg(capture.linesWritten())
+                                 .arg(capture.maxQueueDepth())
+                                 .arg((float)capture.maxLatency()/1000,0,'f',1));
     }
 }
 //-----------------------------------------------------------------------------
@@ -1752,8 +1905,8 @@ void PowerManagementGui::on_recordingButton_clicked()
     PowerManagementRecordGui* powerManagementRecordForm =
                     new PowerManagementRecordGui(socket,this);
     powerManagementRecordForm->setAttribute(Qt::WA_DeleteOnClose);
-    connect(this, SIGNAL(recordMessageReceived(const QString&)),
-                    powerManagementRecordForm, SLOT(onMessageReceived(const QString&)));
+    connect(this, SIGNAL(recordMessageReceived(const Message&)),
+                    powerManagementRecordForm, SLOT(onMessageReceived(const Message&)));
     powerManagementRecordForm->exec();
 }
 
@@ -1767,10 +1920,10 @@ placed to the background.
 void PowerManagementGui::on_monitorButton_clicked()
 {
     PowerManagementMonitorGui* powerManagementMonitorForm =
-                    new PowerManagementMonitorGui(socket,NULL);   
+                    new PowerManagementMonitorGui(socket,&history,NULL);
     powerManagementMonitorForm->setAttribute(Qt::WA_DeleteOnClose);
-    connect(this, SIGNAL(monitorMessageReceived(const QString&)),
-                  powerManagementMonitorForm, SLOT(onMessageReceived(const QString&)));
+    connect(this, SIGNAL(monitorMessageReceived(const Message&)),
+                  powerManagementMonitorForm, SLOT(onMessageReceived(const Message&)));
     powerManagementMonitorForm->setModal(false);
     powerManagementMonitorForm->show();
 }
@@ -1785,11 +1938,74 @@ void PowerManagementGui::on_configureButton_clicked()
     PowerManagementConfigGui* powerManagementConfigForm =
                     new PowerManagementConfigGui(socket,this);
     powerManagementConfigForm->setAttribute(Qt::WA_DeleteOnClose);
-    connect(this, SIGNAL(configureMessageReceived(const QString&)),
-                    powerManagementConfigForm, SLOT(onMessageReceived(const QString&)));
+    connect(this, SIGNAL(configureMessageReceived(const Message&)),
+                    powerManagementConfigForm, SLOT(onMessageReceived(const Message&)));
     powerManagementConfigForm->exec();
 }
 
+//-----------------------------------------------------------------------------
+/** @brief Call up the Link Diagnostics Window.
+
+The baud rate selected is given so that the use of the serial line can be
+shown also when it is reached through TCP.
+*/
+
+void PowerManagementGui::on_diagnosticsButton_clicked()
+{
+    PowerManagementDiagnosticsGui* powerManagementDiagnosticsForm =
+                    new PowerManagementDiagnosticsGui(socket,&capture,
+                                                      bauds[baudrate],NULL);
+    powerManagementDiagnosticsForm->setAttribute(Qt::WA_DeleteOnClose);
+    powerManagementDiagnosticsForm->setModal(false);
+    powerManagementDiagnosticsForm->show();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Call up the Session Replay Window.
+
+Replay is only allowed while disconnected, so that replayed and live messages
+are not mixed. Commands from the windows are then not sent anywhere.
+*/
+
+void PowerManagementGui::on_replayButton_clicked()
+{
+    if (socket != NULL)
+    {
+        displayErrorMessage("Disconnect before replaying a session");
+        return;
+    }
+    PowerManagementReplayGui* powerManagementReplayForm =
+                    new PowerManagementReplayGui(NULL);
+    powerManagementReplayForm->setAttribute(Qt::WA_DeleteOnClose);
+    connect(powerManagementReplayForm, SIGNAL(messageReplayed(const Message&)),
+            this, SLOT(onReplayMessage(const Message&)));
+    connect(powerManagementReplayForm, SIGNAL(replayRestarted()),
+            this, SLOT(onReplayRestarted()));
+    powerManagementReplayForm->setModal(false);
+    powerManagementReplayForm->show();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Handle a replayed message as one received, unless a link is open
+*/
+
+void PowerManagementGui::onReplayMessage(const Message& message)
+{
+    if (socket == NULL) processResponse(message);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Clear the monitor history when a replay starts or seeks
+
+The history is then held in memory, so that a history file is not mixed with
+the replayed samples. The file is used again when the GUI is next started.
+*/
+
+void PowerManagementGui::onReplayRestarted()
+{
+    history.setCapacity(history.capacity());
+}
+
 //-----------------------------------------------------------------------------
 /** @brief Initiate AutoTrack Disable Controls.
 
@@ -1852,61 +2068,72 @@ QString PowerManagementGui::error()
 }
 
 //-----------------------------------------------------------------------------
-/** @brief Successful establishment of serial port setup
+/** @brief Set the capture file options
 
-@returns TRUE if successful.
+@param[in] syncInterval Time in ms between synchronising the file to storage.
+@param[in] timestamps Put the host time in front of each line saved.
 */
-bool PowerManagementGui::success()
+void PowerManagementGui::setCaptureOptions(int syncInterval, bool timestamps)
 {
-    return true;
+    capture.setSyncInterval(syncInterval);
+    capture.setTimestamps(timestamps);
 }
 
 //-----------------------------------------------------------------------------
-/** @brief Close off the window and deallocate resources
+/** @brief Set the size of the monitor history
 
-This may not be necessary as QT may implement it implicitly.
+@param[in] capacity Number of samples held.
+@param[in] fileName File to hold the samples, or empty to hold them in memory.
+@returns false if the file could not be used. The samples are then in memory.
 */
-void PowerManagementGui::closeEvent(QCloseEvent *event)
+bool PowerManagementGui::setHistory(qint64 capacity, QString fileName)
 {
-    event->accept();
+    return history.setCapacity(capacity, fileName);
+}
+
+QString PowerManagementGui::historyError() const
+{
+    return history.error();
 }
 
 //-----------------------------------------------------------------------------
-/** @brief Sleep for a number of centiseconds but keep processing events
+/** @brief Set the rate at which the display is refreshed
 
-*/
+Changed values are drawn at most this many times per second, regardless of the
+rate at which messages arrive.
 
-void PowerManagementGui::ssleep(int centiseconds)
+@param[in] rate Refreshes per second.
+*/
+void PowerManagementGui::setRefreshRate(int rate)
 {
-    for (int i=0; i<centiseconds*10; i++)
-    {
-        qApp->processEvents();
-        millisleep(10);
-    }
+    display.setRefreshRate(rate);
 }
 
 //-----------------------------------------------------------------------------
-/** @brief Check if a socket is valid, that is, connected.
+/** @brief Successful establishment of serial port setup
+
+@returns TRUE if successful.
 */
-bool PowerManagementGui::validsocket()
+bool PowerManagementGui::success()
 {
-    if (socket == NULL)
-    {
-        QMessageBox msgBox;
-        msgBox.open();
-        msgBox.setText("Not yet connected. Click the connect button.");
-        ssleep(20);
-        msgBox.close();
-        return false;
-    }
     return true;
 }
 
+//-----------------------------------------------------------------------------
+/** @brief Close off the window and deallocate resources
+
+This may not be necessary as QT may implement it implicitly.
+*/
+void PowerManagementGui::closeEvent(QCloseEvent *event)
+{
+    event->accept();
+}
+
 //-----------------------------------------------------------------------------
 /** @brief Attempt to connect to the remote system.
 
-For serial, if opening the port is successful, connect to the slot, otherwise
-delete the socket. Read the device name from the GUI.
+The port is opened in the link thread and the result arrives at onLinkOpened,
+which deletes the link if it failed. Read the device name from the GUI.
 */
 void PowerManagementGui::on_connectButton_clicked()
 {
@@ -1914,33 +2141,19 @@ void PowerManagementGui::on_connectButton_clicked()
     if (socket == NULL)
     {
         serialDevice = PowerManagementMainUi.sourceComboBox->currentText();
-        if (socket != NULL) delete socket;
-        socket = new QSerialPort(serialDevice);
-        bool ok = socket->open(QIODevice::ReadWrite);
-        if (ok)
-        {
-            socket->setBaudRate(bauds[baudrate]);
-            socket->setDataBits(QSerialPort::Data8);
-            socket->setParity(QSerialPort::NoParity);
-            socket->setStopBits(QSerialPort::OneStop);
-            socket->setFlowControl(QSerialPort::NoFlowControl);
-            connect(socket, SIGNAL(readyRead()), this, SLOT(onDataAvailable()));
-            PowerManagementMainUi.connectButton->setText("Disconnect");
+        socket = new Link();
+        socket->setRecorder(&capture);
+        connect(socket, SIGNAL(messagesAvailable()), this, SLOT(onMessagesAvailable()));
+        connect(socket, SIGNAL(opened(bool)), this, SLOT(onLinkOpened(bool)));
+        socket->openSerial(serialDevice, bauds[baudrate]);
+        PowerManagementMainUi.connectButton->setText("Disconnect");
 /* Turn on microcontroller communications */
-            socket->write("pc+\n\r");
+        socket->write("pc+\n\r");
 /* This should cause the microcontroller to respond with all data */
-            socket->write("dS\n\r");
-        }
-        else
-        {
-            delete socket;
-            socket = NULL;
-            displayErrorMessage("Unable to connect to serial port");
-        }
+        socket->write("dS\n\r");
     }
     else
     {
-        disconnect(socket, SIGNAL(readyRead()), this, SLOT(onDataAvailable()));
         delete socket;
         socket = NULL;
         PowerManagementMainUi.connectButton->setText("Connect");
@@ -1949,33 +2162,18 @@ void PowerManagementGui::on_connectButton_clicked()
 #else
     if (socket == NULL)
     {
-// Create the TCP socket to the internet process
-        socket = new QTcpSocket(this);
-// Setup QT signal/slots for reading and error handling
-// The readyRead signal from the QAbstractSocket is linked to the onDataAvailable slot
-        connect(socket, SIGNAL(readyRead()), this, SLOT(onDataAvailable()));
+// Create the link to the internet process. Messages are signalled by the link
+// once decoded in its own thread.
+        socket = new Link();
+        socket->setRecorder(&capture);
+        connect(socket, SIGNAL(messagesAvailable()), this, SLOT(onMessagesAvailable()));
+        connect(socket, SIGNAL(opened(bool)), this, SLOT(onLinkOpened(bool)));
 // Obtain the address and port from the edit boxes.
         connectAddress = PowerManagementMainUi.tcpAddressEdit->text();
         connectPort = PowerManagementMainUi.tcpPortEdit->text().toUInt();
-// Connect to the host
-        blockSize = 0;
-        QMessageBox msgBox;
-        msgBox.open();
-        msgBox.setText("Attempting to connect. Please wait.");
-        int count;
-        for (count=0; count<100;count++)
-        {
-            ssleep(1);
-            socket->abort();
-            socket->connectToHost(connectAddress, connectPort);
-            if (socket->waitForConnected(1000)) break;
-        }
-        if (count >= 100) 
-        {
-            msgBox.setText("Timeout while attempting to access remote system.");
-            ssleep(20);
-        }
-        msgBox.close();
+// Connect to the host. The attempt runs in the link thread so the GUI remains
+// responsive. Commands written meanwhile are sent once connected.
+        socket->openTcp(connectAddress, connectPort);
         PowerManagementMainUi.connectButton->setText("Disconnect");
 /* Turn on microcontroller communications */
         socket->write("pc+\n\r");
@@ -1984,7 +2182,6 @@ void PowerManagementGui::on_connectButton_clicked()
     }
     else
     {
-        disconnect(socket, SIGNAL(readyRead()), this, SLOT(onDataAvailable()));
         delete socket;
         socket = NULL;
         PowerManagementMainUi.connectButton->setText("Connect");
@@ -1992,4 +2189,23 @@ void PowerManagementGui::on_connectButton_clicked()
 #endif
 }
 
+//-----------------------------------------------------------------------------
+/** @brief Report the result of a connection attempt.
+
+Only a failure is reported, in which case the link is closed.
+*/
+
+void PowerManagementGui::onLinkOpened(bool ok)
+{
+    if (ok || (socket == NULL)) return;
+    delete socket;
+    socket = NULL;
+    PowerManagementMainUi.connectButton->setText("Connect");
+#ifdef SERIAL
+    displayErrorMessage("Unable to connect to serial port");
+#else
+    displayErrorMessage("Timeout while attempting to access remote system.");
+#endif
+}
+
 
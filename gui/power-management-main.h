@@ -30,9 +30,13 @@
 
 #include "ui_power-management-main.h"
 #include "power-management.h"
-#include <QSerialPort>
+#include "power-management-message.h"
+#include "power-management-dispatch.h"
+#include "power-management-display.h"
+#include "power-management-link.h"
+#include "power-management-capture.h"
+#include "power-management-history.h"
 #include <QSerialPortInfo>
-#include <QTcpSocket>
 #include <QDir>
 #include <QFile>
 #include <QTime>
@@ -66,9 +70,14 @@ public:
     ~PowerManagementGui();
     bool success();
     QString error();
+    void setRefreshRate(int rate);
+    void setCaptureOptions(int syncInterval, bool timestamps);
+    bool setHistory(qint64 capacity, QString fileName);
+    QString historyError() const;
 private slots:
     void on_connectButton_clicked();
-    void onDataAvailable();
+    void onMessagesAvailable();
+    void onLinkOpened(bool ok);
     void on_load1Battery1_pressed();
     void on_load1Battery2_pressed();
     void on_load1Battery3_pressed();
@@ -99,13 +108,17 @@ private slots:
     void on_recordingButton_clicked();
     void on_monitorButton_clicked();
     void on_configureButton_clicked();
+    void on_diagnosticsButton_clicked();
+    void on_replayButton_clicked();
+    void onReplayMessage(const Message& message);
+    void onReplayRestarted();
     void on_autoTrackCheckBox_clicked();
     void closeEvent(QCloseEvent*);
     void disableRadioButtons(bool enable);
 signals:
-    void monitorMessageReceived(const QString response);
-    void recordMessageReceived(const QString response);
-    void configureMessageReceived(const QString response);
+    void monitorMessageReceived(const Message& message);
+    void recordMessageReceived(const Message& message);
+    void configureMessageReceived(const Message& message);
 private:
 // User Interface object instance
     Ui::PowerManagementMainDialog PowerManagementMainUi;
@@ -113,11 +126,33 @@ private:
     void initMainWindow(Ui::PowerManagementMainDialog);
     void setSourceComboBox(int index);
 // Methods
-    void processResponse(const QString response);
-    void getCurrentVoltage(const QStringList breakdown,QString* sVoltage, QString* sCurrent);
+    void processResponse(const Message& message);
+    void initDispatcher();
+    void processTime(const Message& message);
+    void processLoad1(const Message& message);
+    void processLoad2(const Message& message);
+    void processPanel(const Message& message);
+    void processBattery1(const Message& message);
+    void processBattery2(const Message& message);
+    void processBattery3(const Message& message);
+    void processControls(const Message& message);
+    void processSwitches(const Message& message);
+    void processIndicators(const Message& message);
+    void processState1(const Message& message);
+    void processState2(const Message& message);
+    void processState3(const Message& message);
+    void processCharge1(const Message& message);
+    void processCharge2(const Message& message);
+    void processCharge3(const Message& message);
+    void processTemperature(const Message& message);
+    void forwardRecord(const Message& message);
+    void forwardConfigure(const Message& message);
+    void processDebug(const Message& message);
+    MessageDispatcher<PowerManagementGui> dispatcher;
+    DisplayState display;
+    void getCurrentVoltage(const Message& message, QString* sCurrent, QString* sVoltage);
     void displayErrorMessage(const QString message);
-    void saveLine(QString line);    // Save line to a file
-    void ssleep(int seconds);
+    void saveLine(const Message& message);    // Save line to a file
 // Variables
     QString serialDevice;
     uint baudrate;
@@ -125,18 +160,11 @@ private:
     QString connectAddress;
     quint16 connectPort;
     QString errorMessage;
-    QString response;
-#ifdef SERIAL
-    QSerialPort* socket;           //!< Serial port object pointer
-#else
-    QTcpSocket* socket;
-#endif
-    bool validsocket();
-    quint16 blockSize;
-    QTime tick;
+    Link* socket;                  //!< Serial or TCP link object pointer
     QDir saveDirectory;
     QString saveFile;
-    QFile* outFile;
+    CaptureWriter capture;
+    MonitorHistory history;
     int load1Current;
     int load1Voltage;
     unsigned int indicators;
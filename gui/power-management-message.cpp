@@ -0,0 +1,148 @@
+/*       Power Management GUI Decoded Message
+
+Lines received from the BMS are decoded here into a Message for the main window
+and the child windows.
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+#include "power-management-message.h"
+#include <QHash>
+#include <QElapsedTimer>
+
+//-----------------------------------------------------------------------------
+/** @brief Build the table of idents interpreted by the GUI.
+*/
+
+static QHash<quint32,MessageId> buildIdentTable()
+{
+    QHash<quint32,MessageId> table;
+    table.insert(identKey("pH"),messageTime);
+    table.insert(identKey("pQ"),messageQuiescent);
+    table.insert(identKey("dB1"),messageBattery1);
+    table.insert(identKey("dB2"),messageBattery2);
+    table.insert(identKey("dB3"),messageBattery3);
+    table.insert(identKey("dL1"),messageLoad1);
+    table.insert(identKey("dL2"),messageLoad2);
+    table.insert(identKey("dM1"),messagePanel);
+    table.insert(identKey("dO1"),messageState1);
+    table.insert(identKey("dO2"),messageState2);
+    table.insert(identKey("dO3"),messageState3);
+    table.insert(identKey("dC1"),messageCharge1);
+    table.insert(identKey("dC2"),messageCharge2);
+    table.insert(identKey("dC3"),messageCharge3);
+    table.insert(identKey("dT"),messageTemperature);
+    table.insert(identKey("dD"),messageControls);
+    table.insert(identKey("dS"),messageSwitches);
+    table.insert(identKey("ds"),messageSwitchesTrack);
+    table.insert(identKey("dI"),messageIndicators);
+    table.insert(identKey("dE"),messageIdent);
+    return table;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Pack an ident of up to three characters into an integer key.
+
+Longer idents give zero, which is not in the table.
+*/
+
+quint32 identKey(const QString& ident)
+{
+    int length = ident.size();
+    if (length > 3) return 0;
+    quint32 key = 0;
+    for (int i=0; i<length; i++)
+        key |= (quint32)(ident.at(i).toLatin1() & 0xFF) << (8*i);
+    return key;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Decode a line received from the BMS.
+
+The line has the ident and fields separated by commas, without the line
+terminators. Fields that are not integers are decoded as zero.
+
+The monotonic stamp is taken here, so the line must be decoded as soon as it is
+framed.
+
+@param[in] line: text of the line.
+@param[in] time: host time in ms since epoch when the line was received.
+@returns decoded message.
+*/
+
+Message decodeMessage(const QString line, qint64 time)
+{
+    static const QHash<quint32,MessageId> identTable = buildIdentTable();
+    Message message;
+    message.line = line;
+    message.time = time;
+    message.stamp = monotonicTime();
+    message.fields = line.split(",");
+    message.size = message.fields.size();
+    message.ident = message.fields[0].simplified();
+    message.id = identTable.value(identKey(message.ident),messageOther);
+    message.category = categoryOther;
+    if (! message.ident.isEmpty())
+    {
+        switch (message.ident.at(0).toLatin1())
+        {
+            case 'd': message.category = categoryData; break;
+            case 'p': message.category = categoryParameter; break;
+            case 'f': message.category = categoryFile; break;
+            case 'D': message.category = categoryDebug; break;
+        }
+    }
+    message.value[0] = 0;
+    for (int i=1; i<MESSAGE_VALUES; i++)
+    {
+        message.value[i] = 0;
+        if (i < message.size) message.value[i] = message.fields[i].simplified().toInt();
+    }
+    return message;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Clock for monotonicTime, started when first used.
+*/
+
+static QElapsedTimer startedClock()
+{
+    QElapsedTimer clock;
+    clock.start();
+    return clock;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Monotonic time in us since the first call.
+
+Used to time lines against each other within the process, unaffected by the
+host clock being set. Safe to call from any thread.
+*/
+
+qint64 monotonicTime()
+{
+    static const QElapsedTimer clock = startedClock();
+    return clock.nsecsElapsed()/1000;
+}
@@ -0,0 +1,85 @@
+/*          Power Management GUI Decoded Message Header
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+#ifndef POWER_MANAGEMENT_MESSAGE_H
+#define POWER_MANAGEMENT_MESSAGE_H
+
+#include <QString>
+#include <QStringList>
+#include <QMetaType>
+
+// Number of fields, including the ident, decoded to integers
+#define MESSAGE_VALUES 8
+
+// Identities of messages interpreted by the GUI. Others are routed by category.
+typedef enum {messageOther,
+              messageTime, messageQuiescent,
+              messageBattery1, messageBattery2, messageBattery3,
+              messageLoad1, messageLoad2, messagePanel,
+              messageState1, messageState2, messageState3,
+              messageCharge1, messageCharge2, messageCharge3,
+              messageTemperature, messageControls, messageSwitches,
+              messageSwitchesTrack, messageIndicators, messageIdent,
+              numberMessageIds} MessageId;
+
+// Categories from the first character of the ident
+typedef enum {categoryOther, categoryData, categoryParameter, categoryFile,
+              categoryDebug, numberMessageCategories} MessageCategory;
+
+//-----------------------------------------------------------------------------
+/** @brief Message decoded from one line received from the BMS.
+
+The line is split once. The text of each field is kept for fields that are not
+numbers (times, file names, versions) and the leading fields are converted to
+integers in the fixed point scale sent by the BMS, so that consumers do not
+need to parse the line again. The host time, and a monotonic stamp for timing
+against other lines, are taken when the line is framed.
+
+Messages are passed by value. The strings are implicitly shared so copies are
+cheap.
+*/
+
+struct Message
+{
+    MessageId id;
+    MessageCategory category;
+    QString ident;
+    QStringList fields;
+    int size;
+    int value[MESSAGE_VALUES];
+    qint64 time;
+    qint64 stamp;
+    QString line;
+};
+
+Q_DECLARE_METATYPE(Message)
+
+Message decodeMessage(const QString line, qint64 time);
+qint64 monotonicTime();
+quint32 identKey(const QString& ident);
+
+#endif
@@ -4,20 +4,16 @@ Incoming data is displayed in time graphical form.
 
 Two plots are provided with choices of all six interfaces and voltage or
 current to display. only one curve per plot is provided. Sliders are provided
-to scale and offset the curves. Data is stored in arrays for 500 ticks
-(usually seconds but depends on the frequency of incoming messages). The
-x-axis is nominally 100 ticks.
+to scale and offset the curves. Data is taken from the monitor history held by
+the main window, which can cover hours or days. The x-axis is nominally 100
+samples, in seconds from the oldest sample held when the window is opened, and
+can be widened to cover up to 3600 seconds for each point.
 
 At the beginning the curve is built up until it reaches the plot end. then
-it jumps back to allow later data to be displayed.
-
-@todo A slider to offset the x-axis. Once offset the jump effect needs to be
-disabled. The view must remain stable until the slider is changed, then it
-must jump to the correct position relative to the last data plotted, and
-according to the slider setting. This will take into account old plot data
-being deleted as time goes on.
-
-@todo A widget to set the x-axis scale between 1 and 5 time ticks per axis tick.
+it jumps back to allow later data to be displayed. The time offset slider moves
+the plot back over the whole history, and returns to following the data when
+set fully to the right. Long periods are drawn from the decimated levels of the
+history, so the time to redraw depends on the plot width and not the period.
 
 Parts of QWT 6.1.0 examples "realtime" were adapted for this code.
 */
@@ -52,6 +48,7 @@ Parts of QWT 6.1.0 examples "realtime" were adapted for this code.
 #include <QLineEdit>
 #include <QLabel>
 #include <QCloseEvent>
+#include <QDateTime>
 #include <QDebug>
 #include <QtNetwork>
 #include <QTcpSocket>
@@ -72,62 +69,117 @@ Parts of QWT 6.1.0 examples "realtime" were adapted for this code.
 #include <unistd.h>
 
 //-----------------------------------------------------------------------------
-/** @brief Curve Data Subclass of QwtArraySeriesData
+/** @brief History Series Subclass of QwtSeriesData
+
+A view of one channel of the monitor history over a range of samples, at one
+decimation level. Points are taken from the history by index arithmetic when
+the curve is drawn, so setting or extending the range copies nothing and
+allocates nothing. Each bucket of a decimated level gives its minimum and
+maximum as two points at the time of its first sample.
 
 In QwtSeriesData the bounding rectangle of each type of data series is
 computed through qwtBoundingRect, by iterating over the entire series.
 d_boundingRect is a class member of QwtSeriesData intended for caching the
-resulting rectangle.
-
-d_samples is a QVector of the samples.
+resulting rectangle. It is only needed for autoscaling, which is not used.
 */
 
-class CurveData: public QwtArraySeriesData<QPointF>
+class HistorySeries: public QwtSeriesData<QPointF>
 {
 public:
-    CurveData()
+    HistorySeries(const MonitorHistory* h)
     {
+        history = h;
+        channel = 0;
+        start = finish = 0;
+        level = 0;
+        bucketSize = 1;
+        origin = 0;
     }
 
-    virtual QRectF boundingRect() const
+    void setChannel(int c)
     {
-        if ( d_boundingRect.width() < 0.0 ) // that is, cleared or not defined
-            d_boundingRect = qwtBoundingRect( *this );
-
-        return d_boundingRect;
+        channel = c;
+        d_boundingRect = QRectF( 0.0, 0.0, -1.0, -1.0 );
     }
 
-    inline void append( const QPointF &point )
+    void setWindow(qint64 first, qint64 end, int l, qint64 timeOrigin)
     {
-        d_samples += point;
+        start = first;
+        finish = end;
+        level = l;
+        bucketSize = history->bucketSize(level);
+        origin = timeOrigin;
+        d_boundingRect = QRectF( 0.0, 0.0, -1.0, -1.0 );
     }
 
-    void clear()
+    void extend(qint64 end)
     {
-        d_samples.clear();
-        d_samples.squeeze();
+        finish = end;
         d_boundingRect = QRectF( 0.0, 0.0, -1.0, -1.0 );
     }
+
+    virtual size_t size() const
+    {
+        if (finish <= start) return 0;
+        qint64 buckets = (finish-1)/bucketSize - start/bucketSize + 1;
+        return (level == 0) ? buckets : 2*buckets;
+    }
+
+    virtual QPointF sample(size_t i) const
+    {
+        qint64 bucket = start/bucketSize + ((level == 0) ? i : i/2);
+        qint64 n = bucket*bucketSize;
+        if (n < start) n = start;
+/* Samples overwritten since the window was set are shown as the oldest held. */
+        if (n < history->first()) n = history->first();
+        double x = (double)(history->time(n) - origin)/1000;
+        if ((level > 0) && (i % 2))
+            return QPointF(x, history->maximum(level, channel, bucket));
+        return QPointF(x, history->minimum(level, channel, bucket));
+    }
+
+    virtual QRectF boundingRect() const
+    {
+        if ( d_boundingRect.width() < 0.0 ) // that is, cleared or not defined
+            d_boundingRect = qwtBoundingRect( *this );
+
+        return d_boundingRect;
+    }
+private:
+    const MonitorHistory* history;
+    int channel;
+    qint64 start;
+    qint64 finish;
+    int level;
+    qint64 bucketSize;
+    qint64 origin;
 };
 
 //-----------------------------------------------------------------------------
 /** Monitor GUI Constructor
 
-@param[in] p TCP Socket object pointer
+@param[in] p Serial or TCP link object pointer
+@param[in] h Monitor history, filled by the main window.
 @param[in] parent Parent widget.
 */
 
-#ifdef SERIAL
-PowerManagementMonitorGui::PowerManagementMonitorGui(QSerialPort* p, QWidget* parent)
+PowerManagementMonitorGui::PowerManagementMonitorGui(Link* p, MonitorHistory* h,
+                                                     QWidget* parent)
                                                     : QDialog(parent)
 {
     socket = p;
-#else
-PowerManagementMonitorGui::PowerManagementMonitorGui(QTcpSocket* tcpSocket, QWidget* parent)
-                                                    : QDialog(parent)
-{
-    socket = tcpSocket;
-#endif
+    history = h;
+    xSamples = 1;
+    live = true;
+    if (history->end() > history->first())
+        timeOrigin = history->time(history->first());
+    else timeOrigin = QDateTime::currentMSecsSinceEpoch();
+    plotStartTime = timeOrigin;
+    plotEndTime = timeOrigin;
+    source1 = channelB1Current;
+    source2 = channelB1Voltage;
+    series1 = NULL;
+    series2 = NULL;
     PowerManagementMonitorUi.setupUi(this);
     PowerManagementMonitorUi.qwtPlot1->setFrameStyle(QFrame::NoFrame);
     PowerManagementMonitorUi.qwtPlot1->setLineWidth(0);
@@ -147,8 +199,8 @@ PowerManagementMonitorGui::PowerManagementMonitorGui(QTcpSocket* tcpSocket, QWid
     PowerManagementMonitorUi.qwtPlot1->setCanvasBackground(QColor(Qt::white));
     PowerManagementMonitorUi.qwtPlot2->setCanvasBackground(QColor(Qt::white));
 
-    xRangeMax = 100;
-    xRangeMin = 0;
+    float xRangeMax = VISIBLE_POINTS;
+    float xRangeMin = 0;
 
     yScaleBase1 = 10;
     yOffsetBase1 = 10;
@@ -192,14 +244,18 @@ PowerManagementMonitorGui::PowerManagementMonitorGui(QTcpSocket* tcpSocket, QWid
             canvas()->setAttribute(Qt::WA_PaintOnScreen, true);
     }
 
+    series1 = new HistorySeries(history);
+    series1->setChannel(source1);
     d_curve1 = new QwtPlotCurve("Monitor");
-    d_curve1->setData(new CurveData());
+    d_curve1->setData(series1);
     d_curve1->setStyle(QwtPlotCurve::Lines);
     d_curve1->setPen(Qt::black);
     d_curve1->attach(PowerManagementMonitorUi.qwtPlot1);
 
+    series2 = new HistorySeries(history);
+    series2->setChannel(source2);
     d_curve2 = new QwtPlotCurve("Monitor");
-    d_curve2->setData(new CurveData());
+    d_curve2->setData(series2);
     d_curve2->setStyle(QwtPlotCurve::Lines);
     d_curve2->setPen(Qt::black);
     d_curve2->attach(PowerManagementMonitorUi.qwtPlot2);
@@ -207,13 +263,6 @@ PowerManagementMonitorGui::PowerManagementMonitorGui(QTcpSocket* tcpSocket, QWid
     PowerManagementMonitorUi.qwtPlot1->setAutoReplot(false);
     PowerManagementMonitorUi.qwtPlot2->setAutoReplot(false);
 
-    xindex = 0;
-    plotStartIndex = 0;
-    plotEnd = 0;
-    xoffset = 0;
-    lastIndex = 0;
-    xSamples = 1;
-
     PowerManagementMonitorUi.sourceComboBox1->addItem("Battery 1 Current");
     PowerManagementMonitorUi.sourceComboBox1->addItem("Battery 1 Voltage");
     PowerManagementMonitorUi.sourceComboBox1->addItem("Battery 2 Current");
@@ -241,9 +290,8 @@ PowerManagementMonitorGui::PowerManagementMonitorGui(QTcpSocket* tcpSocket, QWid
     PowerManagementMonitorUi.sourceComboBox2->addItem("Panel Current");
     PowerManagementMonitorUi.sourceComboBox2->addItem("Panel Voltage");
     PowerManagementMonitorUi.sourceComboBox2->setCurrentIndex(1);
-
-    source1 = yDataB1Current;
-    source2 = yDataB1Voltage;
+    PowerManagementMonitorUi.xoffsetSlider->setMaximum(OFFSET_STEPS);
+    PowerManagementMonitorUi.xoffsetSlider->setSliderPosition(OFFSET_STEPS);
 }
 
 PowerManagementMonitorGui::~PowerManagementMonitorGui()
@@ -258,45 +306,8 @@ PowerManagementMonitorGui::~PowerManagementMonitorGui()
 */
 void PowerManagementMonitorGui::on_sourceComboBox1_currentIndexChanged(int index)
 {
-    switch (index)
-    {
-        case 0:
-            source1 = yDataB1Current;
-            break;
-        case 1:
-            source1 = yDataB1Voltage;
-            break;
-        case 2:
-            source1 = yDataB2Current;
-            break;
-        case 3:
-            source1 = yDataB2Voltage;
-            break;
-        case 4:
-            source1 = yDataB3Current;
-            break;
-        case 5:
-            source1 = yDataB3Voltage;
-            break;
-        case 6:
-            source1 = yDataL1Current;
-            break;
-        case 7:
-            source1 = yDataL1Voltage;
-            break;
-        case 8:
-            source1 = yDataL2Current;
-            break;
-        case 9:
-            source1 = yDataL2Voltage;
-            break;
-        case 10:
-            source1 = yDataM1Current;
-            break;
-        case 11:
-            source1 = yDataM1Voltage;
-            break;
-    }
+    source1 = index;
+    if (series1 != NULL) series1->setChannel(source1);
 /* Set the vertical ranges for current or voltage.
 Assumes the entries alternate between current/voltage. */
     if ((index % 2) == 0)
@@ -325,45 +336,8 @@ Assumes the entries alternate between current/voltage. */
 
 void PowerManagementMonitorGui::on_sourceComboBox2_currentIndexChanged(int index)
 {
-    switch (index)
-    {
-        case 0:
-            source2 = yDataB1Current;
-            break;
-        case 1:
-            source2 = yDataB1Voltage;
-            break;
-        case 2:
-            source2 = yDataB2Current;
-            break;
-        case 3:
-            source2 = yDataB2Voltage;
-            break;
-        case 4:
-            source2 = yDataB3Current;
-            break;
-        case 5:
-            source2 = yDataB3Voltage;
-            break;
-        case 6:
-            source2 = yDataL1Current;
-            break;
-        case 7:
-            source2 = yDataL1Voltage;
-            break;
-        case 8:
-            source2 = yDataL2Current;
-            break;
-        case 9:
-            source2 = yDataL2Voltage;
-            break;
-        case 10:
-            source2 = yDataM1Current;
-            break;
-        case 11:
-            source2 = yDataM1Voltage;
-            break;
-    }
+    source2 = index;
+    if (series2 != NULL) series2->setChannel(source2);
 /* Set the vertical ranges for current or voltage.
 Assumes the entries alternate between current/voltage. */
     if ((index % 2) == 0)
@@ -393,121 +367,76 @@ Assumes the entries alternate between current/voltage. */
 //-----------------------------------------------------------------------------
 /** @brief Process a Message.
 
-After a command is sent, response messages from the remote are passed here for
-processing. Appropriate fields on the form are updated.
+The main window has already entered the message into the history. A sample is
+added when the panel message ends each block, and is then plotted if the plot
+is following the data.
 
-@param QString entry: A csv string with identifier and FP current and voltage.
+@param[in] message: decoded message.
 */
 
-void PowerManagementMonitorGui::onMessageReceived(const QString &entry)
+void PowerManagementMonitorGui::onMessageReceived(const Message &message)
 {
-/* Update plots.
-This makes an assumption that all quantities will be sent each time tick,
-and that the last in the set is module 1. Collect all data first then plot
-the selected series. Some data will come through that is ignored. */
-    QStringList breakdown = entry.split(",");
-    float current = 0;
-    if (breakdown.size() > 1) current = breakdown[1].simplified().toFloat();
-    float voltage = 0;
-    if (breakdown.size() > 2) voltage = breakdown[2].simplified().toFloat();
-/* xindex is proportional to time and continuously increases. To access the
-arrays, index is the modulo of xindex and wraps around the array bounds
-to form a circular buffer. NUMBER_POINTS is the array size. */
-    int index = xindex % NUMBER_POINTS;
-/* Fill the data arrays */
-    if (breakdown[0].simplified() == "dB1")
-    {
-        yDataB1Current[index] = current;
-        yDataB1Voltage[index] = voltage;
-    }
-    else if (breakdown[0].simplified() == "dB2")
-    {
-        yDataB2Current[index] = current;
-        yDataB2Voltage[index] = voltage;
-    }
-    else if (breakdown[0].simplified() == "dB3")
-    {
-        yDataB3Current[index] = current;
-        yDataB3Voltage[index] = voltage;
-    }
-    else if (breakdown[0].simplified() == "dL1")
-    {
-        yDataL1Current[index] = current;
-        yDataL1Voltage[index] = voltage;
-    }
-    else if (breakdown[0].simplified() == "dL2")
-    {
-        yDataL2Current[index] = current;
-        yDataL2Voltage[index] = voltage;
-    }
-    else if (breakdown[0].simplified() == "dM1")
+    if ((message.id != messagePanel) || ! live) return;
+    if (history->end() <= history->first()) return;
+/* The plot runs from the oldest data to the end of the plot. When the data
+reaches the end it jumps forward to allow room for more data. */
+    if (history->time(history->end()-1) >= plotEndTime)
     {
-        yDataM1Current[index] = current;
-        yDataM1Voltage[index] = voltage;
-
-        xData[index] = (float)xindex;
-/* Process Plots with new incoming data, using the incremental plot feature. */
-/* Only every xSamples item. */
-        if ((index % xSamples) == 0)
-        {
-/* The plot runs from zero time index to the end of the plot.
-It then jumps back by a single discrete time step to allow room for more data.
-This only happens when the xoffset is zero and is being followed in real time. */
-            int plotLength = VISIBLE_POINTS*xSamples;
-            if ((plotEnd == plotLength) && (xoffset == 0))
-            {
-                on_xoffsetSlider_valueChanged(JUMP);
-            }
-/* Incrementally add to the end of the plots if they are still growing. */
-            plotEnd += xSamples;
-            if (plotEnd >= plotLength) plotEnd = plotLength;
-            CurveData *data1 = static_cast<CurveData *> (d_curve1->data());
-            data1->append(QPointF(xData[index], source1[index]));
-            d_directPainter1->drawSeries(d_curve1,data1->size()-2,data1->size()-1);
-            CurveData *data2 = static_cast<CurveData *> (d_curve2->data());
-            data2->append(QPointF(xData[index], source2[index]));
-            d_directPainter2->drawSeries(d_curve2,data2->size()-2,data2->size()-1);
-        }
-        xindex++;
+        on_xoffsetSlider_valueChanged(OFFSET_STEPS);
+        return;
     }
+/* Incrementally add to the end of the plots, every xSamples samples. The last
+point shown is drawn again as its bucket may have changed. */
+    if ((history->end() % xSamples) != 0) return;
+    int from = (int)series1->size()-2;
+    series1->extend(history->end());
+    series2->extend(history->end());
+    if (from < 0) from = 0;
+    if (series1->size() == 0) return;
+    d_directPainter1->drawSeries(d_curve1,from,series1->size()-1);
+    d_directPainter2->drawSeries(d_curve2,from,series2->size()-1);
 }
 
 //-----------------------------------------------------------------------------
-/** @brief Replot the Display Graphs
+/** @brief Number of Points that can be Shown
+
+One decimated bucket is drawn for each pixel across the plot.
+*/
 
-This computes the index of the plot start in the data array, wipes the plot
-and replots from the old data.
+int PowerManagementMonitorGui::plotWidth() const
+{
+    int width = PowerManagementMonitorUi.qwtPlot1->canvas()->width();
+    if (width < VISIBLE_POINTS) width = VISIBLE_POINTS;
+    return width;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Replot the Display Graphs
 
-Global xSamples: the x-axis scale factor.
+This sets the time axis and the window of the history shown by each curve, and
+replots. Only as many points as the plot has pixels are drawn, from the
+decimated levels of the history if the period is long. No samples are copied.
 
-@param int 
+@param[in] startTime: host time of the plot start in ms since the epoch.
+@param[in] endTime: host time of the plot end.
 */
-void PowerManagementMonitorGui::replot(int plotStartIndex, int plotEnd)
+void PowerManagementMonitorGui::replot(qint64 startTime, qint64 endTime)
 {
-    int plotLength = VISIBLE_POINTS*xSamples;
-    int dataStartIndex = plotStartIndex % NUMBER_POINTS;
-    xRangeMin = (float)plotStartIndex;
-    xRangeMax = xRangeMin+plotLength;
+    plotStartTime = startTime;
+    plotEndTime = endTime;
+    float xRangeMin = (float)(startTime - timeOrigin)/1000;
+    float xRangeMax = (float)(endTime - timeOrigin)/1000;
     PowerManagementMonitorUi.qwtPlot1->
         setAxisScale(QwtPlot::xBottom, xRangeMin, xRangeMax);
     PowerManagementMonitorUi.qwtPlot2->
         setAxisScale(QwtPlot::xBottom, xRangeMin, xRangeMax);
-    CurveData *data1 = static_cast<CurveData *> (d_curve1->data());
-    data1->clear();
-    CurveData *data2 = static_cast<CurveData *> (d_curve2->data());
-    data2->clear();
-    QPolygonF points1, points2;
-/* Back fill the plot with old data */
-    for (int i=0; i<plotEnd; i+=xSamples)
-    {
-        int index = (i+dataStartIndex) % NUMBER_POINTS;
-        points1 << QPointF(xData[index],source1[index]);
-        points2 << QPointF(xData[index],source2[index]);
-    }
-    d_curve1->setSamples(points1);
+    qint64 start = history->find(startTime);
+    qint64 finish = history->find(endTime);
+    int level = history->level(start,finish,plotWidth());
+    series1->setWindow(start,finish,level,timeOrigin);
     PowerManagementMonitorUi.qwtPlot1->replot();
     PowerManagementMonitorUi.qwtPlot1->repaint();
-    d_curve2->setSamples(points2);
+    series2->setWindow(start,finish,level,timeOrigin);
     PowerManagementMonitorUi.qwtPlot2->replot();
     PowerManagementMonitorUi.qwtPlot2->repaint();
 }
@@ -539,92 +468,44 @@ void PowerManagementMonitorGui::on_offsetSlider2_valueChanged(int value)
 //-----------------------------------------------------------------------------
 /** @brief Change the Display Graph Horizontal Time Offset
 
-Work back through the array to find the first point to plot. Replot the graph
-from that point on. It will remain steady until xoffset becomes zero.
-
-xindex is the time index of the latest data point.
-plotEndIndex is the time index at the next discrete time step.
-plotStartIndex is the time index where the plot starts.
-(These indexes are translated to actual indexes in the data circular buffer)
-plotEnd is the point on the plot where the data plot stops.
-plotLength is the length of the plot in xSamples time steps.
+The slider places the plot over the whole history, from the oldest sample held
+at the left to the latest at the right. Fully to the right the plot follows the
+data as it arrives, starting at the oldest sample until the plot is filled, and
+leaving room for JUMP points each time it jumps.
 
-value ranges from 0 to 20 in steps of 1.
+@param[in] offset: slider position from 0 to OFFSET_STEPS.
 */
 void PowerManagementMonitorGui::on_xoffsetSlider_valueChanged(int offset)
 {
-    int plotLength = VISIBLE_POINTS*xSamples;
-/* If the last offset was zero, start from normal operation at xindex which
-is the time index for the latest data point to arrive.
-lastIndex is the point where we last viewed the realtime graph. When offset,
-this remains unchanged until a return to realtime. */
-    if (xoffset == 0) lastIndex = xindex;
-    xoffset = (JUMP-offset)*JUMP;
-/* The number of data points to move the plot back is the offset plus a bit
-to bring the curve to the grid line. */
-    int stepback = lastIndex % JUMP + xoffset;
-/* If the offset is now zero, reset back to normal operation at xindex */
-    if (xoffset == 0)
+    qint64 span = (qint64)VISIBLE_POINTS*xSamples*1000;
+    live = (offset >= OFFSET_STEPS);
+    if (history->end() <= history->first())
     {
-        lastIndex = xindex;
-        stepback = 0;
+        replot(timeOrigin, timeOrigin+span);
+        return;
     }
-/* If the last index is shorter than the plot length, set end to the index */
-    int plotEndIndex = lastIndex;
-    if (lastIndex > plotLength)
-        plotEndIndex = lastIndex + JUMP - lastIndex % JUMP;
-    int plotStartIndex = plotEndIndex - plotLength;
-/* Deal with very short plots */
-    if (plotStartIndex < 0) plotStartIndex = 0;
-/* Step back the full way if there is room */
-    else if (plotStartIndex > stepback)
+    qint64 oldest = history->time(history->first());
+    qint64 newest = history->time(history->end()-1);
+    qint64 endTime = oldest + span;
+    if (live)
     {
-        plotStartIndex -= stepback;
-        plotEndIndex -= stepback;
+        if (newest + (qint64)JUMP*xSamples*1000 > endTime)
+            endTime = newest + (qint64)JUMP*xSamples*1000;
     }
-/* Otherwise start at zero and plot from there */
-    else if (plotStartIndex > 0)
-    {
-        plotStartIndex = 0;
-        plotEndIndex -= plotStartIndex;
-    }
-/* Don't move back to times before the buffered data starts */
-    if (plotStartIndex < xindex - NUMBER_POINTS)
-    {
-        plotStartIndex = xindex - NUMBER_POINTS;
-        plotEndIndex = plotStartIndex + plotLength;
-    }
-    plotEnd = lastIndex - plotStartIndex;
-    if (plotEnd > plotLength) plotEnd = plotLength;
-    replot(plotStartIndex, plotEnd);
+    else if (newest - oldest > span)
+        endTime += (newest - oldest - span)*offset/OFFSET_STEPS;
+    replot(endTime - span, endTime);
 }
 
 //-----------------------------------------------------------------------------
 /** @brief Change the Display Graph Sample Period
 
-Period can be changed between 1 and 5.
+Period can be changed between 1 and 3600 seconds for each point.
 */
 void PowerManagementMonitorGui::on_sampleSpinBox_valueChanged(int value)
 {
     xSamples = value;
-    int plotLength = VISIBLE_POINTS*xSamples;
-/* Refresh the plot for no xoffset similarly to that done for normal plots. */
-    if (xoffset == 0)
-    {
-        int plotEndIndex = xindex;
-        if (xindex > plotLength)
-            plotEndIndex = xindex + JUMP - xindex % JUMP;
-        plotStartIndex = plotEndIndex - plotLength;
-        if (plotStartIndex < 0) plotStartIndex = 0;
-        plotEnd = xindex - plotStartIndex;
-        if (plotEnd > plotLength) plotEnd = plotLength;
-        replot(plotStartIndex, plotEnd);
-    }
-/* For shifted plots need to refresh around the shifted point. */
-    else
-    {
-        on_xoffsetSlider_valueChanged(PowerManagementMonitorUi.xoffsetSlider->value());
-    }
+    on_xoffsetSlider_valueChanged(PowerManagementMonitorUi.xoffsetSlider->value());
 }
 
 //-----------------------------------------------------------------------------
@@ -30,20 +30,23 @@
 #define _TTY_POSIX_
 
 #include "power-management.h"
+#include "power-management-message.h"
+#include "power-management-link.h"
+#include "power-management-history.h"
 #include "ui_power-management-monitor.h"
-#include <QSerialPort>
 #include <QSerialPortInfo>
 #include <qwt_plot.h>
 #include <QDialog>
 #include <QtNetwork>
-#include <QTcpSocket>
 
-#define NUMBER_POINTS   600
 #define VISIBLE_POINTS  100
 #define JUMP             20
+// Positions of the time offset slider over the full history, the last is live
+#define OFFSET_STEPS   1000
 
 class QwtPlotCurve;
 class QwtPlotDirectPainter;
+class HistorySeries;
 
 //-----------------------------------------------------------------------------
 /** @brief Power Management Monitor Window.
@@ -54,14 +57,11 @@ class PowerManagementMonitorGui : public QDialog
 {
     Q_OBJECT
 public:
-#ifdef SERIAL
-    PowerManagementMonitorGui(QSerialPort* socket, QWidget* parent = 0);
-#else
-    PowerManagementMonitorGui(QTcpSocket* socket, QWidget* parent = 0);
-#endif
+    PowerManagementMonitorGui(Link* socket, MonitorHistory* history,
+                              QWidget* parent = 0);
     ~PowerManagementMonitorGui();
 private slots:
-    void onMessageReceived(const QString &entry);
+    void onMessageReceived(const Message &message);
     void on_sourceComboBox1_currentIndexChanged(int index);
     void on_offsetSlider1_valueChanged(int value);
     void on_scaleSlider1_valueChanged(int value);
@@ -74,34 +74,18 @@ private slots:
 private:
 // User Interface object instance
     Ui::PowerManagementMonitorDialog PowerManagementMonitorUi;
-#ifdef SERIAL
-    QSerialPort *socket;           //!< Serial port object pointer
-#else
-    QTcpSocket *socket;
-#endif
-    void replot(int plotStartIndex, int plotEnd);
+    Link *socket;                  //!< Serial or TCP link object pointer
+    MonitorHistory *history;       //!< Samples of all interfaces
+    void replot(qint64 startTime, qint64 endTime);
+    int plotWidth() const;
     QwtPlotCurve *d_curve1, *d_curve2;
     QwtPlotDirectPainter *d_directPainter1, *d_directPainter2;
-    int xoffset;
+    HistorySeries *series1, *series2;  //!< Views of the history, owned by the curves
     int xSamples;
-    float xRangeMax;
-    float xRangeMin;
-    float xData[NUMBER_POINTS];
-    float yDataB1Current[NUMBER_POINTS];
-    float yDataB1Voltage[NUMBER_POINTS];
-    float yDataB2Current[NUMBER_POINTS];
-    float yDataB2Voltage[NUMBER_POINTS];
-    float yDataB3Current[NUMBER_POINTS];
-    float yDataB3Voltage[NUMBER_POINTS];
-    float yDataL1Current[NUMBER_POINTS];
-    float yDataL1Voltage[NUMBER_POINTS];
-    float yDataL2Current[NUMBER_POINTS];
-    float yDataL2Voltage[NUMBER_POINTS];
-    float yDataM1Current[NUMBER_POINTS];
-    float yDataM1Voltage[NUMBER_POINTS];
-    long long xindex;
-    long long lastIndex;
-    int plotStartIndex, plotEnd;
+    qint64 timeOrigin;
+    qint64 plotStartTime;
+    qint64 plotEndTime;
+    bool live;
 
     float yScaleBase1;
     float yScale1;
@@ -109,7 +93,7 @@ private:
     float yOffset1;
     float yRangeMax1;
     float yRangeMin1;
-    float* source1;
+    int source1;
 
     float yScaleBase2;
     float yScale2;
@@ -117,7 +101,7 @@ private:
     float yOffset2;
     float yRangeMax2;
     float yRangeMin2;
-    float* source2;
+    int source2;
 };
 
 #endif
@@ -5,6 +5,8 @@ file on the attached medium, notably an SD card.
 
 The files on the card are displayed and a new one suggested.
 Recording is started and stopped, at which the file is closed.
+
+A file on the card can be downloaded to a local file by bulk transfer.
 */
 /****************************************************************************
  *   Copyright (C) 2013 by Ken Sarkies                                      *
@@ -41,6 +43,9 @@ Recording is started and stopped, at which the file is closed.
 #include <QDateTime>
 #include <QDir>
 #include <QFile>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QFileInfo>
 #include <QDebug>
 #include <QStandardItemModel>
 #include <QtNetwork>
@@ -55,21 +60,14 @@ Recording is started and stopped, at which the file is closed.
 The remote unit is queried for status of recording and storage drive statistics.
 The directory listing is obtained from the remote unit. 
 
-@param[in] socket TCP Socket object pointer
+@param[in] socket Serial or TCP link object pointer
 @param[in] parent Parent widget.
 */
 
-#ifdef SERIAL
-PowerManagementRecordGui::PowerManagementRecordGui(QSerialPort* p, QWidget* parent)
+PowerManagementRecordGui::PowerManagementRecordGui(Link* p, QWidget* parent)
                                                     : QDialog(parent)
 {
     socket = p;
-#else
-PowerManagementRecordGui::PowerManagementRecordGui(QTcpSocket* tcpSocket, QWidget* parent)
-                                                    : QDialog(parent)
-{
-    socket = tcpSocket;
-#endif
     PowerManagementRecordUi.setupUi(this);
     requestRecordingStatus();
 // Ask for the microcontroller SD card free space (process response later)
@@ -89,6 +87,12 @@ PowerManagementRecordGui::PowerManagementRecordGui(QTcpSocket* tcpSocket, QWidge
 // Send a command to refresh the directory
     refreshDirectory();
     writeFileHandle = 0xFF;
+    readFileHandle = 0xFF;
+    remoteFileSize = 0;
+    download = new BulkDownload(socket,this);
+    connect(download,SIGNAL(progress(qint64,qint64)),
+            this,SLOT(onDownloadProgress(qint64,qint64)));
+    connect(download,SIGNAL(finished()),this,SLOT(onDownloadFinished()));
 }
 
 PowerManagementRecordGui::~PowerManagementRecordGui()
@@ -191,14 +195,13 @@ void PowerManagementRecordGui::on_closeFileButton_clicked()
 After a command is sent, response messages from the remote are passed here for
 processing. Appropriate fields on the form are updated.
 
-@todo This interprets response as done in main. See if this can be made
-independent of formats.
+The message has been decoded by the main window.
 */
 
-void PowerManagementRecordGui::onMessageReceived(const QString &response)
+void PowerManagementRecordGui::onMessageReceived(const Message &message)
 {
-    QStringList breakdown = response.split(",");
-    QString command = breakdown[0].right(1);
+    const QStringList& breakdown = message.fields;
+    QString command = message.ident.right(1);
 // Error Code
     switch (command[0].toLatin1())
     {
@@ -220,29 +223,8 @@ The response will be a comma separated list of items preceded by a type.
             if (breakdown.size() <= 1) break;
             for (int i=1; i<breakdown.size(); i++)
             {
-                QChar type = breakdown[i][0];
-                bool ok;
-                QString fileSize = QString("%1")
-                    .arg((float)breakdown[i].mid(1,8).toInt(&ok,16)/1000000,8,'f',3);
-                if (type == 'd')
-                    fileSize = "";
-                if ((type == 'f') || (type == 'd'))
-                {
-                    QString fileName = breakdown[i].mid(9,breakdown[i].length()-1);
-                    QFont font;
-                    if (type == 'd') font.setBold(true);
-                    QStandardItem *nameItem = new QStandardItem(fileName);
-                    QStandardItem *sizeItem = new QStandardItem(fileSize);
-                    QList<QStandardItem *> row;
-                    nameItem->setFont(font);
-                    nameItem->setData(Qt::AlignLeft, Qt::TextAlignmentRole);
-                    sizeItem->setData(Qt::AlignRight, Qt::TextAlignmentRole);
-                    row.append(nameItem);
-                    row.append(sizeItem);
-                    nameItem->setData(QVariant(type));
-//                    item->setIcon(...);
-                    model->appendRow(row);
-                }
+                QList<QStandardItem *> row = directoryRow(breakdown[i]);
+                if (! row.isEmpty()) model->appendRow(row);
             }
             break;
         }
@@ -261,35 +243,40 @@ the previous entry has been fully received.
             nextDirectoryEntry = true;
             for (int i=1; i<breakdown.size(); i++)
             {
-                QChar type = breakdown[i][0];
-                bool ok;
-                QString fileSize = QString("%1")
-                    .arg((float)breakdown[i].mid(1,8).toInt(&ok,16)/1000000,8,'f',3);
-                if (type == 'd')
-                    fileSize = "";
-                if ((type == 'f') || (type == 'd'))
-                {
-                    QString fileName = breakdown[i].mid(9,breakdown[i].length()-1);
-                    QFont font;
-                    if (type == 'd') font.setBold(true);
-                    QStandardItem *nameItem = new QStandardItem(fileName);
-                    QStandardItem *sizeItem = new QStandardItem(fileSize);
-                    QList<QStandardItem *> row;
-                    nameItem->setFont(font);
-                    nameItem->setData(Qt::AlignLeft, Qt::TextAlignmentRole);
-                    sizeItem->setData(Qt::AlignRight, Qt::TextAlignmentRole);
-                    row.append(nameItem);
-                    row.append(sizeItem);
-                    nameItem->setData(QVariant(type));
-//                    item->setIcon(...);
-                    model->appendRow(row);
-                }
+                QList<QStandardItem *> row = directoryRow(breakdown[i]);
+                if (! row.isEmpty()) model->appendRow(row);
 /* Request the next entry by sending another incremental directory command with
 no directory name. */
                 socket->write("fd\r\n");
             }
             break;
         }
+/* Directory listing by page.
+The response is the continuation token followed by a page of entries as for
+the full listing. The rows of the page are added to the model together, and
+the next page is asked for until the token is zero.
+*/
+        case 'L':
+        {
+            if (breakdown.size() < 2) break;
+            int token = breakdown[1].toInt();
+            QList<QList<QStandardItem *> > rows;
+            for (int i=2; i<breakdown.size(); i++)
+            {
+                QList<QStandardItem *> row = directoryRow(breakdown[i]);
+                if (! row.isEmpty()) rows.append(row);
+            }
+            int first = model->rowCount();
+            model->insertRows(first, rows.size());
+            for (int r=0; r<rows.size(); r++)
+                for (int c=0; c<rows[r].size(); c++)
+                    model->setItem(first+r, c, rows[r][c]);
+            directoryEnded = (token == 0);
+            if (! directoryEnded)
+                socket->write(QString("fL%1,%2\n\r").arg(token)
+                                .arg(listingDirectory).toLocal8Bit());
+            break;
+        }
 // Status of recording and open files.
 // The write and read file handles are retrieved from this
         case 's':
@@ -305,26 +292,44 @@ no directory name. */
             if (breakdown.size() <= 2) break;
             writeFileHandle = breakdown[2].toInt();
             writeFileOpen = (writeFileHandle < 255);
-            if (writeFileOpen)
+// The write file name is present only if the write file is open.
+            int field = 3;
+            if (writeFileOpen && (breakdown.size() > field))
             {
                 PowerManagementRecordUi.recordFileButton->
                     setStyleSheet("background-color:lightgreen;");
-                PowerManagementRecordUi.recordFileName->setText(breakdown[3]);
+                PowerManagementRecordUi.recordFileName->setText(breakdown[field]);
+                field++;
             }
             else
                 PowerManagementRecordUi.recordFileButton->
                     setStyleSheet("background-color:lightpink;");
-            if (breakdown.size() <= 3) break;
-            readFileHandle = breakdown[3].toInt();
+            if (breakdown.size() <= field) break;
+            readFileHandle = breakdown[field].toInt();
             readFileOpen = (readFileHandle < 255);
-            if (readFileOpen)
-                 PowerManagementRecordUi.readFileName->setText(breakdown[3]);
+            if (readFileOpen && (breakdown.size() > field+1))
+                 PowerManagementRecordUi.readFileName->setText(breakdown[field+1]);
+            PowerManagementRecordUi.readFileButton->setStyleSheet(readFileOpen ?
+                    "background-color:lightgreen;" : "background-color:lightpink;");
            break;
         }
 // Open a file for recording.
         case 'W':
         {
-            writeFileHandle = extractValue(response);
+            writeFileHandle = extractValue(message.line);
+            break;
+        }
+// Open a file for reading, to be downloaded.
+        case 'R':
+        {
+            readFileHandle = message.value[1];
+            readFileOpen = (readFileHandle < 255);
+            break;
+        }
+// Chunk of a bulk download.
+        case 'b':
+        {
+            download->chunkReceived(message);
             break;
         }
         case 'E':
@@ -356,6 +361,42 @@ no directory name. */
     }
 }
 
+//-----------------------------------------------------------------------------
+/** @brief Make a Table Row from a Directory Entry.
+
+The entry is the type, the size as eight hex digits and the name. The name
+item holds the type and the size in bytes for later use.
+
+@param[in] entry: directory entry from a listing response.
+@returns name and size items, or an empty list if not a file or directory.
+*/
+
+QList<QStandardItem *> PowerManagementRecordGui::directoryRow(const QString &entry)
+{
+    QList<QStandardItem *> row;
+    if (entry.isEmpty()) return row;
+    QChar type = entry[0];
+    if ((type != 'f') && (type != 'd')) return row;
+    bool ok;
+    qint64 size = entry.mid(1,8).toLongLong(&ok,16);
+    QString fileSize = QString("%1").arg((float)size/1000000,8,'f',3);
+    if (type == 'd')
+        fileSize = "";
+    QString fileName = entry.mid(9,entry.length()-1);
+    QFont font;
+    if (type == 'd') font.setBold(true);
+    QStandardItem *nameItem = new QStandardItem(fileName);
+    QStandardItem *sizeItem = new QStandardItem(fileSize);
+    nameItem->setFont(font);
+    nameItem->setData(Qt::AlignLeft, Qt::TextAlignmentRole);
+    sizeItem->setData(Qt::AlignRight, Qt::TextAlignmentRole);
+    nameItem->setData(QVariant(type));
+    nameItem->setData(QVariant(size),FILE_SIZE_ROLE);
+    row.append(nameItem);
+    row.append(sizeItem);
+    return row;
+}
+
 //-----------------------------------------------------------------------------
 /** @brief Extract an Integer Value from a Response.
 
@@ -382,16 +423,21 @@ Display filename in edit box, or enter a directory and redisplay.
 void PowerManagementRecordGui::onListItemClicked(const QModelIndex & index)
 {
     PowerManagementRecordUi.recordFileName->clear();
-    QStandardItem *item = model->itemFromIndex(index);
+    QStandardItem *item = model->item(index.row(),0);
     QString fileName = item->text();
     QChar type = item->data().toChar();
     if (type == 'f')
     {
         PowerManagementRecordUi.recordFileName->setText(fileName);
         PowerManagementRecordUi.readFileName->setText(fileName);
+        remoteFileSize = item->data(FILE_SIZE_ROLE).toLongLong();
     }
     if (type == 'd')
-        socket->write(QString("fD%1\n\r").arg(fileName).toLocal8Bit().data());
+    {
+        listingDirectory = fileName;
+        model->clear();
+        socket->write(QString("fL0,%1\n\r").arg(fileName).toLocal8Bit());
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -418,15 +464,15 @@ void PowerManagementRecordGui::on_registerButton_clicked()
 //-----------------------------------------------------------------------------
 /** @brief Refresh the Directory.
 
-This requests the first directory entry for the top directory only.
-Subsequent directory entries are obtained when the response to the previous
-one has been received.
+This requests the first page of the listing for the top directory only.
+Subsequent pages are asked for when the previous one has been received.
 */
 
 void PowerManagementRecordGui::refreshDirectory()
 {
     model->clear();
-    socket->write("fd/\n\r");
+    listingDirectory = "/";
+    socket->write("fL0,/\n\r");
 }
 
 //-----------------------------------------------------------------------------
@@ -449,4 +495,156 @@ void PowerManagementRecordGui::getFreeSpace()
     socket->write("fF\n\r");
 }
 
+//-----------------------------------------------------------------------------
+/** @brief Open the Remote File for Reading.
+
+Any read file already open is closed first, as only one can be open. The
+response gives the file handle used for the download.
+*/
 
+void PowerManagementRecordGui::on_readFileButton_clicked()
+{
+    if (download->isActive())
+    {
+        PowerManagementRecordUi.errorLabel->setText("Download in progress");
+        return;
+    }
+    QString fileName = PowerManagementRecordUi.readFileName->text();
+    if (fileName.length() > 0)
+    {
+        if (readFileHandle < 0xFF)
+            socket->write(QString("fC%1\n\r").arg(readFileHandle).toLocal8Bit());
+        remoteFileName = fileName;
+        socket->write("fR");
+        socket->write(fileName.toLocal8Bit().data());
+        socket->write("\n\r");
+        requestRecordingStatus();
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Choose the Local File for the Download.
+
+An existing file is not replaced here, as it may be a partial download to be
+continued. The download checks this when it starts.
+*/
+
+void PowerManagementRecordGui::on_localFileButton_clicked()
+{
+    QString fileName = QFileDialog::getSaveFileName(this,
+                        "Local File for Download",
+                        PowerManagementRecordUi.readFileName->text(),
+                        "All Files (*)",0,QFileDialog::DontConfirmOverwrite);
+    if (! fileName.isEmpty())
+        PowerManagementRecordUi.localFileName->setText(fileName);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Start or Resume the Download.
+
+The remote file must be open for reading. If the local file is a partial
+download of the same remote file, the whole chunks already in it are kept, so
+a paused or interrupted download continues where it ended. Any other existing
+local file is only replaced if the user agrees.
+*/
+
+void PowerManagementRecordGui::on_downloadButton_clicked()
+{
+    if (download->isActive()) return;
+    if (readFileHandle >= 0xFF)
+    {
+        PowerManagementRecordUi.errorLabel->setText("Remote file not open");
+        return;
+    }
+    QString fileName = PowerManagementRecordUi.localFileName->text();
+    if (fileName.isEmpty())
+    {
+        PowerManagementRecordUi.errorLabel->setText("No local file");
+        return;
+    }
+    PowerManagementRecordUi.errorLabel->clear();
+    bool replace = false;
+    if (QFileInfo(fileName).size() > 0 &&
+        ! BulkDownload::canResume(fileName, remoteFileName, remoteFileSize))
+    {
+        if (QMessageBox::question(this, "Local File Exists",
+                QString("%1 is not a partial download of %2. Replace it?")
+                    .arg(fileName).arg(remoteFileName),
+                QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes)
+            return;
+        replace = true;
+    }
+    if (! download->start(fileName, remoteFileName, remoteFileSize, replace))
+        PowerManagementRecordUi.errorLabel->setText(download->error());
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Pause the Download, keeping what has been written.
+
+*/
+
+void PowerManagementRecordGui::on_pauseDownloadButton_clicked()
+{
+    if (! download->isActive()) return;
+    download->pause();
+    PowerManagementRecordUi.throughputLabel->
+        setText(QString("Paused at %1 kB").arg(download->bytesWritten()/1024));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Cancel the Download and remove the partial local file.
+
+*/
+
+void PowerManagementRecordGui::on_cancelDownloadButton_clicked()
+{
+    download->cancel();
+    PowerManagementRecordUi.progressBar->setRange(0,100);
+    PowerManagementRecordUi.progressBar->setValue(0);
+    PowerManagementRecordUi.throughputLabel->clear();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Show the Progress of the Download.
+
+The progress bar is only a busy indicator if the size of the remote file is
+not known from the directory listing.
+
+@param[in] bytes: bytes in the local file.
+@param[in] rate: bytes per second over the last second.
+*/
+
+void PowerManagementRecordGui::onDownloadProgress(qint64 bytes, qint64 rate)
+{
+    if (remoteFileSize > 0)
+    {
+        qint64 percent = bytes*100/remoteFileSize;
+        if (percent > 100) percent = 100;
+        PowerManagementRecordUi.progressBar->setRange(0,100);
+        PowerManagementRecordUi.progressBar->setValue(percent);
+    }
+    else PowerManagementRecordUi.progressBar->setRange(0,0);
+    PowerManagementRecordUi.throughputLabel->
+        setText(QString("%1 kB at %2 B/s").arg(bytes/1024).arg(rate));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Report the End of the Download.
+
+*/
+
+void PowerManagementRecordGui::onDownloadFinished()
+{
+    if (! download->error().isEmpty())
+    {
+        PowerManagementRecordUi.errorLabel->setText(download->error());
+        return;
+    }
+    PowerManagementRecordUi.progressBar->setRange(0,100);
+    PowerManagementRecordUi.progressBar->setValue(100);
+    PowerManagementRecordUi.errorLabel->
+        setText(QString("Downloaded %1 bytes, %2 chunks repeated, %3 corrupted")
+                .arg(download->bytesWritten())
+                .arg(download->chunksRepeated())
+                .arg(download->chunksCorrupted()));
+}
@@ -30,13 +30,17 @@
 #define _TTY_POSIX_
 
 #include "power-management.h"
+#include "power-management-message.h"
+#include "power-management-link.h"
+#include "power-management-download.h"
 #include "ui_power-management-record.h"
-#include <QSerialPort>
 #include <QSerialPortInfo>
 #include <QDialog>
 #include <QStandardItemModel>
 #include <QtNetwork>
-#include <QTcpSocket>
+
+// Model role holding the size in bytes of a directory entry
+#define FILE_SIZE_ROLE (Qt::UserRole+2)
 
 //-----------------------------------------------------------------------------
 /** @brief Power Management Recording Window.
@@ -47,11 +51,7 @@ class PowerManagementRecordGui : public QDialog
 {
     Q_OBJECT
 public:
-#ifdef SERIAL
-    PowerManagementRecordGui(QSerialPort* socket, QWidget* parent = 0);
-#else
-    PowerManagementRecordGui(QTcpSocket* socket, QWidget* parent = 0);
-#endif
+    PowerManagementRecordGui(Link* socket, QWidget* parent = 0);
     ~PowerManagementRecordGui();
 private slots:
     void on_deleteButton_clicked();
@@ -59,19 +59,23 @@ private slots:
     void on_stopButton_clicked();
     void on_closeFileButton_clicked();
     void on_recordFileButton_clicked();
-    void onMessageReceived(const QString &text);
+    void onMessageReceived(const Message &message);
     void onListItemClicked(const QModelIndex & index);
     void on_registerButton_clicked();
     void on_closeButton_clicked();
+    void on_readFileButton_clicked();
+    void on_localFileButton_clicked();
+    void on_downloadButton_clicked();
+    void on_pauseDownloadButton_clicked();
+    void on_cancelDownloadButton_clicked();
+    void onDownloadProgress(qint64 bytes, qint64 rate);
+    void onDownloadFinished();
 private:
 // User Interface object instance
     Ui::PowerManagementRecordDialog PowerManagementRecordUi;
-#ifdef SERIAL
-    QSerialPort *socket;           //!< Serial port object pointer
-#else
-    QTcpSocket *socket;
-#endif
+    Link *socket;                  //!< Serial or TCP link object pointer
     int extractValue(const QString &response);
+    QList<QStandardItem *> directoryRow(const QString &entry);
     void requestRecordingStatus();
     void refreshDirectory();
     void getFreeSpace();
@@ -84,7 +88,10 @@ private:
     int row;
     bool directoryEnded;
     bool nextDirectoryEntry;
-
+    QString listingDirectory;      //!< Directory being listed by page
+    BulkDownload *download;        //!< Transfer of the read file
+    qint64 remoteFileSize;         //!< Size in the directory of the read file
+    QString remoteFileName;        //!< Name of the read file opened
 };
 
 #endif
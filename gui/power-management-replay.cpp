@@ -0,0 +1,177 @@
+/*       Power Management Session Replay Window
+
+A session recorded from the main window is played back through the main window
+and the windows opened from it, for review without the BMS.
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include "power-management-replay.h"
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QDateTime>
+
+//-----------------------------------------------------------------------------
+/** Power Management Session Replay Window Constructor
+
+@param[in] parent Parent widget.
+*/
+
+PowerManagementReplayGui::PowerManagementReplayGui(QWidget* parent)
+                                                  : QDialog(parent)
+{
+    PowerManagementReplayUi.setupUi(this);
+    PowerManagementReplayUi.speedSpinBox->setRange(1, SESSION_MAX_SPEED);
+    PowerManagementReplayUi.speedSpinBox->setValue(1);
+    PowerManagementReplayUi.playButton->setEnabled(false);
+    PowerManagementReplayUi.positionSlider->setEnabled(false);
+    connect(&player, SIGNAL(messageReplayed(const Message&)),
+            this, SIGNAL(messageReplayed(const Message&)));
+    connect(&player, SIGNAL(positionChanged(qint64)),
+            this, SLOT(onPositionChanged(qint64)));
+    connect(&player, SIGNAL(lineSent(const QString&)),
+            this, SLOT(onLineSent(const QString&)));
+    connect(&player, SIGNAL(finished()), this, SLOT(onFinished()));
+}
+
+PowerManagementReplayGui::~PowerManagementReplayGui()
+{
+    player.close();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Choose a session file and make ready to play it from the start
+*/
+
+void PowerManagementReplayGui::on_openButton_clicked()
+{
+    QString fileName = QFileDialog::getOpenFileName(this,
+                        "Open a Session for Replay", QString(),
+                        QString("Sessions (*%1)").arg(SESSION_SUFFIX));
+    if (fileName.isEmpty()) return;
+    PowerManagementReplayUi.errorLabel->clear();
+    PowerManagementReplayUi.sentLabel->clear();
+    PowerManagementReplayUi.playButton->setText("Play");
+    if (! player.open(fileName))
+    {
+        PowerManagementReplayUi.errorLabel->setText(player.error());
+        PowerManagementReplayUi.playButton->setEnabled(false);
+        PowerManagementReplayUi.positionSlider->setEnabled(false);
+        return;
+    }
+    PowerManagementReplayUi.fileLabel->setText(QFileInfo(fileName).fileName());
+    PowerManagementReplayUi.positionSlider->setRange(0, player.duration()/1000000);
+    PowerManagementReplayUi.positionSlider->setEnabled(true);
+    PowerManagementReplayUi.playButton->setEnabled(true);
+    player.setSpeed(PowerManagementReplayUi.speedSpinBox->value());
+    emit replayRestarted();
+    onPositionChanged(0);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Start or pause the replay
+*/
+
+void PowerManagementReplayGui::on_playButton_clicked()
+{
+    if (player.isPlaying())
+    {
+        player.pause();
+        PowerManagementReplayUi.playButton->setText("Play");
+    }
+    else
+    {
+        if (player.position() >= player.duration())
+        {
+            player.seek(0);
+            emit replayRestarted();
+        }
+        player.play();
+        PowerManagementReplayUi.playButton->setText("Pause");
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Change the replay speed
+*/
+
+void PowerManagementReplayGui::on_speedSpinBox_valueChanged(int rate)
+{
+    player.setSpeed(rate);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Seek to the time at which the slider was left
+*/
+
+void PowerManagementReplayGui::on_positionSlider_sliderReleased()
+{
+    emit replayRestarted();
+    player.seek((qint64)PowerManagementReplayUi.positionSlider->value()*1000000);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Show the replay time
+
+The slider is not moved while it is being dragged.
+*/
+
+void PowerManagementReplayGui::onPositionChanged(qint64 position)
+{
+    if (! PowerManagementReplayUi.positionSlider->isSliderDown())
+        PowerManagementReplayUi.positionSlider->setValue(position/1000000);
+    QDateTime time = QDateTime::fromMSecsSinceEpoch(player.startTime()
+                                                    + position/1000);
+    PowerManagementReplayUi.timeLabel->setText(QString("%1  (%2 of %3 s)")
+                    .arg(time.toString("yyyy-MM-dd hh:mm:ss"))
+                    .arg(position/1000000).arg(player.duration()/1000000));
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Show the last command that was sent to the BMS
+*/
+
+void PowerManagementReplayGui::onLineSent(const QString& line)
+{
+    PowerManagementReplayUi.sentLabel->setText("Sent: " + line);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Replay has reached the end of the session
+*/
+
+void PowerManagementReplayGui::onFinished()
+{
+    PowerManagementReplayUi.playButton->setText("Play");
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Close the window
+*/
+
+void PowerManagementReplayGui::on_closeButton_clicked()
+{
+    close();
+}
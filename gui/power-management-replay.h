@@ -0,0 +1,70 @@
+/*          Power Management GUI Session Replay Header
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#ifndef POWER_MANAGEMENT_REPLAY_H
+#define POWER_MANAGEMENT_REPLAY_H
+
+#include "power-management-message.h"
+#include "power-management-session.h"
+#include "ui_power-management-replay.h"
+#include <QDialog>
+
+//-----------------------------------------------------------------------------
+/** @brief Power Management Session Replay Window.
+
+Controls the replay of a session. The messages replayed are passed to the main
+window as if they had come from the link. The replayRestarted signal is sent
+when a session is opened and on each seek, so that the main window can clear
+the history that the monitor plots are drawn from.
+*/
+
+class PowerManagementReplayGui : public QDialog
+{
+    Q_OBJECT
+public:
+    PowerManagementReplayGui(QWidget* parent = 0);
+    ~PowerManagementReplayGui();
+signals:
+    void messageReplayed(const Message& message);
+    void replayRestarted();
+private slots:
+    void on_openButton_clicked();
+    void on_playButton_clicked();
+    void on_speedSpinBox_valueChanged(int rate);
+    void on_positionSlider_sliderReleased();
+    void on_closeButton_clicked();
+    void onPositionChanged(qint64 position);
+    void onLineSent(const QString& line);
+    void onFinished();
+private:
+// User Interface object instance
+    Ui::PowerManagementReplayDialog PowerManagementReplayUi;
+    SessionPlayer player;
+};
+
+#endif
@@ -0,0 +1,330 @@
+/*       Power Management Session Player
+
+Sessions saved by the capture writer are played back through the same decoding
+as the link, so that the windows can be used to review a recording without the
+BMS.
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include "power-management-session.h"
+#include <QDataStream>
+
+//-----------------------------------------------------------------------------
+/** Session Player Constructor
+*/
+
+SessionPlayer::SessionPlayer(QObject* parent) : QObject(parent)
+{
+    sessionStart = 0;
+    sessionDuration = 0;
+    dataEnd = 0;
+    haveNext = false;
+    clockBase = 0;
+    speed = 1;
+    tick.setInterval(SESSION_REPLAY_TICK);
+    connect(&tick, SIGNAL(timeout()), this, SLOT(onTick()));
+}
+
+SessionPlayer::~SessionPlayer()
+{
+    close();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Open a session file ready to play from the start
+
+@param[in] fileName Name of the session file.
+@returns false if the file could not be read as a session.
+*/
+
+bool SessionPlayer::open(QString fileName)
+{
+    close();
+    errorMessage.clear();
+    file.setFileName(fileName);
+    if (! file.open(QIODevice::ReadOnly))
+    {
+        errorMessage = QString("Could not open %1: %2")
+                        .arg(fileName).arg(file.errorString());
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    quint32 magic, version;
+    stream >> magic >> version >> sessionStart;
+    if ((stream.status() != QDataStream::Ok) || (magic != SESSION_MAGIC) ||
+        (version != SESSION_VERSION))
+    {
+        errorMessage = QString("%1 is not a session file").arg(fileName);
+        file.close();
+        return false;
+    }
+    if (! loadIndex()) buildIndex();
+    seek(0);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Stop playing and close the file
+*/
+
+void SessionPlayer::close()
+{
+    tick.stop();
+    if (file.isOpen()) file.close();
+    indexTimes.clear();
+    indexOffsets.clear();
+    haveNext = false;
+    sessionDuration = 0;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Session details
+
+@returns startTime: host time in ms since epoch at which recording started.
+@returns duration: time in us from the start to the last line.
+@returns position: time in us of the replay from the start.
+*/
+
+bool SessionPlayer::isOpen() const
+{
+    return file.isOpen();
+}
+
+QString SessionPlayer::error() const
+{
+    return errorMessage;
+}
+
+qint64 SessionPlayer::startTime() const
+{
+    return sessionStart;
+}
+
+qint64 SessionPlayer::duration() const
+{
+    return sessionDuration;
+}
+
+qint64 SessionPlayer::position() const
+{
+    if (! tick.isActive()) return clockBase;
+    return qMin(clockBase + clock.nsecsElapsed()/1000*speed, sessionDuration);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the replay speed as a multiple of real time
+
+@param[in] rate: 1 to SESSION_MAX_SPEED.
+*/
+
+void SessionPlayer::setSpeed(int rate)
+{
+    qint64 now = position();
+    speed = qBound(1, rate, SESSION_MAX_SPEED);
+    restartClock(now);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Start, pause and check the replay
+*/
+
+void SessionPlayer::play()
+{
+    if (! file.isOpen() || tick.isActive()) return;
+    clock.start();
+    tick.start();
+}
+
+void SessionPlayer::pause()
+{
+    if (! tick.isActive()) return;
+    clockBase = position();
+    tick.stop();
+}
+
+bool SessionPlayer::isPlaying() const
+{
+    return tick.isActive();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Move the replay to a time
+
+Replay carries on from the first line at or after the time, from the index
+entry before it. Lines passed over are not given out.
+
+@param[in] time: time in us from the start of the session.
+*/
+
+void SessionPlayer::seek(qint64 time)
+{
+    if (! file.isOpen()) return;
+    time = qBound((qint64)0, time, sessionDuration);
+    int entry = 0;
+    while ((entry+1 < indexTimes.size()) && (indexTimes[entry+1] <= time)) entry++;
+    file.seek(indexTimes.isEmpty() ? SESSION_HEADER_SIZE : indexOffsets[entry]);
+    haveNext = readBlock(&next);
+    while (haveNext && (next.time < time)) haveNext = readBlock(&next);
+    restartClock(time);
+    emit positionChanged(time);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Replay the lines due
+
+Lines up to the current replay time are given out. If there are too many for
+one step the replay clock is held back to the last line given out.
+*/
+
+void SessionPlayer::onTick()
+{
+    qint64 now = position();
+    int count = 0;
+    while (haveNext && (next.time <= now) && (count < SESSION_REPLAY_LINES))
+    {
+        QString line = QString::fromLatin1(next.line);
+        if (next.type == sessionReceived)
+            emit messageReplayed(decodeMessage(line, sessionStart + next.time/1000));
+        else if (next.type == sessionSent) emit lineSent(line);
+        now = qMax(now, next.time);
+        haveNext = readBlock(&next);
+        count++;
+    }
+    if (count >= SESSION_REPLAY_LINES) restartClock(now);
+    emit positionChanged(now);
+    if (! haveNext)
+    {
+        clockBase = sessionDuration;
+        tick.stop();
+        emit finished();
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Restart the replay clock from a time
+*/
+
+void SessionPlayer::restartClock(qint64 time)
+{
+    clockBase = time;
+    clock.start();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Read the block at the file position
+
+@param[out] block The block read.
+@returns false at the end of the lines, or if the block is damaged.
+*/
+
+bool SessionPlayer::readBlock(Block* block)
+{
+    if (file.pos() + SESSION_BLOCK_HEADER_SIZE > dataEnd) return false;
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    quint32 length;
+    quint8 type;
+    stream >> length >> type >> block->time;
+    if ((stream.status() != QDataStream::Ok) || (length > SESSION_MAX_LINE) ||
+        (type >= sessionIndex)) return false;
+    block->type = (SessionBlockType)type;
+    block->line = file.read(length);
+    return (block->line.size() == (int)length);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Load the index written when the session was closed
+
+@returns false if the file has no valid trailer and index.
+*/
+
+bool SessionPlayer::loadIndex()
+{
+    qint64 size = file.size();
+    if (size < SESSION_HEADER_SIZE + SESSION_TRAILER_SIZE) return false;
+    file.seek(size - SESSION_TRAILER_SIZE);
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    qint64 indexOffset, length;
+    quint32 magic;
+    stream >> indexOffset >> length >> magic;
+    if ((stream.status() != QDataStream::Ok) || (magic != SESSION_TRAILER_MAGIC) ||
+        (indexOffset < SESSION_HEADER_SIZE) ||
+        (indexOffset + SESSION_BLOCK_HEADER_SIZE > size - SESSION_TRAILER_SIZE))
+        return false;
+    file.seek(indexOffset);
+    quint32 indexLength;
+    quint8 type;
+    qint64 time;
+    stream >> indexLength >> type >> time;
+    if ((type != sessionIndex) || (indexOffset + SESSION_BLOCK_HEADER_SIZE
+            + indexLength + SESSION_TRAILER_SIZE != size)) return false;
+    for (quint32 i=0; i<indexLength/16; i++)
+    {
+        qint64 entryTime, entryOffset;
+        stream >> entryTime >> entryOffset;
+        indexTimes.append(entryTime);
+        indexOffsets.append(entryOffset);
+    }
+    if (stream.status() != QDataStream::Ok)
+    {
+        indexTimes.clear();
+        indexOffsets.clear();
+        return false;
+    }
+    dataEnd = indexOffset;
+    sessionDuration = length;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Build the index by reading through the blocks
+
+Used for a session that was not closed. The lines end at the first damaged or
+incomplete block.
+*/
+
+void SessionPlayer::buildIndex()
+{
+    dataEnd = file.size();
+    file.seek(SESSION_HEADER_SIZE);
+    qint64 nextIndexTime = 0;
+    qint64 offset = file.pos();
+    Block block;
+    while (readBlock(&block))
+    {
+        if (block.time >= nextIndexTime)
+        {
+            indexTimes.append(block.time);
+            indexOffsets.append(offset);
+            nextIndexTime = block.time + SESSION_INDEX_INTERVAL;
+        }
+        sessionDuration = block.time;
+        offset = file.pos();
+    }
+    dataEnd = offset;
+}
@@ -0,0 +1,112 @@
+/*          Power Management GUI Session Player Header
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#ifndef POWER_MANAGEMENT_SESSION_H
+#define POWER_MANAGEMENT_SESSION_H
+
+#include "power-management-message.h"
+#include "power-management-capture.h"
+#include <QObject>
+#include <QString>
+#include <QFile>
+#include <QList>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// Time in ms between replay steps
+#define SESSION_REPLAY_TICK 20
+// Most lines replayed in one step. Replay slows rather than stall the GUI.
+#define SESSION_REPLAY_LINES 1000
+// Longest line accepted, longer blocks are taken as the end of a damaged file
+#define SESSION_MAX_LINE    65536
+#define SESSION_MAX_SPEED   100
+
+//-----------------------------------------------------------------------------
+/** @brief Player of a session recorded by the capture writer.
+
+Received lines are decoded as by the link and given out in the time order of
+the recording, at a multiple of real time, with the host time at which they
+were first received. Lines sent to the BMS are given out as text.
+
+The index at the end of the file is used to seek to a time. If the file was
+not closed, and so has no index, the index is built by reading through the
+blocks when the file is opened.
+*/
+
+class SessionPlayer : public QObject
+{
+    Q_OBJECT
+public:
+    SessionPlayer(QObject* parent = 0);
+    ~SessionPlayer();
+    bool open(QString fileName);
+    void close();
+    bool isOpen() const;
+    QString error() const;
+    qint64 startTime() const;
+    qint64 duration() const;
+    qint64 position() const;
+    void setSpeed(int rate);
+    void play();
+    void pause();
+    bool isPlaying() const;
+    void seek(qint64 time);
+signals:
+    void messageReplayed(const Message& message);
+    void lineSent(const QString& line);
+    void positionChanged(qint64 position);
+    void finished();
+private slots:
+    void onTick();
+private:
+    struct Block
+    {
+        SessionBlockType type;
+        qint64 time;
+        QByteArray line;
+    };
+    bool readBlock(Block* block);
+    bool loadIndex();
+    void buildIndex();
+    void restartClock(qint64 time);
+    QFile file;
+    QString errorMessage;
+    qint64 sessionStart;
+    qint64 sessionDuration;
+    qint64 dataEnd;
+    QList<qint64> indexTimes;
+    QList<qint64> indexOffsets;
+    Block next;
+    bool haveNext;
+    qint64 clockBase;
+    QElapsedTimer clock;
+    int speed;
+    QTimer tick;
+};
+
+#endif
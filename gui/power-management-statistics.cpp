@@ -0,0 +1,179 @@
+/*       Power Management Link Statistics
+
+Rates of bytes, lines and messages of each kind on the link to the BMS, and
+the use made of the serial line, for the diagnostics window and the capture
+daemon.
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include "power-management-statistics.h"
+
+//-----------------------------------------------------------------------------
+/** Link Statistics Constructor
+
+The baud rate is taken from the link unless one is given.
+*/
+
+LinkStatistics::LinkStatistics()
+{
+    baudrate = 0;
+    linkBaudrate = 0;
+    reset();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Start the rates afresh from the next sample
+*/
+
+void LinkStatistics::reset()
+{
+    lastTime = 0;
+    lastBytesRead = 0;
+    lastBytesWritten = 0;
+    lastLines = 0;
+    readRate = 0;
+    writeRate = 0;
+    lineRate = 0;
+    for (int i=0; i<numberMessageIds; i++)
+    {
+        lastMessages[i] = 0;
+        messageRates[i] = 0;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Give the baud rate of the serial line
+
+Used when the link is by TCP to a serial line of known rate.
+
+@param[in] rate: baud rate, zero to take it from the link.
+*/
+
+void LinkStatistics::setBaudrate(qint32 rate)
+{
+    baudrate = rate;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Take the counters of a link and work out the rates since the last
+
+@param[in] link: link sampled.
+@param[in] time: host time of the sample in ms.
+*/
+
+void LinkStatistics::sample(const Link* link, qint64 time)
+{
+    qint64 bytesRead = link->bytesRead();
+    qint64 bytesWritten = link->bytesWritten();
+    qint64 lines = link->linesRead();
+    linkBaudrate = link->baudrate();
+    bool restart = (lastTime == 0) || (time <= lastTime) ||
+                   (bytesRead < lastBytesRead) || (lines < lastLines);
+    double interval = (double)(time - lastTime)/1000;
+    for (int i=0; i<numberMessageIds; i++)
+    {
+        qint64 count = link->messages((MessageId)i);
+        messageRates[i] = restart ? 0 : (count - lastMessages[i])/interval;
+        lastMessages[i] = count;
+    }
+    readRate = restart ? 0 : (bytesRead - lastBytesRead)/interval;
+    writeRate = restart ? 0 : (bytesWritten - lastBytesWritten)/interval;
+    lineRate = restart ? 0 : (lines - lastLines)/interval;
+    lastBytesRead = bytesRead;
+    lastBytesWritten = bytesWritten;
+    lastLines = lines;
+    lastTime = time;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Rates over the last interval, per second
+*/
+
+double LinkStatistics::bytesReadRate() const
+{
+    return readRate;
+}
+
+double LinkStatistics::bytesWrittenRate() const
+{
+    return writeRate;
+}
+
+double LinkStatistics::linesRate() const
+{
+    return lineRate;
+}
+
+double LinkStatistics::messageRate(MessageId id) const
+{
+    return messageRates[id];
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Fraction of the serial line capacity used
+
+@returns fraction used by the busier direction, negative if not known.
+*/
+
+double LinkStatistics::utilisation() const
+{
+    qint32 rate = (baudrate > 0) ? baudrate : linkBaudrate;
+    if (rate <= 0) return -1;
+    return qMax(readRate, writeRate)*STATISTICS_BITS_PER_BYTE/rate;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief One line summary of the rates and the link counters
+*/
+
+QString LinkStatistics::summary(const Link* link) const
+{
+    QString text = QString("in %1 B/s out %2 B/s lines %3/s malformed %4 "
+                           "dropped %5 gaps %6")
+                    .arg(readRate,0,'f',0).arg(writeRate,0,'f',0)
+                    .arg(lineRate,0,'f',1).arg(link->linesMalformed())
+                    .arg(link->framesDropped()).arg(link->timeGaps());
+    if (utilisation() >= 0)
+        text.append(QString(" use %1%").arg(utilisation()*100,0,'f',1));
+    if (link->commandsSent() > 0)
+        text.append(QString(" rtt %1/%2 ms repeated %3 failed %4")
+                    .arg(link->roundTripMean(),0,'f',0).arg(link->roundTripMax())
+                    .arg(link->commandsRepeated()).arg(link->commandsFailed()));
+    return text;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Ident of the messages counted under an identity
+*/
+
+QString LinkStatistics::identName(MessageId id)
+{
+    static const char* names[numberMessageIds] =
+        {"other", "pH", "pQ", "dB1", "dB2", "dB3", "dL1", "dL2", "dM1",
+         "dO1", "dO2", "dO3", "dC1", "dC2", "dC3", "dT", "dD", "dS", "ds",
+         "dI", "dE"};
+    return names[id];
+}
@@ -0,0 +1,79 @@
+/*          Power Management GUI Link Statistics Header
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#ifndef POWER_MANAGEMENT_STATISTICS_H
+#define POWER_MANAGEMENT_STATISTICS_H
+
+#include "power-management-message.h"
+#include "power-management-link.h"
+#include <QString>
+
+// Bits sent on a serial line for each byte, with start and stop bits
+#define STATISTICS_BITS_PER_BYTE 10
+
+//-----------------------------------------------------------------------------
+/** @brief Rates of traffic on a link.
+
+The link counters are sampled at intervals chosen by the caller, and the rates
+are those over the last interval. Utilisation is the busier direction as a
+fraction of the capacity of the serial line, or negative if the baud rate is
+not known, as for a TCP link without one given.
+
+A link replaced by a new one, whose counters start again from zero, starts the
+rates afresh.
+*/
+
+class LinkStatistics
+{
+public:
+    LinkStatistics();
+    void reset();
+    void setBaudrate(qint32 rate);
+    void sample(const Link* link, qint64 time);
+    double bytesReadRate() const;
+    double bytesWrittenRate() const;
+    double linesRate() const;
+    double messageRate(MessageId id) const;
+    double utilisation() const;
+    QString summary(const Link* link) const;
+    static QString identName(MessageId id);
+private:
+    qint32 baudrate;
+    qint32 linkBaudrate;
+    qint64 lastTime;
+    qint64 lastBytesRead;
+    qint64 lastBytesWritten;
+    qint64 lastLines;
+    qint64 lastMessages[numberMessageIds];
+    double readRate;
+    double writeRate;
+    double lineRate;
+    double messageRates[numberMessageIds];
+};
+
+#endif
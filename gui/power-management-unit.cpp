@@ -0,0 +1,466 @@
+/*       Power Management Unit Connection
+
+A connection to one BMS unit, used by the capture daemon and by the multiple
+unit display. Each unit has its own link, capture file and keep-alive.
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include "power-management-unit.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+#include <cstdio>
+
+//-----------------------------------------------------------------------------
+/** Unit Connection Constructor
+
+@param[in] name Name of the unit, used for its capture files.
+@param[in] directory Directory for the capture files. Empty for no capture.
+@param[in] parent Parent object.
+*/
+
+UnitConnection::UnitConnection(QString name, QString directory, QObject* parent)
+                : QObject(parent)
+{
+    unitName = name;
+    captureDirectory = directory;
+    baudrate = 0;
+    tcpPort = 0;
+    link = NULL;
+    linkOpen = false;
+    dropped = 0;
+    nextFileTime = 0;
+    retryTime = 0;
+    retryDelay = UNIT_RETRY_DELAY;
+    statisticsInterval = 0;
+    nextReport = 0;
+    for (int i=0; i<3; i++)
+    {
+        latest.batteryCurrent[i] = 0;
+        latest.batteryVoltage[i] = 0;
+        latest.batteryCharge[i] = 0;
+    }
+    for (int i=0; i<2; i++)
+    {
+        latest.loadCurrent[i] = 0;
+        latest.loadVoltage[i] = 0;
+    }
+    latest.panelCurrent = 0;
+    latest.panelVoltage = 0;
+    latest.temperature = 0;
+    latest.lastMessage = 0;
+    latest.messages = 0;
+    housekeeping.setInterval(UNIT_HOUSEKEEPING_INTERVAL);
+    connect(&housekeeping, SIGNAL(timeout()), this, SLOT(onHousekeeping()));
+}
+
+UnitConnection::~UnitConnection()
+{
+    stop();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Use a serial port for the link
+*/
+
+void UnitConnection::setSerial(QString device, qint32 rate)
+{
+    serialDevice = device;
+    baudrate = rate;
+    tcpAddress.clear();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Use a TCP connection for the link
+*/
+
+void UnitConnection::setTcp(QString address, quint16 port)
+{
+    tcpAddress = address;
+    tcpPort = port;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the capture file options
+
+@param[in] syncInterval Time in ms between synchronising the file to storage.
+@param[in] timestamps Put the host time in front of each line saved.
+*/
+
+void UnitConnection::setCaptureOptions(int syncInterval, bool timestamps)
+{
+    capture.setSyncInterval(syncInterval);
+    capture.setTimestamps(timestamps);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Report the link statistics at intervals
+
+Rates are over each interval. The first report follows one interval after the
+link opens.
+
+@param[in] seconds Time between reports, zero for none.
+*/
+
+void UnitConnection::setStatisticsInterval(int seconds)
+{
+    statisticsInterval = seconds;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Start the unit
+
+The link is opened from the first housekeeping tick.
+*/
+
+void UnitConnection::start()
+{
+    retryTime = 0;
+    housekeeping.start();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Stop the unit
+
+The BMS is told to stop sending, and the capture file is written out and
+closed.
+*/
+
+void UnitConnection::stop()
+{
+    housekeeping.stop();
+    if (link != NULL)
+    {
+        if (linkOpen) link->write("pc-\n\r");
+        dropped += link->framesDropped();
+        link->disconnect(this);
+        delete link;
+        link = NULL;
+        linkOpen = false;
+    }
+    capture.close();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Unit details
+*/
+
+QString UnitConnection::name() const
+{
+    return unitName;
+}
+
+QString UnitConnection::address() const
+{
+    if (tcpAddress.isEmpty()) return serialDevice;
+    return QString("%1:%2").arg(tcpAddress).arg(tcpPort);
+}
+
+bool UnitConnection::isOpen() const
+{
+    return linkOpen;
+}
+
+const UnitState& UnitConnection::state() const
+{
+    return latest;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Messages lost because the unit was not read in time
+*/
+
+qint64 UnitConnection::framesDropped() const
+{
+    if (link == NULL) return dropped;
+    return dropped + link->framesDropped();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Lines lost because the capture file could not keep up
+*/
+
+qint64 UnitConnection::linesDropped() const
+{
+    return capture.linesDropped();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Handle the messages received
+
+Each line is saved, and the keep-alive is returned on each time message. A new
+file is started when a message arrives on a new day.
+*/
+
+void UnitConnection::onMessagesAvailable()
+{
+    if (link == NULL) return;
+    Message message;
+    while (link->takeMessage(&message))
+    {
+        if ((message.id == messageTime) || (message.id == messageQuiescent))
+            link->write("pc+\n\r");
+        if (! captureDirectory.isEmpty())
+        {
+            if (message.time >= nextFileTime) openCapture(message.time);
+            capture.writeLine(message.line, message.time, message.stamp);
+        }
+        updateState(message);
+        emit messageReceived(message);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Start communications once the link is open
+
+On failure the link is closed and tried again later.
+*/
+
+void UnitConnection::onLinkOpened(bool ok)
+{
+    if (link == NULL) return;
+    if (! ok)
+    {
+        closeLink("unable to open link");
+        return;
+    }
+    linkOpen = true;
+    latest.lastMessage = QDateTime::currentMSecsSinceEpoch();
+    statistics.reset();
+    statistics.sample(link, latest.lastMessage);
+    nextReport = latest.lastMessage + statisticsInterval*1000;
+    fprintf(stderr, "%s: link open\n", qPrintable(unitName));
+/* Turn on microcontroller communications */
+    link->write("pc+\n\r");
+/* This should cause the microcontroller to respond with all data */
+    link->write("dS\n\r");
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Handle loss of the link
+*/
+
+void UnitConnection::onLinkClosed()
+{
+    closeLink("link lost");
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Periodic checks
+
+Reopen a closed link when its retry time is reached, close a link that has
+been silent for too long, and report the link statistics when due.
+*/
+
+void UnitConnection::onHousekeeping()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if ((link == NULL) && (now >= retryTime)) openLink();
+    else if (linkOpen && ((now - latest.lastMessage) > UNIT_SILENCE_TIMEOUT))
+        closeLink("no data received");
+    else if (linkOpen && (statisticsInterval > 0) && (now >= nextReport))
+    {
+        statistics.sample(link, now);
+        fprintf(stderr, "%s: %s\n", qPrintable(unitName),
+                qPrintable(statistics.summary(link)));
+        nextReport = now + statisticsInterval*1000;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Open the link
+
+A serial port opens at once. A TCP connection is attempted in the link thread
+and the result arrives later.
+*/
+
+void UnitConnection::openLink()
+{
+    link = new Link(this);
+    linkOpen = false;
+    connect(link, SIGNAL(messagesAvailable()), this, SLOT(onMessagesAvailable()));
+    connect(link, SIGNAL(opened(bool)), this, SLOT(onLinkOpened(bool)));
+    connect(link, SIGNAL(closed()), this, SLOT(onLinkClosed()));
+    if (tcpAddress.isEmpty()) link->openSerial(serialDevice, baudrate);
+    else link->openTcp(tcpAddress, tcpPort);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Close the link and set the time to try again
+
+A link that was open is retried after the first delay. Otherwise the delay is
+doubled up to its limit, so that a missing device is not polled continuously.
+The link may be the sender of the signal being handled, so it is deleted later.
+
+@param[in] reason Text to be reported.
+*/
+
+void UnitConnection::closeLink(QString reason)
+{
+    if (link == NULL) return;
+    fprintf(stderr, "%s: link closed: %s\n", qPrintable(unitName),
+            qPrintable(reason));
+    if (linkOpen) retryDelay = UNIT_RETRY_DELAY;
+    else retryDelay = qMin(retryDelay*2, UNIT_MAX_RETRY_DELAY);
+    retryTime = QDateTime::currentMSecsSinceEpoch() + retryDelay;
+    dropped += link->framesDropped();
+    link->disconnect(this);
+    link->deleteLater();
+    link = NULL;
+    linkOpen = false;
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Start the capture file for the day of a message
+
+Files are named by unit and date and are appended to if they already exist, so
+that a restart during the day continues the same file. Lines arriving while no
+file can be opened are lost.
+
+@param[in] time Host time of the message in ms since epoch.
+*/
+
+void UnitConnection::openCapture(qint64 time)
+{
+    QDate day = QDateTime::fromMSecsSinceEpoch(time).date();
+    nextFileTime = QDateTime(day.addDays(1), QTime(0,0)).toMSecsSinceEpoch();
+    if (capture.isOpen())
+    {
+        if (capture.linesDropped() > 0)
+            fprintf(stderr, "%s: capture lines dropped: %lld\n",
+                    qPrintable(unitName), (long long)capture.linesDropped());
+        capture.close();
+    }
+    QString fileName = QDir(captureDirectory).filePath(QString("%1-%2.csv")
+                            .arg(unitName).arg(day.toString("yyyyMMdd")));
+    if (! capture.open(fileName, true))
+    {
+        fprintf(stderr, "%s: unable to open capture file %s\n",
+                qPrintable(unitName), qPrintable(fileName));
+// Try again in a minute rather than on every message
+        nextFileTime = time + 60000;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Keep the latest values of the main measurements
+*/
+
+void UnitConnection::updateState(const Message& message)
+{
+    latest.lastMessage = message.time;
+    latest.messages++;
+    if (message.size < 2) return;
+    int first = message.value[1];
+    int second = (message.size > 2) ? message.value[2] : 0;
+    switch (message.id)
+    {
+    case messageBattery1:
+    case messageBattery2:
+    case messageBattery3:
+        latest.batteryCurrent[message.id-messageBattery1] = first;
+        latest.batteryVoltage[message.id-messageBattery1] = second;
+        break;
+    case messageCharge1:
+    case messageCharge2:
+    case messageCharge3:
+        latest.batteryCharge[message.id-messageCharge1] = first;
+        break;
+    case messageLoad1:
+    case messageLoad2:
+        latest.loadCurrent[message.id-messageLoad1] = first;
+        latest.loadVoltage[message.id-messageLoad1] = second;
+        break;
+    case messagePanel:
+        latest.panelCurrent = first;
+        latest.panelVoltage = second;
+        break;
+    case messageTemperature:
+        latest.temperature = first;
+        break;
+    default:
+        break;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Create the units listed in a file
+
+Each line names a unit and its link, either
+
+name,serial,device,baudrate
+name,tcp,address,port
+
+Blank lines and lines starting with # are ignored.
+
+@param[in] fileName Name of the units file.
+@param[in] directory Directory for the capture files. Empty for no capture.
+@param[in] parent Parent object of the units.
+@param[out] error Description of the first error found.
+@returns list of units, empty on error.
+*/
+
+QList<UnitConnection*> loadUnits(QString fileName, QString directory,
+                                 QObject* parent, QString* error)
+{
+    QList<UnitConnection*> units;
+    QFile inFile(fileName);
+    if (! inFile.open(QIODevice::ReadOnly))
+    {
+        *error = QString("Unable to open units file %1").arg(fileName);
+        return units;
+    }
+    QTextStream inStream(&inFile);
+    int lineNumber = 0;
+    while (! inStream.atEnd())
+    {
+        QString line = inStream.readLine().simplified();
+        lineNumber++;
+        if (line.isEmpty() || line.startsWith('#')) continue;
+        QStringList fields = line.split(",");
+        for (int i=0; i<fields.size(); i++) fields[i] = fields[i].trimmed();
+        bool ok = (fields.size() == 4) && ! fields[0].isEmpty();
+        uint parameter = 0;
+        if (ok) parameter = fields[3].toUInt(&ok);
+        if (ok && (fields[1] != "serial") && (fields[1] != "tcp")) ok = false;
+        if (! ok)
+        {
+            *error = QString("Invalid unit on line %1 of %2")
+                        .arg(lineNumber).arg(fileName);
+            qDeleteAll(units);
+            units.clear();
+            return units;
+        }
+        UnitConnection* unit = new UnitConnection(fields[0], directory, parent);
+        if (fields[1] == "serial") unit->setSerial(fields[2], parameter);
+        else unit->setTcp(fields[2], parameter);
+        units.append(unit);
+    }
+    return units;
+}
+
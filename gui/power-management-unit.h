@@ -0,0 +1,136 @@
+/*          Power Management GUI Unit Connection Header
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#ifndef POWER_MANAGEMENT_UNIT_H
+#define POWER_MANAGEMENT_UNIT_H
+
+#include "power-management-message.h"
+#include "power-management-link.h"
+#include "power-management-capture.h"
+#include "power-management-statistics.h"
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QTimer>
+
+// Time in ms between checks of the link and of the capture file date
+#define UNIT_HOUSEKEEPING_INTERVAL 1000
+// Time in ms without any message after which the link is reopened
+#define UNIT_SILENCE_TIMEOUT 120000
+// First and longest delay in ms before a failed link is reopened
+#define UNIT_RETRY_DELAY 1000
+#define UNIT_MAX_RETRY_DELAY 60000
+
+//-----------------------------------------------------------------------------
+/** @brief Latest values received from a unit.
+
+Values are in the fixed point scale sent by the BMS.
+*/
+
+struct UnitState
+{
+    int batteryCurrent[3];
+    int batteryVoltage[3];
+    int batteryCharge[3];
+    int loadCurrent[2];
+    int loadVoltage[2];
+    int panelCurrent;
+    int panelVoltage;
+    int temperature;
+    qint64 lastMessage;
+    qint64 messages;
+};
+
+//-----------------------------------------------------------------------------
+/** @brief Connection to one BMS unit with its own capture file.
+
+Opens the link by serial or TCP, returns the keep-alive on each time message,
+keeps the latest values received and saves every line to a capture file for
+each day. The link and the capture writer run in threads of their own, so a
+slow link or file does not hold up other units in the same process. All
+waiting is done by timers. A link that fails to open, is lost, or falls silent
+is closed and reopened after a delay that doubles on each failure.
+
+If no capture directory is given no files are written. Statistics of the link
+can be reported at intervals on stderr.
+*/
+
+class UnitConnection : public QObject
+{
+    Q_OBJECT
+public:
+    UnitConnection(QString name, QString directory, QObject* parent = 0);
+    ~UnitConnection();
+    void setSerial(QString device, qint32 baudrate);
+    void setTcp(QString address, quint16 port);
+    void setCaptureOptions(int syncInterval, bool timestamps);
+    void setStatisticsInterval(int seconds);
+    void start();
+    void stop();
+    QString name() const;
+    QString address() const;
+    bool isOpen() const;
+    const UnitState& state() const;
+    qint64 framesDropped() const;
+    qint64 linesDropped() const;
+signals:
+    void messageReceived(const Message& message);
+private slots:
+    void onMessagesAvailable();
+    void onLinkOpened(bool ok);
+    void onLinkClosed();
+    void onHousekeeping();
+private:
+    void openLink();
+    void closeLink(QString reason);
+    void openCapture(qint64 time);
+    void updateState(const Message& message);
+    QString unitName;
+    QString serialDevice;
+    qint32 baudrate;
+    QString tcpAddress;
+    quint16 tcpPort;
+    QString captureDirectory;
+    Link* link;
+    bool linkOpen;
+    qint64 dropped;
+    CaptureWriter capture;
+    QTimer housekeeping;
+    UnitState latest;
+    qint64 nextFileTime;
+    qint64 retryTime;
+    int retryDelay;
+    LinkStatistics statistics;
+    int statisticsInterval;
+    qint64 nextReport;
+};
+
+QList<UnitConnection*> loadUnits(QString fileName, QString directory,
+                                 QObject* parent, QString* error);
+
+#endif
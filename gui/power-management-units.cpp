@@ -0,0 +1,144 @@
+/*       Power Management Multiple Units Window
+
+Several BMS units are monitored from one process. Each unit has its own link,
+keep-alive and capture file, and this window summarises them all.
+
+@date 16 October 2026
+*/
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#include "power-management-units.h"
+#include <QDateTime>
+#include <QHeaderView>
+#include <QStringList>
+
+// Table columns
+typedef enum {columnUnit, columnAddress, columnLink, columnAge, columnMessages,
+              columnBattery1, columnBattery2, columnBattery3,
+              columnLoad1, columnLoad2, columnPanel, columnTemperature,
+              columnDropped, numberColumns} UnitColumn;
+
+//-----------------------------------------------------------------------------
+/** Power Management Units Window Constructor
+
+The window takes ownership of the units and starts them.
+
+@param[in] unitList Units to be monitored.
+@param[in] parent Parent widget.
+*/
+
+PowerManagementUnitsGui::PowerManagementUnitsGui(QList<UnitConnection*> unitList,
+                                                 QWidget* parent)
+                                                : QDialog(parent)
+{
+    PowerManagementUnitsUi.setupUi(this);
+    units = unitList;
+    model = new QStandardItemModel(units.size(), numberColumns, this);
+    model->setHorizontalHeaderLabels(QStringList() << "Unit" << "Link"
+                                     << "State" << "Age (s)" << "Messages"
+                                     << "Battery 1" << "Battery 2"
+                                     << "Battery 3" << "Load 1" << "Load 2"
+                                     << "Panel" << "Temp" << "Dropped");
+    for (int row=0; row<units.size(); row++)
+    {
+        for (int column=0; column<numberColumns; column++)
+            model->setItem(row, column, new QStandardItem());
+        units[row]->setParent(this);
+        setCell(row, columnUnit, units[row]->name());
+        setCell(row, columnAddress, units[row]->address());
+        units[row]->start();
+    }
+    PowerManagementUnitsUi.unitTableView->setModel(model);
+    PowerManagementUnitsUi.unitTableView->horizontalHeader()
+        ->setSectionResizeMode(QHeaderView::ResizeToContents);
+    refreshTimer.setInterval(UNITS_REFRESH_INTERVAL);
+    connect(&refreshTimer, SIGNAL(timeout()), this, SLOT(onRefresh()));
+    refreshTimer.start();
+}
+
+PowerManagementUnitsGui::~PowerManagementUnitsGui()
+{
+    for (int i=0; i<units.size(); i++) units[i]->stop();
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Refresh the table
+
+Battery cells show voltage, current and state of charge. Load and panel cells
+show current and voltage.
+*/
+
+void PowerManagementUnitsGui::onRefresh()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (int row=0; row<units.size(); row++)
+    {
+        const UnitConnection* unit = units[row];
+        const UnitState& state = unit->state();
+        setCell(row, columnLink, unit->isOpen() ? "Open" : "Closed");
+        if (state.lastMessage > 0)
+            setCell(row, columnAge, QString("%1")
+                    .arg((now - state.lastMessage)/1000));
+        setCell(row, columnMessages, QString("%1").arg(state.messages));
+        for (int i=0; i<3; i++)
+            setCell(row, columnBattery1+i, QString("%1V %2A %3%")
+                    .arg((float)state.batteryVoltage[i]/256,0,'f',2)
+                    .arg((float)state.batteryCurrent[i]/256,0,'f',2)
+                    .arg((float)state.batteryCharge[i]/256,0,'f',0));
+        for (int i=0; i<2; i++)
+            setCell(row, columnLoad1+i, QString("%1A %2V")
+                    .arg((float)state.loadCurrent[i]/256,0,'f',2)
+                    .arg((float)state.loadVoltage[i]/256,0,'f',2));
+        setCell(row, columnPanel, QString("%1A %2V")
+                .arg((float)state.panelCurrent/256,0,'f',2)
+                .arg((float)state.panelVoltage/256,0,'f',2));
+        setCell(row, columnTemperature, QString("%1")
+                .arg((float)state.temperature/256,0,'f',1)
+                .append(QChar(0x00B0)).append("C"));
+        setCell(row, columnDropped, QString("%1")
+                .arg(unit->framesDropped() + unit->linesDropped()));
+    }
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Set the text of a cell only if it has changed
+*/
+
+void PowerManagementUnitsGui::setCell(int row, int column, const QString& text)
+{
+    QStandardItem* item = model->item(row, column);
+    if (item->text() != text) item->setText(text);
+}
+
+//-----------------------------------------------------------------------------
+/** @brief Close the window
+
+The units are stopped when the window is destroyed.
+*/
+
+void PowerManagementUnitsGui::on_closeButton_clicked()
+{
+    close();
+}
+
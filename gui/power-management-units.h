@@ -0,0 +1,68 @@
+/*          Power Management GUI Units Window Header
+
+@date 16 October 2026
+*/
+
+/****************************************************************************
+ *   Copyright (C) 2013 by Ken Sarkies                                      *
+ *   ksarkies@internode.on.net                                              *
+ *                                                                          *
+ *   This file is part of Power Management GUI                              *
+ *                                                                          *
+ *   Power Management GUI is free software; you can redistribute it and/or  *
+ *   modify it under the terms of the GNU General Public License as         *
+ *   published by the Free Software Foundation; either version 2 of the     *
+ *   License, or (at your option) any later version.                        *
+ *                                                                          *
+ *   Power Management GUI is distributed in the hope that it will be useful,*
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of         *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          *
+ *   GNU General Public License for more details.                           *
+ *                                                                          *
+ *   You should have received a copy of the GNU General Public License      *
+ *   along with Power Management GUI if not, write to the                   *
+ *   Free Software Foundation, Inc.,                                        *
+ *   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA.              *
+ ***************************************************************************/
+
+
+#ifndef POWER_MANAGEMENT_UNITS_H
+#define POWER_MANAGEMENT_UNITS_H
+
+#include "power-management-unit.h"
+#include "ui_power-management-units.h"
+#include <QDialog>
+#include <QList>
+#include <QTimer>
+#include <QStandardItemModel>
+
+// Time in ms between refreshes of the units table
+#define UNITS_REFRESH_INTERVAL 500
+
+//-----------------------------------------------------------------------------
+/** @brief Power Management Multiple Units Window.
+
+Shows a summary of the latest values of every unit. The table is refreshed on
+a timer from the state held by each unit, so the cost of the display depends
+on the number of units and not on the rate of messages.
+*/
+
+class PowerManagementUnitsGui : public QDialog
+{
+    Q_OBJECT
+public:
+    PowerManagementUnitsGui(QList<UnitConnection*> units, QWidget* parent = 0);
+    ~PowerManagementUnitsGui();
+private slots:
+    void onRefresh();
+    void on_closeButton_clicked();
+private:
+// User Interface object instance
+    Ui::PowerManagementUnitsDialog PowerManagementUnitsUi;
+    void setCell(int row, int column, const QString& text);
+    QList<UnitConnection*> units;
+    QStandardItemModel* model;
+    QTimer refreshTimer;
+};
+
+#endif
@@ -45,6 +45,7 @@ Uses: Qt version 4.8.1
 
 #include <unistd.h>
 #include "power-management-main.h"
+#include "power-management-units.h"
 #include <QApplication>
 #include <QMessageBox>
 
@@ -58,15 +59,22 @@ int main(int argc,char ** argv)
 /* Interpret any command line options */
     char c;
     opterr = 0;
+    int refreshRate = DISPLAY_REFRESH_RATE;
+    int syncInterval = CAPTURE_SYNC_INTERVAL;
+    bool timestamps = false;
+    QString unitsFile;
+    QString captureDirectory = ".";
+    qint64 historyCapacity = HISTORY_CAPACITY;
+    QString historyFile;
 #ifdef SERIAL
     QString serialDevice = DEFAULT_SERIAL_PORT;
     uint initialBaudrate = DEFAULT_BAUDRATE;
     int baudParm;
-    while ((c = getopt (argc, argv, "P:b:")) != -1)
+    while ((c = getopt (argc, argv, "P:b:B:r:f:Tu:d:H:m:")) != -1)
 #else
     QString tcpAddress = DEFAULT_TCP_ADDRESS;
     uint tcpPort = DEFAULT_TCP_PORT;
-    while ((c = getopt (argc, argv, "a:p:")) != -1)
+    while ((c = getopt (argc, argv, "a:p:B:r:f:Tu:d:H:m:")) != -1)
 #endif
     {
         switch (c)
@@ -104,13 +112,49 @@ int main(int argc,char ** argv)
             tcpPort = atoi(optarg);
             break;
 #endif
+// Benchmark of message decoding and dispatch
+        case 'B':
+            benchmarkDispatch(atoi(optarg));
+            return 0;
+// Display refresh rate
+        case 'r':
+            refreshRate = atoi(optarg);
+            break;
+// Capture file sync interval
+        case 'f':
+            syncInterval = atoi(optarg);
+            break;
+// Capture file host timestamps
+        case 'T':
+            timestamps = true;
+            break;
+// Units file for multiple unit monitoring
+        case 'u':
+            unitsFile = optarg;
+            break;
+// Capture directory for multiple units
+        case 'd':
+            captureDirectory = optarg;
+            break;
+// Number of samples held for the monitor window
+        case 'H':
+            historyCapacity = atoll(optarg);
+            break;
+// File to hold the monitor history
+        case 'm':
+            historyFile = optarg;
+            break;
 // Unknown
         case '?':
 #ifdef SERIAL
-            if ((optopt == 'P') || (optopt == 'b'))
+            if ((optopt == 'P') || (optopt == 'b') || (optopt == 'B')
+                 || (optopt == 'r') || (optopt == 'f') || (optopt == 'u')
+                 || (optopt == 'd') || (optopt == 'H') || (optopt == 'm'))
                 fprintf (stderr, "Option -%c requires an argument.\n", optopt);
 #else
-            if ((optopt == 'a') || (optopt == 'p'))
+            if ((optopt == 'a') || (optopt == 'p') || (optopt == 'B')
+                 || (optopt == 'r') || (optopt == 'f') || (optopt == 'u')
+                 || (optopt == 'd') || (optopt == 'H') || (optopt == 'm'))
                 fprintf (stderr, "Option -%c requires an argument.\n", optopt);
 #endif
             else if (isprint (optopt))
@@ -131,7 +175,29 @@ int main(int argc,char ** argv)
 #endif
 
     QApplication application(argc,argv);
+/* Monitor several units in one window if a units file is given */
+    if (! unitsFile.isEmpty())
+    {
+        QString error;
+        QList<UnitConnection*> units =
+            loadUnits(unitsFile,captureDirectory,0,&error);
+        if (units.isEmpty())
+        {
+            if (error.isEmpty()) error = "No units listed in " + unitsFile;
+            QMessageBox::critical(0,"Unable to read units file",error);
+            return false;
+        }
+        for (int i=0; i<units.size(); i++)
+            units[i]->setCaptureOptions(syncInterval,timestamps);
+        PowerManagementUnitsGui powerManagementUnitsGui(units);
+        powerManagementUnitsGui.show();
+        return application.exec();
+    }
     PowerManagementGui powerManagementGui(inDevice,parameter);
+    powerManagementGui.setRefreshRate(refreshRate);
+    powerManagementGui.setCaptureOptions(syncInterval,timestamps);
+    if (! powerManagementGui.setHistory(historyCapacity,historyFile))
+        fprintf (stderr, "%s\n", qPrintable(powerManagementGui.historyError()));
     if (powerManagementGui.success())
     {
         powerManagementGui.show();
@@ -25,13 +25,42 @@ FORMS           += power-management-main.ui
 FORMS           += power-management-monitor.ui
 FORMS           += power-management-configure.ui
 FORMS           += power-management-record.ui
+FORMS           += power-management-units.ui
+FORMS           += power-management-diagnostics.ui
+FORMS           += power-management-replay.ui
 HEADERS         += power-management-main.h
 HEADERS         += power-management-monitor.h
 HEADERS         += power-management-configure.h
 HEADERS         += power-management-record.h
+HEADERS         += power-management-message.h
+HEADERS         += power-management-dispatch.h
+HEADERS         += power-management-display.h
+HEADERS         += power-management-capture.h
+HEADERS         += power-management-unit.h
+HEADERS         += power-management-units.h
+HEADERS         += power-management-link.h
+HEADERS         += power-management-history.h
+HEADERS         += power-management-download.h
+HEADERS         += power-management-statistics.h
+HEADERS         += power-management-diagnostics.h
+HEADERS         += power-management-session.h
+HEADERS         += power-management-replay.h
 SOURCES         += power-management.cpp
 SOURCES         += power-management-main.cpp
 SOURCES         += power-management-monitor.cpp
 SOURCES         += power-management-configure.cpp
 SOURCES         += power-management-record.cpp
+SOURCES         += power-management-message.cpp
+SOURCES         += power-management-dispatch.cpp
+SOURCES         += power-management-display.cpp
+SOURCES         += power-management-capture.cpp
+SOURCES         += power-management-unit.cpp
+SOURCES         += power-management-units.cpp
+SOURCES         += power-management-link.cpp
+SOURCES         += power-management-history.cpp
+SOURCES         += power-management-download.cpp
+SOURCES         += power-management-statistics.cpp
+SOURCES         += power-management-diagnostics.cpp
+SOURCES         += power-management-session.cpp
+SOURCES         += power-management-replay.cpp
 